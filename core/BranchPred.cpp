@@ -0,0 +1,163 @@
+#include "BranchPred.hpp"
+#include "TageScL.hpp"
+#include "TargetPred.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+
+/*
+ * Every predictor predicts unconditional branches taken and finds
+ * targets in a BTB, overridden for returns and indirect jumps by
+ * TargetPredictor.  Only conditional branches use the direction
+ * tables.
+ */
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    std::unique_ptr<FetchBranchPredictorIF> createBranchPredictor(const std::string & type,
+                                                                  const PredictorConfig & config)
+    {
+        if (type == "perfect") {
+            return nullptr;
+        }
+        if (type == "simple") {
+            return std::make_unique<SimpleBranchPredictorAdapter>();
+        }
+
+        std::unique_ptr<FetchBranchPredictorIF> direction;
+        if (type == "bimodal") {
+            direction = std::make_unique<BimodalBranchPredictor>(config);
+        } else if (type == "gshare") {
+            direction = std::make_unique<GShareBranchPredictor>(config);
+        } else if (type == "tage_sc_l") {
+            direction = std::make_unique<TageScLBranchPredictor>(config);
+        }
+        if (nullptr != direction) {
+            if ((config.ras_entries == 0) && (config.ittage_num_tables == 0)) {
+                return direction;
+            }
+            return std::make_unique<TargetPredictor>(std::move(direction), config);
+        }
+        throw sparta::SpartaException("Unknown branch predictor '") << type
+            << "'.  Choose perfect, simple, bimodal, gshare or tage_sc_l";
+    }
+
+    BranchInput decodeBranch(uint64_t pc, uint64_t opcode)
+    {
+        auto is_link = [](uint64_t reg) { return (reg == 1) || (reg == 5); };
+
+        BranchInput input;
+        input.pc = pc;
+        input.is_conditional = true;
+        if ((opcode & 0x3) == 0x3) {
+            const uint64_t rd = (opcode >> 7) & 0x1f;
+            const uint64_t rs1 = (opcode >> 15) & 0x1f;
+            switch (opcode & 0x7f) {
+                case 0x6f: // jal
+                    input.is_conditional = false;
+                    input.is_call = is_link(rd);
+                    break;
+                case 0x67: // jalr
+                    input.is_conditional = false;
+                    input.is_indirect = true;
+                    input.is_call = is_link(rd);
+                    input.is_return = (rd != rs1) && is_link(rs1);
+                    break;
+                default:
+                    break;
+            }
+            return input;
+        }
+
+        input.inst_size = 2;
+        const uint64_t funct3 = (opcode >> 13) & 0x7;
+        const uint64_t quadrant = opcode & 0x3;
+        if ((quadrant == 0x1) && (funct3 == 0x5)) { // c.j
+            input.is_conditional = false;
+        } else if ((quadrant == 0x2) && (funct3 == 0x4) && (((opcode >> 2) & 0x1f) == 0)) {
+            // c.jr is jalr x0, c.jalr is jalr ra
+            const uint64_t rd = ((opcode >> 12) & 0x1) ? 1 : 0;
+            const uint64_t rs1 = (opcode >> 7) & 0x1f;
+            input.is_conditional = false;
+            input.is_indirect = true;
+            input.is_call = is_link(rd);
+            input.is_return = (rd != rs1) && is_link(rs1);
+        }
+        return input;
+    }
+
+    BranchPrediction SimpleBranchPredictorAdapter::getPrediction(const BranchInput & input) {
+        const DefaultPrediction simple = simple_.getPrediction({input.pc});
+        BranchPrediction prediction;
+        prediction.taken = (simple.predicted_PC != (input.pc + bytes_per_inst));
+        prediction.target = prediction.taken ? simple.predicted_PC : 0;
+        return prediction;
+    }
+
+    void SimpleBranchPredictorAdapter::updatePredictor(const BranchUpdate & update) {
+        DefaultUpdate simple;
+        simple.fetch_PC = update.branch.pc;
+        simple.branch_idx = 0;
+        simple.corrected_PC = update.target;
+        simple.actually_taken = update.taken;
+        simple_.updatePredictor(simple);
+    }
+
+    BranchPrediction BimodalBranchPredictor::getPrediction(const BranchInput & input) {
+        BranchPrediction prediction;
+        prediction.taken = (false == input.is_conditional) || pht_.isTaken(input.pc >> 1);
+        prediction.target = btb_.lookup(input.pc);
+        return prediction;
+    }
+
+    void BimodalBranchPredictor::updatePredictor(const BranchUpdate & update) {
+        if (update.branch.is_conditional) {
+            pht_.update(update.branch.pc >> 1, update.taken);
+        }
+        if (update.taken) {
+            btb_.update(update.branch.pc, update.target);
+        }
+    }
+
+    void BimodalBranchPredictor::saveCheckpoint(std::ostream & os) {
+        pht_.saveCheckpoint(os);
+        btb_.saveCheckpoint(os);
+    }
+
+    void BimodalBranchPredictor::restoreCheckpoint(std::istream & is) {
+        pht_.restoreCheckpoint(is);
+        btb_.restoreCheckpoint(is);
+    }
+
+    BranchPrediction GShareBranchPredictor::getPrediction(const BranchInput & input) {
+        BranchPrediction prediction;
+        prediction.taken = (false == input.is_conditional) || pht_.isTaken(index_(input.pc));
+        prediction.target = btb_.lookup(input.pc);
+        return prediction;
+    }
+
+    void GShareBranchPredictor::updatePredictor(const BranchUpdate & update) {
+        if (update.branch.is_conditional) {
+            pht_.update(index_(update.branch.pc), update.taken);
+            global_history_ = ((global_history_ << 1) | (update.taken ? 1 : 0)) & history_mask_;
+        }
+        if (update.taken) {
+            btb_.update(update.branch.pc, update.target);
+        }
+    }
+
+    void GShareBranchPredictor::saveCheckpoint(std::ostream & os) {
+        pht_.saveCheckpoint(os);
+        btb_.saveCheckpoint(os);
+        checkpoint::write(os, global_history_);
+    }
+
+    void GShareBranchPredictor::restoreCheckpoint(std::istream & is) {
+        pht_.restoreCheckpoint(is);
+        btb_.restoreCheckpoint(is);
+        global_history_ = checkpoint::read<uint64_t>(is) & history_mask_;
+    }
+
+} // namespace BranchPredictor
+} // namespace olympia
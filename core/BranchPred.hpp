@@ -0,0 +1,262 @@
+// <BranchPred.hpp> -*- C++ -*-
+
+//!
+//! \file BranchPred.hpp
+//! \brief Branch predictors used by Fetch, built on the branch prediction interface
+//!
+
+/*
+ * Fetch asks a predictor about one branch at a time and tells it the branch's
+ * real outcome right after, in program order.  The predictors here use flat,
+ * power-of-two sized tables so that a prediction never allocates.
+ * */
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BranchPredIF.hpp"
+#include "Checkpoint.hpp"
+#include "SimpleBranchPred.hpp"
+
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    //! A branch being fetched
+    class BranchInput
+    {
+    public:
+        uint64_t pc = 0;
+        bool is_conditional = false;
+        bool is_call = false;
+        bool is_return = false;
+        bool is_indirect = false; // Target from a register (returns too)
+        uint32_t inst_size = 4;   // Bytes: calls return past it
+    };
+
+    //! What a predictor expects the branch to do
+    class BranchPrediction
+    {
+    public:
+        bool taken = false;
+        // Predicted target of a taken branch.  0 if the predictor has none
+        uint64_t target = 0;
+    };
+
+    //! What the branch really did
+    class BranchUpdate
+    {
+    public:
+        BranchInput branch;
+        bool taken = false;
+        uint64_t target = 0;
+    };
+
+    using FetchBranchPredictorIF = BranchPredictorIF<BranchPrediction, BranchUpdate, BranchInput>;
+
+    /*!
+     * \brief A predictor whose tables carry over from functional
+     *        warming: they can be checkpointed, and the fraction of the
+     *        BTB in use tells how warm they are.  Checkpoints must be
+     *        taken with no prediction waiting for its update
+     */
+    class PredictorStateIF : public CheckpointableIF
+    {
+    public:
+        //! Fraction of BTB entries holding a target, [0, 1]
+        virtual double getBTBCoverage() const = 0;
+    };
+
+    /*!
+     * \brief Classify a branch from its RISC-V encoding, for branches
+     *        that are not decoded by Mavis (functional warming and
+     *        BranchPredEval).
+     *        Follows the call and return rules of Inst.  An encoding
+     *        that is not a branch is taken to be a conditional branch
+     */
+    BranchInput decodeBranch(uint64_t pc, uint64_t opcode);
+
+    //! Table sizes, as log2 of the number of entries, and history lengths
+    class PredictorConfig
+    {
+    public:
+        uint32_t pht_bits = 12;
+        uint32_t btb_bits = 10;
+        uint32_t history_bits = 12;
+
+        // TAGE-SC-L: pht_bits sizes the bimodal base
+        uint32_t tage_num_tables = 8;
+        uint32_t tage_table_bits = 10;
+        uint32_t tage_tag_bits = 11;
+        uint32_t tage_min_history = 4;
+        uint32_t tage_max_history = 640;
+        uint32_t sc_table_bits = 10;
+        uint32_t loop_set_bits = 4;
+
+        // Target prediction, for every predictor but "simple".  0
+        // turns the RAS or ITTAGE off
+        uint32_t ras_entries = 16;
+        uint32_t ittage_num_tables = 5;
+        uint32_t ittage_table_bits = 9;
+    };
+
+    /*!
+     * \brief Create a predictor by name: "simple", "bimodal", "gshare" or
+     *        "tage_sc_l".  All but "simple" predict return and indirect
+     *        targets with a RAS and ITTAGE (TargetPred.hpp), unless the
+     *        config turns them off.
+     *        "perfect" is nullptr: every branch is predicted correctly.
+     *        Throws on an unknown name
+     */
+    std::unique_ptr<FetchBranchPredictorIF> createBranchPredictor(const std::string & type,
+                                                                  const PredictorConfig & config);
+
+    //! Direct-mapped branch target buffer, tagged with the full PC
+    class BranchTargetBuffer
+    {
+    public:
+        explicit BranchTargetBuffer(uint32_t bits) :
+            entries_(1ull << bits),
+            mask_(entries_.size() - 1)
+        {}
+
+        //! Target of the branch at pc.  0 on a miss
+        uint64_t lookup(uint64_t pc) const {
+            const Entry & entry = entries_[index_(pc)];
+            return (entry.pc == pc) ? entry.target : 0;
+        }
+
+        void update(uint64_t pc, uint64_t target) {
+            entries_[index_(pc)] = {pc, target};
+        }
+
+        //! Fraction of entries holding a target
+        double getCoverage() const {
+            uint64_t num_valid = 0;
+            for (const auto & entry : entries_) {
+                num_valid += (entry.pc != std::numeric_limits<uint64_t>::max()) ? 1 : 0;
+            }
+            return static_cast<double>(num_valid) / entries_.size();
+        }
+
+        void saveCheckpoint(std::ostream & os) const { checkpoint::writeTable(os, entries_); }
+
+        void restoreCheckpoint(std::istream & is) { checkpoint::readTable(is, entries_); }
+
+    private:
+        struct Entry
+        {
+            uint64_t pc = std::numeric_limits<uint64_t>::max();
+            uint64_t target = 0;
+        };
+
+        size_t index_(uint64_t pc) const { return (pc >> 1) & mask_; }
+
+        std::vector<Entry> entries_;
+        const uint64_t mask_;
+    };
+
+    //! Table of 2-bit saturating counters, initialized weakly not taken
+    class CounterTable
+    {
+    public:
+        explicit CounterTable(uint32_t bits) :
+            counters_(1ull << bits, 1),
+            mask_(counters_.size() - 1)
+        {}
+
+        bool isTaken(uint64_t index) const { return counters_[index & mask_] > 1; }
+
+        void update(uint64_t index, bool taken) {
+            uint8_t & counter = counters_[index & mask_];
+            if (taken) {
+                counter = (counter == 3) ? 3 : (counter + 1);
+            } else {
+                counter = (counter == 0) ? 0 : (counter - 1);
+            }
+        }
+
+        void saveCheckpoint(std::ostream & os) const { checkpoint::writeTable(os, counters_); }
+
+        void restoreCheckpoint(std::istream & is) { checkpoint::readTable(is, counters_); }
+
+    private:
+        std::vector<uint8_t> counters_;
+        const uint64_t mask_;
+    };
+
+    /*!
+     * \brief The SimpleBranchPredictor queried one branch at a time:
+     *        each branch is its own one-instruction fetch packet
+     */
+    class SimpleBranchPredictorAdapter : public FetchBranchPredictorIF
+    {
+    public:
+        SimpleBranchPredictorAdapter() :
+            simple_(1)
+        {}
+
+        BranchPrediction getPrediction(const BranchInput & input) override;
+        void updatePredictor(const BranchUpdate & update) override;
+
+    private:
+        SimpleBranchPredictor simple_;
+    };
+
+    //! Per-PC 2-bit counters and a BTB
+    class BimodalBranchPredictor : public FetchBranchPredictorIF, public PredictorStateIF
+    {
+    public:
+        explicit BimodalBranchPredictor(const PredictorConfig & config) :
+            pht_(config.pht_bits),
+            btb_(config.btb_bits)
+        {}
+
+        BranchPrediction getPrediction(const BranchInput & input) override;
+        void updatePredictor(const BranchUpdate & update) override;
+
+        double getBTBCoverage() const override { return btb_.getCoverage(); }
+        void saveCheckpoint(std::ostream & os) override;
+        void restoreCheckpoint(std::istream & is) override;
+
+    private:
+        CounterTable pht_;
+        BranchTargetBuffer btb_;
+    };
+
+    //! 2-bit counters indexed by the PC xor the global history, and a BTB
+    class GShareBranchPredictor : public FetchBranchPredictorIF, public PredictorStateIF
+    {
+    public:
+        explicit GShareBranchPredictor(const PredictorConfig & config) :
+            pht_(config.pht_bits),
+            btb_(config.btb_bits),
+            history_mask_((config.history_bits >= 64) ? std::numeric_limits<uint64_t>::max()
+                                                      : ((1ull << config.history_bits) - 1))
+        {}
+
+        BranchPrediction getPrediction(const BranchInput & input) override;
+        void updatePredictor(const BranchUpdate & update) override;
+
+        double getBTBCoverage() const override { return btb_.getCoverage(); }
+        void saveCheckpoint(std::ostream & os) override;
+        void restoreCheckpoint(std::istream & is) override;
+
+    private:
+        uint64_t index_(uint64_t pc) const { return (pc >> 1) ^ global_history_; }
+
+        CounterTable pht_;
+        BranchTargetBuffer btb_;
+        const uint64_t history_mask_;
+        uint64_t global_history_ = 0;
+    };
+
+} // namespace BranchPredictor
+} // namespace olympia
@@ -8,8 +8,42 @@ constexpr char olympia::CPU::name[];
 
 //! \brief Constructor of this CPU Unit
 olympia::CPU::CPU(sparta::TreeNode* node, const olympia::CPU::CPUParameterSet* params) :
-    sparta::Unit{node}
+    sparta::Unit{node},
+    total_retired_(&unit_stat_set_, node),
+    stat_ipc_(&unit_stat_set_, "ipc", "Instructions retired per cycle by all cores",
+              &unit_stat_set_, "total_number_retired/cycles")
 {}
 
 //! \brief Destructor of this CPU Unit
 olympia::CPU::~CPU() = default;
+
+olympia::CPU::TotalRetiredCounter::TotalRetiredCounter(sparta::StatisticSet* stat_set,
+                                                       sparta::TreeNode* cpu_node) :
+    sparta::ReadOnlyCounter(stat_set, "total_number_retired",
+                            "The total number of instructions retired by all cores",
+                            sparta::CounterBase::COUNT_NORMAL, &unused_),
+    cpu_node_(cpu_node)
+{}
+
+//! \brief Sum of the cores' retired instruction counters
+auto olympia::CPU::TotalRetiredCounter::get() const -> counter_type
+{
+    if(core_counters_.empty()){
+        for(const auto child : cpu_node_->getChildren()){
+            if(child->getName().compare(0, 4, "core") != 0){
+                continue;
+            }
+            auto counter = child->getChild("rob.stats.total_number_retired", false);
+            if(counter != nullptr){
+                core_counters_.emplace_back(sparta::notNull(
+                    dynamic_cast<const sparta::CounterBase*>(counter)));
+            }
+        }
+    }
+
+    counter_type total = 0;
+    for(const auto counter : core_counters_){
+        total += counter->get();
+    }
+    return total;
+}
@@ -4,10 +4,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/statistics/ReadOnlyCounter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
 
 namespace olympia{
 
@@ -38,5 +41,33 @@ public:
     //! \brief Destructor of the CPU Unit
     ~CPU();
 
+private:
+
+    /**
+     * @brief Instructions retired by every core together: the sum of
+     *        the cores' rob.stats.total_number_retired
+     */
+    class TotalRetiredCounter : public sparta::ReadOnlyCounter{
+    public:
+        TotalRetiredCounter(sparta::StatisticSet* stat_set, sparta::TreeNode* cpu_node);
+
+        counter_type get() const override;
+
+    private:
+        sparta::TreeNode* const cpu_node_;
+
+        //! The cores' counters, found on first use (the cores are
+        //! built after the CPU)
+        mutable std::vector<const sparta::CounterBase*> core_counters_;
+
+        //! Unused: the value is computed by get()
+        const counter_type unused_ = 0;
+    };
+
+    TotalRetiredCounter total_retired_;
+
+    //! Aggregate (throughput) IPC of all cores
+    sparta::StatisticDef stat_ipc_;
+
 }; // class CPU
 }  // namespace olympia
@@ -15,6 +15,7 @@
 #include "MMU.hpp"
 #include "SimpleTLB.hpp"
 #include "BIU.hpp"
+#include "ICache.hpp"
 #include "L2Cache.hpp"
 #include "MSS.hpp"
 #include "ROB.hpp"
@@ -65,6 +66,10 @@ namespace olympia{
         sparta::ResourceFactory<olympia::DCache,
                 olympia::DCache::CacheParameterSet> dcache_rf;
 
+        //! \brief Resource Factory to build an ICache Unit
+        sparta::ResourceFactory<olympia::ICache,
+                olympia::ICache::ICacheParameterSet> icache_rf;
+
         //! \brief Resource Factory to build a TLB Unit
         sparta::ResourceFactory<olympia::SimpleTLB,
                 olympia::SimpleTLB::TLBParameterSet> tlb_rf;
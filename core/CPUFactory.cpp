@@ -27,43 +27,67 @@ auto olympia::CPUFactory::setTopology(const std::string& topology,
     topology_->setNumCores(num_cores);
 }
 
+/**
+ * @brief Replace the multicore wildcard with the core index
+ */
+auto olympia::CPUFactory::replaceWildcard_(std::string name,
+                                           const std::size_t core_idx) const -> std::string
+{
+    const std::string replace_with = std::to_string(core_idx);
+    for(auto pos = name.find(to_replace_); pos != std::string::npos;
+        pos = name.find(to_replace_, pos + replace_with.size())){
+        name.replace(pos, 1, replace_with);
+    }
+    return name;
+}
+
+/**
+ * @brief Implementation : Build one resource node
+ */
+auto olympia::CPUFactory::buildUnit_(sparta::RootTreeNode* root_node,
+                                     const olympia::CPUTopology::UnitInfo& unit,
+                                     const std::size_t core_idx) -> void
+{
+    const std::string parent_name = replaceWildcard_(unit.parent_name, core_idx);
+    const std::string node_name = replaceWildcard_(unit.name, core_idx);
+    const std::string human_name = replaceWildcard_(unit.human_name, core_idx);
+    auto parent_node = root_node->getChildAs<sparta::TreeNode>(parent_name);
+    auto rtn = new sparta::ResourceTreeNode(parent_node,
+                                            node_name,
+                                            unit.group_name,
+                                            unit.group_id,
+                                            human_name,
+                                            unit.factory);
+    if(unit.is_private_subtree){
+        rtn->makeSubtreePrivate();
+        private_nodes_.emplace_back(rtn);
+    }
+    to_delete_.emplace_back(rtn);
+    resource_names_.emplace_back(node_name);
+    // Add an extensions factory to create CoreExtensions when
+    // encountered in a YAML topo file.  This class establishes the
+    // type of the parameters defined in the CoreExtensions.  If not
+    // defined, any unknown extensions are considered pure strings.
+    rtn->addExtensionFactory(olympia::CoreExtensions::name,
+                             [&]() -> sparta::TreeNode::ExtensionsBase * {return new olympia::CoreExtensions();});
+}
+
 /**
  * @brief Implemenation : Build the device tree by instantiating resource nodes
  */
 auto olympia::CPUFactory::buildTree_(sparta::RootTreeNode* root_node,
                                      const std::vector<olympia::CPUTopology::UnitInfo>& units) -> void
 {
-    std::string parent_name, human_name, node_name, replace_with;
     for(std::size_t num_of_cores = 0; num_of_cores < topology_->num_cores; ++num_of_cores){
         for(const auto& unit : units){
-            parent_name = unit.parent_name;
-            node_name = unit.name;
-            human_name = unit.human_name;
-            replace_with = std::to_string(num_of_cores);
-            std::replace(parent_name.begin(), parent_name.end(), to_replace_, *replace_with.c_str());
-            std::replace(node_name.begin(), node_name.end(), to_replace_, *replace_with.c_str());
-            std::replace(human_name.begin(), human_name.end(), to_replace_, *replace_with.c_str());
-            auto parent_node = root_node->getChildAs<sparta::TreeNode>(parent_name);
-            auto rtn = new sparta::ResourceTreeNode(parent_node,
-                                                    node_name,
-                                                    unit.group_name,
-                                                    unit.group_id,
-                                                    human_name,
-                                                    unit.factory);
-            if(unit.is_private_subtree){
-                rtn->makeSubtreePrivate();
-                private_nodes_.emplace_back(rtn);
-            }
-            to_delete_.emplace_back(rtn);
-            resource_names_.emplace_back(node_name);
-            // Add an extensions factory to create CoreExtensions when
-            // encountered in a YAML topo file.  This class establishes the
-            // type of the parameters defined in the CoreExtensions.  If not
-            // defined, any unknown extensions are considered pure strings.
-            rtn->addExtensionFactory(olympia::CoreExtensions::name,
-                                     [&]() -> sparta::TreeNode::ExtensionsBase * {return new olympia::CoreExtensions();});
+            buildUnit_(root_node, unit, num_of_cores);
         }
     }
+
+    // Units every core shares are built once
+    for(const auto& unit : topology_->shared_units){
+        buildUnit_(root_node, unit, 0);
+    }
 }
 
 /**
@@ -72,16 +96,13 @@ auto olympia::CPUFactory::buildTree_(sparta::RootTreeNode* root_node,
 auto olympia::CPUFactory::bindTree_(sparta::RootTreeNode* root_node,
                                     const std::vector<olympia::CPUTopology::PortConnectionInfo>& ports) -> void
 {
-    std::string out_port_name, in_port_name,replace_with;
+    std::string out_port_name, in_port_name;
     for(std::size_t num_of_cores = 0; num_of_cores < topology_->num_cores; ++num_of_cores)
     {
         for(const auto& port : ports)
         {
-            out_port_name = port.output_port_name;
-            in_port_name = port.input_port_name;
-            replace_with = std::to_string(num_of_cores);
-            std::replace(out_port_name.begin(), out_port_name.end(), to_replace_, *replace_with.c_str());
-            std::replace(in_port_name.begin(), in_port_name.end(), to_replace_, *replace_with.c_str());
+            out_port_name = replaceWildcard_(port.output_port_name, num_of_cores);
+            in_port_name = replaceWildcard_(port.input_port_name, num_of_cores);
             sparta::bind(root_node->getChildAs<sparta::Port>(out_port_name),
                          root_node->getChildAs<sparta::Port>(in_port_name));
         }
@@ -64,6 +64,18 @@ private:
      */
     auto buildTree_(sparta::RootTreeNode*,
                     const std::vector<CPUTopology::UnitInfo>&) -> void;
+
+    /**
+     * @brief Implementation : Build one resource node for a core
+     */
+    auto buildUnit_(sparta::RootTreeNode*,
+                    const CPUTopology::UnitInfo&,
+                    const std::size_t) -> void;
+
+    /**
+     * @brief Replace every wildcard in a name with the core index
+     */
+    auto replaceWildcard_(std::string, const std::size_t) const -> std::string;
     /**
      * @brief Implementation : Bind all the ports between different units and set TLBs and preload
      */
@@ -35,6 +35,14 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
             sparta::TreeNode::GROUP_IDX_NONE,
             &factories->fetch_rf
         },
+        {
+            "icache",
+            "cpu.core*",
+            "Instruction Cache Unit",
+            sparta::TreeNode::GROUP_NAME_NONE,
+            sparta::TreeNode::GROUP_IDX_NONE,
+            &factories->icache_rf
+        },
         {
             "decode",
             "cpu.core*",
@@ -124,14 +132,6 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
             sparta::TreeNode::GROUP_IDX_NONE,
             &factories->biu_rf
         },
-        {
-            "mss",
-            "cpu.core*",
-            "Memory Sub-System",
-            sparta::TreeNode::GROUP_NAME_NONE,
-            sparta::TreeNode::GROUP_IDX_NONE,
-            &factories->mss_rf
-        },
         {
             "rob",
             "cpu.core*",
@@ -158,6 +158,18 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
         }
     };
 
+    //! The memory subsystem behind every core's BIU
+    shared_units = {
+        {
+            "mss",
+            "cpu",
+            "Memory Sub-System",
+            sparta::TreeNode::GROUP_NAME_NONE,
+            sparta::TreeNode::GROUP_IDX_NONE,
+            &factories->mss_rf
+        }
+    };
+
     //! Instantiating ports of this topology
     port_connections = {
         {
@@ -168,6 +180,30 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
             "cpu.core*.fetch.ports.in_fetch_queue_credits",
             "cpu.core*.decode.ports.out_fetch_queue_credits"
         },
+        {
+            "cpu.core*.fetch.ports.out_icache_req",
+            "cpu.core*.icache.ports.in_fetch_req"
+        },
+        {
+            "cpu.core*.fetch.ports.out_icache_prefetch_req",
+            "cpu.core*.icache.ports.in_fetch_prefetch_req"
+        },
+        {
+            "cpu.core*.icache.ports.out_fetch_resp",
+            "cpu.core*.fetch.ports.in_icache_resp"
+        },
+        {
+            "cpu.core*.icache.ports.out_l2cache_req",
+            "cpu.core*.l2cache.ports.in_icache_l2cache_req"
+        },
+        {
+            "cpu.core*.icache.ports.in_l2cache_ack",
+            "cpu.core*.l2cache.ports.out_l2cache_icache_ack"
+        },
+        {
+            "cpu.core*.icache.ports.in_l2cache_resp",
+            "cpu.core*.l2cache.ports.out_l2cache_icache_resp"
+        },
         {
             "cpu.core*.decode.ports.out_uop_queue_write",
             "cpu.core*.rename.ports.in_uop_queue_append"
@@ -258,11 +294,11 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
         },
         {
             "cpu.core*.biu.ports.out_mss_req_sync",
-            "cpu.core*.mss.ports.in_mss_req_sync"
+            "cpu.mss.ports.in_mss_req_sync_core*"
         },
         {
             "cpu.core*.biu.ports.in_mss_ack_sync",
-            "cpu.core*.mss.ports.out_mss_ack_sync"
+            "cpu.mss.ports.out_mss_ack_sync_core*"
         },
         {
             "cpu.core*.rob.ports.out_retire_flush",
@@ -276,6 +312,10 @@ olympia::CoreTopologySimple::CoreTopologySimple(){
             "cpu.core*.rob.ports.out_rob_retire_ack_rename",
             "cpu.core*.rename.ports.in_rename_retire_ack"
         },
+        {
+            "cpu.core*.rob.ports.out_rob_retire_ack_rename",
+            "cpu.core*.fetch.ports.in_fetch_retire_ack"
+        },
         {
             "cpu.core*.flushmanager.ports.out_flush_upper",
             "cpu.core*.dispatch.ports.in_reorder_flush"
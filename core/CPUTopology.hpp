@@ -126,6 +126,11 @@ namespace olympia
         std::vector<UnitInfo> units;
         std::vector<PortConnectionInfo> port_connections;
 
+        //! Units built once and shared by every core (e.g. the memory
+        //! subsystem).  Their port connections are in port_connections,
+        //! where '*' in their port names is the core they connect to
+        std::vector<UnitInfo> shared_units;
+
     }; // class CPUTopology
 
     //
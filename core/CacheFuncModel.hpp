@@ -29,7 +29,8 @@ namespace olympia
         SimpleCacheLine(const SimpleCacheLine & rhs) :
             BasicCacheItem(rhs),
             line_size_(rhs.line_size_),
-            valid_(rhs.valid_)
+            valid_(rhs.valid_),
+            prefetched_(rhs.prefetched_)
         {
         }
 
@@ -39,6 +40,7 @@ namespace olympia
             BasicCacheItem::operator=(rhs);
             line_size_ = rhs.line_size_;
             valid_ = rhs.valid_;
+            prefetched_ = rhs.prefetched_;
 
             return *this;
         }
@@ -49,6 +51,7 @@ namespace olympia
         void reset(uint64_t addr)
         {
             setValid(true);
+            setPrefetched(false);
             BasicCacheItem::setAddr(addr);
         }
 
@@ -63,6 +66,11 @@ namespace olympia
 
         bool isModified() const { return modified_; }
 
+        // Filled by a prefetch and not used by a demand access yet
+        void setPrefetched(bool p) { prefetched_ = p; }
+
+        bool isPrefetched() const { return prefetched_; }
+
         // Required by SimpleCache2
         bool read(uint64_t offset, uint32_t size, uint32_t *buf) const
         {
@@ -87,6 +95,7 @@ namespace olympia
         uint64_t line_size_ = 0;
         bool valid_ = false;
         bool modified_ = false;
+        bool prefetched_ = false;
 
     }; // class SimpleCacheLine
 
@@ -113,6 +122,39 @@ namespace olympia
             preloadable_(this, std::bind(&CacheFuncModel::preloadPkt_, this, _1),
                          std::bind(&CacheFuncModel::preloadDump_, this, _1))
         {}
+
+        /**
+         * Functional access for warming: update MRU on a hit, fill
+         * the line on a miss.  Returns true on a hit
+         */
+        bool warmAccess(uint64_t addr)
+        {
+            auto cache_line = peekLine(addr);
+            if ((cache_line != nullptr) && cache_line->isValid())
+            {
+                touchMRU(*cache_line);
+                return true;
+            }
+            allocateWithMRUUpdate(getLineForReplacementWithInvalidCheck(addr), addr);
+            return false;
+        }
+
+        //! Fraction of lines that are valid
+        double getValidFraction() const
+        {
+            uint64_t num_lines = 0;
+            uint64_t num_valid = 0;
+            for (auto set_it = begin(); set_it != end(); ++set_it)
+            {
+                for (auto line_it = set_it->begin(); line_it != set_it->end(); ++line_it)
+                {
+                    ++num_lines;
+                    num_valid += line_it->isValid() ? 1 : 0;
+                }
+            }
+            return (num_lines == 0) ? 0.0 : static_cast<double>(num_valid) / num_lines;
+        }
+
     private:
         /**
          * Implement a preload by just doing a fill to the va in the packet.
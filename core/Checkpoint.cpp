@@ -0,0 +1,142 @@
+// <Checkpoint.cpp> -*- C++ -*-
+
+//!
+//! \file Checkpoint.cpp
+//! \brief Binary checkpoints of warmed microarchitectural state
+//!
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "Checkpoint.hpp"
+
+#include "sparta/simulation/ResourceTreeNode.hpp"
+
+namespace olympia
+{
+    namespace checkpoint
+    {
+        void writeString(std::ostream & os, const std::string & str)
+        {
+            write<uint64_t>(os, str.size());
+            os.write(str.data(), str.size());
+        }
+
+        std::string readString(std::istream & is)
+        {
+            std::string str(read<uint64_t>(is), '\0');
+            is.read(str.data(), str.size());
+            if (!is)
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint is truncated");
+            }
+            return str;
+        }
+    } // namespace checkpoint
+
+    Checkpointer::Checkpointer(sparta::TreeNode* node) { findUnits_(node); }
+
+    void Checkpointer::findUnits_(sparta::TreeNode* node)
+    {
+        if (auto rtn = dynamic_cast<sparta::ResourceTreeNode*>(node); rtn != nullptr)
+        {
+            if (auto unit = dynamic_cast<CheckpointableIF*>(rtn->getResource()); unit != nullptr)
+            {
+                units_.emplace_back(node, unit);
+            }
+        }
+        for (auto child : node->getChildren())
+        {
+            findUnits_(child);
+        }
+    }
+
+    void Checkpointer::save(const std::string & filename, const std::string & workload,
+                            const uint64_t workload_position) const
+    {
+        std::ofstream fs(filename, std::ios::binary | std::ios::trunc);
+        if (!fs)
+        {
+            throw sparta::SpartaException("ERROR: Issues opening ") << filename;
+        }
+        fs.write(checkpoint::MAGIC, sizeof(checkpoint::MAGIC));
+        checkpoint::write(fs, checkpoint::VERSION);
+        checkpoint::writeString(fs, std::filesystem::path(workload).filename().string());
+        checkpoint::write(fs, workload_position);
+        checkpoint::write<uint64_t>(fs, units_.size());
+        for (const auto & unit : units_)
+        {
+            std::ostringstream state;
+            unit.second->saveCheckpoint(state);
+            checkpoint::writeString(fs, unit.first->getLocation());
+            checkpoint::writeString(fs, state.str());
+        }
+        if (!fs)
+        {
+            throw sparta::SpartaException("ERROR: Issues writing ") << filename;
+        }
+    }
+
+    uint64_t Checkpointer::restore(const std::string & filename, const std::string & workload) const
+    {
+        std::ifstream fs(filename, std::ios::binary);
+        if (!fs)
+        {
+            throw sparta::SpartaException("ERROR: Issues opening ") << filename;
+        }
+        char magic[sizeof(checkpoint::MAGIC)] = {};
+        fs.read(magic, sizeof(magic));
+        if (!fs || (std::memcmp(magic, checkpoint::MAGIC, sizeof(magic)) != 0))
+        {
+            throw sparta::SpartaException("ERROR: ") << filename << " is not a checkpoint";
+        }
+        const auto version = checkpoint::read<uint32_t>(fs);
+        if (version != checkpoint::VERSION)
+        {
+            throw sparta::SpartaException("ERROR: ")
+                << filename << " is checkpoint version " << version << ", expected version "
+                << checkpoint::VERSION;
+        }
+
+        const std::string saved_workload = checkpoint::readString(fs);
+        if (saved_workload != std::filesystem::path(workload).filename().string())
+        {
+            std::cerr << "WARNING: checkpoint " << filename << " was taken on " << saved_workload
+                      << ", restoring it on " << workload << std::endl;
+        }
+        const auto workload_position = checkpoint::read<uint64_t>(fs);
+
+        std::map<std::string, std::string> sections;
+        const auto num_sections = checkpoint::read<uint64_t>(fs);
+        for (uint64_t i = 0; i < num_sections; ++i)
+        {
+            std::string location = checkpoint::readString(fs);
+            sections[location] = checkpoint::readString(fs);
+        }
+
+        for (const auto & unit : units_)
+        {
+            const auto section = sections.find(unit.first->getLocation());
+            if (section == sections.end())
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint ")
+                    << filename << " has no state for " << unit.first->getLocation();
+            }
+            std::istringstream state(section->second);
+            try
+            {
+                unit.second->restoreCheckpoint(state);
+            }
+            catch (sparta::SpartaException & e)
+            {
+                e << " (restoring " << unit.first->getLocation() << ")";
+                throw;
+            }
+        }
+        return workload_position;
+    }
+} // namespace olympia
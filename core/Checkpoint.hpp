@@ -0,0 +1,201 @@
+// <Checkpoint.hpp> -*- C++ -*-
+
+//!
+//! \file Checkpoint.hpp
+//! \brief Binary checkpoints of warmed microarchitectural state
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class CheckpointableIF
+     * \brief A unit whose functional state (tags, replacement state,
+     *        predictor tables) can be saved to and restored from a
+     *        checkpoint.  The binary counterpart of Sparta's
+     *        PreloadDumpableIF/PreloadableIF pair: it also carries
+     *        replacement state, and restores without going through
+     *        YAML
+     */
+    class CheckpointableIF
+    {
+      public:
+        virtual ~CheckpointableIF() = default;
+
+        //! Write the unit's state.  Not const: reading some
+        //! replacement policies' order means touching them (the state
+        //! is left as it was)
+        virtual void saveCheckpoint(std::ostream & os) = 0;
+
+        //! Restore what saveCheckpoint wrote.  Throws if the
+        //! checkpoint does not fit the unit's configuration
+        virtual void restoreCheckpoint(std::istream & is) = 0;
+    };
+
+    namespace checkpoint
+    {
+        static constexpr char MAGIC[8] = {'O', 'L', 'Y', 'C', 'K', 'P', 'T', '\0'};
+        static constexpr uint32_t VERSION = 3;
+
+        template <typename T> void write(std::ostream & os, const T & value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T> T read(std::istream & is)
+        {
+            T value{};
+            is.read(reinterpret_cast<char*>(&value), sizeof(T));
+            if (!is)
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint is truncated");
+            }
+            return value;
+        }
+
+        void writeString(std::ostream & os, const std::string & str);
+        std::string readString(std::istream & is);
+
+        //! Save a table of trivially copyable entries without padding
+        template <typename T> void writeTable(std::ostream & os, const std::vector<T> & table)
+        {
+            static_assert(std::has_unique_object_representations_v<T>,
+                          "Table entries are written as raw bytes and must have no padding");
+            write<uint64_t>(os, table.size());
+            os.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(T));
+        }
+
+        //! Restore what writeTable wrote.  Throws if the sizes differ
+        template <typename T> void readTable(std::istream & is, std::vector<T> & table)
+        {
+            const auto saved_size = read<uint64_t>(is);
+            if (saved_size != table.size())
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint has a table of ")
+                    << saved_size << " entries, the model has " << table.size();
+            }
+            is.read(reinterpret_cast<char*>(table.data()), table.size() * sizeof(T));
+            if (!is)
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint is truncated");
+            }
+        }
+
+        /*!
+         * \brief Save the valid bits, addresses and replacement order of
+         *        every line of a SimpleCache2-based cache
+         *
+         * The replacement order of a set is read by repeatedly taking
+         * its LRU way and making it MRU.  After every way has been
+         * touched once, both true LRU and tree-PLRU are back in the
+         * state they started in, and replaying the same touches from
+         * reset rebuilds that state.
+         */
+        template <typename CacheT> void saveCache(std::ostream & os, CacheT & cache)
+        {
+            uint32_t num_sets = 0;
+            uint32_t num_ways = 0;
+            for (auto set_it = cache.begin(); set_it != cache.end(); ++set_it)
+            {
+                num_ways = static_cast<uint32_t>(std::distance(set_it->begin(), set_it->end()));
+                ++num_sets;
+            }
+            write(os, num_sets);
+            write(os, num_ways);
+
+            for (auto set_it = cache.begin(); set_it != cache.end(); ++set_it)
+            {
+                for (auto line_it = set_it->begin(); line_it != set_it->end(); ++line_it)
+                {
+                    write<uint8_t>(os, line_it->isValid() ? 1 : 0);
+                    write<uint64_t>(os, line_it->getAddr());
+                }
+                auto & replacement = set_it->getReplacementIF();
+                for (uint32_t i = 0; i < num_ways; ++i)
+                {
+                    const uint32_t way = replacement.getLRUWay();
+                    write(os, way);
+                    replacement.touchMRU(way);
+                }
+            }
+        }
+
+        template <typename CacheT> void restoreCache(std::istream & is, CacheT & cache)
+        {
+            uint32_t num_sets = 0;
+            uint32_t num_ways = 0;
+            for (auto set_it = cache.begin(); set_it != cache.end(); ++set_it)
+            {
+                num_ways = static_cast<uint32_t>(std::distance(set_it->begin(), set_it->end()));
+                ++num_sets;
+            }
+            const auto saved_sets = read<uint32_t>(is);
+            const auto saved_ways = read<uint32_t>(is);
+            if ((saved_sets != num_sets) || (saved_ways != num_ways))
+            {
+                throw sparta::SpartaException("ERROR: Checkpoint has ")
+                    << saved_sets << " sets of " << saved_ways << " ways, the model has "
+                    << num_sets << " sets of " << num_ways << " ways";
+            }
+
+            for (auto set_it = cache.begin(); set_it != cache.end(); ++set_it)
+            {
+                for (auto line_it = set_it->begin(); line_it != set_it->end(); ++line_it)
+                {
+                    const bool valid = read<uint8_t>(is) != 0;
+                    const uint64_t addr = read<uint64_t>(is);
+                    if (valid)
+                    {
+                        line_it->reset(addr);
+                    }
+                    line_it->setValid(valid);
+                }
+                auto & replacement = set_it->getReplacementIF();
+                replacement.reset();
+                for (uint32_t i = 0; i < num_ways; ++i)
+                {
+                    replacement.touchMRU(read<uint32_t>(is));
+                }
+            }
+        }
+    } // namespace checkpoint
+
+    /*!
+     * \class Checkpointer
+     * \brief Saves and restores every CheckpointableIF unit under a
+     *        node, with the workload position, to a binary file
+     *
+     * File layout: MAGIC, VERSION, the workload name and the number of
+     * workload instructions consumed, then one section per unit: its
+     * tree location and the bytes it wrote.
+     */
+    class Checkpointer
+    {
+      public:
+        explicit Checkpointer(sparta::TreeNode* node);
+
+        void save(const std::string & filename, const std::string & workload,
+                  const uint64_t workload_position) const;
+
+        //! Restore the units.  Returns the workload position to skip to
+        uint64_t restore(const std::string & filename, const std::string & workload) const;
+
+      private:
+        void findUnits_(sparta::TreeNode* node);
+
+        std::vector<std::pair<sparta::TreeNode*, CheckpointableIF*>> units_;
+    };
+} // namespace olympia
@@ -10,6 +10,22 @@
 
 namespace olympia::coreutils
 {
+    //! Index of the core (cpu.core<N>) a node is in.  0 for nodes
+    //! outside a core, e.g. in unit test benches
+    inline uint32_t getCoreIndex(const sparta::TreeNode* node)
+    {
+        for (; node != nullptr; node = node->getParent())
+        {
+            const std::string & name = node->getName();
+            if ((name.size() > 4) && (name.compare(0, 4, "core") == 0)
+                && (name.find_first_not_of("0123456789", 4) == std::string::npos))
+            {
+                return static_cast<uint32_t>(std::stoul(name.substr(4)));
+            }
+        }
+        return 0;
+    }
+
     inline auto getPipeTopology(sparta::TreeNode* node, const std::string & pipe_name)
     {
         auto core_extension = node->getExtension(olympia::CoreExtensions::name);
@@ -12,7 +12,7 @@ namespace olympia
         num_mshr_entries_(p->mshr_entries),
         mshr_file_("mshr_file", p->mshr_entries, getClock()),
         mshr_entry_allocator_(
-            sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->mshr_entry_allocator)
+            sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->getMSHREntryAllocator())
     {
         sparta_assert(num_mshr_entries_ > 0, "There must be atleast 1 MSHR entry");
 
@@ -67,6 +67,14 @@ namespace olympia
         ILOG("DCache reload complete!");
     }
 
+    void DCache::warm(WarmingRecord & record)
+    {
+        if (record.is_mem_access && !l1_always_hit_)
+        {
+            record.dl1_miss = !l1_cache_->warmAccess(record.getPhyAddr());
+        }
+    }
+
     // Access L1Cache
     bool DCache::dataLookup_(const MemoryAccessInfoPtr & mem_access_info_ptr)
     {
@@ -7,6 +7,8 @@
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/utils/LogUtils.hpp"
 #include "CacheFuncModel.hpp"
+#include "Checkpoint.hpp"
+#include "FunctionalWarming.hpp"
 #include "Inst.hpp"
 #include "cache/TreePLRUReplacement.hpp"
 #include "MemoryAccessInfo.hpp"
@@ -14,7 +16,7 @@
 
 namespace olympia
 {
-    class DCache : public sparta::Unit
+    class DCache : public sparta::Unit, public FunctionalWarmingIF, public CheckpointableIF
     {
       public:
         class CacheParameterSet : public sparta::ParameterSet
@@ -33,6 +35,19 @@ namespace olympia
         static const char name[];
         DCache(sparta::TreeNode* n, const CacheParameterSet* p);
 
+        //! Functional warming: fill/touch the DL1 tags
+        void warm(WarmingRecord & record) override;
+
+        double getWarmingCoverage() const override { return l1_cache_->getValidFraction(); }
+
+        //! Checkpoint the DL1 tags and replacement state
+        void saveCheckpoint(std::ostream & os) override { checkpoint::saveCache(os, *l1_cache_); }
+
+        void restoreCheckpoint(std::istream & is) override
+        {
+            checkpoint::restoreCache(is, *l1_cache_);
+        }
+
       private:
         ////////////////////////////////////////////////////////////////////////////////
         // L1 Data Cache Handling
@@ -13,6 +13,13 @@ using namespace std;
 
 namespace olympia
 {
+    namespace
+    {
+        // Iterations a loop body must hit in the micro-op cache, in a
+        // row, before the loop buffer locks onto it
+        constexpr uint32_t LOOP_BUFFER_LOCK_ITERATIONS = 2;
+    } // namespace
+
     constexpr char Decode::name[];
 
     Decode::Decode(sparta::TreeNode* node, const DecodeParameterSet* p) :
@@ -48,10 +55,56 @@ namespace olympia
         fusion_match_max_tries_(p->fusion_match_max_tries),
         fusion_max_group_size_(p->fusion_max_group_size),
         fusion_summary_report_(p->fusion_summary_report),
-        fusion_group_definitions_(p->fusion_group_definitions)
+        fusion_group_definitions_(p->fusion_group_definitions),
+        event_log_(PipelineEventLog::getBuffer(node)),
+        decode_latency_(p->decode_latency),
+        uop_cache_hit_latency_(p->uop_cache_hit_latency),
+        loop_buffer_size_(p->loop_buffer_size),
+
+        uop_cache_hits_(&unit_stat_set_, "uop_cache_hits",
+                        "Number of instructions that hit in the micro-op cache",
+                        sparta::Counter::COUNT_NORMAL),
+
+        uop_cache_misses_(&unit_stat_set_, "uop_cache_misses",
+                          "Number of instructions that missed in the micro-op cache",
+                          sparta::Counter::COUNT_NORMAL),
+
+        uop_cache_fill_overflows_(&unit_stat_set_, "uop_cache_fill_overflows",
+                                  "Number of decoded instructions with no room left in "
+                                  "their window's micro-op cache entry",
+                                  sparta::Counter::COUNT_NORMAL),
+
+        uop_cache_groups_(&unit_stat_set_, "uop_cache_groups",
+                          "Number of decode groups entirely from the micro-op cache and "
+                          "loop buffer, not matched against the fusion groups",
+                          sparta::Counter::COUNT_NORMAL),
+
+        loop_buffer_insts_(&unit_stat_set_, "loop_buffer_insts",
+                           "Number of instructions the loop buffer replayed",
+                           sparta::Counter::COUNT_NORMAL),
+
+        loop_buffer_locks_(&unit_stat_set_, "loop_buffer_locks",
+                           "Number of times the loop buffer locked onto a loop",
+                           sparta::Counter::COUNT_NORMAL),
+
+        uop_cache_hit_rate_(&unit_stat_set_, "uop_cache_hit_rate",
+                            "Micro-op cache hits per lookup", &unit_stat_set_,
+                            "uop_cache_hits/(uop_cache_hits+uop_cache_misses)")
     {
         initializeFusion_();
 
+        if (p->uop_cache_entries != 0)
+        {
+            uop_cache_ = std::make_unique<UopCache>(
+                p->uop_cache_entries, p->uop_cache_associativity, p->uop_cache_window_bytes,
+                p->uop_cache_uops_per_entry);
+        }
+        sparta_assert((loop_buffer_size_ == 0) || (uop_cache_ != nullptr),
+                      "The loop buffer replays micro-op cache hits: set uop_cache_entries too");
+        decode_group_insts_.reserve(num_to_decode_);
+        loop_body_.reserve(loop_buffer_size_);
+        loop_buffer_.reserve(loop_buffer_size_);
+
         fetch_queue_.enableCollection(node);
 
         fetch_queue_write_in_.registerConsumerHandler(
@@ -93,8 +146,15 @@ namespace olympia
         if (fusion_enable_)
         {
             fuser_ = std::make_unique<FusionType>(fusion_group_definitions_);
-            hcache_ = fusion::HCache(FusionGroupType::jenkins_1aat);
             fusion_num_groups_defined_ = fuser_->getFusionGroupContainer().size();
+
+            // The container is not changed after this: its groups stay put
+            for (const auto & fgPair : fuser_->getFusionGroupContainer())
+            {
+                fusion_matcher_.addPattern(fgPair.second.uids());
+                fusion_matcher_groups_.emplace_back(&fgPair.second);
+            }
+            fusion_matcher_.compile();
         }
         else
         {
@@ -123,6 +183,7 @@ namespace olympia
         for (auto & i : *insts)
         {
             fetch_queue_.push(i);
+            fetch_queue_slots_.emplace_back(lookupDecoded_(i));
             ILOG("Received: " << i);
         }
         if (uop_queue_credits_ > 0)
@@ -131,6 +192,120 @@ namespace olympia
         }
     }
 
+    Decode::FetchQueueSlot Decode::lookupDecoded_(const InstPtr & inst)
+    {
+        const uint64_t cycle = getClock()->currentCycle();
+        FetchQueueSlot slot;
+        slot.ready_cycle = cycle + decode_latency_;
+        if (uop_cache_ == nullptr)
+        {
+            return slot;
+        }
+
+        // A locked loop is replayed without micro-op cache lookups
+        const UopCache::DecodedInst* decoded = loop_buffer_locked_ ? replayLoop_(inst) : nullptr;
+        if (decoded != nullptr)
+        {
+            ++loop_buffer_insts_;
+            slot.ready_cycle = cycle;
+        }
+        else
+        {
+            decoded = uop_cache_->lookup(inst->getPC());
+            if (decoded != nullptr)
+            {
+                ++uop_cache_hits_;
+                slot.ready_cycle = cycle + uop_cache_hit_latency_;
+            }
+            else
+            {
+                ++uop_cache_misses_;
+            }
+            if (loop_buffer_size_ != 0)
+            {
+                detectLoop_(inst, decoded);
+            }
+        }
+
+        if (decoded != nullptr)
+        {
+            slot.cached = true;
+            slot.decoded = *decoded;
+        }
+        return slot;
+    }
+
+    const UopCache::DecodedInst* Decode::replayLoop_(const InstPtr & inst)
+    {
+        const UopCache::DecodedInst & next = loop_buffer_[loop_buffer_pos_];
+        if (inst->getPC() != next.pc)
+        {
+            // The loop exited, or took another path through its body
+            ILOG("Loop buffer unlocked at " << inst);
+            resetLoopBuffer_();
+            return nullptr;
+        }
+        if (++loop_buffer_pos_ == loop_buffer_.size())
+        {
+            loop_buffer_pos_ = 0;
+        }
+        return &next;
+    }
+
+    void Decode::detectLoop_(const InstPtr & inst, const UopCache::DecodedInst* cached)
+    {
+        // Collect the body since the watched branch was last taken
+        if ((cached != nullptr) && loop_body_cached_
+            && ((loop_body_uops_ + cached->num_uops) <= loop_buffer_size_))
+        {
+            loop_body_uops_ += cached->num_uops;
+            loop_body_.emplace_back(*cached);
+        }
+        else
+        {
+            loop_body_cached_ = false;
+        }
+
+        // A backward taken branch closes a loop
+        const uint64_t target = inst->getTargetVAddr();
+        const bool taken = inst->isBranch() && (inst->isTakenBranch() || !inst->isCondBranch());
+        if (!taken || (target == 0) || (target > inst->getPC()))
+        {
+            return;
+        }
+
+        if ((inst->getPC() == loop_branch_pc_) && loop_body_cached_ && !loop_body_.empty()
+            && (loop_body_.front().pc == target))
+        {
+            if (++loop_iterations_ >= LOOP_BUFFER_LOCK_ITERATIONS)
+            {
+                ILOG("Loop buffer locked on the loop closed by " << inst);
+                std::swap(loop_buffer_, loop_body_);
+                loop_buffer_locked_ = true;
+                loop_buffer_pos_ = 0;
+                ++loop_buffer_locks_;
+            }
+        }
+        else
+        {
+            loop_branch_pc_ = inst->getPC();
+            loop_iterations_ = 0;
+        }
+        loop_body_.clear();
+        loop_body_cached_ = true;
+        loop_body_uops_ = 0;
+    }
+
+    void Decode::resetLoopBuffer_()
+    {
+        loop_buffer_locked_ = false;
+        loop_branch_pc_ = 0;
+        loop_iterations_ = 0;
+        loop_body_.clear();
+        loop_body_cached_ = true;
+        loop_body_uops_ = 0;
+    }
+
     void Decode::updateVcsrs_(const InstPtr & inst)
     {
         VCSRs_.setVCSRs(inst->getVL(), inst->getSEW(), inst->getLMUL(), inst->getVTA());
@@ -176,8 +351,17 @@ namespace olympia
     void Decode::handleFlush_(const FlushManager::FlushingCriteria & criteria)
     {
         ILOG("Got a flush call for " << criteria);
+        if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+        {
+            for (const auto & inst : fetch_queue_)
+            {
+                event_log_->record(PipelineEventType::FLUSH, inst);
+            }
+        }
         fetch_queue_credits_outp_.send(fetch_queue_.size());
         fetch_queue_.clear();
+        fetch_queue_slots_.clear();
+        resetLoopBuffer_();
 
         // Reset the vector uop generator
         vec_uop_gen_->handleFlush(criteria);
@@ -190,10 +374,14 @@ namespace olympia
         num_to_decode = std::min(num_to_decode, num_to_decode_);
 
         // buffer to maximize the chances of a group match limited
-        // by max allowed latency, bounded by max group size
+        // by max allowed latency, bounded by max group size.  Micro-op
+        // cache hits were fused when decoded: no need to gather them
         if (fusion_enable_)
         {
-            if (num_to_decode < fusion_max_group_size_ && latency_count_ < fusion_max_latency_)
+            const bool front_cached =
+                !fetch_queue_slots_.empty() && fetch_queue_slots_.front().cached;
+            if (num_to_decode < fusion_max_group_size_ && latency_count_ < fusion_max_latency_
+                && !front_cached)
             {
                 ++latency_count_;
                 return;
@@ -205,6 +393,12 @@ namespace olympia
         // For fusion
         InstUidListType uids;
 
+        // Cycles until the next instruction leaves the decoders or the
+        // micro-op cache, if it has not yet
+        const uint64_t cycle = getClock()->currentCycle();
+        uint64_t wake_delay = 0;
+        bool all_cached = true;
+
         // Send instructions on their way to rename
         InstGroupPtr insts =
             sparta::allocate_sparta_shared_pointer<InstGroup>(instgroup_allocator);
@@ -224,6 +418,17 @@ namespace olympia
             {
                 sparta_assert(fetch_queue_.size() > 0,
                      "Cannot read from the fetch queue because it is empty!");
+                const FetchQueueSlot & slot = fetch_queue_slots_.front();
+                if (slot.ready_cycle > cycle)
+                {
+                    wake_delay = slot.ready_cycle - cycle;
+                    break;
+                }
+                DecodeGroupInst group_inst;
+                group_inst.cached_fusion_status = slot.decoded.fusion_status;
+                group_inst.cached_fusion_size = slot.decoded.fusion_size;
+                all_cached = all_cached && slot.cached;
+
                 auto & inst = fetch_queue_.read(0);
 
                 // for vector instructions, we block on vset and do not allow any other
@@ -268,9 +473,11 @@ namespace olympia
                     // Even if LMUL == 1, we need the vector uop generator to create a uop for us
                     // because some generators will add additional sources and destinations to the
                     // instruction (e.g. widening, multiply-add, slides).
+                    group_inst.num_uops = 0;
                     while(vec_uop_gen_->getNumUopsRemaining() >= 1)
                     {
                         const InstPtr uop = vec_uop_gen_->generateUop();
+                        ++group_inst.num_uops;
                         if (insts->size() < num_to_decode_)
                         {
                             insts->emplace_back(uop);
@@ -294,9 +501,12 @@ namespace olympia
                 {
                     uids.push_back(inst->getMavisUid());
                 }
+                group_inst.inst = inst;
+                decode_group_insts_.emplace_back(group_inst);
 
                 // Remove from Fetch Queue
                 fetch_queue_.pop();
+                fetch_queue_slots_.pop_front();
             }
             else
             {
@@ -305,14 +515,65 @@ namespace olympia
             }
         }
 
-        if (fusion_enable_)
+        if (insts->empty() && (wake_delay != 0))
+        {
+            ev_decode_insts_event_.schedule(wake_delay);
+            return;
+        }
+
+        all_cached = all_cached && !decode_group_insts_.empty();
+        if (all_cached)
+        {
+            ++uop_cache_groups_;
+        }
+
+        if (fusion_enable_ && all_cached)
+        {
+            // Fused when they were decoded: mark them the same way.
+            // This group may be cut elsewhere than the one that filled
+            // the micro-op cache, so only fusion groups whose head and
+            // ghosts are all in it are fused again
+            for (size_t head = 0; head < decode_group_insts_.size(); ++head)
+            {
+                const DecodeGroupInst & head_inst = decode_group_insts_[head];
+                const size_t end = head + head_inst.cached_fusion_size;
+                if ((head_inst.cached_fusion_status != Inst::Status::FUSED)
+                    || (end > decode_group_insts_.size()))
+                {
+                    continue;
+                }
+                bool whole = true;
+                for (size_t idx = head; whole && (idx < end); ++idx)
+                {
+                    const DecodeGroupInst & group_inst = decode_group_insts_[idx];
+                    whole = (group_inst.inst->getExtendedStatus() == Inst::Status::UNMOD)
+                            && ((idx == head)
+                                || (group_inst.cached_fusion_status
+                                    == Inst::Status::FUSION_GHOST));
+                }
+                if (!whole)
+                {
+                    continue;
+                }
+
+                head_inst.inst->setExtendedStatus(Inst::Status::FUSED);
+                ++fusion_num_fuse_instructions_;
+                for (size_t idx = head + 1; idx < end; ++idx)
+                {
+                    decode_group_insts_[idx].inst->setExtendedStatus(Inst::Status::FUSION_GHOST);
+                    ++fusion_num_ghost_instructions_;
+                    ++fusion_pred_cycles_saved_;
+                }
+                head = end - 1;
+            }
+        }
+        else if (fusion_enable_)
         {
             MatchInfoListType matches;
             uint32_t max_itrs = 0;
-            FusionGroupContainerType & container = fuser_->getFusionGroupContainer();
             do
             {
-                matchFusionGroups_(matches, insts, uids, container);
+                matchFusionGroups_(matches, uids);
                 processMatches_(matches, insts, uids);
                 // Future feature whereIsEgon(insts,numGhosts);
                 ++max_itrs;
@@ -330,9 +591,44 @@ namespace olympia
             }
         }
 
+        if ((uop_cache_ != nullptr) && !all_cached)
+        {
+            for (size_t idx = 0; idx < decode_group_insts_.size(); ++idx)
+            {
+                const DecodeGroupInst & group_inst = decode_group_insts_[idx];
+                UopCache::DecodedInst decoded;
+                decoded.pc = group_inst.inst->getPC();
+                decoded.num_uops = group_inst.num_uops;
+                decoded.fusion_status = group_inst.inst->getExtendedStatus();
+                if (decoded.fusion_status == Inst::Status::FUSED)
+                {
+                    // The ghosts follow their head
+                    while (((idx + decoded.fusion_size) < decode_group_insts_.size())
+                           && (decode_group_insts_[idx + decoded.fusion_size]
+                                   .inst->getExtendedStatus()
+                               == Inst::Status::FUSION_GHOST))
+                    {
+                        ++decoded.fusion_size;
+                    }
+                }
+                if (!uop_cache_->fill(decoded))
+                {
+                    ++uop_cache_fill_overflows_;
+                }
+            }
+        }
+        decode_group_insts_.clear();
+
         // Send decoded instructions to rename
         sparta_assert(insts->size() <= num_to_decode_,
             "Instruction group grew too large! " << insts);
+        if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+        {
+            for (const auto & inst : *insts)
+            {
+                event_log_->record(PipelineEventType::DECODE, inst);
+            }
+        }
         uop_queue_outp_.send(insts);
 
         // TODO: whereisegon() would remove the ghosts,
@@ -352,7 +648,7 @@ namespace olympia
         // instructions in the queue, schedule another decode session
         if (uop_queue_credits_ > 0 && (fetch_queue_.size() + uop_queue_.size()) > 0)
         {
-            ev_decode_insts_event_.schedule(1);
+            ev_decode_insts_event_.schedule((wake_delay != 0) ? wake_delay : 1);
         }
     }
 } // namespace olympia
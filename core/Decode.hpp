@@ -4,8 +4,12 @@
 
 #include "CoreTypes.hpp"
 #include "FlushManager.hpp"
+#include "FusionMatcher.hpp"
 #include "InstGroup.hpp"
 #include "MavisUnit.hpp"
+#include "PipelineEventLog.hpp"
+#include "RingQueue.hpp"
+#include "UopCache.hpp"
 
 #include "fsl_api/FieldExtractor.h"
 #include "fsl_api/Fusion.h"
@@ -19,6 +23,8 @@
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
 
 #include <limits>
 #include <map>
@@ -36,6 +42,15 @@ namespace olympia
      * Decode unit will
      * 1. Retrieve instructions from the fetch queue (retrieved via port)
      * 2. Push the instruction down the decode pipe (internal, of parameterized length)
+     *
+     * Optionally, a micro-op cache keeps what the decoders made of each
+     * instruction: its uop count and fusion marking.  Instructions that
+     * hit leave decode after uop_cache_hit_latency cycles instead of
+     * decode_latency, and a decode group that hit entirely is not
+     * matched against the fusion groups again.  A loop buffer
+     * (loop stream detector) locks onto a loop whose body hit in the
+     * micro-op cache for two iterations in a row and replays it, with no
+     * latency and no micro-op cache lookups, until the loop exits.
      */
     class Decode : public sparta::Unit
     {
@@ -68,7 +83,12 @@ namespace olympia
         class DecodeParameterSet : public sparta::ParameterSet
         {
           public:
-            DecodeParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+            DecodeParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n)
+            {
+                num_to_decode.addDependentValidationCallback(
+                    InstGroup::fitsWidth,
+                    "Num to decode must fit in an InstGroup (InstGroup::MAX_WIDTH)");
+            }
 
             //! \brief width of decoder
             PARAMETER(uint32_t, num_to_decode, 4, "Decode group size")
@@ -135,6 +155,27 @@ namespace olympia
 
             //! Vector tail agnostic, default is undisturbed
             PARAMETER(bool, init_vta, 0, "vector tail agnostic")
+
+            //! \brief cycles an instruction spends in the decoders
+            PARAMETER(uint32_t, decode_latency, 0,
+                      "Cycles before an instruction the decoders decode can leave decode")
+
+            //! \brief micro-op cache geometry, 0 entries disables it
+            PARAMETER(uint32_t, uop_cache_entries, 0,
+                      "Micro-op cache entries, one per window of code.  0 disables the "
+                      "micro-op cache")
+            PARAMETER(uint32_t, uop_cache_associativity, 8, "Micro-op cache associativity")
+            PARAMETER(uint32_t, uop_cache_window_bytes, 32,
+                      "Bytes of code per micro-op cache entry (power of 2)")
+            PARAMETER(uint32_t, uop_cache_uops_per_entry, 8, "Uops a micro-op cache entry holds")
+            PARAMETER(uint32_t, uop_cache_hit_latency, 0,
+                      "Cycles before an instruction that hit in the micro-op cache can leave "
+                      "decode")
+
+            //! \brief loop stream detector, needs the micro-op cache
+            PARAMETER(uint32_t, loop_buffer_size, 0,
+                      "Uops of a loop body the loop buffer can replay.  0 disables the loop "
+                      "buffer")
         };
 
         /**
@@ -181,25 +222,14 @@ namespace olympia
 
         //! \brief compare the dynamic uid vector to the predefined groups
         //!
-        //! returns a sorted list of matches
-        //! Matches the fusionGroup sets against the input. There is a continuation
-        //! check invoked if the fusionGroup is larger than the input list.
-        //! FusionGroups must exactly match a segment of the input.
-        //!
-        //! During construction each fusion group has a pre-calculated Hash
-        //! created from the UIDs in the group.
-        //!
-        //! The group hash is matched against hashes formed from the input UIDs.
-        //!
-        //! In order to match the input to the group, hashes must be created of
+        //! returns a sorted list of matches, longest groups first, then
+        //! by position.  FusionGroups must exactly match a segment of
         //! the input.
         //!
-        //! A 'cache' of the inputUids is created on entry. The cache is indexed
-        //! by group size. The cache data is a vector of pairs, pair.first is the
-        //! input position within inputUids, pair.second is the hash of the
-        //! inputUids in that segment.
-        void matchFusionGroups_(MatchInfoListType & matches, InstGroupPtr & insts,
-                                InstUidListType & inputUIDS, FusionGroupContainerType &);
+        //! The groups are compiled into fusion_matcher_, an Aho-Corasick
+        //! automaton, when fusion is initialized, so one pass over the
+        //! input finds every match however many groups are defined.
+        void matchFusionGroups_(MatchInfoListType & matches, InstUidListType & inputUIDS);
 
         //! \brief process the fusion matches
         void processMatches_(MatchInfoListType &, InstGroupPtr & insts,
@@ -321,8 +351,12 @@ namespace olympia
         //! \see Fusion.hpp
         std::unique_ptr<FusionType> fuser_{nullptr};
 
-        //! \brief fusion group matching hash
-        fusion::HCache hcache_;
+        //! \brief the fusion groups compiled for matching
+        FusionMatcher fusion_matcher_;
+        //! \brief the fusion group of each fusion_matcher_ pattern
+        std::vector<const FusionGroupType*> fusion_matcher_groups_;
+        //! \brief fusion_matcher_ output, kept to reuse its storage
+        std::vector<FusionMatcher::Match> fusion_matcher_matches_;
 
         //! \brief fusion function object callback proxies
         struct cbProxy_;
@@ -333,6 +367,73 @@ namespace olympia
         //! \brief the fusion group definition files, JSON or (future) FSL
         const std::vector<std::string> fusion_group_definitions_;
 
+        //! \brief where decoded instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
+        //////////////////////////////////////////////////////////////////////
+        // Micro-op cache and loop buffer
+
+        //! \brief where a fetch queue instruction is decoded, and when
+        //! it can leave decode.  Kept in step with fetch_queue_
+        struct FetchQueueSlot
+        {
+            uint64_t ready_cycle = 0;
+            bool cached = false; // From the micro-op cache or loop buffer
+            UopCache::DecodedInst decoded;
+        };
+
+        //! \brief a fetch queue instruction in the decode group being
+        //! built, and the number of uops it became
+        struct DecodeGroupInst
+        {
+            InstPtr inst;
+            uint32_t num_uops = 1;
+            Inst::Status cached_fusion_status = Inst::Status::UNMOD;
+            uint32_t cached_fusion_size = 1;
+        };
+
+        //! \brief find where an instruction arriving from Fetch is
+        //! decoded: loop buffer, micro-op cache or decoders
+        FetchQueueSlot lookupDecoded_(const InstPtr & inst);
+
+        //! \brief the loop buffer's copy of the next instruction of the
+        //! locked loop, or nullptr (and unlock) if inst is not it
+        const UopCache::DecodedInst* replayLoop_(const InstPtr & inst);
+
+        //! \brief watch for a loop whose body hits in the micro-op cache
+        //! and fits in the loop buffer, and lock onto it
+        void detectLoop_(const InstPtr & inst, const UopCache::DecodedInst* cached);
+
+        //! \brief unlock the loop buffer and restart loop detection
+        void resetLoopBuffer_();
+
+        const uint32_t decode_latency_;
+        const uint32_t uop_cache_hit_latency_;
+        const uint32_t loop_buffer_size_;
+        std::unique_ptr<UopCache> uop_cache_;
+        RingQueue<FetchQueueSlot> fetch_queue_slots_;
+        std::vector<DecodeGroupInst> decode_group_insts_;
+
+        // Loop stream detector: the backward taken branch closing the
+        // loop being watched, the body seen since it was last taken, and
+        // the body the loop buffer replays once locked
+        uint64_t loop_branch_pc_ = 0;
+        uint32_t loop_iterations_ = 0;
+        bool loop_body_cached_ = true;
+        uint32_t loop_body_uops_ = 0;
+        std::vector<UopCache::DecodedInst> loop_body_;
+        std::vector<UopCache::DecodedInst> loop_buffer_;
+        bool loop_buffer_locked_ = false;
+        uint32_t loop_buffer_pos_ = 0;
+
+        sparta::Counter uop_cache_hits_;
+        sparta::Counter uop_cache_misses_;
+        sparta::Counter uop_cache_fill_overflows_;
+        sparta::Counter uop_cache_groups_;
+        sparta::Counter loop_buffer_insts_;
+        sparta::Counter loop_buffer_locks_;
+        sparta::StatisticDef uop_cache_hit_rate_;
+
         Inst::VCSRs VCSRs_;
 
         MavisType* mavis_facade_;
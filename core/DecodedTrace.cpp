@@ -0,0 +1,219 @@
+// <DecodedTrace.cpp> -*- C++ -*-
+
+//!
+//! \file DecodedTrace.cpp
+//! \brief Reader and converter for pre-decoded trace files
+//!
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "DecodedTrace.hpp"
+#include "InstGenerator.hpp"
+#include "mavis/Mavis.h"
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    DecodedTraceReader::DecodedTraceReader(const std::string & filename) : filename_(filename)
+    {
+        const int fd = ::open(filename_.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw sparta::SpartaException("ERROR: Issues opening ")
+                << filename_ << ": " << std::strerror(errno);
+        }
+
+        struct stat file_stat;
+        if (::fstat(fd, &file_stat) != 0
+            || static_cast<size_t>(file_stat.st_size) < sizeof(decoded_trace::FileHeader))
+        {
+            ::close(fd);
+            throw sparta::SpartaException("ERROR: ") << filename_ << " is not a pre-decoded trace";
+        }
+        mapped_size_ = file_stat.st_size;
+
+        // Shared, read-only: every process replaying this file maps the same pages
+        void* addr = ::mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            throw sparta::SpartaException("ERROR: Could not map ")
+                << filename_ << ": " << std::strerror(errno);
+        }
+        mapped_ = static_cast<const uint8_t*>(addr);
+        header_ = reinterpret_cast<const decoded_trace::FileHeader*>(mapped_);
+
+        if (std::memcmp(header_->magic, decoded_trace::MAGIC, sizeof(decoded_trace::MAGIC)) != 0)
+        {
+            ::munmap(const_cast<uint8_t*>(mapped_), mapped_size_);
+            throw sparta::SpartaException("ERROR: ") << filename_ << " is not a pre-decoded trace";
+        }
+        if (header_->version != decoded_trace::VERSION)
+        {
+            ::munmap(const_cast<uint8_t*>(mapped_), mapped_size_);
+            throw sparta::SpartaException("ERROR: ")
+                << filename_ << " is pre-decoded trace version " << header_->version
+                << ", expected version " << decoded_trace::VERSION << ".  Regenerate it";
+        }
+
+        pc_ = getColumn_<uint64_t>(decoded_trace::PC);
+        opcode_ = getColumn_<uint32_t>(decoded_trace::OPCODE);
+        uid_ = getColumn_<uint32_t>(decoded_trace::UID);
+        target_vaddr_ = getColumn_<uint64_t>(decoded_trace::TARGET_VADDR);
+        flags_ = getColumn_<uint8_t>(decoded_trace::FLAGS);
+        direct_index_ = getColumn_<uint32_t>(decoded_trace::DIRECT_INDEX);
+        direct_operands_ = getColumn_<decoded_trace::DirectOperands>(decoded_trace::DIRECT_OPERANDS);
+
+        // Replay is sequential
+        ::madvise(const_cast<uint8_t*>(mapped_), mapped_size_, MADV_SEQUENTIAL);
+    }
+
+    DecodedTraceReader::~DecodedTraceReader()
+    {
+        ::munmap(const_cast<uint8_t*>(mapped_), mapped_size_);
+    }
+
+    template <typename T>
+    const T* DecodedTraceReader::getColumn_(const decoded_trace::Column column) const
+    {
+        const uint64_t num_entries = (column == decoded_trace::DIRECT_OPERANDS)
+                                         ? header_->num_direct
+                                         : header_->num_insts;
+        const uint64_t offset = header_->column_offset[column];
+        if ((offset % alignof(T)) != 0 || offset > mapped_size_
+            || (num_entries * sizeof(T)) > (mapped_size_ - offset))
+        {
+            throw sparta::SpartaException("ERROR: ") << filename_ << " is truncated or corrupt";
+        }
+        return reinterpret_cast<const T*>(mapped_ + offset);
+    }
+
+    namespace
+    {
+        // Append a column to the file at the next 8-byte boundary
+        template <typename T>
+        void writeColumn(std::ofstream & fs, const std::vector<T> & column, uint64_t & offset)
+        {
+            static const char padding[8] = {};
+            const uint64_t pos = static_cast<uint64_t>(fs.tellp());
+            const uint64_t aligned = (pos + 7) & ~uint64_t(7);
+            fs.write(padding, aligned - pos);
+            offset = aligned;
+            fs.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+        }
+
+        decoded_trace::PackedOperand packOperand(const mavis::OperandInfo::Element & element)
+        {
+            sparta_assert(element.field_value <= UINT16_MAX,
+                          "Operand value too large for a pre-decoded trace: "
+                              << element.field_value);
+            return {static_cast<uint8_t>(element.field_id),
+                    static_cast<uint8_t>(element.operand_type),
+                    static_cast<uint16_t>(element.field_value)};
+        }
+    } // namespace
+
+    uint64_t convertToDecodedTrace(MavisType* mavis_facade, const std::string & workload,
+                                   const std::string & output, const sparta::Clock* clk,
+                                   const uint64_t inst_limit)
+    {
+        std::unique_ptr<InstGenerator> inst_generator =
+            InstGenerator::createGenerator(mavis_facade, workload, false);
+
+        std::vector<uint64_t> pcs;
+        std::vector<uint32_t> opcodes;
+        std::vector<uint32_t> uids;
+        std::vector<uint64_t> target_vaddrs;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> direct_indexes;
+        std::vector<decoded_trace::DirectOperands> direct_operands;
+
+        InstPtr inst;
+        while (((inst_limit == 0) || (pcs.size() < inst_limit))
+               && (inst = inst_generator->getNextInst(clk)) != nullptr)
+        {
+            pcs.emplace_back(inst->getPC());
+            opcodes.emplace_back(inst->getOpCode());
+            uids.emplace_back(inst->getMavisUid());
+            target_vaddrs.emplace_back(inst->getTargetVAddr());
+            flags.emplace_back((inst->isTakenBranch() ? decoded_trace::FLAG_TAKEN_BRANCH : 0)
+                               | (inst->isLoadStoreInst() ? decoded_trace::FLAG_MEM_ACCESS : 0)
+                               | (inst->isBranch() ? decoded_trace::FLAG_BRANCH : 0));
+
+            // Instructions without an encoding (JSON mnemonics) carry
+            // their operands so they can be rebuilt directly
+            if (inst->getOpCode() != 0)
+            {
+                direct_indexes.emplace_back(decoded_trace::NO_DIRECT_INDEX);
+                continue;
+            }
+
+            decoded_trace::DirectOperands direct = {};
+            const auto & srcs = inst->getSourceOpInfoList();
+            const auto & dests = inst->getDestOpInfoList();
+            sparta_assert(srcs.size() <= std::size(direct.srcs)
+                              && dests.size() <= std::size(direct.dests),
+                          "Too many operands for a pre-decoded trace: " << inst);
+            for (const auto & src : srcs)
+            {
+                direct.srcs[direct.num_srcs++] = packOperand(src);
+            }
+            for (const auto & dest : dests)
+            {
+                direct.dests[direct.num_dests++] = packOperand(dest);
+            }
+            direct.has_imm = inst->hasImmediate();
+            direct.imm = direct.has_imm ? inst->getImmediate() : 0;
+            direct.vl = inst->getVL();
+            direct.sew = static_cast<uint16_t>(inst->getSEW());
+            direct.lmul = static_cast<uint8_t>(inst->getLMUL());
+            direct.vta = static_cast<uint8_t>(inst->getVTA());
+            direct_indexes.emplace_back(static_cast<uint32_t>(direct_operands.size()));
+            direct_operands.emplace_back(direct);
+        }
+
+        std::ofstream fs;
+        fs.exceptions(std::ios::failbit | std::ios::badbit);
+        try
+        {
+            fs.open(output, std::ios::binary | std::ios::trunc);
+
+            decoded_trace::FileHeader header = {};
+            std::memcpy(header.magic, decoded_trace::MAGIC, sizeof(header.magic));
+            header.version = decoded_trace::VERSION;
+            header.num_insts = pcs.size();
+            header.num_direct = direct_operands.size();
+
+            // Columns first, then rewrite the header with their offsets
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writeColumn(fs, pcs, header.column_offset[decoded_trace::PC]);
+            writeColumn(fs, opcodes, header.column_offset[decoded_trace::OPCODE]);
+            writeColumn(fs, uids, header.column_offset[decoded_trace::UID]);
+            writeColumn(fs, target_vaddrs, header.column_offset[decoded_trace::TARGET_VADDR]);
+            writeColumn(fs, flags, header.column_offset[decoded_trace::FLAGS]);
+            writeColumn(fs, direct_indexes, header.column_offset[decoded_trace::DIRECT_INDEX]);
+            writeColumn(fs, direct_operands,
+                        header.column_offset[decoded_trace::DIRECT_OPERANDS]);
+            fs.seekp(0);
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+        catch (const std::ios_base::failure & e)
+        {
+            throw sparta::SpartaException("ERROR: Issues writing ") << output << ": " << e.what();
+        }
+
+        std::cout << "olympia: wrote " << pcs.size() << " pre-decoded instructions to " << output
+                  << std::endl;
+        return pcs.size();
+    }
+} // namespace olympia
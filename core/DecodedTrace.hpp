@@ -0,0 +1,161 @@
+// <DecodedTrace.hpp> -*- C++ -*-
+
+//!
+//! \file DecodedTrace.hpp
+//! \brief A memory-mappable, columnar, pre-decoded instruction trace
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "Inst.hpp"
+#include "MavisUnit.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief Pre-decoded trace file layout
+     *
+     * A pre-decoded trace (.pdt) holds the dynamic instruction stream of
+     * a workload after it has been decompressed and decoded once.  The
+     * file is a FileHeader followed by one column per field, each column
+     * 8-byte aligned and indexed by the dynamic instruction number:
+     *
+     *   PC              uint64_t   instruction PC
+     *   OPCODE          uint32_t   instruction encoding (0 if built from a mnemonic)
+     *   UID             uint32_t   Mavis unique ID, checked against the decode
+     *   TARGET_VADDR    uint64_t   load/store address or branch target
+     *   FLAGS           uint8_t    FLAG_* bits
+     *   DIRECT_INDEX    uint32_t   index into DIRECT_OPERANDS or NO_DIRECT_INDEX
+     *   DIRECT_OPERANDS DirectOperands, one per instruction that has no encoding
+     *
+     * The file is read through a read-only shared mapping, so every
+     * simulator on a host replaying the same file shares its pages.
+     * Values are stored in host byte order.
+     */
+    namespace decoded_trace
+    {
+        static constexpr char FILE_EXTENSION[] = "pdt";
+        static constexpr char MAGIC[8] = {'O', 'L', 'Y', 'P', 'D', 'T', '\0', '\0'};
+        static constexpr uint32_t VERSION = 2;
+
+        enum Column : uint32_t
+        {
+            PC,
+            OPCODE,
+            UID,
+            TARGET_VADDR,
+            FLAGS,
+            DIRECT_INDEX,
+            DIRECT_OPERANDS,
+            NUM_COLUMNS
+        };
+
+        static constexpr uint8_t FLAG_TAKEN_BRANCH = 0x1;
+        static constexpr uint8_t FLAG_MEM_ACCESS = 0x2;
+        static constexpr uint8_t FLAG_BRANCH = 0x4;
+        static constexpr uint32_t NO_DIRECT_INDEX = 0xffffffff;
+
+        struct FileHeader
+        {
+            char     magic[8];
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t num_insts;
+            uint64_t num_direct;
+            uint64_t column_offset[NUM_COLUMNS];
+        };
+
+        //! An operand of an instruction built from its mnemonic
+        struct PackedOperand
+        {
+            uint8_t  field_id;
+            uint8_t  type;
+            uint16_t value;
+        };
+
+        //! Everything needed to rebuild an instruction that has no
+        //! encoding (JSON instructions given by mnemonic)
+        struct DirectOperands
+        {
+            uint64_t      imm;
+            PackedOperand srcs[6];
+            PackedOperand dests[3];
+            uint32_t      vl;
+            uint16_t      sew;
+            uint8_t       lmul;
+            uint8_t       vta;
+            uint8_t       num_srcs;
+            uint8_t       num_dests;
+            uint8_t       has_imm;
+            uint8_t       reserved;
+        };
+        static_assert(sizeof(DirectOperands) == 56, "DirectOperands layout changed");
+    } // namespace decoded_trace
+
+    /*!
+     * \class DecodedTraceReader
+     * \brief Read-only memory mapping of a pre-decoded trace file
+     */
+    class DecodedTraceReader
+    {
+      public:
+        explicit DecodedTraceReader(const std::string & filename);
+        ~DecodedTraceReader();
+
+        DecodedTraceReader(const DecodedTraceReader &) = delete;
+        DecodedTraceReader & operator=(const DecodedTraceReader &) = delete;
+
+        uint64_t size() const { return header_->num_insts; }
+
+        uint64_t getPC(const uint64_t idx) const { return pc_[idx]; }
+
+        uint32_t getOpcode(const uint64_t idx) const { return opcode_[idx]; }
+
+        uint32_t getUID(const uint64_t idx) const { return uid_[idx]; }
+
+        uint64_t getTargetVAddr(const uint64_t idx) const { return target_vaddr_[idx]; }
+
+        uint8_t getFlags(const uint64_t idx) const { return flags_[idx]; }
+
+        //! nullptr if the instruction is rebuilt from its opcode
+        const decoded_trace::DirectOperands* getDirectOperands(const uint64_t idx) const
+        {
+            const uint32_t direct_idx = direct_index_[idx];
+            return (direct_idx == decoded_trace::NO_DIRECT_INDEX) ? nullptr
+                                                                  : &direct_operands_[direct_idx];
+        }
+
+      private:
+        template <typename T> const T* getColumn_(const decoded_trace::Column column) const;
+
+        const std::string filename_;
+        size_t mapped_size_ = 0;
+        const uint8_t* mapped_ = nullptr;
+        const decoded_trace::FileHeader* header_ = nullptr;
+
+        const uint64_t* pc_ = nullptr;
+        const uint32_t* opcode_ = nullptr;
+        const uint32_t* uid_ = nullptr;
+        const uint64_t* target_vaddr_ = nullptr;
+        const uint8_t* flags_ = nullptr;
+        const uint32_t* direct_index_ = nullptr;
+        const decoded_trace::DirectOperands* direct_operands_ = nullptr;
+    };
+
+    /*!
+     * \brief Convert a workload into a pre-decoded trace file
+     * \param mavis_facade The decoder
+     * \param workload     Any workload accepted by InstGenerator::createGenerator
+     * \param output       Name of the pre-decoded trace file to write
+     * \param clk          Clock used to build the instructions
+     * \param inst_limit   Stop after this many instructions.  0 means no limit
+     * \return The number of instructions written
+     */
+    uint64_t convertToDecodedTrace(MavisType* mavis_facade, const std::string & workload,
+                                   const std::string & output, const sparta::Clock* clk,
+                                   const uint64_t inst_limit);
+} // namespace olympia
@@ -15,7 +15,8 @@ namespace olympia
         dispatch_queue_("dispatch_queue", p->dispatch_queue_depth, node->getClock(),
                         getStatisticSet()),
         num_to_dispatch_(p->num_to_dispatch),
-        dispatch_queue_depth_(p->dispatch_queue_depth)
+        dispatch_queue_depth_(p->dispatch_queue_depth),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         weighted_unit_distribution_context_.assignContextWeights(p->context_weights);
         dispatch_queue_.enableCollection(node);
@@ -298,6 +299,10 @@ namespace olympia
          
             if (dispatched)
             {
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::DISPATCH, ex_inst_ptr);
+                }
                 insts_dispatched->emplace_back(ex_inst_ptr);
                 dispatch_queue_.pop();
                 --credits_rob_;
@@ -333,6 +338,13 @@ namespace olympia
     void Dispatch::handleFlush_(const FlushManager::FlushingCriteria & criteria)
     {
         ILOG("Got a flush call for " << criteria);
+        if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+        {
+            for (const auto & inst : dispatch_queue_)
+            {
+                event_log_->record(PipelineEventType::FLUSH, inst);
+            }
+        }
         out_dispatch_queue_credits_.send(dispatch_queue_.size());
         dispatch_queue_.clear();
         out_reorder_write_.cancel();
@@ -21,6 +21,7 @@
 #include "CoreTypes.hpp"
 #include "InstGroup.hpp"
 #include "FlushManager.hpp"
+#include "PipelineEventLog.hpp"
 
 namespace olympia
 {
@@ -40,7 +41,12 @@ namespace olympia
         class DispatchParameterSet : public sparta::ParameterSet
         {
           public:
-            DispatchParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+            DispatchParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n)
+            {
+                num_to_dispatch.addDependentValidationCallback(
+                    InstGroup::fitsWidth,
+                    "Num to dispatch must fit in an InstGroup (InstGroup::MAX_WIDTH)");
+            }
 
             PARAMETER(uint32_t, num_to_dispatch, 3, "Number of instructions to dispatch")
             PARAMETER(uint32_t, dispatch_queue_depth, 10, "Depth of the dispatch buffer")
@@ -108,6 +114,9 @@ namespace olympia
         uint32_t credits_rob_ = 0;
         uint32_t dispatch_queue_depth_;
 
+        // Where dispatched instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
         // Send rename initial credits
         void sendInitialCredits_();
 
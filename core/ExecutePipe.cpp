@@ -16,7 +16,8 @@ namespace olympia
         enable_random_misprediction_(p->enable_random_misprediction && p->contains_branch_unit),
         issue_queue_name_(p->iq_name),
         valu_adder_num_(p->valu_adder_num),
-        collected_inst_(node, node->getName())
+        collected_inst_(node, node->getName()),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         p->enable_random_misprediction.ignore();
         p->contains_branch_unit.ignore();
@@ -56,6 +57,10 @@ namespace olympia
         if (num_passes_needed_ == 0)
         {
             ex_inst->setStatus(Inst::Status::SCHEDULED);
+            if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+            {
+                event_log_->record(PipelineEventType::ISSUE, ex_inst);
+            }
             // we only need to check if unit_busy_ if instruction doesn't have multiple passes
             // if it does need multiple passes, we need to keep unit_busy_ blocked so no instruction
             // can get dispatched before the next pass begins
@@ -146,7 +151,11 @@ namespace olympia
                 scoreboard_views_[reg_file]->setReady(dest_bits);
             }
 
-            if (enable_random_misprediction_)
+            if (ex_inst->isMispredicted())
+            {
+                ILOG("Resolved a mispredicted branch: " << ex_inst);
+            }
+            else if (enable_random_misprediction_)
             {
                 if (ex_inst->isBranch() && (std::rand() % 20) == 0)
                 {
@@ -170,6 +179,10 @@ namespace olympia
     void ExecutePipe::completeInst_(const InstPtr & ex_inst)
     {
         ex_inst->setStatus(Inst::Status::COMPLETED);
+        if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+        {
+            event_log_->record(PipelineEventType::COMPLETE, ex_inst);
+        }
         complete_event_.collect(*ex_inst);
         ILOG("Completing inst: " << ex_inst);
         out_execute_pipe_.send(1);
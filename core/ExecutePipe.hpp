@@ -28,6 +28,8 @@
 #include "CoreTypes.hpp"
 #include "FlushManager.hpp"
 #include "Inst.hpp"
+#include "PipelineEventLog.hpp"
+#include "RuntimeTunable.hpp"
 
 namespace olympia
 {
@@ -35,7 +37,7 @@ namespace olympia
      * \class ExecutePipe
      * \brief Defines the stages for an execution pipe
      */
-    class ExecutePipe : public sparta::Unit
+    class ExecutePipe : public sparta::Unit, public RuntimeTunableIF
     {
 
       public:
@@ -49,7 +51,8 @@ namespace olympia
                       "use execute_time param instead")
             PARAMETER(uint32_t, execute_time, 1, "Time for execution")
             PARAMETER(bool, enable_random_misprediction, false,
-                      "test mode to inject random branch mispredictions")
+                      "test mode to inject random branch mispredictions on top of the "
+                      "fetch branch predictor's")
             PARAMETER(uint32_t, valu_adder_num, 8,
                       "VALU Number of Adders") // # of 64 bit adders, so 8 64 bit adders = 512 bits
             HIDDEN_PARAMETER(bool, contains_branch_unit, false,
@@ -68,6 +71,18 @@ namespace olympia
         //! \brief Name of this resource. Required by sparta::UnitFactory
         static const char name[];
 
+        //! execute_time (used with ignore_inst_execute_time) can
+        //! change after warm-up
+        std::vector<std::string> getTunableParameters() const override
+        {
+            return {"execute_time"};
+        }
+
+        void tune(const std::string & param_name, const std::string & value) override
+        {
+            execute_time_ = parseTunable<uint32_t>(param_name, value);
+        }
+
         bool canAccept() { return !unit_busy_; }
 
         // Write result to registers
@@ -97,7 +112,7 @@ namespace olympia
         bool unit_busy_ = false;
         // Execution unit's execution time
         const bool ignore_inst_execute_time_ = false;
-        const uint32_t execute_time_;
+        uint32_t execute_time_;
         const bool enable_random_misprediction_;
         const std::string issue_queue_name_;
         uint32_t valu_adder_num_;
@@ -117,6 +132,9 @@ namespace olympia
         // A pipeline collector
         sparta::collection::Collectable<InstPtr> collected_inst_;
 
+        // Where issued and completed instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
         // For correlation activities
         sparta::pevents::PeventCollector<InstPEventPairs> complete_event_{
             "COMPLETE", getContainer(), getClock()};
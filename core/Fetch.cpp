@@ -7,8 +7,11 @@
 
 #include <algorithm>
 #include "Fetch.hpp"
+#include "Checkpoint.hpp"
+#include "CoreUtils.hpp"
 #include "InstGenerator.hpp"
 #include "MavisUnit.hpp"
+#include "OlympiaAllocators.hpp"
 
 #include "sparta/utils/LogUtils.hpp"
 #include "sparta/events/StartupEvent.hpp"
@@ -21,14 +24,65 @@ namespace olympia
         sparta::Unit(node),
         num_insts_to_fetch_(p->num_to_fetch),
         skip_nonuser_mode_(p->skip_nonuser_mode),
-        my_clk_(getClock())
+        async_trace_ring_size_(p->async_trace_ring_size),
+        async_trace_rewind_window_(p->async_trace_rewind_window),
+        my_clk_(getClock()),
+        replay_window_size_(p->replay_window_size),
+        inst_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(node))
+                            ->getInstAllocator()),
+        memory_access_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(node))
+                                     ->getMemoryAccessAllocator()),
+        event_log_(PipelineEventLog::getBuffer(node)),
+        branch_predictor_type_(p->branch_predictor),
+        fetch_from_icache_(p->fetch_from_icache),
+        ftq_size_(p->ftq_size),
+        icache_requests_(p->icache_requests),
+        fdip_lookahead_(p->fdip_lookahead)
     {
+        BranchPredictor::PredictorConfig bpred_config;
+        bpred_config.pht_bits = p->bpred_pht_bits;
+        bpred_config.btb_bits = p->bpred_btb_bits;
+        bpred_config.history_bits = p->bpred_history_bits;
+        bpred_config.tage_num_tables = p->tage_num_tables;
+        bpred_config.tage_table_bits = p->tage_table_bits;
+        bpred_config.tage_tag_bits = p->tage_tag_bits;
+        bpred_config.tage_min_history = p->tage_min_history;
+        bpred_config.tage_max_history = p->tage_max_history;
+        bpred_config.sc_table_bits = p->sc_table_bits;
+        bpred_config.loop_set_bits = p->loop_set_bits;
+        bpred_config.ras_entries = p->ras_entries;
+        bpred_config.ittage_num_tables = p->ittage_num_tables;
+        bpred_config.ittage_table_bits = p->ittage_table_bits;
+        branch_predictor_ = BranchPredictor::createBranchPredictor(branch_predictor_type_, bpred_config);
+
         in_fetch_queue_credits_.registerConsumerHandler(
             CREATE_SPARTA_HANDLER_WITH_DATA(Fetch, receiveFetchQueueCredits_, uint32_t));
 
         in_fetch_flush_redirect_.registerConsumerHandler(
             CREATE_SPARTA_HANDLER_WITH_DATA(Fetch, flushFetch_, FlushManager::FlushingCriteria));
 
+        if (replay_window_size_ != 0)
+        {
+            in_fetch_retire_ack_.registerConsumerHandler(
+                CREATE_SPARTA_HANDLER_WITH_DATA(Fetch, releaseRetired_, InstPtr));
+        }
+
+        if (fetch_from_icache_)
+        {
+            sparta_assert((ftq_size_ > 0) && (icache_requests_ > 0),
+                          "Fetch: ftq_size and icache_requests must be greater than 0");
+
+            // Fetch blocks end at the ICache's line boundaries
+            const uint32_t line_size =
+                node->getParent()
+                    ->getChildAs<sparta::ParameterBase>("icache.params.l1_line_size")
+                    ->getValueAs<uint32_t>();
+            icache_line_mask_ = ~(static_cast<uint64_t>(line_size) - 1);
+
+            in_icache_resp_.registerConsumerHandler(
+                CREATE_SPARTA_HANDLER_WITH_DATA(Fetch, receiveICacheResp_, MemoryAccessInfoPtr));
+        }
+
         fetch_inst_event_.reset(new sparta::SingleCycleUniqueEvent<>(
             &unit_event_set_, "fetch_random", CREATE_SPARTA_HANDLER(Fetch, fetchInstruction_)));
         // Schedule a single event to start reading from a trace file
@@ -42,15 +96,116 @@ namespace olympia
         // Get the CPU Node
         auto cpu_node = getContainer()->getParent()->getParent();
         auto extension = sparta::notNull(cpu_node->getExtension("simulation_configuration"));
-        auto workload = extension->getParameters()->getParameter("workload");
+        // This core's own workload, if it has one
+        std::string workload =
+            extension->getParameters()->getParameter("workload")->getValueAsString();
+        const auto core_workloads = extension->getParameters()
+                                        ->getParameter("core_workloads")
+                                        ->getValueAs<std::vector<std::string>>();
+        const uint32_t core_idx = coreutils::getCoreIndex(getContainer());
+        if ((core_idx < core_workloads.size()) && (false == core_workloads[core_idx].empty()))
+        {
+            workload = core_workloads[core_idx];
+        }
         inst_generator_ = InstGenerator::createGenerator(
-            getMavis(getContainer()), workload->getValueAsString(), skip_nonuser_mode_);
+            getMavis(getContainer()), workload, skip_nonuser_mode_,
+            async_trace_ring_size_, async_trace_rewind_window_);
+        inst_generator_->setMavisUnit(getMavisUnit(getContainer()));
+
+        // Fast-forward to where detailed simulation starts
+        const uint64_t fast_forward =
+            extension->getParameters()->getParameter("fast_forward")->getValueAs<uint64_t>();
+        const bool functional_warming =
+            extension->getParameters()->getParameter("functional_warming")->getValueAs<bool>();
+
+        // Sampled simulation always warms between intervals
+        const auto sim_params = extension->getParameters();
+        const uint64_t sampling_period =
+            sim_params->getParameter("sampling_period")->getValueAs<uint64_t>();
+        if (sampling_period != 0)
+        {
+            sampling_detail_length_ =
+                sim_params->getParameter("sampling_warmup")->getValueAs<uint64_t>()
+                + sim_params->getParameter("sampling_measure")->getValueAs<uint64_t>();
+            sparta_assert((sampling_detail_length_ != 0)
+                              && (sampling_detail_length_ <= sampling_period),
+                          "Sampling warm-up plus measurement (" << sampling_detail_length_
+                              << ") must be non-zero and fit in the sampling period ("
+                              << sampling_period << ")");
+            sampling_skip_length_ = sampling_period - sampling_detail_length_;
+        }
+
+        if (functional_warming || (sampling_skip_length_ != 0))
+        {
+            // Everything in this core that can be warmed
+            functional_warmer_.reset(new FunctionalWarmer(getContainer()->getParent()));
+        }
+
+        // Start from a checkpoint: restore the warmed state and move
+        // the workload to where the checkpoint was taken
+        uint64_t workload_position = 0;
+        const std::string checkpoint_restore =
+            sim_params->getParameter("checkpoint_restore")->getValueAsString();
+        if (false == checkpoint_restore.empty())
+        {
+            const Checkpointer checkpointer(getContainer()->getParent());
+            const uint64_t position =
+                checkpointer.restore(checkpoint_restore, workload);
+            workload_position = inst_generator_->skip(position);
+            std::cout << "olympia: restored checkpoint " << checkpoint_restore
+                      << " at workload instruction " << workload_position << std::endl;
+        }
+
+        if (fast_forward != 0)
+        {
+            InstGenerator::WarmingCallback warm;
+            if (functional_warming)
+            {
+                warm = [this](WarmingRecord & record) { functional_warmer_->warm(record); };
+            }
+            const uint64_t skipped = inst_generator_->skip(fast_forward, warm);
+            workload_position += skipped;
+            std::cout << "olympia: fast-forwarded " << skipped << " instructions" << std::endl;
+            ILOG("Fast-forwarded " << skipped << " of " << fast_forward << " instructions");
+            if (functional_warming)
+            {
+                functional_warmer_->reportCoverage(std::cout, "after fast-forward");
+            }
+        }
+
+        const std::string checkpoint_save =
+            sim_params->getParameter("checkpoint_save")->getValueAsString();
+        if (false == checkpoint_save.empty())
+        {
+            Checkpointer(getContainer()->getParent())
+                .save(checkpoint_save, workload, workload_position);
+            std::cout << "olympia: saved checkpoint " << checkpoint_save
+                      << " at workload instruction " << workload_position << std::endl;
+        }
 
         fetch_inst_event_->schedule(1);
     }
 
+    void Fetch::onStartingTeardown_()
+    {
+        if (fetch_from_icache_)
+        {
+            setStallCause_(StallCause::NONE, getClock()->currentCycle());
+        }
+        if (functional_warmer_)
+        {
+            functional_warmer_->reportCoverage(std::cout, "at end of simulation");
+        }
+    }
+
     void Fetch::fetchInstruction_()
     {
+        if (fetch_from_icache_)
+        {
+            fetchFromICache_();
+            return;
+        }
+
         const uint32_t upper = std::min(credits_inst_queue_, num_insts_to_fetch_);
 
         // Nothing to send.  Don't need to schedule this again.
@@ -63,11 +218,19 @@ namespace olympia
             sparta::allocate_sparta_shared_pointer<InstGroup>(instgroup_allocator);
         for (uint32_t i = 0; i < upper; ++i)
         {
-            InstPtr ex_inst = inst_generator_->getNextInst(my_clk_);
+            InstPtr ex_inst = getNextInst_();
             if (SPARTA_EXPECT_TRUE(nullptr != ex_inst))
             {
                 ex_inst->setSpeculative(speculative_path_);
+                if (ex_inst->isBranch() && (nullptr != branch_predictor_))
+                {
+                    predictBranch_(ex_inst);
+                }
                 insts_to_send->emplace_back(ex_inst);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::FETCH, ex_inst);
+                }
                 ILOG("Sending: " << ex_inst << " down the pipe");
             }
             else
@@ -76,13 +239,19 @@ namespace olympia
             }
         }
 
+        if (async_trace_ring_size_ != 0)
+        {
+            trace_producer_stalls_ = inst_generator_->getProducerStalls();
+            trace_consumer_stalls_ = inst_generator_->getConsumerStalls();
+        }
+
         if (false == insts_to_send->empty())
         {
             out_fetch_queue_write_.send(insts_to_send);
 
             credits_inst_queue_ -= static_cast<uint32_t>(insts_to_send->size());
 
-            if ((credits_inst_queue_ > 0) && (false == inst_generator_->isDone()))
+            if ((credits_inst_queue_ > 0) && (false == isDone_()))
             {
                 fetch_inst_event_->schedule(1);
             }
@@ -99,6 +268,404 @@ namespace olympia
         }
     }
 
+    void Fetch::fetchFromICache_()
+    {
+        const uint64_t cycle = getClock()->currentCycle();
+
+        // The predictor queues one fetch block per cycle
+        if ((fetch_target_queue_.size() < ftq_size_) && hasInstsToPredict_())
+        {
+            queueFetchBlock_();
+        }
+
+        // Look up the oldest fetch block not looked up yet, if there
+        // is room for another lookup
+        uint32_t lookups = 0;
+        bool can_look_up = false;
+        for (auto & block : fetch_target_queue_)
+        {
+            if (nullptr == block.icache_req)
+            {
+                if (lookups < icache_requests_)
+                {
+                    block.icache_req = sparta::allocate_sparta_shared_pointer<MemoryAccessInfo>(
+                        memory_access_allocator_, block.line_addr);
+                    out_icache_req_.send(block.icache_req);
+                    ILOG("Fetch: looking up line 0x" << std::hex << block.line_addr);
+                    can_look_up = (lookups + 1 < icache_requests_);
+                }
+                break;
+            }
+            if (false == block.ready)
+            {
+                ++lookups;
+            }
+        }
+
+        const bool can_prefetch = (fdip_lookahead_ != 0) && prefetchFetchBlock_();
+
+        // Send decode what it has room for from the oldest block
+        bool sent = false;
+        const uint32_t upper = std::min(credits_inst_queue_, num_insts_to_fetch_);
+        if ((false == fetch_target_queue_.empty()) && fetch_target_queue_.front().ready
+            && (upper > 0))
+        {
+            FetchBlock & block = fetch_target_queue_.front();
+            InstGroupPtr insts_to_send =
+                sparta::allocate_sparta_shared_pointer<InstGroup>(instgroup_allocator);
+            while ((insts_to_send->size() < upper) && (block.num_insts > 0))
+            {
+                const InstPtr & ex_inst = ftq_insts_.front();
+                insts_to_send->emplace_back(ex_inst);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::FETCH, ex_inst);
+                }
+                ILOG("Sending: " << ex_inst << " down the pipe");
+                ftq_insts_.pop_front();
+                --block.num_insts;
+            }
+            if (block.num_insts == 0)
+            {
+                fetch_target_queue_.pop_front();
+            }
+
+            out_fetch_queue_write_.send(insts_to_send);
+            credits_inst_queue_ -= static_cast<uint32_t>(insts_to_send->size());
+            sent = true;
+        }
+
+        if (async_trace_ring_size_ != 0)
+        {
+            trace_producer_stalls_ = inst_generator_->getProducerStalls();
+            trace_consumer_stalls_ = inst_generator_->getConsumerStalls();
+        }
+
+        // What holds up the next cycle's delivery
+        StallCause cause = StallCause::NONE;
+        if (fetch_target_queue_.empty())
+        {
+            cause = hasInstsToPredict_() ? StallCause::FTQ_EMPTY : StallCause::NONE;
+        }
+        else if (false == fetch_target_queue_.front().ready)
+        {
+            cause = StallCause::ICACHE;
+        }
+        else if (credits_inst_queue_ == 0)
+        {
+            cause = StallCause::DECODE_FULL;
+        }
+        if (sent)
+        {
+            setStallCause_(StallCause::NONE, cycle);
+        }
+        if (cause != stall_cause_)
+        {
+            setStallCause_(cause, cycle + 1);
+        }
+
+        // Keep going while there is work that does not wait on the
+        // ICache or decode, which wake fetch up themselves
+        const bool can_predict =
+            (fetch_target_queue_.size() < ftq_size_) && hasInstsToPredict_();
+        can_look_up = can_look_up
+                      && std::any_of(fetch_target_queue_.begin(), fetch_target_queue_.end(),
+                                     [](const FetchBlock & block)
+                                     { return nullptr == block.icache_req; });
+        const bool can_send = (false == fetch_target_queue_.empty())
+                              && fetch_target_queue_.front().ready && (credits_inst_queue_ > 0);
+        if (can_predict || can_look_up || can_prefetch || can_send)
+        {
+            fetch_inst_event_->schedule(1);
+        }
+    }
+
+    void Fetch::queueFetchBlock_()
+    {
+        FetchBlock block;
+        while (block.num_insts < num_insts_to_fetch_)
+        {
+            InstPtr inst = next_block_inst_;
+            next_block_inst_ = nullptr;
+            if (nullptr == inst)
+            {
+                inst = getNextInst_();
+                if (nullptr == inst)
+                {
+                    break;
+                }
+            }
+
+            const uint64_t line_addr = inst->getPC() & icache_line_mask_;
+            if (block.num_insts == 0)
+            {
+                block.line_addr = line_addr;
+            }
+            else if (line_addr != block.line_addr)
+            {
+                // Starts the next block
+                next_block_inst_ = inst;
+                break;
+            }
+
+            inst->setSpeculative(speculative_path_);
+            const bool is_branch = inst->isBranch();
+            if (is_branch && (nullptr != branch_predictor_))
+            {
+                predictBranch_(inst);
+            }
+            const bool taken = is_branch && (inst->isTakenBranch() || !inst->isCondBranch());
+            ftq_insts_.emplace_back(inst);
+            ++block.num_insts;
+
+            // Fetch continues at the branch target, in a new block
+            if (taken)
+            {
+                break;
+            }
+        }
+
+        if (block.num_insts > 0)
+        {
+            ILOG("Fetch: queued a fetch block of " << block.num_insts << " instructions at line 0x"
+                                                   << std::hex << block.line_addr);
+            fetch_target_queue_.emplace_back(block);
+            ++ftq_blocks_;
+        }
+    }
+
+    bool Fetch::prefetchFetchBlock_()
+    {
+        // Blocks up to fdip_lookahead_ past the first one not looked up
+        auto block = std::find_if(fetch_target_queue_.begin(), fetch_target_queue_.end(),
+                                  [](const FetchBlock & b) { return nullptr == b.icache_req; });
+        const auto lookahead_end =
+            block + std::min<ptrdiff_t>(fdip_lookahead_, fetch_target_queue_.end() - block);
+
+        bool prefetched = false;
+        for (; block != lookahead_end; ++block)
+        {
+            if (block->prefetched)
+            {
+                continue;
+            }
+            if (prefetched)
+            {
+                return true;
+            }
+            block->prefetched = true;
+            if (block->line_addr != last_prefetch_line_)
+            {
+                last_prefetch_line_ = block->line_addr;
+                ILOG("Fetch: prefetching line 0x" << std::hex << block->line_addr);
+                out_icache_prefetch_req_.send(
+                    sparta::allocate_sparta_shared_pointer<MemoryAccessInfo>(
+                        memory_access_allocator_, block->line_addr));
+                ++fdip_prefetches_;
+                prefetched = true;
+            }
+        }
+        return false;
+    }
+
+    void Fetch::receiveICacheResp_(const MemoryAccessInfoPtr & resp)
+    {
+        for (auto & block : fetch_target_queue_)
+        {
+            if (block.icache_req == resp)
+            {
+                ILOG("Fetch: line 0x" << std::hex << block.line_addr << " arrived");
+                block.ready = true;
+                fetch_inst_event_->schedule(sparta::Clock::Cycle(0));
+                return;
+            }
+        }
+        // The block was flushed while the ICache looked it up
+    }
+
+    void Fetch::setStallCause_(const StallCause cause, const uint64_t cycle)
+    {
+        if (cycle > stall_start_cycle_)
+        {
+            const uint64_t stall_cycles = cycle - stall_start_cycle_;
+            switch (stall_cause_)
+            {
+            case StallCause::ICACHE:
+                stall_icache_cycles_ += stall_cycles;
+                break;
+            case StallCause::FTQ_EMPTY:
+                stall_ftq_empty_cycles_ += stall_cycles;
+                break;
+            case StallCause::DECODE_FULL:
+                stall_decode_full_cycles_ += stall_cycles;
+                break;
+            case StallCause::NONE:
+                break;
+            }
+        }
+        stall_cause_ = cause;
+        stall_start_cycle_ = cycle;
+    }
+
+    InstPtr Fetch::getNextInst_()
+    {
+        // Instructions flushed and still in the window are rebuilt
+        // from their records
+        if (replay_next_ < replay_window_.size())
+        {
+            const ReplayRecord & record = replay_window_[replay_next_++];
+            InstPtr inst = sparta::allocate_sparta_shared_pointer<Inst>(
+                inst_allocator_, record.opcode_info, record.inst_arch_info, my_clk_);
+            inst->setPC(record.pc);
+            inst->setTargetVAddr(record.target_vaddr);
+            inst->setTakenBranch(record.is_taken_branch);
+            inst->setVCSRs(&record.vcsrs);
+            inst->setRewindIterator(record.rewind_iter);
+            inst->setUniqueID(inst_generator_->getNextUniqueID());
+            inst->setProgramID(record.program_id);
+            ++replayed_insts_;
+            return inst;
+        }
+
+        // Sampled simulation: each period starts by functionally
+        // warming past the instructions that are not simulated in
+        // detail.  Keyed on the program ID so that a workload rewind
+        // to before the boundary skips the same instructions again,
+        // but only once for each time the generator reaches it
+        const uint64_t next_program_id = inst_generator_->getNextProgramID();
+        if ((sampling_skip_length_ != 0)
+            && (((next_program_id - 1) % sampling_detail_length_) == 0)
+            && (next_program_id != sampling_skipped_period_start_))
+        {
+            sampling_skipped_period_start_ = next_program_id;
+            sampling_warmed_insts_ +=
+                inst_generator_->skip(sampling_skip_length_, [this](WarmingRecord & record)
+                                      { functional_warmer_->warm(record); });
+        }
+
+        InstPtr inst = inst_generator_->getNextInst(my_clk_);
+        if ((replay_window_size_ != 0) && (nullptr != inst))
+        {
+            if (replay_window_.size() == replay_window_size_)
+            {
+                replay_window_.pop_front();
+            }
+            replay_window_.push_back({inst->getOpCodeInfo(), inst->getInstArchInfo(),
+                                      inst->getRewindState(), *inst->getVCSRs(), inst->getPC(),
+                                      inst->getTargetVAddr(), inst->getProgramID(),
+                                      inst->isTakenBranch()});
+            replay_next_ = replay_window_.size();
+        }
+        return inst;
+    }
+
+    void Fetch::predictBranch_(const InstPtr & inst)
+    {
+        const uint64_t program_id = inst->getProgramID();
+        if (program_id < next_predicted_program_id_)
+        {
+            // Fetched again after a flush
+            const auto it = std::lower_bound(mispredicted_branches_.begin(),
+                                             mispredicted_branches_.end(),
+                                             std::make_pair(program_id, false));
+            if ((it != mispredicted_branches_.end()) && (it->first == program_id))
+            {
+                inst->setMispredicted(it->second);
+            }
+            return;
+        }
+        next_predicted_program_id_ = program_id + 1;
+
+        BranchPredictor::BranchUpdate outcome;
+        outcome.branch.pc = inst->getPC();
+        outcome.branch.is_conditional = inst->isCondBranch();
+        outcome.branch.is_call = inst->isCall();
+        outcome.branch.is_return = inst->isReturn();
+        outcome.branch.is_indirect = inst->isIndirect();
+        // Compressed encodings do not end in 0b11
+        outcome.branch.inst_size = ((inst->getOpCode() & 0x3) == 0x3) ? 4 : 2;
+        outcome.taken = inst->isTakenBranch() || (false == inst->isCondBranch());
+        outcome.target = inst->getTargetVAddr();
+
+        const auto prediction = branch_predictor_->getPrediction(outcome.branch);
+        branch_predictor_->updatePredictor(outcome);
+
+        // Workloads without targets (0) only check the direction
+        const bool direction_wrong = (prediction.taken != outcome.taken);
+        const bool target_wrong = (false == direction_wrong) && outcome.taken
+                                  && (outcome.target != 0) && (prediction.target != outcome.target);
+        if (direction_wrong || target_wrong)
+        {
+            ILOG("Mispredicted " << (target_wrong ? "target of " : "") << inst);
+            inst->setMispredicted(target_wrong);
+            mispredicted_branches_.emplace_back(program_id, target_wrong);
+        }
+    }
+
+    void Fetch::warm(WarmingRecord & record)
+    {
+        if ((false == record.is_branch) || (nullptr == branch_predictor_))
+        {
+            return;
+        }
+        BranchPredictor::BranchUpdate outcome;
+        outcome.branch = BranchPredictor::decodeBranch(record.pc, record.opcode);
+        outcome.taken = record.is_taken_branch || (false == outcome.branch.is_conditional);
+        outcome.target = record.branch_target;
+
+        // Predict first: the RAS and the histories move on prediction
+        branch_predictor_->getPrediction(outcome.branch);
+        branch_predictor_->updatePredictor(outcome);
+    }
+
+    double Fetch::getWarmingCoverage() const
+    {
+        // A perfect predictor has nothing to warm
+        if (nullptr == branch_predictor_)
+        {
+            return 1.0;
+        }
+        const auto state =
+            dynamic_cast<const BranchPredictor::PredictorStateIF*>(branch_predictor_.get());
+        return (nullptr != state) ? state->getBTBCoverage() : 0.0;
+    }
+
+    void Fetch::saveCheckpoint(std::ostream & os)
+    {
+        checkpoint::writeString(os, branch_predictor_type_);
+        if (auto state = dynamic_cast<BranchPredictor::PredictorStateIF*>(branch_predictor_.get());
+            nullptr != state)
+        {
+            state->saveCheckpoint(os);
+        }
+    }
+
+    void Fetch::restoreCheckpoint(std::istream & is)
+    {
+        const std::string saved_type = checkpoint::readString(is);
+        if (saved_type != branch_predictor_type_)
+        {
+            throw sparta::SpartaException("ERROR: Checkpoint has a ")
+                << saved_type << " branch predictor, the model has " << branch_predictor_type_;
+        }
+        if (auto state = dynamic_cast<BranchPredictor::PredictorStateIF*>(branch_predictor_.get());
+            nullptr != state)
+        {
+            state->restoreCheckpoint(is);
+        }
+    }
+
+    bool Fetch::hasInstsToPredict_() const
+    {
+        return (nullptr != next_block_inst_) || (replay_next_ < replay_window_.size())
+               || (false == inst_generator_->isDone());
+    }
+
+    bool Fetch::isDone_() const
+    {
+        return (false == hasInstsToPredict_()) && fetch_target_queue_.empty();
+    }
+
     // Called when decode has room
     void Fetch::receiveFetchQueueCredits_(const uint32_t & dat)
     {
@@ -111,6 +678,18 @@ namespace olympia
         fetch_inst_event_->schedule(sparta::Clock::Cycle(0));
     }
 
+    // Retired instructions can no longer be flushed, so they leave
+    // the replay window.  They were all fetched, so they are all
+    // before replay_next_
+    void Fetch::releaseRetired_(const InstPtr & inst)
+    {
+        while ((replay_next_ > 0) && (replay_window_.front().program_id <= inst->getProgramID()))
+        {
+            replay_window_.pop_front();
+            --replay_next_;
+        }
+    }
+
     // Called from FlushManager via in_fetch_flush_redirect_port
     void Fetch::flushFetch_(const FlushManager::FlushingCriteria & criteria)
     {
@@ -118,19 +697,79 @@ namespace olympia
 
         auto flush_inst = criteria.getInstPtr();
 
-        // Rewind the tracefile
-        if (criteria.isInclusiveFlush())
+        // Replay from the window if it still holds the first
+        // instruction to refetch.  The window always ends with the
+        // last instruction taken from the generator, so the generator
+        // itself does not need to move
+        const uint64_t refetch_program_id =
+            flush_inst->getProgramID() + (criteria.isInclusiveFlush() ? 0 : 1);
+
+        // Nothing older is fetched again
+        while ((false == mispredicted_branches_.empty())
+               && (mispredicted_branches_.front().first < refetch_program_id))
         {
-            inst_generator_->reset(flush_inst, false); // Replay this instruction
+            mispredicted_branches_.pop_front();
+        }
+        if ((false == replay_window_.empty())
+            && (refetch_program_id >= replay_window_.front().program_id)
+            && (refetch_program_id <= (replay_window_.back().program_id + 1)))
+        {
+            ++replay_window_hits_;
+            replay_next_ = refetch_program_id - replay_window_.front().program_id;
         }
         else
         {
-            inst_generator_->reset(flush_inst, true); // Skip to next instruction
+            ++replay_window_misses_;
+            replay_window_.clear();
+            replay_next_ = 0;
+
+            // The generator goes back to just before (inclusive) or
+            // after the flushing instruction, which is past the skip
+            // of that instruction's period only
+            if (sampling_skip_length_ != 0)
+            {
+                sampling_skipped_period_start_ =
+                    ((flush_inst->getProgramID() - 1) / sampling_detail_length_)
+                        * sampling_detail_length_ + 1;
+            }
+
+            // Rewind the tracefile
+            if (criteria.isInclusiveFlush())
+            {
+                inst_generator_->reset(flush_inst, false); // Replay this instruction
+            }
+            else
+            {
+                inst_generator_->reset(flush_inst, true); // Skip to next instruction
+            }
         }
 
         // Cancel all previously sent instructions on the outport
         out_fetch_queue_write_.cancel();
 
+        // Predicted fetch blocks were all younger than the flush.
+        // ICache lookups already sent still complete, and are ignored
+        if (fetch_from_icache_)
+        {
+            if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+            {
+                for (const auto & inst : ftq_insts_)
+                {
+                    event_log_->record(PipelineEventType::FLUSH, inst);
+                }
+                if (nullptr != next_block_inst_)
+                {
+                    event_log_->record(PipelineEventType::FLUSH, next_block_inst_);
+                }
+            }
+            fetch_target_queue_.clear();
+            ftq_insts_.clear();
+            next_block_inst_ = nullptr;
+            last_prefetch_line_ = ~0ull;
+            setStallCause_(StallCause::FTQ_EMPTY, getClock()->currentCycle());
+            fetch_inst_event_->schedule(1);
+        }
+
         // No longer speculative
         // speculative_path_ = false;
     }
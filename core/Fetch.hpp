@@ -8,17 +8,27 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <utility>
 #include "sparta/ports/DataPort.hpp"
 #include "sparta/events/SingleCycleUniqueEvent.hpp"
 #include "sparta/collection/Collectable.hpp"
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
 
 #include "CoreTypes.hpp"
 #include "InstGroup.hpp"
 #include "FlushManager.hpp"
+#include "BranchPred.hpp"
+#include "Checkpoint.hpp"
+#include "FunctionalWarming.hpp"
+#include "MemoryAccessInfo.hpp"
+#include "PipelineEventLog.hpp"
+#include "RingQueue.hpp"
 
 namespace olympia
 {
@@ -34,7 +44,7 @@ namespace olympia
      * required to release fetch from holding out on branch
      * resolution.
      */
-    class Fetch : public sparta::Unit
+    class Fetch : public sparta::Unit, public FunctionalWarmingIF, public CheckpointableIF
     {
     public:
         //! \brief Parameters for Fetch model
@@ -52,10 +62,63 @@ namespace olympia
                 };
                 num_to_fetch.addDependentValidationCallback(non_zero_validator,
                                                             "Num to fetch must be greater than 0");
+                num_to_fetch.addDependentValidationCallback(InstGroup::fitsWidth,
+                                                            "Num to fetch must fit in an InstGroup "
+                                                            "(InstGroup::MAX_WIDTH)");
             }
 
             PARAMETER(uint32_t, num_to_fetch,          4, "Number of instructions to fetch")
             PARAMETER(bool,     skip_nonuser_mode, false, "For STF traces, skip system instructions if present")
+            PARAMETER(uint32_t, async_trace_ring_size, 0,
+                      "For STF traces, number of trace records read ahead on a background "
+                      "thread (power of 2).  0 reads the trace on the simulation thread")
+            PARAMETER(uint32_t, replay_window_size, 0,
+                      "Number of fetched, not yet retired instructions kept to be rebuilt "
+                      "after a flush without rewinding the workload.  Instructions leave the "
+                      "window when they retire.  A window as deep as the ROB plus the "
+                      "front-end queues replays every flush.  0 always rewinds the workload")
+            PARAMETER(uint32_t, async_trace_rewind_window, 1024,
+                      "For asynchronous STF reads, number of already-fetched trace records kept "
+                      "in the ring for flush rewinds.  Must be smaller than async_trace_ring_size")
+            PARAMETER(std::string, branch_predictor, "perfect",
+                      "Branch predictor: perfect, simple, bimodal, gshare or tage_sc_l")
+            PARAMETER(uint32_t, bpred_pht_bits, 12,
+                      "log2 of the number of direction counters (bimodal, gshare, tage_sc_l base)")
+            PARAMETER(uint32_t, bpred_btb_bits, 10, "log2 of the number of BTB entries")
+            PARAMETER(uint32_t, bpred_history_bits, 12, "Global history length (gshare)")
+            PARAMETER(uint32_t, tage_num_tables, 8, "Number of TAGE tagged tables (tage_sc_l)")
+            PARAMETER(uint32_t, tage_table_bits, 10,
+                      "log2 of the number of entries per TAGE tagged table (tage_sc_l)")
+            PARAMETER(uint32_t, tage_tag_bits, 11, "TAGE tag width in bits (tage_sc_l)")
+            PARAMETER(uint32_t, tage_min_history, 4,
+                      "History length of the shortest TAGE table (tage_sc_l)")
+            PARAMETER(uint32_t, tage_max_history, 640,
+                      "History length of the longest TAGE table (tage_sc_l)")
+            PARAMETER(uint32_t, sc_table_bits, 10,
+                      "log2 of the number of entries per statistical corrector table (tage_sc_l)")
+            PARAMETER(uint32_t, loop_set_bits, 4,
+                      "log2 of the number of 4-way loop predictor sets (tage_sc_l)")
+            PARAMETER(uint32_t, ras_entries, 16,
+                      "Return address stack entries (power of 2).  0 predicts returns "
+                      "with the BTB")
+            PARAMETER(uint32_t, ittage_num_tables, 5,
+                      "Number of ITTAGE tagged tables for indirect jump targets.  0 predicts "
+                      "them with the BTB")
+            PARAMETER(uint32_t, ittage_table_bits, 9,
+                      "log2 of the number of entries per ITTAGE tagged table")
+            PARAMETER(bool, fetch_from_icache, false,
+                      "Decouple branch prediction from fetch: predicted fetch blocks wait in "
+                      "a fetch target queue and are read through the ICache.  false fetches "
+                      "straight from the workload, with no instruction-side latency")
+            PARAMETER(uint32_t, ftq_size, 16,
+                      "Fetch target queue entries, in fetch blocks (fetch_from_icache)")
+            PARAMETER(uint32_t, icache_requests, 2,
+                      "ICache lookups fetch keeps in flight for the oldest fetch blocks "
+                      "(fetch_from_icache)")
+            PARAMETER(uint32_t, fdip_lookahead, 0,
+                      "Fetch-directed instruction prefetching: number of fetch blocks past "
+                      "the ones being looked up whose lines are prefetched into the ICache.  "
+                      "0 turns prefetching off (fetch_from_icache)")
         };
 
         /**
@@ -72,6 +135,19 @@ namespace olympia
         //! \brief Name of this resource. Required by sparta::UnitFactory
         static const char * name;
 
+        //! Train the branch predictor with a skipped branch, as if it
+        //! had been predicted and resolved
+        void warm(WarmingRecord & record) override;
+
+        //! The branch predictor's BTB coverage
+        double getWarmingCoverage() const override;
+
+        //! Checkpoint the branch predictor's tables and histories.
+        //! The "simple" predictor keeps no fixed tables and is not
+        //! saved: it starts cold
+        void saveCheckpoint(std::ostream & os) override;
+        void restoreCheckpoint(std::istream & is) override;
+
     private:
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -88,6 +164,20 @@ namespace olympia
         sparta::DataInPort<FlushManager::FlushingCriteria> in_fetch_flush_redirect_
             {&unit_port_set_, "in_fetch_flush_redirect", sparta::SchedulingPhase::Flush, 1};
 
+        // Retired instructions, released from the replay window
+        sparta::DataInPort<InstPtr> in_fetch_retire_ack_
+            {&unit_port_set_, "in_fetch_retire_ack", 1};
+
+        // Fetch block lookups to the ICache, and the ICache's answers
+        sparta::DataOutPort<MemoryAccessInfoPtr> out_icache_req_
+            {&unit_port_set_, "out_icache_req", 0};
+        sparta::DataInPort<MemoryAccessInfoPtr> in_icache_resp_
+            {&unit_port_set_, "in_icache_resp", 1};
+
+        // Prefetches for the lines of fetch blocks further down the FTQ
+        sparta::DataOutPort<MemoryAccessInfoPtr> out_icache_prefetch_req_
+            {&unit_port_set_, "out_icache_prefetch_req", 0};
+
         ////////////////////////////////////////////////////////////////////////////////
         // Instruction fetch
         // Number of instructions to fetch
@@ -96,6 +186,10 @@ namespace olympia
         // For traces with system instructions, skip them
         const bool skip_nonuser_mode_;
 
+        // Background STF reader configuration (0 == synchronous reads)
+        const uint32_t async_trace_ring_size_;
+        const uint32_t async_trace_rewind_window_;
+
         // Number of credits from decode that fetch has
         uint32_t credits_inst_queue_ = 0;
 
@@ -105,6 +199,115 @@ namespace olympia
         // Instruction generation
         std::unique_ptr<InstGenerator> inst_generator_;
 
+        // Units warmed during fast-forward (if functional warming is on)
+        // and between sampled intervals
+        std::unique_ptr<FunctionalWarmer> functional_warmer_;
+
+        // Sampled simulation: every sampling_detail_length_ detailed
+        // instructions, skip sampling_skip_length_ instructions with
+        // functional warming
+        uint64_t sampling_detail_length_ = 0;
+        uint64_t sampling_skip_length_ = 0;
+
+        // Program ID of the first detailed instruction of the period
+        // whose skip the generator is past.  A rewind to that
+        // instruction or later must not skip again
+        uint64_t sampling_skipped_period_start_ = 0;
+
+        // A fetched instruction's workload information.  Enough to
+        // rebuild it after a flush without going back to the workload
+        // or to Mavis
+        struct ReplayRecord
+        {
+            mavis::OpcodeInfo::PtrType opcode_info;
+            InstArchInfo::PtrType      inst_arch_info;
+            Inst::RewindIterator       rewind_iter;
+            Inst::VCSRs                vcsrs;
+            sparta::memory::addr_t     pc = 0;
+            sparta::memory::addr_t     target_vaddr = 0;
+            uint64_t                   program_id = 0;
+            bool                       is_taken_branch = false;
+        };
+
+        // The instructions taken from the generator and not retired
+        // yet, in program order, up to replay_window_size_ of the
+        // youngest.  Records from replay_next_ on were flushed and are
+        // fetched again before the generator is used
+        const uint32_t replay_window_size_;
+        RingQueue<ReplayRecord> replay_window_;
+        size_t replay_next_ = 0;
+
+        // Allocator for rebuilt instructions
+        InstAllocator & inst_allocator_;
+
+        // Allocator for ICache requests
+        MemoryAccessInfoAllocator & memory_access_allocator_;
+
+        // Where fetched instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
+        // Branch prediction.  No predictor predicts perfectly.  Each
+        // dynamic branch is predicted, and the predictor trained with
+        // its outcome from the workload, only the first time it is
+        // fetched; branches fetched again after a flush keep that
+        // prediction's outcome
+        const std::string branch_predictor_type_;
+        std::unique_ptr<BranchPredictor::FetchBranchPredictorIF> branch_predictor_;
+        uint64_t next_predicted_program_id_ = 0;
+
+        // Mispredicted branches that may be fetched again: program ID
+        // and whether only the target was wrong.  In program order
+        RingQueue<std::pair<uint64_t, bool>> mispredicted_branches_;
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Decoupled front end (fetch_from_icache)
+        //
+        // Each cycle the predictor walks ahead of fetch and queues one
+        // fetch block: the instructions of one ICache line, up to the
+        // first predicted-taken branch, at most num_to_fetch of them.
+        // The oldest blocks are looked up in the ICache, and blocks
+        // are sent to decode in order once their line arrives
+        const bool fetch_from_icache_;
+        const uint32_t ftq_size_;
+        const uint32_t icache_requests_;
+        uint64_t icache_line_mask_ = 0;
+
+        struct FetchBlock
+        {
+            uint64_t line_addr = 0;
+            uint32_t num_insts = 0;          // Left to send to decode
+            MemoryAccessInfoPtr icache_req;  // nullptr until looked up
+            bool ready = false;              // Line arrived
+            bool prefetched = false;         // Considered by the prefetcher
+        };
+
+        // Fetch-directed instruction prefetching: each cycle, the
+        // oldest block within fdip_lookahead_ blocks of the first one
+        // not looked up has its line prefetched.  Consecutive blocks
+        // in one line are prefetched once
+        const uint32_t fdip_lookahead_;
+        uint64_t last_prefetch_line_ = ~0ull;
+
+        // Fetch target queue, and the instructions of its blocks in
+        // program order
+        RingQueue<FetchBlock> fetch_target_queue_;
+        RingQueue<InstPtr> ftq_insts_;
+
+        // First instruction of the next fetch block, taken from the
+        // workload but not queued yet
+        InstPtr next_block_inst_;
+
+        // Why decode got nothing from fetch, from stall_start_cycle_ on
+        enum class StallCause
+        {
+            NONE,
+            ICACHE,      // Head fetch block waiting on the ICache
+            FTQ_EMPTY,   // Predictor has not queued a block (redirect)
+            DECODE_FULL  // No decode credits
+        };
+        StallCause stall_cause_ = StallCause::NONE;
+        uint64_t stall_start_cycle_ = 0;
+
         // Fetch instruction event, triggered when there are credits
         // from decode.  The callback set is either to fetch random
         // instructions or a perfect IPC set
@@ -122,14 +325,114 @@ namespace olympia
         // Read data from a trace
         void fetchInstruction_();
 
+        // One cycle of the decoupled front end
+        void fetchFromICache_();
+
+        // Predict the next fetch block and queue it in the FTQ
+        void queueFetchBlock_();
+
+        // Prefetch the line of a fetch block ahead of the lookups.
+        // Returns true if more blocks are waiting to be prefetched
+        bool prefetchFetchBlock_();
+
+        // The ICache has the line of a fetch block
+        void receiveICacheResp_(const MemoryAccessInfoPtr &);
+
+        // Account the stall that ends at cycle and start a new one
+        void setStallCause_(StallCause cause, uint64_t cycle);
+
+        // Are there instructions left to predict?
+        bool hasInstsToPredict_() const;
+
+        // Next instruction, from the replay window or the generator
+        InstPtr getNextInst_();
+
+        // Are there instructions left to fetch?
+        bool isDone_() const;
+
         // Receive flush from FlushManager
         void flushFetch_(const FlushManager::FlushingCriteria &);
 
+        // Release a retired instruction from the replay window
+        void releaseRetired_(const InstPtr &);
+
+        // Predict a fetched branch and mark it if mispredicted
+        void predictBranch_(const InstPtr &);
+
         // Recieve vset instruction and set waiting_on_vset_ flag
         void process_vset_(const InstPtr &);
 
+        // Report the warm-up coverage at the end of simulation
+        void onStartingTeardown_() override;
+
         // Are we fetching a speculative path?
         bool speculative_path_ = false;
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Counters
+
+        // Flushes served from the replay window vs. from a workload rewind
+        sparta::Counter replay_window_hits_{
+            getStatisticSet(), "replay_window_hits",
+            "Number of flushes recovered from the fetch replay window",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter replay_window_misses_{
+            getStatisticSet(), "replay_window_misses",
+            "Number of flushes that rewound the workload",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::StatisticDef replay_window_hit_rate_{
+            getStatisticSet(), "replay_window_hit_rate",
+            "Fraction of flushes recovered from the fetch replay window", getStatisticSet(),
+            "replay_window_hits/(replay_window_hits+replay_window_misses)"};
+
+        // Instructions functionally warmed between sampled intervals
+        sparta::Counter sampling_warmed_insts_{
+            getStatisticSet(), "sampling_warmed_insts",
+            "Number of instructions functionally warmed between sampled intervals",
+            sparta::Counter::COUNT_NORMAL};
+
+        // Instructions rebuilt from the replay window
+        sparta::Counter replayed_insts_{
+            getStatisticSet(), "replayed_insts",
+            "Number of instructions fetched again from the replay window",
+            sparta::Counter::COUNT_NORMAL};
+
+        // Front-end stalls by cause (fetch_from_icache)
+        sparta::Counter ftq_blocks_{
+            getStatisticSet(), "ftq_blocks",
+            "Number of fetch blocks the predictor queued in the fetch target queue",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter fdip_prefetches_{
+            getStatisticSet(), "fdip_prefetches",
+            "Number of ICache prefetches sent for fetch blocks in the fetch target queue",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter stall_icache_cycles_{
+            getStatisticSet(), "stall_icache_cycles",
+            "Cycles decode got nothing because the oldest fetch block waited on the ICache",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter stall_ftq_empty_cycles_{
+            getStatisticSet(), "stall_ftq_empty_cycles",
+            "Cycles decode got nothing because the fetch target queue was empty",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter stall_decode_full_cycles_{
+            getStatisticSet(), "stall_decode_full_cycles",
+            "Cycles a ready fetch block waited for decode credits",
+            sparta::Counter::COUNT_NORMAL};
+
+        // Times the background trace reader found the prefetch ring full
+        sparta::Counter trace_producer_stalls_{
+            getStatisticSet(), "trace_producer_stalls",
+            "Number of times the background STF reader waited on a full prefetch ring",
+            sparta::Counter::COUNT_LATEST};
+
+        // Times fetch waited on the background trace reader
+        sparta::Counter trace_consumer_stalls_{
+            getStatisticSet(), "trace_consumer_stalls",
+            "Number of times fetch waited on the background STF reader",
+            sparta::Counter::COUNT_LATEST};
+
+        friend class FetchTester;
     };
+    class FetchTester;
 
 }
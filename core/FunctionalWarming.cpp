@@ -0,0 +1,52 @@
+// <FunctionalWarming.cpp> -*- C++ -*-
+
+//!
+//! \file FunctionalWarming.cpp
+//! \brief Warm functional state (tags, TLB, predictors) from skipped instructions
+//!
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "FunctionalWarming.hpp"
+
+#include "sparta/simulation/ResourceTreeNode.hpp"
+
+namespace olympia
+{
+    FunctionalWarmer::FunctionalWarmer(sparta::TreeNode* node)
+    {
+        findUnits_(node);
+        std::stable_sort(units_.begin(), units_.end(),
+                         [](const auto & lhs, const auto & rhs)
+                         { return lhs.second->getWarmingLevel() < rhs.second->getWarmingLevel(); });
+    }
+
+    void FunctionalWarmer::findUnits_(sparta::TreeNode* node)
+    {
+        if (auto rtn = dynamic_cast<sparta::ResourceTreeNode*>(node); rtn != nullptr)
+        {
+            if (auto unit = dynamic_cast<FunctionalWarmingIF*>(rtn->getResource()); unit != nullptr)
+            {
+                units_.emplace_back(node, unit);
+            }
+        }
+        for (auto child : node->getChildren())
+        {
+            findUnits_(child);
+        }
+    }
+
+    void FunctionalWarmer::reportCoverage(std::ostream & os, const std::string & when) const
+    {
+        for (const auto & unit : units_)
+        {
+            std::ostringstream coverage;
+            coverage << std::fixed << std::setprecision(1)
+                     << (unit.second->getWarmingCoverage() * 100.0);
+            os << "olympia: warm-up coverage " << when << ": " << unit.first->getLocation() << " "
+               << coverage.str() << "% valid" << std::endl;
+        }
+    }
+} // namespace olympia
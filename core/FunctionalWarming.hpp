@@ -0,0 +1,95 @@
+// <FunctionalWarming.hpp> -*- C++ -*-
+
+//!
+//! \file FunctionalWarming.hpp
+//! \brief Warm functional state (tags, TLB, predictors) from skipped instructions
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "sparta/simulation/TreeNode.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief What a skipped instruction tells the functional models
+     */
+    struct WarmingRecord
+    {
+        uint64_t pc = 0;
+        uint64_t opcode = 0;
+        uint64_t mem_vaddr = 0;     //!< Valid if is_mem_access
+        uint64_t branch_target = 0; //!< Valid if is_branch
+        bool is_mem_access = false;
+        bool is_branch = false;
+        bool is_taken_branch = false;
+
+        //! Set by the DL1 for the levels behind it
+        bool dl1_miss = false;
+
+        //! Same faked translation as Inst::getRAdr
+        uint64_t getPhyAddr() const { return mem_vaddr | 0x8000000; }
+    };
+
+    /*!
+     * \class FunctionalWarmingIF
+     * \brief A unit whose functional state can be updated directly
+     *        from skipped instructions, without scheduling any events
+     *        or counting statistics
+     */
+    class FunctionalWarmingIF
+    {
+      public:
+        //! Units are warmed in ascending level order, so that a level
+        //! can see the outcome of the ones in front of it
+        enum class WarmingLevel
+        {
+            L1, // Branch predictors, TLB, L1 caches
+            L2
+        };
+
+        virtual ~FunctionalWarmingIF() = default;
+
+        virtual WarmingLevel getWarmingLevel() const { return WarmingLevel::L1; }
+
+        //! Update functional state with a skipped instruction
+        virtual void warm(WarmingRecord & record) = 0;
+
+        //! Fraction of valid entries, [0, 1]
+        virtual double getWarmingCoverage() const = 0;
+    };
+
+    /*!
+     * \class FunctionalWarmer
+     * \brief Finds every FunctionalWarmingIF unit under a node and
+     *        feeds them skipped instructions
+     */
+    class FunctionalWarmer
+    {
+      public:
+        explicit FunctionalWarmer(sparta::TreeNode* node);
+
+        void warm(WarmingRecord & record)
+        {
+            for (auto & unit : units_)
+            {
+                unit.second->warm(record);
+            }
+        }
+
+        bool empty() const { return units_.empty(); }
+
+        //! Print the coverage of every warmed unit, tagged with when
+        void reportCoverage(std::ostream & os, const std::string & when) const;
+
+      private:
+        void findUnits_(sparta::TreeNode* node);
+
+        std::vector<std::pair<sparta::TreeNode*, FunctionalWarmingIF*>> units_;
+    };
+} // namespace olympia
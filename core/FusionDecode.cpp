@@ -102,91 +102,20 @@ namespace olympia
     }
 
     // ----------------------------------------------------------------------
-    // TODO: this performs well for the FusionGroup set sizes tested, ~256.
-    // More testing is intended for 2048 (10x any practical size).
-    // Further improvement is deferred until a decsion on uop/trace cache
-    // implementations. Regardless, if warranted for model performance,
-    // an abstracted uop$ can be built using what is below adding the more
-    // conventional address indexing but retaining the UIDs as abstractions
-    // to fully decoded instrs.
+    // One pass of the automaton built from the fusion groups finds every
+    // group in the input: no per-group work, so thousands of groups cost
+    // about what a few do.
     // ----------------------------------------------------------------------
-    void Decode::matchFusionGroups_(MatchInfoListType & matches, InstGroupPtr & insts,
-                                    InstUidListType & inputUids,
-                                    FusionGroupContainerType & fusionGroups)
+    void Decode::matchFusionGroups_(MatchInfoListType & matches, InstUidListType & inputUids)
     {
         matches.clear(); // Clear any existing matches
 
-        // The cache is a map of cachelines, indexed by size,
-        //          <size, list of <index,hash>
-        //
-        //   3   1:hash  2:hash 3:hash  ... modulo size, inputUids.size() % 3
-        hcache_.clear();
-
-        for (auto & fgPair : fusionGroups)
+        fusion_matcher_matches_.clear();
+        fusion_matcher_.match(inputUids, fusion_matcher_matches_);
+        for (const auto & match : fusion_matcher_matches_)
         {
-            auto & fGrp = fgPair.second;
-            size_t grpSize = fGrp.uids().size();
-            hcache_.buildHashCacheEntry(inputUids, grpSize);
-        }
-
-        for (auto & fgPair : fusionGroups)
-        {
-
-            HashType grpHash = fgPair.first;
-            auto & fGrp = fgPair.second;
-            size_t grpSize = fGrp.uids().size();
-
-            // No match possible if the fg is bigger than the input
-            if (grpSize > inputUids.size())
-            {
-                /*++filtered;*/ continue;
-            }
-
-            // If the grpSize is not in the hash cache we need to calculate it
-            if (hcache_.find(grpSize) == hcache_.end())
-            {
-                hcache_.buildHashCacheEntry(inputUids, grpSize);
-            }
-
-            // If this fires something unexplained happened, the entry hit
-            // in the first place or it was constructed on a miss,
-            // either way this should never fire.
-            sparta_assert(hcache_.find(grpSize) != hcache_.end())
-
-                // pairs is from the cache entries with the same size as fGrp.
-                // a pair is <index,hash>, index is the position in the input
-                HashPairListType pairs = hcache_[grpSize];
-
-            // For each of the pairs that have the same size as fGrp.
-            for (auto & ep : pairs)
-            {
-                // if the pair.hash matches the group's hash
-                if (ep.second == grpHash)
-                {
-
-                    // DLOG("HASH HIT, index "<<dec<<ep.first<<" hash 0x"<<setw(8)
-                    //                        <<hex<<setfill('0')<<grpHash);
-                    size_t startIdx = ep.first;
-                    bool match = true;
-                    size_t j = 0;
-
-                    for (size_t i = startIdx; i < grpSize; ++i)
-                    {
-                        if (inputUids[i] != fGrp.uids()[j])
-                        {
-                            match = false;
-                            break;
-                        }
-                        ++j;
-                    }
-
-                    if (match)
-                    {
-                        matches.emplace_back(fGrp.name(), startIdx, 0, fGrp.uids());
-                        // DLOG("SEQ MATCH "<<fGrp.name()<<" "<<dec<<grpSize);
-                    }
-                }
-            }
+            const FusionGroupType & fGrp = *fusion_matcher_groups_[match.pattern];
+            matches.emplace_back(fGrp.name(), match.start, 0, fGrp.uids());
         }
 
         // FIXME: make this an assignable function object
@@ -0,0 +1,151 @@
+// <FusionMatcher.cpp> -*- C++ -*-
+
+#include "FusionMatcher.hpp"
+
+#include <algorithm>
+#include <deque>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    FusionMatcher::FusionMatcher() : trie_(1) {}
+
+    uint32_t FusionMatcher::addPattern(const std::vector<UidType> & uids)
+    {
+        sparta_assert(!compiled_, "FusionMatcher: patterns must be added before compile()");
+        sparta_assert(!uids.empty(), "FusionMatcher: empty pattern");
+
+        uint32_t state = 0;
+        for (const UidType uid : uids)
+        {
+            const auto child = trie_[state].children.find(uid);
+            if (child != trie_[state].children.end())
+            {
+                state = child->second;
+                continue;
+            }
+            const uint32_t next = static_cast<uint32_t>(trie_.size());
+            // emplace_back may reallocate trie_: index it again after
+            trie_.emplace_back();
+            trie_[state].children.emplace(uid, next);
+            state = next;
+        }
+
+        const uint32_t pattern = static_cast<uint32_t>(pattern_lengths_.size());
+        pattern_lengths_.emplace_back(static_cast<uint32_t>(uids.size()));
+        trie_[state].patterns.emplace_back(pattern);
+        return pattern;
+    }
+
+    void FusionMatcher::compile()
+    {
+        sparta_assert(!compiled_, "FusionMatcher: compile() called twice");
+        compiled_ = true;
+
+        const uint32_t num_states = static_cast<uint32_t>(trie_.size());
+
+        // Flatten the transitions: std::map keeps each run sorted
+        transition_begin_.reserve(num_states + 1);
+        for (const auto & node : trie_)
+        {
+            transition_begin_.emplace_back(static_cast<uint32_t>(transition_uids_.size()));
+            for (const auto & child : node.children)
+            {
+                transition_uids_.emplace_back(child.first);
+                transition_states_.emplace_back(child.second);
+            }
+        }
+        transition_begin_.emplace_back(static_cast<uint32_t>(transition_uids_.size()));
+
+        // Failure links, breadth first: a state's link is found from its
+        // parent's, which is shallower
+        fail_.assign(num_states, 0);
+        std::vector<uint32_t> order;
+        order.reserve(num_states);
+        std::deque<uint32_t> queue{0};
+        while (!queue.empty())
+        {
+            const uint32_t state = queue.front();
+            queue.pop_front();
+            order.emplace_back(state);
+            for (const auto & child : trie_[state].children)
+            {
+                uint32_t link = 0;
+                if (state != 0)
+                {
+                    uint32_t candidate = fail_[state];
+                    int64_t next = findTransition_(candidate, child.first);
+                    while ((next < 0) && (candidate != 0))
+                    {
+                        candidate = fail_[candidate];
+                        next = findTransition_(candidate, child.first);
+                    }
+                    link = (next < 0) ? 0 : static_cast<uint32_t>(next);
+                }
+                fail_[child.second] = link;
+                queue.emplace_back(child.second);
+            }
+        }
+
+        // Outputs: a state's own patterns, then its failure link's,
+        // which are complete since the link is shallower
+        std::vector<std::vector<uint32_t>> outputs(num_states);
+        for (const uint32_t state : order)
+        {
+            outputs[state] = trie_[state].patterns;
+            if (state != 0)
+            {
+                const auto & inherited = outputs[fail_[state]];
+                outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+            }
+        }
+        output_begin_.reserve(num_states + 1);
+        for (const auto & state_outputs : outputs)
+        {
+            output_begin_.emplace_back(static_cast<uint32_t>(outputs_.size()));
+            outputs_.insert(outputs_.end(), state_outputs.begin(), state_outputs.end());
+        }
+        output_begin_.emplace_back(static_cast<uint32_t>(outputs_.size()));
+
+        // The trie is not needed any more
+        std::vector<TrieNode>().swap(trie_);
+    }
+
+    int64_t FusionMatcher::findTransition_(uint32_t state, UidType uid) const
+    {
+        const auto begin = transition_uids_.begin() + transition_begin_[state];
+        const auto end = transition_uids_.begin() + transition_begin_[state + 1];
+        const auto it = std::lower_bound(begin, end, uid);
+        if ((it == end) || (*it != uid))
+        {
+            return -1;
+        }
+        return transition_states_[it - transition_uids_.begin()];
+    }
+
+    void FusionMatcher::match(const std::vector<UidType> & input,
+                              std::vector<Match> & matches) const
+    {
+        sparta_assert(compiled_, "FusionMatcher: match() before compile()");
+
+        uint32_t state = 0;
+        for (uint32_t i = 0; i < input.size(); ++i)
+        {
+            int64_t next = findTransition_(state, input[i]);
+            while ((next < 0) && (state != 0))
+            {
+                state = fail_[state];
+                next = findTransition_(state, input[i]);
+            }
+            state = (next < 0) ? 0 : static_cast<uint32_t>(next);
+
+            for (uint32_t out = output_begin_[state]; out < output_begin_[state + 1]; ++out)
+            {
+                const uint32_t pattern = outputs_[out];
+                matches.push_back({pattern, i + 1 - pattern_lengths_[pattern]});
+            }
+        }
+    }
+
+} // namespace olympia
@@ -0,0 +1,92 @@
+// <FusionMatcher.hpp> -*- C++ -*-
+
+//!
+//! \file FusionMatcher.hpp
+//! \brief Aho-Corasick automaton over Mavis UIDs for fusion group matching
+//!
+
+/*
+ * Decode looks for every fusion group (a sequence of Mavis UIDs) in
+ * the UIDs of each decode group.  The fusion groups are compiled once,
+ * at startup, into an Aho-Corasick automaton: a trie of the groups
+ * with failure links, each state listing the groups that end there.
+ * One pass over the decode group then finds every occurrence of every
+ * fusion group, at a cost that follows the decode group's length and
+ * the number of matches, not the number of fusion groups.
+ *
+ * Mavis UIDs are sparse and there can be thousands, so the transitions
+ * of a state are a sorted run in one flat array, searched with a
+ * binary search.
+ * */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace olympia
+{
+    class FusionMatcher
+    {
+      public:
+        //! A Mavis instruction UID
+        using UidType = uint32_t;
+
+        //! An occurrence of a pattern in the input
+        struct Match
+        {
+            uint32_t pattern = 0; // Id addPattern returned
+            uint32_t start = 0;   // Index of its first UID in the input
+        };
+
+        FusionMatcher();
+
+        //! Add a pattern before compile().  Returns its id: patterns are
+        //! numbered from 0 in the order they are added
+        uint32_t addPattern(const std::vector<UidType> & uids);
+
+        //! Build the automaton.  No pattern can be added after
+        void compile();
+
+        //! Append every occurrence of every pattern in input to matches,
+        //! ordered by the index of their last UID
+        void match(const std::vector<UidType> & input, std::vector<Match> & matches) const;
+
+        uint32_t getNumPatterns() const { return static_cast<uint32_t>(pattern_lengths_.size()); }
+
+        uint32_t getPatternLength(uint32_t pattern) const { return pattern_lengths_[pattern]; }
+
+        //! States in the automaton, root included
+        uint32_t getNumStates() const { return static_cast<uint32_t>(fail_.size()); }
+
+      private:
+        //! The state reached from state on uid, or -1
+        int64_t findTransition_(uint32_t state, UidType uid) const;
+
+        //! The trie while patterns are added
+        struct TrieNode
+        {
+            std::map<UidType, uint32_t> children;
+            std::vector<uint32_t> patterns;
+        };
+        std::vector<TrieNode> trie_;
+        bool compiled_ = false;
+
+        std::vector<uint32_t> pattern_lengths_;
+
+        // Transitions of state s: [transition_begin_[s], transition_begin_[s + 1])
+        // in transition_uids_ (sorted) and transition_states_
+        std::vector<uint32_t> transition_begin_;
+        std::vector<UidType> transition_uids_;
+        std::vector<uint32_t> transition_states_;
+
+        // Longest proper suffix of a state that is also a state
+        std::vector<uint32_t> fail_;
+
+        // Patterns ending at state s, its own and those of its failure
+        // chain: [output_begin_[s], output_begin_[s + 1]) in outputs_
+        std::vector<uint32_t> output_begin_;
+        std::vector<uint32_t> outputs_;
+    };
+
+} // namespace olympia
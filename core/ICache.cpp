@@ -0,0 +1,261 @@
+// <ICache.cpp> -*- C++ -*-
+
+#include "ICache.hpp"
+#include "OlympiaAllocators.hpp"
+
+#include <algorithm>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    const char ICache::name[] = "icache";
+
+    ICache::ICache(sparta::TreeNode* n, const ICacheParameterSet* p) :
+        sparta::Unit(n),
+        l1_always_hit_(p->l1_always_hit),
+        mshrs_(p->mshr_entries),
+        memory_access_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))
+                                     ->getMemoryAccessAllocator())
+    {
+        sparta_assert(p->mshr_entries > 0, "There must be atleast 1 MSHR entry");
+
+        in_fetch_req_.registerConsumerHandler(
+            CREATE_SPARTA_HANDLER_WITH_DATA(ICache, receiveFetchReq_, MemoryAccessInfoPtr));
+
+        in_fetch_prefetch_req_.registerConsumerHandler(
+            CREATE_SPARTA_HANDLER_WITH_DATA(ICache, receivePrefetchReq_, MemoryAccessInfoPtr));
+
+        in_l2cache_ack_.registerConsumerHandler(
+            CREATE_SPARTA_HANDLER_WITH_DATA(ICache, receiveAckFromL2Cache_, uint32_t));
+
+        in_l2cache_resp_.registerConsumerHandler(
+            CREATE_SPARTA_HANDLER_WITH_DATA(ICache, receiveRespFromL2Cache_, MemoryAccessInfoPtr));
+
+        setupL1Cache_(p);
+    }
+
+    void ICache::setupL1Cache_(const ICacheParameterSet* p)
+    { // IL1 cache config
+        const uint32_t l1_line_size = p->l1_line_size;
+        const uint32_t l1_size_kb = p->l1_size_kb;
+        const uint32_t l1_associativity = p->l1_associativity;
+        std::unique_ptr<sparta::cache::ReplacementIF> repl(
+            new sparta::cache::TreePLRUReplacement(l1_associativity));
+        l1_cache_.reset(new CacheFuncModel(getContainer(), l1_size_kb, l1_line_size, *repl));
+        addr_decoder_ = l1_cache_->getAddrDecoder();
+    }
+
+    void ICache::warm(WarmingRecord & record)
+    {
+        if (!l1_always_hit_)
+        {
+            l1_cache_->warmAccess(record.pc);
+        }
+    }
+
+    // Reload cache line
+    void ICache::reloadCache_(uint64_t line_addr, bool prefetched)
+    {
+        auto l1_cache_line = &l1_cache_->getLineForReplacementWithInvalidCheck(line_addr);
+        if (l1_cache_line->isValid() && l1_cache_line->isPrefetched())
+        {
+            il1_prefetches_useless_++;
+        }
+        l1_cache_->allocateWithMRUUpdate(*l1_cache_line, line_addr);
+        l1_cache_line->setPrefetched(prefetched);
+
+        ILOG("ICache reload complete: line=0x" << std::hex << line_addr);
+    }
+
+    bool ICache::lookup_(const MemoryAccessInfoPtr & mem_access_info_ptr)
+    {
+        const uint64_t fetch_addr = mem_access_info_ptr->getPhyAddr();
+
+        bool cache_hit = l1_always_hit_;
+        if (!cache_hit)
+        {
+            auto cache_line = l1_cache_->peekLine(fetch_addr);
+            cache_hit = (cache_line != nullptr) && cache_line->isValid();
+            if (cache_hit)
+            {
+                l1_cache_->touchMRU(*cache_line);
+                if (cache_line->isPrefetched())
+                {
+                    il1_prefetches_useful_++;
+                    cache_line->setPrefetched(false);
+                }
+            }
+        }
+
+        if (cache_hit)
+        {
+            ILOG("IL1 ICache HIT: addr=0x" << std::hex << fetch_addr);
+            il1_cache_hits_++;
+            mem_access_info_ptr->setCacheState(MemoryAccessInfo::CacheState::HIT);
+            mem_access_info_ptr->setDataReady(true);
+            out_fetch_resp_.send(mem_access_info_ptr);
+            return true;
+        }
+
+        // Wait on a line that is already being fetched
+        const uint64_t line_addr = addr_decoder_->calcBlockAddr(fetch_addr);
+        for (auto & mshr : mshrs_)
+        {
+            if (mshr.valid && (mshr.line_addr == line_addr))
+            {
+                ILOG("IL1 ICache MISS on a pending line: addr=0x" << std::hex << fetch_addr);
+                il1_cache_misses_++;
+                il1_mshr_merges_++;
+                if (mshr.prefetch)
+                {
+                    il1_prefetches_late_++;
+                    mshr.prefetch = false;
+                }
+                mem_access_info_ptr->setCacheState(MemoryAccessInfo::CacheState::MISS);
+                mshr.waiting.emplace_back(mem_access_info_ptr);
+                return true;
+            }
+        }
+
+        MissEntry* free_entry = findFreeMSHR_();
+        if (free_entry == nullptr)
+        {
+            return false;
+        }
+
+        ILOG("IL1 ICache MISS: addr=0x" << std::hex << fetch_addr);
+        il1_cache_misses_++;
+        mem_access_info_ptr->setCacheState(MemoryAccessInfo::CacheState::MISS);
+        free_entry->valid = true;
+        free_entry->sent = false;
+        free_entry->prefetch = false;
+        free_entry->line_addr = line_addr;
+        free_entry->waiting.emplace_back(mem_access_info_ptr);
+        uev_send_miss_requests_.schedule(sparta::Clock::Cycle(0));
+        return true;
+    }
+
+    ICache::MissEntry* ICache::findFreeMSHR_()
+    {
+        for (auto & mshr : mshrs_)
+        {
+            if (!mshr.valid)
+            {
+                return &mshr;
+            }
+        }
+        return nullptr;
+    }
+
+    void ICache::receiveFetchReq_(const MemoryAccessInfoPtr & mem_access_info_ptr)
+    {
+        ILOG("Received fetch request " << mem_access_info_ptr);
+
+        // Requests are looked up in order: nothing passes a request
+        // waiting for an MSHR
+        if (!blocked_requests_.empty() || !lookup_(mem_access_info_ptr))
+        {
+            ILOG("No free MSHR, blocking " << mem_access_info_ptr);
+            il1_mshr_full_++;
+            blocked_requests_.emplace_back(mem_access_info_ptr);
+        }
+    }
+
+    void ICache::receivePrefetchReq_(const MemoryAccessInfoPtr & mem_access_info_ptr)
+    {
+        if (l1_always_hit_)
+        {
+            return;
+        }
+
+        const uint64_t line_addr = addr_decoder_->calcBlockAddr(mem_access_info_ptr->getPhyAddr());
+        auto cache_line = l1_cache_->peekLine(line_addr);
+        const bool in_mshr = std::any_of(mshrs_.begin(), mshrs_.end(),
+                                         [line_addr](const MissEntry & mshr)
+                                         { return mshr.valid && (mshr.line_addr == line_addr); });
+        if (((cache_line != nullptr) && cache_line->isValid()) || in_mshr)
+        {
+            il1_prefetches_filtered_++;
+            return;
+        }
+
+        // Keep the last free MSHR for a demand miss
+        const auto free_mshrs = std::count_if(mshrs_.begin(), mshrs_.end(),
+                                              [](const MissEntry & mshr) { return !mshr.valid; });
+        if (free_mshrs < 2)
+        {
+            il1_prefetches_dropped_++;
+            return;
+        }
+
+        ILOG("IL1 prefetch: line=0x" << std::hex << line_addr);
+        MissEntry* entry = findFreeMSHR_();
+        entry->valid = true;
+        entry->sent = false;
+        entry->prefetch = true;
+        entry->line_addr = line_addr;
+        il1_prefetches_issued_++;
+        uev_send_miss_requests_.schedule(sparta::Clock::Cycle(0));
+    }
+
+    void ICache::sendMissRequests_()
+    {
+        for (auto & mshr : mshrs_)
+        {
+            if (l2cache_credits_ == 0)
+            {
+                // Resumed by the next ack
+                return;
+            }
+            if (mshr.valid && !mshr.sent)
+            {
+                auto l2_req = sparta::allocate_sparta_shared_pointer<MemoryAccessInfo>(
+                    memory_access_allocator_, mshr.line_addr);
+                ILOG("Sending miss request to L2Cache " << l2_req);
+                out_l2cache_req_.send(l2_req);
+                mshr.sent = true;
+                --l2cache_credits_;
+            }
+        }
+    }
+
+    void ICache::receiveAckFromL2Cache_(const uint32_t & ack)
+    {
+        // The ack is the number of free slots in the L2's ICache request queue
+        l2cache_credits_ = ack;
+        ILOG("L2Cache credits: " << l2cache_credits_);
+        uev_send_miss_requests_.schedule(sparta::Clock::Cycle(0));
+    }
+
+    void ICache::receiveRespFromL2Cache_(const MemoryAccessInfoPtr & mem_access_info_ptr)
+    {
+        ILOG("Received cache refill " << mem_access_info_ptr);
+        const uint64_t line_addr = addr_decoder_->calcBlockAddr(mem_access_info_ptr->getPhyAddr());
+
+        for (auto & mshr : mshrs_)
+        {
+            if (mshr.valid && (mshr.line_addr == line_addr))
+            {
+                reloadCache_(line_addr, mshr.prefetch);
+                for (const auto & waiting : mshr.waiting)
+                {
+                    waiting->setCacheState(MemoryAccessInfo::CacheState::HIT);
+                    waiting->setDataReady(true);
+                    out_fetch_resp_.send(waiting);
+                }
+                // Keep the vector's storage for the next miss
+                mshr.waiting.clear();
+                mshr.valid = false;
+                break;
+            }
+        }
+
+        // Retry the requests that were waiting for an MSHR
+        while (!blocked_requests_.empty() && lookup_(blocked_requests_.front()))
+        {
+            blocked_requests_.pop_front();
+        }
+    }
+
+} // namespace olympia
@@ -0,0 +1,235 @@
+// <ICache.hpp> -*- C++ -*-
+
+//!
+//! \file ICache.hpp
+//! \brief The L1 instruction cache behind Fetch's fetch target queue
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/events/UniqueEvent.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/simulation/Unit.hpp"
+#include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
+#include "sparta/utils/LogUtils.hpp"
+#include "CacheFuncModel.hpp"
+#include "Checkpoint.hpp"
+#include "FunctionalWarming.hpp"
+#include "MemoryAccessInfo.hpp"
+#include "RingQueue.hpp"
+#include "cache/TreePLRUReplacement.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class ICache
+     * \brief Looks up the line of each fetch block Fetch requests.
+     *
+     * Hits are returned the cycle after the request arrives.  Misses
+     * are tracked by line in MSHRs, so fetch blocks that share a
+     * missing line wait on a single L2 request, and are answered
+     * together when the L2 returns the line.  When every MSHR is busy
+     * a missing request waits for one to free up.
+     *
+     * Fetch can also send prefetches for the lines of fetch blocks it
+     * has not looked up yet.  A prefetch is dropped if its line is in
+     * the cache or an MSHR already, or if it would take the last free
+     * MSHR, which is kept for demand misses.  Prefetched lines are
+     * tracked until a demand access uses them or they are evicted.
+     */
+    class ICache : public sparta::Unit, public FunctionalWarmingIF, public CheckpointableIF
+    {
+      public:
+        class ICacheParameterSet : public sparta::ParameterSet
+        {
+          public:
+            ICacheParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+
+            PARAMETER(uint32_t, l1_line_size, 64, "IL1 line size (power of 2)")
+            PARAMETER(uint32_t, l1_size_kb, 32, "Size of IL1 in KB (power of 2)")
+            PARAMETER(uint32_t, l1_associativity, 8, "IL1 associativity (power of 2)")
+            PARAMETER(bool, l1_always_hit, false, "IL1 will always hit")
+            PARAMETER(uint32_t, mshr_entries, 4, "Number of lines the IL1 can miss on at once")
+        };
+
+        static const char name[];
+        ICache(sparta::TreeNode* n, const ICacheParameterSet* p);
+
+        //! Functional warming: fill/touch the line of every skipped PC
+        void warm(WarmingRecord & record) override;
+
+        double getWarmingCoverage() const override { return l1_cache_->getValidFraction(); }
+
+        //! Checkpoint the IL1 tags and replacement state
+        void saveCheckpoint(std::ostream & os) override { checkpoint::saveCache(os, *l1_cache_); }
+
+        void restoreCheckpoint(std::istream & is) override
+        {
+            checkpoint::restoreCache(is, *l1_cache_);
+        }
+
+      private:
+        ////////////////////////////////////////////////////////////////////////////////
+        // L1 Instruction Cache Handling
+        ////////////////////////////////////////////////////////////////////////////////
+        using L1Handle = CacheFuncModel::Handle;
+        L1Handle l1_cache_;
+        const bool l1_always_hit_;
+        const sparta::cache::AddrDecoderIF* addr_decoder_ = nullptr;
+
+        //! A line being fetched from the L2, and the fetch requests
+        //! waiting on it
+        struct MissEntry
+        {
+            bool valid = false;
+            bool sent = false;
+            bool prefetch = false; // No demand request waiting on it yet
+            uint64_t line_addr = 0;
+            std::vector<MemoryAccessInfoPtr> waiting;
+        };
+
+        std::vector<MissEntry> mshrs_;
+
+        // Missing requests that found every MSHR busy
+        RingQueue<MemoryAccessInfoPtr> blocked_requests_;
+
+        // Requests the L2 can still take
+        uint32_t l2cache_credits_ = 0;
+
+        MemoryAccessInfoAllocator & memory_access_allocator_;
+
+        void setupL1Cache_(const ICacheParameterSet* p);
+
+        //! Look up a fetch request: answer a hit, or track the miss.
+        //! Returns false if the request missed and no MSHR was free
+        bool lookup_(const MemoryAccessInfoPtr & mem_access_info_ptr);
+
+        void reloadCache_(uint64_t line_addr, bool prefetched);
+
+        //! An MSHR to hold a new miss, or nullptr
+        MissEntry* findFreeMSHR_();
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Handle requests
+        ////////////////////////////////////////////////////////////////////////////////
+
+        void receiveFetchReq_(const MemoryAccessInfoPtr & mem_access_info_ptr);
+
+        void receivePrefetchReq_(const MemoryAccessInfoPtr & mem_access_info_ptr);
+
+        void receiveAckFromL2Cache_(const uint32_t & ack);
+
+        void receiveRespFromL2Cache_(const MemoryAccessInfoPtr & mem_access_info_ptr);
+
+        void sendMissRequests_();
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Input Ports
+        ////////////////////////////////////////////////////////////////////////////////
+        sparta::DataInPort<MemoryAccessInfoPtr> in_fetch_req_{&unit_port_set_, "in_fetch_req", 1};
+
+        sparta::DataInPort<MemoryAccessInfoPtr> in_fetch_prefetch_req_{&unit_port_set_,
+                                                                       "in_fetch_prefetch_req", 1};
+
+        sparta::DataInPort<uint32_t> in_l2cache_ack_{&unit_port_set_, "in_l2cache_ack", 1};
+
+        sparta::DataInPort<MemoryAccessInfoPtr> in_l2cache_resp_{&unit_port_set_, "in_l2cache_resp",
+                                                                 1};
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Output Ports
+        ////////////////////////////////////////////////////////////////////////////////
+        sparta::DataOutPort<MemoryAccessInfoPtr> out_fetch_resp_{&unit_port_set_, "out_fetch_resp",
+                                                                 0};
+
+        sparta::DataOutPort<MemoryAccessInfoPtr> out_l2cache_req_{&unit_port_set_,
+                                                                  "out_l2cache_req", 0};
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Events
+        ////////////////////////////////////////////////////////////////////////////////
+        sparta::UniqueEvent<> uev_send_miss_requests_{
+            &unit_event_set_, "send_miss_requests",
+            CREATE_SPARTA_HANDLER(ICache, sendMissRequests_)};
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Counters
+        ////////////////////////////////////////////////////////////////////////////////
+        sparta::Counter il1_cache_hits_{getStatisticSet(), "il1_cache_hits",
+                                        "Number of IL1 cache hits", sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_cache_misses_{getStatisticSet(), "il1_cache_misses",
+                                          "Number of IL1 cache misses",
+                                          sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_mshr_merges_{getStatisticSet(), "il1_mshr_merges",
+                                         "Number of IL1 misses to a line already being fetched",
+                                         sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_mshr_full_{getStatisticSet(), "il1_mshr_full",
+                                       "Number of IL1 misses that waited for a free MSHR",
+                                       sparta::Counter::COUNT_NORMAL};
+
+        sparta::StatisticDef il1_miss_rate_{getStatisticSet(), "il1_miss_rate",
+                                            "IL1 misses per lookup", getStatisticSet(),
+                                            "il1_cache_misses/(il1_cache_hits+il1_cache_misses)"};
+
+        // Prefetches.  A late prefetch was still in flight when fetch
+        // asked for its line: that demand access is also counted as a
+        // miss
+        sparta::Counter il1_prefetches_issued_{getStatisticSet(), "il1_prefetches_issued",
+                                               "Number of IL1 prefetches sent to the L2",
+                                               sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_prefetches_filtered_{
+            getStatisticSet(), "il1_prefetches_filtered",
+            "Number of IL1 prefetches dropped: line in the IL1 or an MSHR already",
+            sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_prefetches_dropped_{
+            getStatisticSet(), "il1_prefetches_dropped",
+            "Number of IL1 prefetches dropped for lack of a free MSHR",
+            sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_prefetches_useful_{
+            getStatisticSet(), "il1_prefetches_useful",
+            "Number of prefetched IL1 lines a demand access hit on",
+            sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_prefetches_late_{
+            getStatisticSet(), "il1_prefetches_late",
+            "Number of IL1 prefetches a demand access found still in flight",
+            sparta::Counter::COUNT_NORMAL};
+
+        sparta::Counter il1_prefetches_useless_{
+            getStatisticSet(), "il1_prefetches_useless",
+            "Number of prefetched IL1 lines evicted before a demand access used them",
+            sparta::Counter::COUNT_NORMAL};
+
+        sparta::StatisticDef il1_prefetch_accuracy_{
+            getStatisticSet(), "il1_prefetch_accuracy",
+            "Fraction of issued IL1 prefetches a demand access used", getStatisticSet(),
+            "(il1_prefetches_useful+il1_prefetches_late)/il1_prefetches_issued"};
+
+        sparta::StatisticDef il1_prefetch_coverage_{
+            getStatisticSet(), "il1_prefetch_coverage",
+            "Fraction of IL1 demand misses (without prefetching) that prefetches covered",
+            getStatisticSet(),
+            "(il1_prefetches_useful+il1_prefetches_late)/(il1_prefetches_useful+il1_cache_misses)"};
+
+        sparta::StatisticDef il1_prefetch_timeliness_{
+            getStatisticSet(), "il1_prefetch_timeliness",
+            "Fraction of used IL1 prefetches that arrived before the demand access",
+            getStatisticSet(),
+            "il1_prefetches_useful/(il1_prefetches_useful+il1_prefetches_late)"};
+
+        friend class ICacheTester;
+    };
+    class ICacheTester;
+
+} // namespace olympia
@@ -1,6 +1,8 @@
 // <Inst.cpp> -*- C++ -*-
 
 #include "Inst.hpp"
+#include <iomanip>
+#include <sstream>
 #include <unordered_map>
 
 namespace olympia
@@ -19,6 +21,23 @@ namespace olympia
         { Inst::Status::FUSION_GHOST,"FUSION_GHOST" }
     };
 
+    namespace
+    {
+        // Every Inst in flight holds a record: sized like the Inst pool
+        // (OlympiaAllocators' inst_water_mark), but never the limit
+        sparta::SpartaSharedPointerAllocator<Inst::ColdData> cold_data_allocator(1000000, 2500);
+    } // namespace
+
+    Inst::ColdRecord::ColdRecord() :
+        data_(sparta::allocate_sparta_shared_pointer<ColdData>(cold_data_allocator))
+    {
+    }
+
+    Inst::ColdRecord::ColdRecord(const ColdRecord & other) :
+        data_(sparta::allocate_sparta_shared_pointer<ColdData>(cold_data_allocator, *other.data_))
+    {
+    }
+
     bool isCallInstruction(const mavis::OpcodeInfo::PtrType & opcode_info)
     {
         if (opcode_info->isInstType(mavis::OpcodeInfo::InstructionTypes::JAL)
@@ -60,6 +79,7 @@ namespace olympia
                const InstArchInfo::PtrType & inst_arch_info, const sparta::Clock* clk) :
         opcode_info_(opcode_info),
         inst_arch_info_(inst_arch_info),
+        status_state_(Status::FETCHED),
         is_store_(opcode_info->isInstType(mavis::OpcodeInfo::InstructionTypes::STORE)),
         is_transfer_(miscutils::isOneOf(inst_arch_info_->getTargetPipe(),
                                         InstArchInfo::TargetPipe::I2F,
@@ -70,8 +90,16 @@ namespace olympia
         is_csr_(opcode_info->isInstType(mavis::OpcodeInfo::InstructionTypes::CSR)),
         is_vector_(opcode_info->isInstType(mavis::OpcodeInfo::InstructionTypes::VECTOR)),
         is_return_(isReturnInstruction(opcode_info)),
+        is_indirect_(opcode_info->isInstType(mavis::OpcodeInfo::InstructionTypes::JALR)),
         has_immediate_(opcode_info_->hasImmediate()),
-        status_state_(Status::FETCHED)
+        is_oldest_(false),
+        is_speculative_(false),
+        is_mispredicted_(false),
+        is_target_mispredicted_(false),
+        is_taken_branch_(false),
+        uopid_valid_(false),
+        has_tail_(false),
+        is_blocking_vset_(false)
     {
         sparta_assert(inst_arch_info_ != nullptr,
                       "Mavis decoded the instruction, but Olympia has no uarch data for it: "
@@ -83,4 +111,35 @@ namespace olympia
         sparta_assert(getExecuteTime() != 0,
             "Unknown execution time (latency) for " << getMnemonic());
     }
+
+    std::string Inst::info() const
+    {
+        std::string rStatus = "DONTCARE";
+        std::string eStatus = "UNKNOWN";
+
+        if (getExtendedStatus() == Inst::Status::UNMOD)
+        {
+            eStatus = "UNMOD";
+        }
+        else if (getExtendedStatus() == Inst::Status::FUSED)
+        {
+            eStatus = "FUSED";
+        }
+        else if (getExtendedStatus() == Inst::Status::FUSION_GHOST)
+        {
+            eStatus = "GHOST";
+        }
+
+        std::stringstream ss;
+
+        ss << "uid: " << std::dec                   //<< std::hex << std::setfill('0')
+           << getUniqueID() << " pid: " << std::dec //<< std::hex << std::setfill('0')
+           << getProgramID() << " mav: 0x" << std::hex << std::setw(2) << std::setfill('0')
+           << getMavisUid() << " inc: " << std::dec << getProgramIDIncrement() << " pc: 0x"
+           << std::hex << std::setw(8) << std::setfill('0') << getPC() << " " << std::setw(10)
+           << std::setfill(' ') << rStatus << " " << std::setw(12) << std::setfill(' ')
+           << eStatus << " '" << getDisasm() << "'";
+
+        return ss.str();
+    }
 } // namespace olympia
@@ -17,6 +17,7 @@
 #include "CoreTypes.hpp"
 #include "MiscUtils.hpp"
 
+#include <array>
 #include <cstdlib>
 #include <ostream>
 #include <unordered_map>
@@ -49,7 +50,33 @@ namespace olympia
                 bool is_x0 = false;
             };
 
-            using RegList = std::vector<Reg>;
+            //! The source registers, held inline: an instruction has at
+            //! most a few, and every unit from Rename to the ROB walks them
+            class RegList
+            {
+              public:
+                static constexpr uint32_t MAX_REGS = 6;
+
+                void push_back(const Reg & reg)
+                {
+                    sparta_assert(size_ < MAX_REGS, "Too many source registers");
+                    regs_[size_++] = reg;
+                }
+
+                const Reg* begin() const { return regs_.data(); }
+
+                const Reg* end() const { return regs_.data() + size_; }
+
+                const Reg & operator[](const uint32_t idx) const { return regs_[idx]; }
+
+                uint32_t size() const { return size_; }
+
+                bool empty() const { return size_ == 0; }
+
+              private:
+                std::array<Reg, MAX_REGS> regs_;
+                uint8_t size_ = 0;
+            };
 
             void setOriginalDestination(const Reg & destination) { original_dest_ = destination; }
 
@@ -57,7 +84,7 @@ namespace olympia
 
             void setDataReg(const Reg & data_reg) { data_reg_ = data_reg; }
 
-            void setSource(const Reg & source) { src_.emplace_back(source); }
+            void setSource(const Reg & source) { src_.push_back(source); }
 
             const RegList & getSourceList() const { return src_; }
 
@@ -165,11 +192,20 @@ namespace olympia
 
         bool getFlushedStatus() const { return getStatus() == olympia::Inst::Status::FLUSHED; }
 
-        void setMispredicted() { is_mispredicted_ = true; }
+        // Mark this branch mispredicted: its direction, or (target)
+        // only its target
+        void setMispredicted(bool target = false)
+        {
+            is_mispredicted_ = true;
+            is_target_mispredicted_ = target;
+        }
 
         // Is this branch instruction mispredicted?
         bool isMispredicted() const { return is_mispredicted_; }
 
+        // Was the direction right but the target wrong?
+        bool isTargetMispredicted() const { return is_target_mispredicted_; }
+
         const Status & getExtendedStatus() const { return extended_status_state_; }
 
         void setExtendedStatus(Status status)
@@ -194,9 +230,49 @@ namespace olympia
         bool isMarkedOldest() const { return is_oldest_; }
 
         // Rewind iterator used for going back in program simulation after flushes
-        template <typename T> void setRewindIterator(T iter) { rewind_iter_ = iter; }
+        using JSONIterator = uint64_t;
+        using RewindIterator = std::variant<stf::STFInstReader::iterator, JSONIterator>;
 
-        template <typename T> T getRewindIterator() const { return std::get<T>(rewind_iter_); }
+        //! The fields only read on a flush, by the vector uop generator
+        //! or for replay.  They live in a side record so that they do
+        //! not share the pipeline's cache lines
+        struct ColdData
+        {
+            RewindIterator rewind_iter;
+            VCSRs vcsrs;
+            sparta::SpartaWeakPointer<olympia::Inst> parent_uop;
+            uint64_t program_id_increment = 1;
+        };
+
+        //! An Inst's ColdData, from a pool that recycles the records of
+        //! retired instructions.  Copying an Inst copies its record
+        class ColdRecord
+        {
+          public:
+            ColdRecord();
+
+            ColdRecord(const ColdRecord & other);
+
+            ColdRecord & operator=(const ColdRecord & other)
+            {
+                *data_ = *other.data_;
+                return *this;
+            }
+
+            ColdData* operator->() { return data_.get(); }
+
+            const ColdData* operator->() const { return data_.get(); }
+
+          private:
+            sparta::SpartaSharedPointer<ColdData> data_;
+        };
+
+        template <typename T> void setRewindIterator(T iter) { cold_->rewind_iter = iter; }
+
+        template <typename T> T getRewindIterator() const { return std::get<T>(cold_->rewind_iter); }
+
+        // The rewind iterator, whichever workload type set it
+        const RewindIterator & getRewindState() const { return cold_->rewind_iter; }
 
         // Set the instructions unique ID.  This ID in constantly
         // incremented and does not repeat.  The same instruction in a
@@ -208,12 +284,16 @@ namespace olympia
         // Set the instruction's UOp ID. This ID is incremented based
         // off of number of Uops. The UOp instructions will all have the same
         // UID, but different UOp IDs.
-        void setUOpID(uint64_t uopid) { uopid_ = uopid; }
+        void setUOpID(uint64_t uopid)
+        {
+            uopid_ = uopid;
+            uopid_valid_ = true;
+        }
 
         // Set the instruction's UOp ID. This ID is incremented based
         // off of number of Uops. The UOp instructions will all have the same
         // UID, but different UOp IDs.
-        uint64_t getUOpID() const { return uopid_.isValid() ? uopid_.getValue() : 0; }
+        uint64_t getUOpID() const { return uopid_valid_ ? uopid_ : 0; }
 
         void setBlockingVSET(bool is_blocking_vset) { is_blocking_vset_ = is_blocking_vset; }
 
@@ -230,10 +310,10 @@ namespace olympia
         // A fused operation will modify the program_id_increment_ based on
         // the number of instructions fused. A-B-C-D -> fA  incr becomes 4
         // This is planned, but not currently used.
-        void setProgramIDIncrement(uint64_t incr) { program_id_increment_ = incr; }
+        void setProgramIDIncrement(uint64_t incr) { cold_->program_id_increment = incr; }
 
         // This is planned, but not currently used.
-        uint64_t getProgramIDIncrement() const { return program_id_increment_; }
+        uint64_t getProgramIDIncrement() const { return cold_->program_id_increment; }
 
         // Set the instruction's PC
         void setPC(sparta::memory::addr_t inst_pc) { inst_pc_ = inst_pc; }
@@ -246,47 +326,47 @@ namespace olympia
 
         void setVCSRs(const VCSRs * input_VCSRs)
         {
-            VCSRs_ = *input_VCSRs;
+            cold_->vcsrs = *input_VCSRs;
         }
 
-        const VCSRs * getVCSRs() const { return &VCSRs_; }
+        const VCSRs * getVCSRs() const { return &cold_->vcsrs; }
 
         // Set lmul from vset (vsetivli, vsetvli)
         void setLMUL(uint32_t lmul)
         {
-            VCSRs_.lmul = lmul;
-            VCSRs_.vlmax = VCSRs_.vlmax_formula();
+            cold_->vcsrs.lmul = lmul;
+            cold_->vcsrs.vlmax = cold_->vcsrs.vlmax_formula();
         }
 
         // Set sew from vset (vsetivli, vsetvli)
         void setSEW(uint32_t sew)
         {
-            VCSRs_.sew = sew;
-            VCSRs_.vlmax = VCSRs_.vlmax_formula();
+            cold_->vcsrs.sew = sew;
+            cold_->vcsrs.vlmax = cold_->vcsrs.vlmax_formula();
         }
 
         // Set VL from vset (vsetivli, vsetvli)
-        void setVL(uint32_t vl) { VCSRs_.vl = vl; }
+        void setVL(uint32_t vl) { cold_->vcsrs.vl = vl; }
 
         // Set VTA (vector tail agnostic)
         // vta = true means agnostic, set destination values to 1's or maintain original
         // vta = false means undisturbed, maintain original destination values
-        void setVTA(bool vta) { VCSRs_.vta = vta; }
+        void setVTA(bool vta) { cold_->vcsrs.vta = vta; }
 
-        uint32_t getSEW() const { return VCSRs_.sew; }
-        uint32_t getLMUL() const { return VCSRs_.lmul; }
-        uint32_t getVL() const { return VCSRs_.vl; }
-        uint32_t getVTA() const { return VCSRs_.vta; }
-        uint32_t getVLMAX() const { return VCSRs_.vlmax; }
+        uint32_t getSEW() const { return cold_->vcsrs.sew; }
+        uint32_t getLMUL() const { return cold_->vcsrs.lmul; }
+        uint32_t getVL() const { return cold_->vcsrs.vl; }
+        uint32_t getVTA() const { return cold_->vcsrs.vta; }
+        uint32_t getVLMAX() const { return cold_->vcsrs.vlmax; }
 
         void setTail(bool has_tail) { has_tail_ = has_tail; }
         bool hasTail() const { return has_tail_; }
 
         void setUOpParent(sparta::SpartaWeakPointer<olympia::Inst> & parent_uop)
         {
-            parent_uop_ = parent_uop;
+            cold_->parent_uop = parent_uop;
         }
-        sparta::SpartaWeakPointer<olympia::Inst> getUOpParent() { return parent_uop_; }
+        sparta::SpartaWeakPointer<olympia::Inst> getUOpParent() { return cold_->parent_uop; }
 
         // Branch instruction was taken (always set for JAL/JALR)
         void setTakenBranch(bool taken) { is_taken_branch_ = taken; }
@@ -386,6 +466,9 @@ namespace olympia
 
         bool isReturn() const { return is_return_; }
 
+        //! Does this branch jump to a register (returns too)?
+        bool isIndirect() const { return is_indirect_; }
+
         bool hasImmediate() const { return has_immediate_; }
 
         bool isVset() const { return inst_arch_info_->isVset(); }
@@ -432,80 +515,54 @@ namespace olympia
 
         mavis::OpcodeInfo::PtrType getOpCodeInfo() { return opcode_info_; }
 
-        // Duplicates stream operator but does not change EXPECT logs
-        std::string info()
-        {
-            std::string rStatus = "DONTCARE";
-            std::string eStatus = "UNKNOWN";
-
-            if (getExtendedStatus() == Inst::Status::UNMOD)
-            {
-                eStatus = "UNMOD";
-            }
-            else if (getExtendedStatus() == Inst::Status::FUSED)
-            {
-                eStatus = "FUSED";
-            }
-            else if (getExtendedStatus() == Inst::Status::FUSION_GHOST)
-            {
-                eStatus = "GHOST";
-            }
-
-            std::stringstream ss;
-
-            ss << "uid: " << std::dec                   //<< std::hex << std::setfill('0')
-               << getUniqueID() << " pid: " << std::dec //<< std::hex << std::setfill('0')
-               << getProgramID() << " mav: 0x" << std::hex << std::setw(2) << std::setfill('0')
-               << getMavisUid() << " inc: " << std::dec << getProgramIDIncrement() << " pc: 0x"
-               << std::hex << std::setw(8) << std::setfill('0') << getPC() << " " << std::setw(10)
-               << std::setfill(' ') << rStatus << " " << std::setw(12) << std::setfill(' ')
-               << eStatus << " '" << getDisasm() << "'";
+        const InstArchInfo::PtrType & getInstArchInfo() const { return inst_arch_info_; }
 
-            return ss.str();
-        }
+        // Duplicates stream operator but does not change EXPECT logs
+        std::string info() const;
 
       private:
+        //
+        // Hot: read or written by most units for most instructions.
+        // Kept together at the front of the object so that the pipeline
+        // touches as few of its cache lines as possible
+        //
         mavis::OpcodeInfo::PtrType opcode_info_;
         InstArchInfo::PtrType inst_arch_info_;
 
-        sparta::memory::addr_t inst_pc_ = 0; // Instruction's PC
-        sparta::memory::addr_t target_vaddr_ =
-            0; // Instruction's Target PC (for branches, loads/stores)
-        bool is_oldest_ = false;
-        uint64_t unique_id_ = 0;  // Supplied by Fetch
-        uint64_t program_id_ = 0; // Supplied by a trace Reader or execution backend
-        sparta::utils::ValidValue<uint64_t> uopid_; // Set in decode
-        uint64_t program_id_increment_ = 1;
-        bool is_speculative_ = false; // Is this instruction soon to be flushed?
-        const bool is_store_;
-        const bool is_transfer_; // Is this a transfer instruction (F2I/I2F)
-        const bool is_branch_;
-        const bool is_condbranch_;
-        const bool is_call_;
-        const bool is_csr_;
-        const bool is_vector_;
-        const bool is_return_;
-        const bool has_immediate_;
-
-        VCSRs VCSRs_;
-        bool has_tail_ = false; // Does this vector uop have a tail?
+        Status status_state_;
+        Status extended_status_state_{Inst::Status::UNMOD};
+
+        // Static instruction type
+        const bool is_store_ : 1;
+        const bool is_transfer_ : 1; // Is this a transfer instruction (F2I/I2F)
+        const bool is_branch_ : 1;
+        const bool is_condbranch_ : 1;
+        const bool is_call_ : 1;
+        const bool is_csr_ : 1;
+        const bool is_vector_ : 1;
+        const bool is_return_ : 1;
+        const bool is_indirect_ : 1;
+        const bool has_immediate_ : 1;
+
+        bool is_oldest_ : 1;
+        bool is_speculative_ : 1;  // Is this instruction soon to be flushed?
+        bool is_mispredicted_ : 1; // Did this instruction mispredict?
+        bool is_target_mispredicted_ : 1; // ... only its target?
+        bool is_taken_branch_ : 1;
+        bool uopid_valid_ : 1;     // Has decode set uopid_?
+        bool has_tail_ : 1;        // Does this vector uop have a tail?
 
         // blocking vset is a vset that needs to read a value from a register value. A blocking vset
         // can't be resolved until after execution, so we need to block on it due to UOp fracturing
-        bool is_blocking_vset_ = false;
-
-        sparta::SpartaWeakPointer<olympia::Inst> parent_uop_;
+        bool is_blocking_vset_ : 1;
 
-        // Did this instruction mispredict?
-        bool is_mispredicted_ = false;
-        bool is_taken_branch_ = false;
+        uint64_t unique_id_ = 0;  // Supplied by Fetch
+        uint64_t program_id_ = 0; // Supplied by a trace Reader or execution backend
+        uint64_t uopid_ = 0;      // Set in decode
+        sparta::memory::addr_t inst_pc_ = 0; // Instruction's PC
+        sparta::memory::addr_t target_vaddr_ =
+            0; // Instruction's Target PC (for branches, loads/stores)
         sparta::Scheduleable* ev_retire_ = nullptr;
-        Status status_state_;
-        Status extended_status_state_{Inst::Status::UNMOD};
-
-        using JSONIterator = uint64_t;
-        using RewindIterator = std::variant<stf::STFInstReader::iterator, JSONIterator>;
-        RewindIterator rewind_iter_;
 
         // Rename information
         using RegisterBitMaskArray =
@@ -514,6 +571,13 @@ namespace olympia
         RegisterBitMaskArray dest_reg_bit_masks_;
         RegisterBitMaskArray store_data_mask_;
         RenameData rename_data;
+
+        //
+        // Cold: written once by Fetch or Decode and read back only on a
+        // flush, by the vector uop generator or for replay
+        //
+        ColdRecord cold_;
+
         static const std::unordered_map<Inst::Status, std::string> status2String;
     };
 
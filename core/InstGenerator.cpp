@@ -1,14 +1,59 @@
 
+#include <algorithm>
+
 #include "InstGenerator.hpp"
 #include "json.hpp" // From Mavis
 #include "mavis/Mavis.h"
 
 namespace olympia
 {
+    namespace
+    {
+        std::unique_ptr<stf::STFInstReader> openSTFReader(const std::string & filename,
+                                                          const bool skip_nonuser_mode)
+        {
+            std::ifstream fs;
+            std::ios_base::iostate exceptionMask = fs.exceptions() | std::ios::failbit;
+            fs.exceptions(exceptionMask);
+
+            try
+            {
+                fs.open(filename);
+            }
+            catch (const std::ifstream::failure & e)
+            {
+                throw sparta::SpartaException("ERROR: Issues opening ") << filename << ": " << e.what();
+            }
+
+            // If true, search for an stf-pte file alongside this trace.
+            constexpr bool CHECK_FOR_STF_PTE = false;
+
+            // Filter out mode change events regardless of skip_nonuser_mode
+            // value. Required for traces that stay in machine mode the entire
+            // time
+            constexpr bool FILTER_MODE_CHANGE_EVENTS = true;
+            constexpr size_t BUFFER_SIZE = 4096;
+            return std::unique_ptr<stf::STFInstReader>(
+                new stf::STFInstReader(filename, skip_nonuser_mode, CHECK_FOR_STF_PTE,
+                                       FILTER_MODE_CHANGE_EVENTS, BUFFER_SIZE));
+        }
+    }
+
     std::unique_ptr<InstGenerator> InstGenerator::createGenerator(MavisType* mavis_facade,
                                                                   const std::string & filename,
-                                                                  const bool skip_nonuser_mode)
+                                                                  const bool skip_nonuser_mode,
+                                                                  const uint32_t async_ring_size,
+                                                                  const uint32_t async_rewind_window)
     {
+        const std::string pdt_ext = std::string(".") + decoded_trace::FILE_EXTENSION;
+        if ((filename.size() > pdt_ext.size())
+            && filename.substr(filename.size() - pdt_ext.size()) == pdt_ext)
+        {
+            std::cout << "olympia: pre-decoded trace input detected" << std::endl;
+            return std::unique_ptr<InstGenerator>(
+                new DecodedTraceInstGenerator(mavis_facade, filename));
+        }
+
         const std::string json_ext = "json";
         if ((filename.size() > json_ext.size())
             && filename.substr(filename.size() - json_ext.size()) == json_ext)
@@ -22,13 +67,21 @@ namespace olympia
             && filename.substr(filename.size() - stf_ext.size()) == stf_ext)
         {
             std::cout << "olympia: STF file input detected" << std::endl;
+            if (async_ring_size != 0)
+            {
+                std::cout << "olympia: reading STF on a background thread, ring size "
+                          << async_ring_size << std::endl;
+                return std::unique_ptr<InstGenerator>(
+                    new AsyncTraceInstGenerator(mavis_facade, filename, skip_nonuser_mode,
+                                                async_ring_size, async_rewind_window));
+            }
             return std::unique_ptr<InstGenerator>(
                 new TraceInstGenerator(mavis_facade, filename, skip_nonuser_mode));
         }
 
         // Dunno what it is...
         sparta_assert(false, "Unknown file extension for '" << filename
-                                                            << "'.  Expected .json or .[z]stf");
+                                                            << "'.  Expected .json, .[z]stf or .pdt");
         return nullptr;
     }
 
@@ -50,9 +103,114 @@ namespace olympia
             throw sparta::SpartaException("ERROR: Issues opening ") << filename << ": " << e.what();
         }
 
-        jobj_.reset(new nlohmann::json);
-        fs >> *jobj_;
-        n_insts_ = jobj_->size();
+        // Compile the JSON into records in one pass.  The DOM is
+        // dropped when this constructor returns
+        nlohmann::json jobj;
+        fs >> jobj;
+        n_insts_ = jobj.size();
+        records_.resize(n_insts_);
+
+        for (uint64_t index = 0; index < n_insts_; ++index)
+        {
+            const nlohmann::json & jinst = jobj.at(index);
+            JSONInstRecord & record = records_[index];
+
+            if (jinst.find("opcode") != jinst.end())
+            {
+                record.opcode =
+                    std::strtoull(jinst["opcode"].get<std::string>().c_str(), nullptr, 0);
+                record.has_opcode = true;
+                continue;
+            }
+
+            if (jinst.find("mnemonic") == jinst.end())
+            {
+                throw sparta::SpartaException() << "Missing mnemonic at " << index;
+            }
+            record.uid = mavis_facade_->lookupInstructionUniqueID(jinst["mnemonic"]);
+
+            auto addOperand = [&jinst](auto & operands, uint8_t & num_operands,
+                                       const std::string & key,
+                                       const mavis::InstMetaData::OperandFieldID operand_field_id,
+                                       const mavis::InstMetaData::OperandTypes operand_type)
+            {
+                if (jinst.find(key) != jinst.end())
+                {
+                    operands[num_operands++] = {operand_field_id, operand_type,
+                                                jinst[key].get<uint64_t>()};
+                }
+            };
+
+            addOperand(record.srcs, record.num_srcs, "rs1",
+                       mavis::InstMetaData::OperandFieldID::RS1,
+                       mavis::InstMetaData::OperandTypes::LONG);
+            addOperand(record.srcs, record.num_srcs, "fs1",
+                       mavis::InstMetaData::OperandFieldID::RS1,
+                       mavis::InstMetaData::OperandTypes::DOUBLE);
+            addOperand(record.srcs, record.num_srcs, "rs2",
+                       mavis::InstMetaData::OperandFieldID::RS2,
+                       mavis::InstMetaData::OperandTypes::LONG);
+            addOperand(record.srcs, record.num_srcs, "fs2",
+                       mavis::InstMetaData::OperandFieldID::RS2,
+                       mavis::InstMetaData::OperandTypes::DOUBLE);
+            addOperand(record.srcs, record.num_srcs, "vs1",
+                       mavis::InstMetaData::OperandFieldID::RS1,
+                       mavis::InstMetaData::OperandTypes::VECTOR);
+            addOperand(record.srcs, record.num_srcs, "vs2",
+                       mavis::InstMetaData::OperandFieldID::RS2,
+                       mavis::InstMetaData::OperandTypes::VECTOR);
+
+            addOperand(record.dests, record.num_dests, "rd",
+                       mavis::InstMetaData::OperandFieldID::RD,
+                       mavis::InstMetaData::OperandTypes::LONG);
+            addOperand(record.dests, record.num_dests, "fd",
+                       mavis::InstMetaData::OperandFieldID::RD,
+                       mavis::InstMetaData::OperandTypes::DOUBLE);
+            addOperand(record.dests, record.num_dests, "vd",
+                       mavis::InstMetaData::OperandFieldID::RD,
+                       mavis::InstMetaData::OperandTypes::VECTOR);
+
+            if (jinst.find("imm") != jinst.end())
+            {
+                record.imm = jinst["imm"].get<uint64_t>();
+                record.has_imm = true;
+            }
+
+            if (jinst.find("vaddr") != jinst.end())
+            {
+                record.vaddr =
+                    std::strtoull(jinst["vaddr"].get<std::string>().c_str(), nullptr, 0);
+                record.has_vaddr = true;
+            }
+
+            if (jinst.find("vtype") != jinst.end())
+            {
+                // immediate, so decode from hex: vsew is bits [5:3], vlmul is bits [2:0]
+                const uint64_t vtype =
+                    std::strtoull(jinst["vtype"].get<std::string>().c_str(), nullptr, 0);
+                record.sew = 8u << ((vtype >> 3) & 0x7);
+                record.lmul = 1u << (vtype & 0x7);
+                record.has_vtype = true;
+            }
+
+            if (jinst.find("vta") != jinst.end())
+            {
+                record.vta = jinst["vta"].get<uint64_t>() > 0;
+                record.has_vta = true;
+            }
+
+            if (jinst.find("vl") != jinst.end())
+            {
+                record.vl = jinst["vl"].get<uint64_t>();
+                record.has_vl = true;
+            }
+
+            if (jinst.find("taken") != jinst.end())
+            {
+                record.taken = jinst["taken"].get<bool>();
+                record.has_taken = true;
+            }
+        }
     }
 
     bool JSONInstGenerator::isDone() const { return (curr_inst_index_ >= n_insts_); }
@@ -68,6 +226,29 @@ namespace olympia
         }
     }
 
+    uint64_t JSONInstGenerator::skip(const uint64_t num_insts, const WarmingCallback & warm)
+    {
+        const uint64_t skipped = std::min(num_insts, n_insts_ - std::min(curr_inst_index_, n_insts_));
+        if (warm)
+        {
+            for (uint64_t idx = curr_inst_index_; idx < (curr_inst_index_ + skipped); ++idx)
+            {
+                // Without decoding, a vaddr is taken to be a memory
+                // access and a taken field to be a branch
+                const JSONInstRecord & record = records_[idx];
+                WarmingRecord warming_record;
+                warming_record.opcode = record.opcode;
+                warming_record.is_mem_access = record.has_vaddr;
+                warming_record.mem_vaddr = record.vaddr;
+                warming_record.is_branch = record.has_taken;
+                warming_record.is_taken_branch = record.taken;
+                warm(warming_record);
+            }
+        }
+        curr_inst_index_ += skipped;
+        return skipped;
+    }
+
     InstPtr JSONInstGenerator::getNextInst(const sparta::Clock* clk)
     {
         if (SPARTA_EXPECT_FALSE(isDone()))
@@ -75,98 +256,59 @@ namespace olympia
             return nullptr;
         }
 
-        // Get the JSON record at the current index
-        nlohmann::json jinst = jobj_->at(curr_inst_index_);
+        const JSONInstRecord & record = records_[curr_inst_index_];
         InstPtr inst;
-        if (jinst.find("opcode") != jinst.end())
+        if (record.has_opcode)
         {
-            uint64_t opcode = std::strtoull(jinst["opcode"].get<std::string>().c_str(), nullptr, 0);
-            inst = mavis_facade_->makeInst(opcode, clk);
+            inst = makeInst_(record.opcode, clk);
         }
         else
         {
-            if (jinst.find("mnemonic") == jinst.end())
+            mavis::OperandInfo srcs;
+            for (uint8_t i = 0; i < record.num_srcs; ++i)
             {
-                throw sparta::SpartaException() << "Missing mnemonic at " << curr_inst_index_;
+                srcs.addElement(record.srcs[i].field_id, record.srcs[i].type,
+                                record.srcs[i].value);
             }
-            const std::string mnemonic = jinst["mnemonic"];
-
-            auto addElement = [&jinst](mavis::OperandInfo & operands, const std::string & key,
-                                       const mavis::InstMetaData::OperandFieldID operand_field_id,
-                                       const mavis::InstMetaData::OperandTypes operand_type)
-            {
-                if (jinst.find(key) != jinst.end())
-                {
-                    operands.addElement(operand_field_id, operand_type, jinst[key].get<uint64_t>());
-                }
-            };
-
-            mavis::OperandInfo srcs;
-            addElement(srcs, "rs1", mavis::InstMetaData::OperandFieldID::RS1,
-                       mavis::InstMetaData::OperandTypes::LONG);
-            addElement(srcs, "fs1", mavis::InstMetaData::OperandFieldID::RS1,
-                       mavis::InstMetaData::OperandTypes::DOUBLE);
-            addElement(srcs, "rs2", mavis::InstMetaData::OperandFieldID::RS2,
-                       mavis::InstMetaData::OperandTypes::LONG);
-            addElement(srcs, "fs2", mavis::InstMetaData::OperandFieldID::RS2,
-                       mavis::InstMetaData::OperandTypes::DOUBLE);
-            addElement(srcs, "vs1", mavis::InstMetaData::OperandFieldID::RS1,
-                       mavis::InstMetaData::OperandTypes::VECTOR);
-            addElement(srcs, "vs2", mavis::InstMetaData::OperandFieldID::RS2,
-                       mavis::InstMetaData::OperandTypes::VECTOR);
 
             mavis::OperandInfo dests;
-            addElement(dests, "rd", mavis::InstMetaData::OperandFieldID::RD,
-                       mavis::InstMetaData::OperandTypes::LONG);
-            addElement(dests, "fd", mavis::InstMetaData::OperandFieldID::RD,
-                       mavis::InstMetaData::OperandTypes::DOUBLE);
-            addElement(dests, "vd", mavis::InstMetaData::OperandFieldID::RD,
-                       mavis::InstMetaData::OperandTypes::VECTOR);
+            for (uint8_t i = 0; i < record.num_dests; ++i)
+            {
+                dests.addElement(record.dests[i].field_id, record.dests[i].type,
+                                 record.dests[i].value);
+            }
 
-            if (jinst.find("imm") != jinst.end())
+            if (record.has_imm)
             {
-                const uint64_t imm = jinst["imm"].get<uint64_t>();
-                mavis::ExtractorDirectOpInfoList ex_info(mnemonic, srcs, dests, imm);
+                mavis::ExtractorDirectOpInfoList ex_info(record.uid, srcs, dests, record.imm);
                 inst = mavis_facade_->makeInstDirectly(ex_info, clk);
             }
             else
             {
-                mavis::ExtractorDirectOpInfoList ex_info(mnemonic, srcs, dests);
+                mavis::ExtractorDirectOpInfoList ex_info(record.uid, srcs, dests);
                 inst = mavis_facade_->makeInstDirectly(ex_info, clk);
             }
 
-            if (jinst.find("vaddr") != jinst.end())
+            if (record.has_vaddr)
             {
-                uint64_t vaddr = std::strtoull(jinst["vaddr"].get<std::string>().c_str(), nullptr, 0);
-                inst->setTargetVAddr(vaddr);
+                inst->setTargetVAddr(record.vaddr);
             }
-            if (jinst.find("vtype") != jinst.end())
+            if (record.has_vtype)
             {
-                // immediate, so decode from hex
-                uint64_t vtype = std::strtoull(jinst["vtype"].get<std::string>().c_str(), nullptr, 0);
-                std::string binaryString = std::bitset<32>(vtype).to_string();
-                uint32_t sew = std::pow(2, std::stoi(binaryString.substr(26, 3), nullptr, 2)) * 8;
-                uint32_t lmul = std::pow(2, std::stoi(binaryString.substr(29, 3), nullptr, 2));
-                inst->setLMUL(lmul);
-                inst->setSEW(sew);
+                inst->setLMUL(record.lmul);
+                inst->setSEW(record.sew);
             }
-
-            if (jinst.find("vta") != jinst.end())
+            if (record.has_vta)
             {
-                const bool vta = jinst["vta"].get<uint64_t>() > 0 ? true: false;
-                inst->setVTA(vta);
+                inst->setVTA(record.vta);
             }
-
-            if (jinst.find("vl") != jinst.end())
+            if (record.has_vl)
             {
-                const uint64_t vl = jinst["vl"].get<uint64_t>();
-                inst->setVL(vl);
+                inst->setVL(record.vl);
             }
-
-            if (jinst.find("taken") != jinst.end())
+            if (record.has_taken)
             {
-                const bool taken = jinst["taken"].get<bool>();
-                inst->setTakenBranch(taken);
+                inst->setTakenBranch(record.taken);
             }
         }
 
@@ -178,35 +320,125 @@ namespace olympia
     }
 
     ////////////////////////////////////////////////////////////////////////////////
-    // STF Inst Generator
-    TraceInstGenerator::TraceInstGenerator(MavisType* mavis_facade, const std::string & filename,
-                                           const bool skip_nonuser_mode) :
-        InstGenerator(mavis_facade)
+    // Pre-decoded Trace Inst Generator
+    DecodedTraceInstGenerator::DecodedTraceInstGenerator(MavisType* mavis_facade,
+                                                         const std::string & filename) :
+        InstGenerator(mavis_facade),
+        reader_(filename)
     {
-        std::ifstream fs;
-        std::ios_base::iostate exceptionMask = fs.exceptions() | std::ios::failbit;
-        fs.exceptions(exceptionMask);
+    }
 
-        try
+    bool DecodedTraceInstGenerator::isDone() const { return (curr_inst_index_ >= reader_.size()); }
+
+    void DecodedTraceInstGenerator::reset(const InstPtr & inst_ptr, const bool skip = false)
+    {
+        curr_inst_index_ = inst_ptr->getRewindIterator<uint64_t>();
+        program_id_ = inst_ptr->getProgramID();
+        if (skip)
         {
-            fs.open(filename);
+            ++curr_inst_index_;
+            ++program_id_;
         }
-        catch (const std::ifstream::failure & e)
+    }
+
+    uint64_t DecodedTraceInstGenerator::skip(const uint64_t num_insts,
+                                             const WarmingCallback & warm)
+    {
+        const uint64_t skipped =
+            std::min(num_insts, reader_.size() - std::min(curr_inst_index_, reader_.size()));
+        if (warm)
         {
-            throw sparta::SpartaException("ERROR: Issues opening ") << filename << ": " << e.what();
+            for (uint64_t idx = curr_inst_index_; idx < (curr_inst_index_ + skipped); ++idx)
+            {
+                const uint8_t flags = reader_.getFlags(idx);
+                WarmingRecord warming_record;
+                warming_record.pc = reader_.getPC(idx);
+                warming_record.opcode = reader_.getOpcode(idx);
+                warming_record.is_mem_access = flags & decoded_trace::FLAG_MEM_ACCESS;
+                warming_record.mem_vaddr = reader_.getTargetVAddr(idx);
+                warming_record.is_branch = flags & decoded_trace::FLAG_BRANCH;
+                warming_record.is_taken_branch = flags & decoded_trace::FLAG_TAKEN_BRANCH;
+                warming_record.branch_target = reader_.getTargetVAddr(idx);
+                warm(warming_record);
+            }
         }
+        curr_inst_index_ += skipped;
+        return skipped;
+    }
 
-        // If true, search for an stf-pte file alongside this trace.
-        constexpr bool CHECK_FOR_STF_PTE = false;
+    InstPtr DecodedTraceInstGenerator::getNextInst(const sparta::Clock* clk)
+    {
+        if (SPARTA_EXPECT_FALSE(isDone()))
+        {
+            return nullptr;
+        }
+
+        InstPtr inst;
+        if (const auto* direct = reader_.getDirectOperands(curr_inst_index_);
+            SPARTA_EXPECT_FALSE(direct != nullptr))
+        {
+            auto unpack = [](mavis::OperandInfo & operands,
+                             const decoded_trace::PackedOperand & operand)
+            {
+                operands.addElement(
+                    static_cast<mavis::InstMetaData::OperandFieldID>(operand.field_id),
+                    static_cast<mavis::InstMetaData::OperandTypes>(operand.type), operand.value);
+            };
+
+            mavis::OperandInfo srcs;
+            for (uint8_t i = 0; i < direct->num_srcs; ++i)
+            {
+                unpack(srcs, direct->srcs[i]);
+            }
+            mavis::OperandInfo dests;
+            for (uint8_t i = 0; i < direct->num_dests; ++i)
+            {
+                unpack(dests, direct->dests[i]);
+            }
 
-        // Filter out mode change events regardless of skip_nonuser_mode
-        // value. Required for traces that stay in machine mode the entire
-        // time
-        constexpr bool FILTER_MODE_CHANGE_EVENTS = true;
-        constexpr size_t BUFFER_SIZE = 4096;
-        reader_.reset(new stf::STFInstReader(filename, skip_nonuser_mode, CHECK_FOR_STF_PTE,
-                                             FILTER_MODE_CHANGE_EVENTS, BUFFER_SIZE));
+            const mavis::InstructionUniqueID uid = reader_.getUID(curr_inst_index_);
+            if (direct->has_imm)
+            {
+                mavis::ExtractorDirectOpInfoList ex_info(uid, srcs, dests, direct->imm);
+                inst = mavis_facade_->makeInstDirectly(ex_info, clk);
+            }
+            else
+            {
+                mavis::ExtractorDirectOpInfoList ex_info(uid, srcs, dests);
+                inst = mavis_facade_->makeInstDirectly(ex_info, clk);
+            }
+            inst->setLMUL(direct->lmul);
+            inst->setSEW(direct->sew);
+            inst->setVTA(direct->vta);
+            inst->setVL(direct->vl);
+        }
+        else
+        {
+            inst = makeInst_(reader_.getOpcode(curr_inst_index_), clk);
+            sparta_assert(inst->getMavisUid() == reader_.getUID(curr_inst_index_),
+                          "Pre-decoded trace was generated with a different ISA description: "
+                              << inst << " expected Mavis UID "
+                              << reader_.getUID(curr_inst_index_));
+        }
 
+        inst->setPC(reader_.getPC(curr_inst_index_));
+        inst->setTargetVAddr(reader_.getTargetVAddr(curr_inst_index_));
+        inst->setTakenBranch(reader_.getFlags(curr_inst_index_)
+                             & decoded_trace::FLAG_TAKEN_BRANCH);
+        inst->setRewindIterator<uint64_t>(curr_inst_index_);
+        inst->setUniqueID(++unique_id_);
+        inst->setProgramID(program_id_++);
+        ++curr_inst_index_;
+        return inst;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // STF Inst Generator
+    TraceInstGenerator::TraceInstGenerator(MavisType* mavis_facade, const std::string & filename,
+                                           const bool skip_nonuser_mode) :
+        InstGenerator(mavis_facade),
+        reader_(openSTFReader(filename, skip_nonuser_mode))
+    {
         next_it_ = reader_->begin();
     }
 
@@ -223,6 +455,37 @@ namespace olympia
         }
     }
 
+    uint64_t TraceInstGenerator::skip(const uint64_t num_insts, const WarmingCallback & warm)
+    {
+        // Walk the reader; no decode and no Inst
+        uint64_t skipped = 0;
+        while ((skipped < num_insts) && (next_it_ != reader_->end()))
+        {
+            if (warm)
+            {
+                WarmingRecord warming_record;
+                warming_record.pc = next_it_->pc();
+                warming_record.opcode = next_it_->opcode();
+                if (const auto & mem_accesses = next_it_->getMemoryAccesses();
+                    !mem_accesses.empty())
+                {
+                    warming_record.is_mem_access = true;
+                    warming_record.mem_vaddr = mem_accesses.front().getAddress();
+                }
+                if (next_it_->isBranch())
+                {
+                    warming_record.is_branch = true;
+                    warming_record.is_taken_branch = next_it_->isTakenBranch();
+                    warming_record.branch_target = next_it_->branchTarget();
+                }
+                warm(warming_record);
+            }
+            ++next_it_;
+            ++skipped;
+        }
+        return skipped;
+    }
+
     InstPtr TraceInstGenerator::getNextInst(const sparta::Clock* clk)
     {
         if (SPARTA_EXPECT_FALSE(isDone()))
@@ -234,21 +497,16 @@ namespace olympia
 
         try
         {
-            InstPtr inst = mavis_facade_->makeInst(opcode, clk);
+            InstPtr inst = makeInst_(opcode, clk);
             inst->setPC(next_it_->pc());
             inst->setUniqueID(++unique_id_);
             inst->setProgramID(program_id_++);
             inst->setRewindIterator<stf::STFInstReader::iterator>(next_it_);
             if (const auto & mem_accesses = next_it_->getMemoryAccesses(); !mem_accesses.empty())
             {
-                using VectorAddrType = std::vector<sparta::memory::addr_t>;
-                VectorAddrType addrs;
-                std::for_each(next_it_->getMemoryAccesses().begin(),
-                              next_it_->getMemoryAccesses().end(),
-                              [&addrs](const auto & ma) { addrs.emplace_back(ma.getAddress()); });
-                inst->setTargetVAddr(addrs.front());
-                // For misaligns, more than 1 address is provided
-                // inst->setVAddrVector(std::move(addrs));
+                // For misaligns, more than 1 address is provided.  Only
+                // the first is modeled, so the others are not copied
+                inst->setTargetVAddr(mem_accesses.begin()->getAddress());
             }
             if (next_it_->isBranch())
             {
@@ -268,4 +526,197 @@ namespace olympia
         return nullptr;
     }
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Asynchronous STF Inst Generator
+    AsyncTraceInstGenerator::AsyncTraceInstGenerator(MavisType* mavis_facade,
+                                                     const std::string & filename,
+                                                     const bool skip_nonuser_mode,
+                                                     const uint32_t ring_size,
+                                                     const uint32_t rewind_window) :
+        InstGenerator(mavis_facade),
+        reader_(openSTFReader(filename, skip_nonuser_mode)),
+        ring_(ring_size),
+        rewind_window_(rewind_window)
+    {
+        sparta_assert(rewind_window_ < ring_size,
+                      "The STF rewind window (" << rewind_window_
+                      << ") must be smaller than the STF ring size (" << ring_size << ")");
+        producer_ = std::thread(&AsyncTraceInstGenerator::produceRecords_, this);
+    }
+
+    AsyncTraceInstGenerator::~AsyncTraceInstGenerator()
+    {
+        stop_producer_.store(true, std::memory_order_relaxed);
+        if (producer_.joinable())
+        {
+            producer_.join();
+        }
+    }
+
+    void AsyncTraceInstGenerator::produceRecords_()
+    {
+        try
+        {
+            for (auto stf_it = reader_->begin(); stf_it != reader_->end(); ++stf_it)
+            {
+                TraceRecord record;
+                record.opcode = stf_it->opcode();
+                record.pc = stf_it->pc();
+                record.stf_index = stf_it->index();
+                if (const auto & mem_accesses = stf_it->getMemoryAccesses(); !mem_accesses.empty())
+                {
+                    // For misaligns, more than 1 address is provided; only
+                    // the first is used by the model
+                    record.target_vaddr = mem_accesses.front().getAddress();
+                    record.has_target = true;
+                }
+                if (stf_it->isBranch())
+                {
+                    record.is_branch = true;
+                    record.is_taken_branch = stf_it->isTakenBranch();
+                    record.target_vaddr = stf_it->branchTarget();
+                    record.has_target = true;
+                }
+
+                if (false == ring_.tryPush(record))
+                {
+                    // One stall per wait on a full ring, however long
+                    producer_stalls_.fetch_add(1, std::memory_order_relaxed);
+                    while (false == ring_.tryPush(record))
+                    {
+                        if (stop_producer_.load(std::memory_order_relaxed))
+                        {
+                            return;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            producer_error_ = std::current_exception();
+        }
+        producer_done_.store(true, std::memory_order_release);
+    }
+
+    bool AsyncTraceInstGenerator::isDone() const
+    {
+        return producer_done_.load(std::memory_order_acquire) && (next_seq_ == ring_.getProduced());
+    }
+
+    void AsyncTraceInstGenerator::reset(const InstPtr & inst_ptr, const bool skip = false)
+    {
+        const uint64_t rewind_seq = inst_ptr->getRewindIterator<uint64_t>() + (skip ? 1 : 0);
+        if (SPARTA_EXPECT_FALSE(rewind_seq < ring_.getReleased()))
+        {
+            throw sparta::SpartaException("ERROR: a flush rewinds the STF trace ")
+                << (next_seq_ - rewind_seq) << " records, past the " << rewind_window_
+                << " kept for rewinds.  Increase the fetch parameter "
+                   "async_trace_rewind_window, and async_trace_ring_size with it";
+        }
+        next_seq_ = rewind_seq;
+        program_id_ = inst_ptr->getProgramID() + (skip ? 1 : 0);
+    }
+
+    bool AsyncTraceInstGenerator::waitForNextRecord_()
+    {
+        // Wait on the producer if it has not caught up yet.  One
+        // stall per wait, however long
+        bool stalled = false;
+        while (next_seq_ == ring_.getProduced())
+        {
+            if (producer_done_.load(std::memory_order_acquire))
+            {
+                if (SPARTA_EXPECT_FALSE(producer_error_ != nullptr))
+                {
+                    std::rethrow_exception(producer_error_);
+                }
+                return (next_seq_ != ring_.getProduced());
+            }
+            consumer_stalls_ += stalled ? 0 : 1;
+            stalled = true;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void AsyncTraceInstGenerator::releaseRecords_()
+    {
+        // Keep the last rewind_window_ records around for flushes
+        if ((next_seq_ > rewind_window_) && ((next_seq_ - rewind_window_) > ring_.getReleased()))
+        {
+            ring_.release(next_seq_ - rewind_window_);
+        }
+    }
+
+    uint64_t AsyncTraceInstGenerator::skip(const uint64_t num_insts,
+                                           const WarmingCallback & warm)
+    {
+        uint64_t skipped = 0;
+        while ((skipped < num_insts) && waitForNextRecord_())
+        {
+            const uint64_t available = std::min(ring_.getProduced() - next_seq_,
+                                                num_insts - skipped);
+            if (warm)
+            {
+                for (uint64_t seq = next_seq_; seq < (next_seq_ + available); ++seq)
+                {
+                    const TraceRecord & record = ring_.at(seq);
+                    WarmingRecord warming_record;
+                    warming_record.pc = record.pc;
+                    warming_record.opcode = record.opcode;
+                    warming_record.is_mem_access = record.has_target && !record.is_branch;
+                    warming_record.mem_vaddr = record.target_vaddr;
+                    warming_record.is_branch = record.is_branch;
+                    warming_record.is_taken_branch = record.is_taken_branch;
+                    warming_record.branch_target = record.target_vaddr;
+                    warm(warming_record);
+                }
+            }
+            next_seq_ += available;
+            skipped += available;
+            releaseRecords_();
+        }
+        return skipped;
+    }
+
+    InstPtr AsyncTraceInstGenerator::getNextInst(const sparta::Clock* clk)
+    {
+        if (false == waitForNextRecord_())
+        {
+            return nullptr;
+        }
+
+        const TraceRecord & record = ring_.at(next_seq_);
+
+        try
+        {
+            InstPtr inst = makeInst_(record.opcode, clk);
+            inst->setPC(record.pc);
+            inst->setUniqueID(++unique_id_);
+            inst->setProgramID(program_id_++);
+            inst->setRewindIterator<uint64_t>(next_seq_);
+            if (record.has_target)
+            {
+                inst->setTargetVAddr(record.target_vaddr);
+            }
+            if (record.is_branch)
+            {
+                inst->setTakenBranch(record.is_taken_branch);
+            }
+            ++next_seq_;
+            releaseRecords_();
+            return inst;
+        }
+        catch (std::exception & excpt)
+        {
+            std::cerr << "ERROR: Mavis failed decoding: 0x" << std::hex << record.opcode
+                      << " for STF It PC: 0x" << record.pc << " STFID: " << std::dec
+                      << record.stf_index << " err: " << excpt.what() << std::endl;
+            throw;
+        }
+        return nullptr;
+    }
+
 } // namespace olympia
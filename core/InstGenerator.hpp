@@ -7,19 +7,24 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
+#include "DecodedTrace.hpp"
+#include "FunctionalWarming.hpp"
 #include "Inst.hpp"
 #include "MavisUnit.hpp"
+#include "SPSCRing.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
 
 #include "stf-inc/stf_inst_reader.hpp"
 
-namespace nlohmann {
-    using json = class nlohmann::basic_json<>;
-}
-
 namespace olympia
 {
     /*
@@ -36,14 +41,53 @@ namespace olympia
         InstGenerator(MavisType * mavis_facade) : mavis_facade_(mavis_facade) {}
         virtual ~InstGenerator() {}
         virtual InstPtr getNextInst(const sparta::Clock * clk) = 0;
+        // If async_ring_size is non-zero, STF traces are read on a
+        // background thread through a ring of that many records
         static std::unique_ptr<InstGenerator> createGenerator(MavisType * mavis_facade,
                                                               const std::string & filename,
-                                                              const bool skip_nonuser_mode);
+                                                              const bool skip_nonuser_mode,
+                                                              const uint32_t async_ring_size = 0,
+                                                              const uint32_t async_rewind_window = 0);
         virtual bool isDone() const = 0;
         virtual void reset(const InstPtr &, const bool) = 0;
 
+        // Consume up to num_insts instructions from the workload
+        // without building them (fast-forward).  Program IDs are not
+        // advanced; they only number the instructions simulated in
+        // detail.  If given, warm is called with each skipped
+        // instruction's memory access and branch outcome.  Returns
+        // the number of instructions skipped
+        using WarmingCallback = std::function<void(WarmingRecord &)>;
+        virtual uint64_t skip(const uint64_t num_insts, const WarmingCallback & warm = nullptr) = 0;
+
+        // Number of times a background trace reader waited on a full
+        // ring (producer) or the simulator waited on an empty one
+        // (consumer).  A wait counts once, however long it spins
+        virtual uint64_t getProducerStalls() const { return 0; }
+        virtual uint64_t getConsumerStalls() const { return 0; }
+
+        // Hand out the next instruction unique ID.  Used when an
+        // instruction is rebuilt outside of the generator
+        uint64_t getNextUniqueID() { return ++unique_id_; }
+
+        // Program ID the next instruction from the generator will get
+        uint64_t getNextProgramID() const { return program_id_; }
+
+        // Decode opcodes through the given unit's decode cache
+        // instead of going to the Mavis facade directly
+        void setMavisUnit(MavisUnit * mavis_unit) { mavis_unit_ = mavis_unit; }
+
     protected:
+        InstPtr makeInst_(const uint64_t opcode, const sparta::Clock * clk)
+        {
+            if (mavis_unit_ != nullptr) {
+                return mavis_unit_->makeInst(opcode, clk);
+            }
+            return mavis_facade_->makeInst(opcode, clk);
+        }
+
         MavisType * mavis_facade_ = nullptr;
+        MavisUnit * mavis_unit_ = nullptr;
         uint64_t    unique_id_ = 0;
         uint64_t    program_id_ = 1;
     };
@@ -58,12 +102,49 @@ namespace olympia
 
         bool isDone() const override final;
         void reset(const InstPtr &, const bool) override final;
+        uint64_t skip(const uint64_t num_insts, const WarmingCallback & warm) override final;
 
 
     private:
-        std::unique_ptr<nlohmann::json> jobj_;
-        uint64_t                        curr_inst_index_ = 0;
-        uint64_t                        n_insts_ = 0;
+        // An operand of a JSON instruction given by mnemonic
+        struct JSONOperand
+        {
+            mavis::InstMetaData::OperandFieldID field_id;
+            mavis::InstMetaData::OperandTypes   type;
+            uint64_t                            value;
+        };
+
+        // One JSON instruction, compiled at construction so that
+        // getNextInst never touches the JSON DOM.  Either opcode
+        // is decoded, or the instruction is built directly from
+        // the Mavis UID and the operands
+        struct JSONInstRecord
+        {
+            uint64_t                   opcode = 0;
+            mavis::InstructionUniqueID uid = 0;
+            uint64_t                   imm = 0;
+            uint64_t                   vaddr = 0;
+            uint64_t                   vl = 0;
+            uint32_t                   sew = 0;
+            uint32_t                   lmul = 0;
+            std::array<JSONOperand, 6> srcs;
+            std::array<JSONOperand, 3> dests;
+            uint8_t                    num_srcs = 0;
+            uint8_t                    num_dests = 0;
+            bool                       has_opcode = false;
+            bool                       has_imm = false;
+            bool                       has_vaddr = false;
+            bool                       has_vtype = false;
+            bool                       has_vta = false;
+            bool                       vta = false;
+            bool                       has_vl = false;
+            bool                       has_taken = false;
+            bool                       taken = false;
+        };
+
+        std::vector<JSONInstRecord> records_;
+        uint64_t                    curr_inst_index_ = 0;
+        uint64_t                    n_insts_ = 0;
     };
 
     // Generates instructions from an STF Trace file
@@ -81,10 +162,96 @@ namespace olympia
 
         bool isDone() const override final;
         void reset(const InstPtr &, const bool) override final;
+        uint64_t skip(const uint64_t num_insts, const WarmingCallback & warm) override final;
     private:
         std::unique_ptr<stf::STFInstReader> reader_;
 
         // Always points to the *next* stf inst
         stf::STFInstReader::iterator next_it_;
     };
+
+    // Generates instructions from a memory-mapped pre-decoded trace
+    // file (see DecodedTrace.hpp)
+    class DecodedTraceInstGenerator : public InstGenerator
+    {
+    public:
+        DecodedTraceInstGenerator(MavisType * mavis_facade,
+                                  const std::string & filename);
+
+        InstPtr getNextInst(const sparta::Clock * clk) override final;
+
+        bool isDone() const override final;
+        void reset(const InstPtr &, const bool) override final;
+        uint64_t skip(const uint64_t num_insts, const WarmingCallback & warm) override final;
+
+    private:
+        DecodedTraceReader reader_;
+        uint64_t           curr_inst_index_ = 0;
+    };
+
+    // Generates instructions from an STF Trace file that is read
+    // ahead of the simulation on a background thread
+    class AsyncTraceInstGenerator : public InstGenerator
+    {
+    public:
+        // The producer thread fills a ring of ring_size records.  The
+        // last rewind_window consumed records are kept readable so
+        // that the generator can be reset() to them after a flush
+        AsyncTraceInstGenerator(MavisType * mavis_facade,
+                                const std::string & filename,
+                                const bool skip_nonuser_mode,
+                                const uint32_t ring_size,
+                                const uint32_t rewind_window);
+
+        ~AsyncTraceInstGenerator();
+
+        InstPtr getNextInst(const sparta::Clock * clk) override final;
+
+        bool isDone() const override final;
+        void reset(const InstPtr &, const bool) override final;
+        uint64_t skip(const uint64_t num_insts, const WarmingCallback & warm) override final;
+
+        uint64_t getProducerStalls() const override final {
+            return producer_stalls_.load(std::memory_order_relaxed);
+        }
+        uint64_t getConsumerStalls() const override final { return consumer_stalls_; }
+
+    private:
+        // Everything Fetch needs from an STF record, read ahead by
+        // the producer thread
+        struct TraceRecord
+        {
+            uint64_t               opcode = 0;
+            sparta::memory::addr_t pc = 0;
+            sparta::memory::addr_t target_vaddr = 0;
+            uint64_t               stf_index = 0;
+            bool                   has_target = false;
+            bool                   is_branch = false;
+            bool                   is_taken_branch = false;
+        };
+
+        // Producer thread body
+        void produceRecords_();
+
+        // Wait until the record at next_seq_ is available.  Returns
+        // false if the trace is exhausted
+        bool waitForNextRecord_();
+
+        // Release records older than the rewind window to the producer
+        void releaseRecords_();
+
+        std::unique_ptr<stf::STFInstReader> reader_;
+        SPSCRing<TraceRecord> ring_;
+        const uint64_t rewind_window_;
+
+        // Sequence number of the *next* record to hand to Fetch
+        uint64_t next_seq_ = 0;
+
+        uint64_t consumer_stalls_ = 0;
+        std::atomic<uint64_t> producer_stalls_{0};
+        std::atomic<bool> producer_done_{false};
+        std::atomic<bool> stop_producer_{false};
+        std::exception_ptr producer_error_;
+        std::thread producer_;
+    };
 }
@@ -2,10 +2,13 @@
 
 #pragma once
 
-#include <vector>
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <iterator>
 #include "CoreTypes.hpp"
 
+#include "sparta/simulation/TreeNode.hpp"
 #include "sparta/utils/LogUtils.hpp"
 #include "sparta/utils/SpartaSharedPointer.hpp"
 #include "sparta/utils/SpartaSharedPointerAllocator.hpp"
@@ -17,37 +20,62 @@ namespace olympia
     //! \brief An instruction group is the data type passed between units
     //!
     //! It's faster/easier to copy pointers to an instruction group
-    //! than to pass copies of the vectors contained
+    //! than to pass copies of the vectors contained.  The instructions
+    //! are held inline, up to the widest stage the model supports, so
+    //! a group never touches the heap; groups themselves come from
+    //! instgroup_allocator and are recycled as stages release them
     class InstGroup
     {
-        using InstVector = std::vector<InstQueue::value_type>;
     public:
-        using iterator       = InstVector::iterator;
-        using const_iterator = InstVector::const_iterator;
+        //! Most instructions in a group: the widest fetch, decode,
+        //! rename or dispatch width
+        static constexpr uint32_t MAX_WIDTH = 16;
+
+        //! Parameter validation callback: a stage that sends up to
+        //! width instructions per group must fit them in one
+        static bool fitsWidth(uint32_t & width, const sparta::TreeNode *) {
+            return width <= MAX_WIDTH;
+        }
+
+    private:
+        using InstArray = std::array<InstQueue::value_type, MAX_WIDTH>;
+
+    public:
+        using iterator       = InstArray::iterator;
+        using const_iterator = InstArray::const_iterator;
 
         void emplace_back(const typename InstQueue::value_type & inst) {
-            insts_.emplace_back(inst);
+            sparta_assert(size_ < MAX_WIDTH,
+                          "Instruction group is full: stage widths are limited to "
+                          << MAX_WIDTH);
+            insts_[size_++] = inst;
         }
 
         iterator erase(iterator first, iterator last) {
-            return insts_.erase(first, last);
+            const iterator new_end = std::move(last, end(), first);
+            for(auto it = new_end; it != end(); ++it) {
+                it->reset();
+            }
+            size_ -= static_cast<uint32_t>(std::distance(first, last));
+            return first;
         }
 
         iterator erase(iterator pos) {
-            return insts_.erase(pos);
+            return erase(pos, std::next(pos));
         }
 
         iterator begin() { return insts_.begin(); }
-        iterator end()   { return insts_.end(); }
+        iterator end()   { return insts_.begin() + size_; }
 
         const_iterator begin() const { return insts_.begin(); }
-        const_iterator end()   const { return insts_.end(); }
+        const_iterator end()   const { return insts_.begin() + size_; }
 
-        std::size_t size() const  { return insts_.size(); }
-        bool        empty() const { return insts_.empty(); }
+        std::size_t size() const  { return size_; }
+        bool        empty() const { return size_ == 0; }
 
     private:
-        InstVector insts_;
+        InstArray insts_;
+        uint32_t  size_ = 0;
     };
     extern sparta::SpartaSharedPointerAllocator<InstGroup> instgroup_allocator;
     using InstGroupPtr = sparta::SpartaSharedPointer<InstGroup>;
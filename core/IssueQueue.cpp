@@ -11,7 +11,8 @@ namespace olympia
         sparta::Unit(node),
         ready_queue_(IssueQueueSorter(&iq_sorter)),
         scheduler_size_(p->scheduler_size),
-        in_order_issue_(p->in_order_issue)
+        in_order_issue_(p->in_order_issue),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         in_execute_inst_.registerConsumerHandler(
             CREATE_SPARTA_HANDLER_WITH_DATA(IssueQueue, receiveInstsFromDispatch_, InstPtr));
@@ -23,6 +24,8 @@ namespace olympia
         node->getParent()->registerForNotification<bool, IssueQueue, &IssueQueue::onROBTerminate_>(
             this, "rob_stopped_notif_channel", false /* ROB maybe not be constructed yet */);
         iq_sorter.setSorting(p->in_order_issue);
+        issue_queue_.reserve(scheduler_size_);
+        ready_queue_.reserve(scheduler_size_);
     }
 
     void IssueQueue::setupIssueQueue_()
@@ -97,7 +100,7 @@ namespace olympia
 
     void IssueQueue::handleOperandIssueCheck_(const InstPtr & ex_inst)
     {
-        const auto srcs = ex_inst->getRenameData().getSourceList();
+        const auto & srcs = ex_inst->getRenameData().getSourceList();
 
         // Lambda function to check if a source is ready.
         // Returns true if source is ready.
@@ -183,9 +186,8 @@ namespace olympia
                 {
                     ILOG("Sending instruction " << inst << " to exe_pipe " << exe_pipe->getName())
                     exe_pipe->insertInst(inst);
-                    auto delete_iter = inst_itr++;
                     sent = true;
-                    ready_queue_.erase(delete_iter);
+                    inst_itr = ready_queue_.erase(inst_itr);
                     popIssueQueue_(inst);
                     ++total_insts_issued_;
                     break;
@@ -205,15 +207,21 @@ namespace olympia
         auto issue_queue_iter = issue_queue_.begin();
         while (issue_queue_iter != issue_queue_.end())
         {
-            auto delete_iter = issue_queue_iter++;
-
-            auto inst_ptr = *delete_iter;
+            auto inst_ptr = *issue_queue_iter;
 
             // Remove flushed instruction from issue queue and clear scoreboard
             // callbacks
-            if (criteria.includedInFlush(inst_ptr))
+            if (!criteria.includedInFlush(inst_ptr))
+            {
+                ++issue_queue_iter;
+            }
+            else
             {
-                issue_queue_.erase(delete_iter);
+                issue_queue_iter = issue_queue_.erase(issue_queue_iter);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::FLUSH, inst_ptr);
+                }
 
                 scoreboard_views_[core_types::RegFile::RF_INTEGER]->clearCallbacks(
                     inst_ptr->getUniqueID());
@@ -235,20 +243,23 @@ namespace olympia
         auto ready_queue_iter = ready_queue_.begin();
         while (ready_queue_iter != ready_queue_.end())
         {
-            auto delete_iter = ready_queue_iter++;
-            auto inst_ptr = *delete_iter;
+            auto inst_ptr = *ready_queue_iter;
             if (criteria.includedInFlush(inst_ptr))
             {
-                ready_queue_.erase(delete_iter);
+                ready_queue_iter = ready_queue_.erase(ready_queue_iter);
                 ILOG("Flush Instruction ID: " << inst_ptr->getUniqueID() << " from ready queue");
             }
+            else
+            {
+                ++ready_queue_iter;
+            }
         }
     }
 
     // Append instruction into issue queue
     void IssueQueue::appendIssueQueue_(const InstPtr & inst_ptr)
     {
-        sparta_assert(issue_queue_.size() <= scheduler_size_,
+        sparta_assert(issue_queue_.size() < scheduler_size_,
                       "Appending issue queue causes overflows!");
 
         issue_queue_.emplace_back(inst_ptr);
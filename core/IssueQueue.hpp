@@ -15,12 +15,13 @@
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/simulation/Unit.hpp"
 
-#include "sparta/resources/PriorityQueue.hpp"
 
 #include "CoreTypes.hpp"
 #include "ExecutePipe.hpp"
 #include "FlushManager.hpp"
 #include "Inst.hpp"
+#include "PipelineEventLog.hpp"
+#include "VectorPriorityQueue.hpp"
 
 namespace olympia
 {
@@ -125,13 +126,18 @@ namespace olympia
         std::vector<olympia::ExecutePipe*> pipes_;
         std::vector<std::string> exe_unit_str_;
         IssueQueueSorter iq_sorter;
-        sparta::PriorityQueue<InstPtr, IssueQueueSorter>
-            ready_queue_;                // queue for instructions that have operands ready
-        std::list<InstPtr> issue_queue_; // instructions that have been sent from dispatch,
-                                         // not ready yet
+        // queue for instructions that have operands ready.  Reserved to
+        // the scheduler size: never reallocates
+        VectorPriorityQueue<InstPtr, IssueQueueSorter> ready_queue_;
+        // instructions that have been sent from dispatch, not ready
+        // yet.  Reserved to the scheduler size: never reallocates
+        std::vector<InstPtr> issue_queue_;
 
         const uint32_t scheduler_size_;
         const bool in_order_issue_;
+
+        // Pipeline event log, or nullptr
+        PipelineEventLog::Buffer* const event_log_;
         sparta::Counter total_insts_issued_{getStatisticSet(), "total_insts_issued",
                                             "Total instructions issued",
                                             sparta::Counter::COUNT_NORMAL};
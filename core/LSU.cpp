@@ -22,9 +22,9 @@ namespace olympia
         replay_issue_delay_(p->replay_issue_delay),
         ready_queue_(),
         load_store_info_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(node))
-                                       ->load_store_info_allocator),
+                                       ->getLoadStoreInfoAllocator()),
         memory_access_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(node))
-                                     ->memory_access_allocator),
+                                     ->getMemoryAccessAllocator()),
         address_calculation_stage_(0),
         mmu_lookup_stage_(address_calculation_stage_ + p->mmu_lookup_stage_length),
         cache_lookup_stage_(mmu_lookup_stage_ + p->cache_lookup_stage_length),
@@ -35,7 +35,8 @@ namespace olympia
             + p->cache_read_stage_length), // Complete stage is after the cache read stage
         ldst_pipeline_("LoadStorePipeline", (complete_stage_ + 1),
                        getClock()), // complete_stage_ + 1 is number of stages
-        allow_speculative_load_exec_(p->allow_speculative_load_exec)
+        allow_speculative_load_exec_(p->allow_speculative_load_exec),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         sparta_assert(p->mmu_lookup_stage_length > 0,
                       "MMU lookup stage should atleast be one cycle");
@@ -44,6 +45,10 @@ namespace olympia
         sparta_assert(p->cache_lookup_stage_length > 0,
                       "Cache lookup stage should atleast be one cycle");
 
+        // Everything in the ready queue is in the inst queue or the
+        // replay buffer
+        ready_queue_.reserve(ldst_inst_queue_size_ + replay_buffer_size_);
+
         // Pipeline collection config
         ldst_pipeline_.enableCollection(node);
         ldst_inst_queue_.enableCollection(node);
@@ -468,6 +473,10 @@ namespace olympia
         {
             ILOG("Store marked as completed " << inst_ptr);
             inst_ptr->setStatus(Inst::Status::COMPLETED);
+            if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+            {
+                event_log_->record(PipelineEventType::COMPLETE, inst_ptr);
+            }
             load_store_info_ptr->setState(LoadStoreInstInfo::IssueState::READY);
             ldst_pipeline_.invalidateStage(cache_lookup_stage_);
             if (allow_speculative_load_exec_)
@@ -687,6 +696,10 @@ namespace olympia
 
             // Mark instruction as completed
             inst_ptr->setStatus(Inst::Status::COMPLETED);
+            if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+            {
+                event_log_->record(PipelineEventType::COMPLETE, inst_ptr);
+            }
 
             // Remove completed instruction from queues
             ILOG("Removed issue queue " << inst_ptr);
@@ -1144,6 +1157,10 @@ namespace olympia
 
                 // Update instruction status
                 inst_ptr->setStatus(Inst::Status::SCHEDULED);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::ISSUE, inst_ptr);
+                }
                 return;
             }
         }
@@ -1278,6 +1295,10 @@ namespace olympia
             if (criteria.includedInFlush(inst_ptr))
             {
                 ldst_inst_queue_.erase(delete_iter);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::FLUSH, inst_ptr);
+                }
 
                 // Clear any scoreboard callback
                 std::vector<core_types::RegFile> reg_files = {core_types::RF_INTEGER,
@@ -1334,13 +1355,15 @@ namespace olympia
         {
             auto inst_ptr = (*iter)->getInstPtr();
 
-            auto delete_iter = iter++;
-
             if (criteria.includedInFlush(inst_ptr))
             {
-                ready_queue_.erase(delete_iter);
+                iter = ready_queue_.erase(iter);
                 ILOG("Flushing from ready queue - Instruction ID: " << inst_ptr->getUniqueID());
             }
+            else
+            {
+                ++iter;
+            }
         }
     }
 
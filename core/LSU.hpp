@@ -13,7 +13,6 @@
 #include "sparta/events/StartupEvent.hpp"
 #include "sparta/resources/Pipeline.hpp"
 #include "sparta/resources/Buffer.hpp"
-#include "sparta/resources/PriorityQueue.hpp"
 #include "sparta/pairs/SpartaKeyPairs.hpp"
 #include "sparta/simulation/State.hpp"
 #include "sparta/utils/SpartaSharedPointer.hpp"
@@ -29,11 +28,14 @@
 #include "MemoryAccessInfo.hpp"
 #include "LoadStoreInstInfo.hpp"
 #include "MMU.hpp"
+#include "PipelineEventLog.hpp"
 #include "DCache.hpp"
+#include "RuntimeTunable.hpp"
+#include "VectorPriorityQueue.hpp"
 
 namespace olympia
 {
-    class LSU : public sparta::Unit
+    class LSU : public sparta::Unit, public RuntimeTunableIF
     {
       public:
         /*!
@@ -73,6 +75,17 @@ namespace olympia
         //! name of this resource.
         static const char name[];
 
+        //! The replay delay can change after warm-up
+        std::vector<std::string> getTunableParameters() const override
+        {
+            return {"replay_issue_delay"};
+        }
+
+        void tune(const std::string & param_name, const std::string & value) override
+        {
+            replay_issue_delay_ = parseTunable<uint32_t>(param_name, value);
+        }
+
         ////////////////////////////////////////////////////////////////////////////////
         // Type Name/Alias Declaration
         ////////////////////////////////////////////////////////////////////////////////
@@ -135,9 +148,9 @@ namespace olympia
 
         sparta::Buffer<LoadStoreInstInfoPtr> replay_buffer_;
         const uint32_t replay_buffer_size_;
-        const uint32_t replay_issue_delay_;
+        uint32_t replay_issue_delay_;
 
-        sparta::PriorityQueue<LoadStoreInstInfoPtr> ready_queue_;
+        VectorPriorityQueue<LoadStoreInstInfoPtr> ready_queue_;
         // MMU unit
         bool mmu_busy_ = false;
 
@@ -170,6 +183,9 @@ namespace olympia
         // LSU Microarchitecture parameters
         const bool allow_speculative_load_exec_;
 
+        // Where issued and completed instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
         // ROB stopped simulation early, transactions could still be inflight.
         bool rob_stopped_simulation_ = false;
 
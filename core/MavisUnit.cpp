@@ -78,22 +78,136 @@ namespace olympia
                                      getUArchFiles(n, p, p->uarch_file_path, pseudo_file_path_),
                                      mavis_uid_list_, getUArchAnnotationOverrides(p),
                                      InstPtrAllocator<InstAllocator>
-                                     (sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->inst_allocator),
+                                     (sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->getInstAllocator()),
                                      InstPtrAllocator<InstArchInfoAllocator>
-                                     (sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->inst_arch_info_allocator)))
-    {}
+                                     (sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->getInstArchInfoAllocator()))),
+        decode_cache_size_(p->decode_cache_size),
+        inst_allocator_(sparta::notNull(OlympiaAllocators::getOlympiaAllocators(n))->getInstAllocator())
+    {
+        decode_entries_.resize(decode_cache_size_);
+        uint32_t num_buckets = 1;
+        while (num_buckets < (2 * decode_cache_size_)) {
+            num_buckets <<= 1;
+        }
+        decode_buckets_.assign(num_buckets, NO_ENTRY);
+    }
 
     /**
      * \brief Destruct a mavis unit
      */
     MavisUnit::~MavisUnit() {}
 
+    /**
+     * \brief Decode an opcode, using the decode cache if enabled
+     * \param opcode The opcode to decode
+     * \param clk    Clock for the new instruction
+     * \return A newly allocated instruction
+     */
+    InstPtr MavisUnit::makeInst(const uint64_t opcode, const sparta::Clock * clk)
+    {
+        if (decode_cache_size_ == 0) {
+            return mavis_facade_->makeInst(opcode, clk);
+        }
+
+        uint32_t & bucket = decodeBucket_(opcode);
+        for (uint32_t idx = bucket; idx != NO_ENTRY; idx = decode_entries_[idx].bucket_next)
+        {
+            if (decode_entries_[idx].opcode == opcode)
+            {
+                ++decode_cache_hits_;
+                unlinkLRU_(idx);
+                pushLRUFront_(idx);
+                const DecodedOpcode & decoded = decode_entries_[idx].decoded;
+                return sparta::allocate_sparta_shared_pointer<Inst>(inst_allocator_,
+                                                                    decoded.first, decoded.second, clk);
+            }
+        }
+
+        ++decode_cache_misses_;
+        InstPtr inst = mavis_facade_->makeInst(opcode, clk);
+
+        // A free entry, or the least recently used one
+        uint32_t idx = decode_entries_used_;
+        if (decode_entries_used_ < decode_cache_size_) {
+            ++decode_entries_used_;
+        }
+        else
+        {
+            ++decode_cache_evictions_;
+            idx = decode_lru_tail_;
+            unlinkLRU_(idx);
+            uint32_t * link = &decodeBucket_(decode_entries_[idx].opcode);
+            while (*link != idx) {
+                link = &decode_entries_[*link].bucket_next;
+            }
+            *link = decode_entries_[idx].bucket_next;
+        }
+
+        DecodeCacheEntry & entry = decode_entries_[idx];
+        entry.opcode = opcode;
+        entry.decoded = DecodedOpcode(inst->getOpCodeInfo(), inst->getInstArchInfo());
+        entry.bucket_next = bucket;
+        bucket = idx;
+        pushLRUFront_(idx);
+        return inst;
+    }
+
+    uint32_t & MavisUnit::decodeBucket_(const uint64_t opcode)
+    {
+        // Fibonacci hashing spreads the opcode bits over the index
+        const uint64_t hash = opcode * 0x9e3779b97f4a7c15ull;
+        return decode_buckets_[(hash >> 32) & (decode_buckets_.size() - 1)];
+    }
+
+    void MavisUnit::unlinkLRU_(const uint32_t idx)
+    {
+        DecodeCacheEntry & entry = decode_entries_[idx];
+        if (entry.lru_prev != NO_ENTRY) {
+            decode_entries_[entry.lru_prev].lru_next = entry.lru_next;
+        }
+        else {
+            decode_lru_head_ = entry.lru_next;
+        }
+        if (entry.lru_next != NO_ENTRY) {
+            decode_entries_[entry.lru_next].lru_prev = entry.lru_prev;
+        }
+        else {
+            decode_lru_tail_ = entry.lru_prev;
+        }
+        entry.lru_prev = NO_ENTRY;
+        entry.lru_next = NO_ENTRY;
+    }
+
+    void MavisUnit::pushLRUFront_(const uint32_t idx)
+    {
+        DecodeCacheEntry & entry = decode_entries_[idx];
+        entry.lru_prev = NO_ENTRY;
+        entry.lru_next = decode_lru_head_;
+        if (decode_lru_head_ != NO_ENTRY) {
+            decode_entries_[decode_lru_head_].lru_prev = idx;
+        }
+        else {
+            decode_lru_tail_ = idx;
+        }
+        decode_lru_head_ = idx;
+    }
+
     /**
      * \brief Sparta-visible global function to find a mavis node and provide the mavis facade
      * \param node Tree node to start the search (recurses up the tree from here until a mavis unit is found)
      * \return Pointer to Mavis facade object
      */
     MavisType* getMavis(sparta::TreeNode *node)
+    {
+        return getMavisUnit(node)->getFacade();
+    }
+
+    /**
+     * \brief Sparta-visible global function to find a mavis node
+     * \param node Tree node to start the search (recurses up the tree from here until a mavis unit is found)
+     * \return Pointer to the Mavis unit
+     */
+    MavisUnit* getMavisUnit(sparta::TreeNode *node)
     {
         MavisUnit * mavis_unit = nullptr;
         if (node)
@@ -102,12 +216,12 @@ namespace olympia
                 mavis_unit = node->getChild(MavisUnit::name)->getResourceAs<MavisUnit>();
             }
             else {
-                return getMavis(node->getParent());
+                return getMavisUnit(node->getParent());
             }
         }
         sparta_assert(mavis_unit != nullptr, "Mavis unit was not found");
         // cppcheck-suppress nullPointer
-        return mavis_unit->getFacade();
+        return mavis_unit;
     }
 
 } // namespace olympia
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include <cinttypes>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "sparta/utils/SpartaSharedPointer.hpp"
@@ -15,6 +18,7 @@
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/ResourceFactory.hpp"
 #include "sparta/simulation/ResourceFactory.hpp"
+#include "sparta/statistics/Counter.hpp"
 
 #include "mavis/DecoderTypes.h"
 
@@ -58,6 +62,8 @@ namespace olympia
     Format : <mnemonic>, <attribute> : <value>
     Example: -p .....params.uarch_overrides "[ "add, latency : 100", "lw, dispatch : ["iex","lsu"] ]"
 ")")
+            PARAMETER(uint32_t, decode_cache_size, 4096,
+                      "Number of decoded opcodes kept by makeInst (LRU).  0 disables the cache")
         };
 
         static constexpr char name[] = "mavis";
@@ -81,6 +87,17 @@ namespace olympia
             return mavis_facade_.get();
         }
 
+        /**
+         * \brief Decode an opcode into a new instruction
+         * \param opcode The opcode to decode
+         * \param clk    The clock the instruction is created on
+         *
+         * Same as MavisType::makeInst, but the decoded OpcodeInfo and
+         * InstArchInfo pair is looked up in an opcode-keyed cache
+         * first.  On a hit only the Inst itself is allocated.
+         */
+        InstPtr makeInst(const uint64_t opcode, const sparta::Clock * clk);
+
     private:
 
         //! Mavis Instruction ID's that we want to use in Olympia
@@ -90,6 +107,51 @@ namespace olympia
 
         const std::string          pseudo_file_path_; ///< Path to olympia pseudo ISA/uArch JSON files
         std::unique_ptr<MavisType> mavis_facade_;     ///< Mavis facade object
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // Decode cache
+
+        //! The static (shared) decode information of an opcode
+        using DecodedOpcode = std::pair<mavis::OpcodeInfo::PtrType, InstArchInfo::PtrType>;
+
+        static constexpr uint32_t NO_ENTRY = std::numeric_limits<uint32_t>::max();
+
+        //! A cache entry, linked into the LRU order and into the
+        //! chain of its hash bucket.  Entries are allocated once, when
+        //! the unit is built, so a miss does not allocate
+        struct DecodeCacheEntry
+        {
+            uint64_t opcode = 0;
+            DecodedOpcode decoded;
+            uint32_t lru_prev = NO_ENTRY;
+            uint32_t lru_next = NO_ENTRY;
+            uint32_t bucket_next = NO_ENTRY;
+        };
+
+        uint32_t & decodeBucket_(const uint64_t opcode);
+        void unlinkLRU_(const uint32_t idx);
+        void pushLRUFront_(const uint32_t idx);
+
+        const uint32_t decode_cache_size_;
+        InstAllocator & inst_allocator_;
+
+        std::vector<DecodeCacheEntry> decode_entries_;
+        //! Power of 2 number of buckets, at least twice the entries
+        std::vector<uint32_t> decode_buckets_;
+        //! Most recently used entry at the head
+        uint32_t decode_lru_head_ = NO_ENTRY;
+        uint32_t decode_lru_tail_ = NO_ENTRY;
+        uint32_t decode_entries_used_ = 0;
+
+        sparta::Counter decode_cache_hits_{
+            getStatisticSet(), "decode_cache_hits",
+            "Number of opcodes found in the decode cache", sparta::Counter::COUNT_NORMAL};
+        sparta::Counter decode_cache_misses_{
+            getStatisticSet(), "decode_cache_misses",
+            "Number of opcodes decoded by Mavis", sparta::Counter::COUNT_NORMAL};
+        sparta::Counter decode_cache_evictions_{
+            getStatisticSet(), "decode_cache_evictions",
+            "Number of opcodes evicted from the decode cache", sparta::Counter::COUNT_NORMAL};
     };
 
     using MavisFactory = sparta::ResourceFactory<MavisUnit,
@@ -97,4 +159,6 @@ namespace olympia
 
     MavisType *getMavis(sparta::TreeNode *);
 
+    MavisUnit *getMavisUnit(sparta::TreeNode *);
+
 } // namespace olympia
@@ -86,6 +86,14 @@ namespace olympia
         {
         }
 
+        //! An instruction fetch of the line holding fetch_addr.  There
+        //! is no Inst; the address is the (untranslated) PC
+        explicit MemoryAccessInfo(const uint64_t fetch_addr) :
+            MemoryAccessInfo(InstPtr())
+        {
+            fetch_addr_ = fetch_addr;
+        }
+
         virtual ~MemoryAccessInfo() {}
 
         // This Inst pointer will act as our portal to the Inst class
@@ -110,9 +118,18 @@ namespace olympia
 
         bool getPhyAddrStatus() const { return phy_addr_ready_; }
 
-        uint64_t getPhyAddr() const { return ldst_inst_ptr_->getRAdr(); }
+        uint64_t getPhyAddr() const
+        {
+            return (ldst_inst_ptr_ != nullptr) ? ldst_inst_ptr_->getRAdr() : fetch_addr_;
+        }
 
-        sparta::memory::addr_t getVAddr() const { return ldst_inst_ptr_->getTargetVAddr(); }
+        sparta::memory::addr_t getVAddr() const
+        {
+            return (ldst_inst_ptr_ != nullptr) ? ldst_inst_ptr_->getTargetVAddr() : fetch_addr_;
+        }
+
+        //! Is this an instruction fetch?
+        bool isFetch() const { return ldst_inst_ptr_ == nullptr; }
 
         void setSrcUnit(const ArchUnit & src_unit) { src_ = src_unit; }
 
@@ -199,6 +216,9 @@ namespace olympia
         LoadStoreInstIterator issue_queue_iterator_;
         LoadStoreInstIterator replay_queue_iterator_;
         MSHREntryInfoIterator mshr_entry_info_iterator_;
+
+        // Address of an instruction fetch
+        uint64_t fetch_addr_ = 0;
     };
 
     using MemoryAccessInfoPtr = sparta::SpartaSharedPointer<MemoryAccessInfo>;
@@ -279,7 +299,14 @@ namespace olympia
 
     inline std::ostream & operator<<(std::ostream & os, const olympia::MemoryAccessInfo & mem)
     {
-        os << "memptr: " << mem.getInstPtr();
+        if (mem.isFetch())
+        {
+            os << "fetch: 0x" << std::hex << mem.getPhyAddr() << std::dec;
+        }
+        else
+        {
+            os << "memptr: " << mem.getInstPtr();
+        }
         return os;
     }
 
@@ -0,0 +1,256 @@
+// <PipelineEventLog.cpp> -*- C++ -*-
+
+#include "PipelineEventLog.hpp"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    constexpr char PipelineEventLog::name[];
+    constexpr char PipelineEventLog::MAGIC[];
+
+    const char* getPipelineEventTypeName(const PipelineEventType type)
+    {
+        switch (type)
+        {
+        case PipelineEventType::FETCH:
+            return "fetch";
+        case PipelineEventType::DECODE:
+            return "decode";
+        case PipelineEventType::RENAME:
+            return "rename";
+        case PipelineEventType::DISPATCH:
+            return "dispatch";
+        case PipelineEventType::ISSUE:
+            return "issue";
+        case PipelineEventType::COMPLETE:
+            return "complete";
+        case PipelineEventType::RETIRE:
+            return "retire";
+        case PipelineEventType::FLUSH:
+            return "flush";
+        case PipelineEventType::N_TYPES:
+            break;
+        }
+        return "unknown";
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // PipelineEventLog
+
+    PipelineEventLog::PipelineEventLog(sparta::TreeNode* parent, const std::string & filename,
+                                       const uint32_t events_per_unit) :
+        sparta::TreeNode(parent, name, "Binary log of instruction pipeline events"),
+        events_per_unit_(events_per_unit),
+        file_(filename, std::ios::binary | std::ios::trunc),
+        cctx_(ZSTD_createCCtx()),
+        compressed_(ZSTD_CStreamOutSize())
+    {
+        sparta_assert(events_per_unit_ != 0, "A pipeline event buffer needs room for an event");
+        if (!file_)
+        {
+            throw sparta::SpartaException("ERROR: Cannot open the pipeline event log ")
+                << filename;
+        }
+        file_.write(MAGIC, sizeof(MAGIC) - 1);
+    }
+
+    PipelineEventLog::~PipelineEventLog()
+    {
+        writeOut();
+
+        ZSTD_inBuffer input{nullptr, 0, 0};
+        size_t remaining = 0;
+        do
+        {
+            ZSTD_outBuffer output{compressed_.data(), compressed_.size(), 0};
+            remaining = ZSTD_compressStream2(cctx_, &output, &input, ZSTD_e_end);
+            if (ZSTD_isError(remaining))
+            {
+                break;
+            }
+            file_.write(compressed_.data(), output.pos);
+        } while (remaining != 0);
+        ZSTD_freeCCtx(cctx_);
+    }
+
+    PipelineEventLog::Buffer* PipelineEventLog::getBuffer(sparta::TreeNode* node)
+    {
+        for (sparta::TreeNode* n = node; n != nullptr; n = n->getParent())
+        {
+            if (n->hasChild(name))
+            {
+                return n->getChildAs<PipelineEventLog>(name)->addUnit_(node);
+            }
+        }
+        return nullptr;
+    }
+
+    PipelineEventLog::Buffer* PipelineEventLog::addUnit_(sparta::TreeNode* node)
+    {
+        sparta_assert(buffers_.size() < std::numeric_limits<uint16_t>::max(),
+                      "Too many units in the pipeline event log");
+        const std::string location = node->getLocation();
+        const BlockHeader header{UNIT_BLOCK, static_cast<uint32_t>(location.size())};
+        write_(&header, sizeof(header));
+        write_(location.data(), location.size());
+
+        buffers_.emplace_back(new Buffer(this, static_cast<uint16_t>(buffers_.size()),
+                                         node->getClock(), events_per_unit_));
+        return buffers_.back().get();
+    }
+
+    void PipelineEventLog::writeOut()
+    {
+        for (auto & buffer : buffers_)
+        {
+            if (buffer->num_events_ != 0)
+            {
+                const BlockHeader header{EVENTS_BLOCK, buffer->num_events_};
+                write_(&header, sizeof(header));
+                write_(buffer->events_.data(), buffer->num_events_ * sizeof(PipelineEvent));
+                buffer->num_events_ = 0;
+            }
+        }
+        const BlockHeader header{END_OF_WRITE_OUT_BLOCK, 0};
+        write_(&header, sizeof(header));
+    }
+
+    void PipelineEventLog::write_(const void* data, const size_t size)
+    {
+        ZSTD_inBuffer input{data, size, 0};
+        while (input.pos != input.size)
+        {
+            ZSTD_outBuffer output{compressed_.data(), compressed_.size(), 0};
+            const size_t ret = ZSTD_compressStream2(cctx_, &output, &input, ZSTD_e_continue);
+            sparta_assert(!ZSTD_isError(ret),
+                          "Pipeline event log compression failed: " << ZSTD_getErrorName(ret));
+            file_.write(compressed_.data(), output.pos);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // PipelineEventReader
+
+    PipelineEventReader::PipelineEventReader(const std::string & filename) :
+        file_(filename, std::ios::binary),
+        dctx_(ZSTD_createDCtx()),
+        compressed_(ZSTD_DStreamInSize()),
+        decompressed_(ZSTD_DStreamOutSize())
+    {
+        char magic[sizeof(PipelineEventLog::MAGIC) - 1];
+        if (!file_.read(magic, sizeof(magic))
+            || (std::memcmp(magic, PipelineEventLog::MAGIC, sizeof(magic)) != 0))
+        {
+            ZSTD_freeDCtx(dctx_);
+            throw sparta::SpartaException("ERROR: ")
+                << filename << " is not a pipeline event log";
+        }
+    }
+
+    PipelineEventReader::~PipelineEventReader() { ZSTD_freeDCtx(dctx_); }
+
+    bool PipelineEventReader::next(PipelineEvent & event)
+    {
+        while (next_event_ == events_.size())
+        {
+            if (false == readWriteOut_())
+            {
+                return false;
+            }
+        }
+        event = events_[next_event_++];
+        return true;
+    }
+
+    bool PipelineEventReader::readWriteOut_()
+    {
+        events_.clear();
+        next_event_ = 0;
+
+        PipelineEventLog::BlockHeader header;
+        while (read_(&header, sizeof(header)))
+        {
+            switch (header.kind)
+            {
+            case PipelineEventLog::UNIT_BLOCK:
+            {
+                std::string location(header.count, '\0');
+                if (!read_(location.data(), header.count))
+                {
+                    throw sparta::SpartaException("ERROR: Truncated pipeline event log");
+                }
+                units_.emplace_back(std::move(location));
+                break;
+            }
+            case PipelineEventLog::EVENTS_BLOCK:
+            {
+                const size_t first = events_.size();
+                events_.resize(first + header.count);
+                if (!read_(&events_[first], header.count * sizeof(PipelineEvent)))
+                {
+                    throw sparta::SpartaException("ERROR: Truncated pipeline event log");
+                }
+                break;
+            }
+            case PipelineEventLog::END_OF_WRITE_OUT_BLOCK:
+                // Within a cycle, in pipeline order
+                std::stable_sort(events_.begin(), events_.end(),
+                                 [](const PipelineEvent & a, const PipelineEvent & b)
+                                 {
+                                     return (a.cycle != b.cycle) ? (a.cycle < b.cycle)
+                                                                 : (a.type < b.type);
+                                 });
+                return true;
+            default:
+                throw sparta::SpartaException("ERROR: Corrupt pipeline event log: block kind ")
+                    << header.kind;
+            }
+        }
+        return false;
+    }
+
+    bool PipelineEventReader::read_(void* data, size_t size)
+    {
+        char* dest = static_cast<char*>(data);
+        while (size != 0)
+        {
+            if (decompressed_pos_ == decompressed_size_)
+            {
+                if ((compressed_pos_ == compressed_size_) && file_)
+                {
+                    file_.read(compressed_.data(), compressed_.size());
+                    compressed_size_ = file_.gcount();
+                    compressed_pos_ = 0;
+                }
+                ZSTD_inBuffer input{compressed_.data(), compressed_size_, compressed_pos_};
+                ZSTD_outBuffer output{decompressed_.data(), decompressed_.size(), 0};
+                const size_t ret = ZSTD_decompressStream(dctx_, &output, &input);
+                if (ZSTD_isError(ret))
+                {
+                    throw sparta::SpartaException("ERROR: Corrupt pipeline event log: ")
+                        << ZSTD_getErrorName(ret);
+                }
+                compressed_pos_ = input.pos;
+                decompressed_pos_ = 0;
+                decompressed_size_ = output.pos;
+                if ((decompressed_size_ == 0) && (compressed_pos_ == compressed_size_) && !file_)
+                {
+                    return false;
+                }
+            }
+            const size_t n = std::min(size, decompressed_size_ - decompressed_pos_);
+            std::memcpy(dest, decompressed_.data() + decompressed_pos_, n);
+            decompressed_pos_ += n;
+            dest += n;
+            size -= n;
+        }
+        return true;
+    }
+} // namespace olympia
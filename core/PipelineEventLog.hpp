@@ -0,0 +1,196 @@
+// <PipelineEventLog.hpp> -*- C++ -*-
+
+//!
+//! \file PipelineEventLog.hpp
+//! \brief A binary log of instruction pipeline events, cheap enough to
+//!        leave on for whole runs
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+
+#include "Inst.hpp"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace olympia
+{
+    //! What happened to an instruction
+    enum class PipelineEventType : uint8_t
+    {
+        FETCH,
+        DECODE,
+        RENAME,
+        DISPATCH,
+        ISSUE,
+        COMPLETE,
+        RETIRE,
+        FLUSH,
+        N_TYPES
+    };
+
+    const char* getPipelineEventTypeName(const PipelineEventType type);
+
+    //! One event.  Written to the log as is
+    struct PipelineEvent
+    {
+        uint64_t cycle;
+        uint64_t uid;
+        uint64_t pc;
+        uint16_t unit; //!< Index in the log's unit table
+        PipelineEventType type;
+        uint8_t reserved[5];
+    };
+
+    static_assert(sizeof(PipelineEvent) == 32, "PipelineEvent records are 32 bytes");
+
+    /*!
+     * \class PipelineEventLog
+     * \brief A TreeNode that streams the pipeline events of every unit
+     *        below its parent to a zstd-compressed file
+     *
+     * Units record into their own fixed-size buffer: one store per
+     * event, no formatting.  When any buffer fills, all of them are
+     * written out, so every event of a write-out is no older than the
+     * events of the previous one and a reader only has to sort one
+     * write-out at a time.
+     *
+     * The file is the 8-byte magic "OLYPEL01" followed by a zstd
+     * stream of blocks.  A block is a uint32 kind and a uint32 count:
+     *  - UNIT_BLOCK: count bytes of a unit's location.  Units are
+     *    numbered in the order of their blocks
+     *  - EVENTS_BLOCK: count PipelineEvent records
+     *  - END_OF_WRITE_OUT_BLOCK: no payload; closes one write-out
+     */
+    class PipelineEventLog : public sparta::TreeNode
+    {
+      public:
+        static constexpr char name[] = "pipeline_event_log";
+        static constexpr char MAGIC[] = "OLYPEL01";
+
+        enum BlockKind : uint32_t
+        {
+            UNIT_BLOCK = 1,
+            EVENTS_BLOCK,
+            END_OF_WRITE_OUT_BLOCK
+        };
+
+        struct BlockHeader
+        {
+            uint32_t kind;
+            uint32_t count;
+        };
+
+        /*!
+         * \class Buffer
+         * \brief One unit's events since the last write-out
+         */
+        class Buffer
+        {
+          public:
+            void record(const PipelineEventType type, const InstPtr & inst)
+            {
+                if (SPARTA_EXPECT_FALSE(num_events_ == events_.size()))
+                {
+                    log_->writeOut();
+                }
+                events_[num_events_++] = {clock_->currentCycle(), inst->getUniqueID(), inst->getPC(),
+                                          unit_, type, {}};
+            }
+
+          private:
+            friend class PipelineEventLog;
+
+            Buffer(PipelineEventLog* log, const uint16_t unit, const sparta::Clock* clock,
+                   const uint32_t num_events) :
+                log_(log),
+                unit_(unit),
+                clock_(clock),
+                events_(num_events)
+            {
+            }
+
+            PipelineEventLog* const log_;
+            const uint16_t unit_;
+            const sparta::Clock* const clock_;
+            std::vector<PipelineEvent> events_;
+            uint32_t num_events_ = 0;
+        };
+
+        //! Log to filename, buffering events_per_unit events per unit
+        PipelineEventLog(sparta::TreeNode* parent, const std::string & filename,
+                         const uint32_t events_per_unit = 4096);
+
+        //! Writes out what is buffered and closes the file
+        ~PipelineEventLog();
+
+        //! The buffer the unit at node records into, or nullptr if there
+        //! is no log above it.  Call once, from the unit's constructor
+        static Buffer* getBuffer(sparta::TreeNode* node);
+
+        //! Write every buffered event to the file
+        void writeOut();
+
+      private:
+        Buffer* addUnit_(sparta::TreeNode* node);
+
+        void write_(const void* data, const size_t size);
+
+        const uint32_t events_per_unit_;
+        std::ofstream file_;
+        ZSTD_CCtx_s* cctx_ = nullptr;
+        std::vector<char> compressed_;
+        std::vector<std::unique_ptr<Buffer>> buffers_;
+    };
+
+    /*!
+     * \class PipelineEventReader
+     * \brief Reads a PipelineEventLog back in cycle order
+     */
+    class PipelineEventReader
+    {
+      public:
+        //! Throws if the file is not a pipeline event log
+        explicit PipelineEventReader(const std::string & filename);
+
+        ~PipelineEventReader();
+
+        //! The next event, in cycle order.  Returns false at the end
+        bool next(PipelineEvent & event);
+
+        //! Unit locations, by PipelineEvent::unit.  Complete for every
+        //! event returned so far
+        const std::vector<std::string> & getUnits() const { return units_; }
+
+      private:
+        //! Read one write-out into events_, sorted
+        bool readWriteOut_();
+
+        //! Read decompressed bytes.  Returns false at the end of the
+        //! stream
+        bool read_(void* data, size_t size);
+
+        std::ifstream file_;
+        ZSTD_DCtx_s* dctx_ = nullptr;
+        std::vector<char> compressed_;
+        size_t compressed_pos_ = 0;
+        size_t compressed_size_ = 0;
+        std::vector<char> decompressed_;
+        size_t decompressed_pos_ = 0;
+        size_t decompressed_size_ = 0;
+
+        std::vector<std::string> units_;
+        std::vector<PipelineEvent> events_;
+        size_t next_event_ = 0;
+    };
+} // namespace olympia
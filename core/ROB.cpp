@@ -30,7 +30,8 @@ namespace olympia
         num_to_retire_(p->num_to_retire),
         num_insts_to_retire_(p->num_insts_to_retire),
         retire_heartbeat_(p->retire_heartbeat),
-        reorder_buffer_("ReorderBuffer", p->retire_queue_depth, node->getClock(), &unit_stat_set_)
+        reorder_buffer_("ReorderBuffer", p->retire_queue_depth, node->getClock(), &unit_stat_set_),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         // Set a cycle delay on the retire, just for kicks
         ev_retire_.setDelay(1);
@@ -52,6 +53,11 @@ namespace olympia
             this->getContainer(), "rob_stopped_notif_channel", "ROB terminated simulation channel",
             "rob_stopped_notif_channel"));
 
+        // Notify the sampling driver of measurement intervals
+        sampling_notif_source_.reset(new sparta::NotificationSource<bool>(
+            this->getContainer(), "sampling_notif_channel", "Sampled measurement interval channel",
+            "sampling_notif_channel"));
+
         // Send initial credits to anyone that cares.  Probably Dispatch.
         sparta::StartupEvent(node, CREATE_SPARTA_HANDLER(ROB, sendInitialCredits_));
     }
@@ -67,6 +73,34 @@ namespace olympia
     {
         out_reorder_buffer_credits_.send(reorder_buffer_.capacity());
         ev_ensure_forward_progress_.schedule(retire_timeout_interval_);
+
+        // Sampled simulation.  Test benches may run the ROB without
+        // a simulation configuration
+        auto cpu_node = getContainer()->getParent()->getParent();
+        auto extension = cpu_node->getExtension("simulation_configuration");
+        if (nullptr == extension)
+        {
+            return;
+        }
+        stop_core_only_ =
+            extension->getParameters()->getParameter("num_cores")->getValueAs<uint32_t>() > 1;
+        sampling_measure_ =
+            extension->getParameters()->getParameter("sampling_measure")->getValueAs<uint64_t>();
+        if (sampling_measure_ != 0)
+        {
+            sampling_warmup_ =
+                extension->getParameters()->getParameter("sampling_warmup")->getValueAs<uint64_t>();
+            next_sampling_boundary_ = sampling_warmup_;
+            if (sampling_warmup_ == 0)
+            {
+                // No detailed warm-up: the first interval measures from
+                // the first instruction retired
+                sampling_measuring_ = true;
+                next_sampling_boundary_ = sampling_measure_;
+                ILOG("sampling: measurement starts after 0 instructions");
+                sampling_notif_source_->postNotification(true);
+            }
+        }
     }
 
     // An illustration of the use of the callback -- instead of
@@ -99,6 +133,10 @@ namespace olympia
             {
                 ILOG("flushing " << youngest_inst);
                 youngest_inst->setStatus(Inst::Status::FLUSHED);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::FLUSH, youngest_inst);
+                }
                 reorder_buffer_.pop_back();
                 ++credits_to_send;
             }
@@ -112,8 +150,9 @@ namespace olympia
 
     void ROB::retireInstructions_()
     {
-        // ROB is expecting a flush (back to itself)
-        if (expect_flush_)
+        // ROB is expecting a flush (back to itself), or this core
+        // reached its instruction limit
+        if (expect_flush_ || rob_stopped_simulation_)
         {
             return;
         }
@@ -135,6 +174,10 @@ namespace olympia
             {
                 // UPDATE:
                 ex_inst.setStatus(Inst::Status::RETIRED);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::RETIRE, ex_inst_ptr);
+                }
                 if (ex_inst.isStoreInst())
                 {
                     out_rob_retire_ack_.send(ex_inst_ptr);
@@ -144,6 +187,15 @@ namespace olympia
 
                 // All instructions count as 1 uop
                 ++num_uops_retired_;
+                if (ex_inst.isBranch())
+                {
+                    ++num_branches_retired_;
+                    if (ex_inst.isMispredicted())
+                    {
+                        ++(ex_inst.isTargetMispredicted() ? num_target_mispredictions_
+                                                          : num_direction_mispredictions_);
+                    }
+                }
                 if (ex_inst_ptr->getUOpID() == 0)
                 {
                     ++num_retired_;
@@ -162,6 +214,11 @@ namespace olympia
                     // The fused op records the number of insts that
                     // were eliminated and adjusts the progID as needed
                     expected_program_id_ += ex_inst.getProgramIDIncrement();
+
+                    if (SPARTA_EXPECT_FALSE(sampling_measure_ != 0))
+                    {
+                        checkSamplingBoundary_();
+                    }
                 }
 
                 reorder_buffer_.pop();
@@ -183,17 +240,23 @@ namespace olympia
                 {
                     rob_stopped_simulation_ = true;
                     rob_stopped_notif_source_->postNotification(true);
-                    getScheduler()->stopRunning();
+                    if (false == stop_core_only_)
+                    {
+                        getScheduler()->stopRunning();
+                    }
                     break;
                 }
 
                 // Is this a misprdicted branch requiring a refetch?
                 if (ex_inst.isMispredicted())
                 {
-                    FlushManager::FlushingCriteria criteria(FlushManager::FlushCause::MISPREDICTION,
-                                                            ex_inst_ptr);
+                    const auto cause = ex_inst.isTargetMispredicted()
+                                           ? FlushManager::FlushCause::TARGET_MISPREDICTION
+                                           : FlushManager::FlushCause::MISPREDICTION;
+                    FlushManager::FlushingCriteria criteria(cause, ex_inst_ptr);
                     out_retire_flush_.send(criteria);
                     expect_flush_ = true;
+                    ++num_flushes_;
                     break;
                 }
 
@@ -243,6 +306,11 @@ namespace olympia
     // Make sure the pipeline is making forward progress
     void ROB::checkForwardProgress_()
     {
+        // A core that reached its limit waits for the others
+        if (rob_stopped_simulation_)
+        {
+            return;
+        }
         if (getClock()->currentCycle() - last_retirement_ >= retire_timeout_interval_)
         {
             sparta::SpartaException e;
@@ -254,6 +322,22 @@ namespace olympia
         ev_ensure_forward_progress_.schedule(retire_timeout_interval_);
     }
 
+    // Has retirement crossed into or out of a measurement interval?
+    // Fused instructions can cross more than one boundary at once.
+    // With no warm-up the next interval starts as the last one ends
+    void ROB::checkSamplingBoundary_()
+    {
+        const uint64_t num_retired_ids = expected_program_id_ - 1;
+        while (num_retired_ids >= next_sampling_boundary_)
+        {
+            sampling_measuring_ = !sampling_measuring_;
+            next_sampling_boundary_ += sampling_measuring_ ? sampling_measure_ : sampling_warmup_;
+            ILOG("sampling: measurement " << (sampling_measuring_ ? "starts" : "ends") << " after "
+                                          << num_retired_ids << " instructions");
+            sampling_notif_source_->postNotification(sampling_measuring_);
+        }
+    }
+
     void ROB::onStartingTeardown_()
     {
         if ((reorder_buffer_.size() > 0) && (false == rob_stopped_simulation_))
@@ -268,7 +352,6 @@ namespace olympia
     // sys gets flushed unless it is csr rd
     void ROB::retireSysInst_(InstPtr &ex_inst)
     {
-        auto srclist = ex_inst->getRenameData().getSourceList();
         // if SYS instr is not a csr instruction flush
         // if SYS instr is a csr but src1 is not x0, flush
         // otherwise it is a csr read, therefore don't flush
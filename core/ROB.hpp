@@ -18,6 +18,8 @@
 #include "CoreTypes.hpp"
 #include "InstGroup.hpp"
 #include "FlushManager.hpp"
+#include "PipelineEventLog.hpp"
+#include "RuntimeTunable.hpp"
 
 namespace olympia
 {
@@ -29,7 +31,7 @@ namespace olympia
      * The Reorder buffer will
      * 1. retire and writeback completed instructions
      */
-    class ROB : public sparta::Unit
+    class ROB : public sparta::Unit, public RuntimeTunableIF
     {
     public:
         //! \brief Parameters for ROB model
@@ -69,6 +71,19 @@ namespace olympia
         /// Destroy!
         ~ROB();
 
+        //! The instruction limit can be raised after the ROB stopped
+        //! the simulation at it, to resume it
+        std::vector<std::string> getTunableParameters() const override
+        {
+            return {"num_insts_to_retire"};
+        }
+
+        void tune(const std::string & param_name, const std::string & value) override
+        {
+            num_insts_to_retire_ = parseTunable<uint32_t>(param_name, value);
+            rob_stopped_simulation_ = false;
+        }
+
     private:
 
         // Stats and counters
@@ -79,19 +94,55 @@ namespace olympia
         sparta::StatisticInstance  overall_ipc_si_;   // An overall IPC statistic instance starting at time == 0
         sparta::StatisticInstance  period_ipc_si_;    // An IPC counter for the period between retirement heartbeats
 
+        // Retired branches and their mispredictions, by cause
+        sparta::Counter num_branches_retired_{
+            &unit_stat_set_, "total_branches_retired", "The total number of branches retired",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::Counter num_direction_mispredictions_{
+            &unit_stat_set_, "direction_mispredictions",
+            "Retired branches whose direction was mispredicted", sparta::Counter::COUNT_NORMAL};
+        sparta::Counter num_target_mispredictions_{
+            &unit_stat_set_, "target_mispredictions",
+            "Retired taken branches predicted taken to the wrong target",
+            sparta::Counter::COUNT_NORMAL};
+        sparta::StatisticDef branch_mpki_{
+            &unit_stat_set_, "branch_mpki", "Branch mispredictions per thousand instructions",
+            &unit_stat_set_,
+            "(direction_mispredictions+target_mispredictions)*1000/total_number_retired"};
+        sparta::StatisticDef direction_mpki_{
+            &unit_stat_set_, "direction_mpki",
+            "Branch direction mispredictions per thousand instructions", &unit_stat_set_,
+            "direction_mispredictions*1000/total_number_retired"};
+        sparta::StatisticDef target_mpki_{
+            &unit_stat_set_, "target_mpki",
+            "Branch target mispredictions per thousand instructions", &unit_stat_set_,
+            "target_mispredictions*1000/total_number_retired"};
+        sparta::StatisticDef branch_misprediction_rate_{
+            &unit_stat_set_, "branch_misprediction_rate", "Fraction of branches mispredicted",
+            &unit_stat_set_,
+            "(direction_mispredictions+target_mispredictions)/total_branches_retired"};
+
         // Parameter constants
         const sparta::Clock::Cycle retire_timeout_interval_;
         const uint32_t num_to_retire_;
-        const uint32_t num_insts_to_retire_; // parameter from ilimit
+        uint32_t num_insts_to_retire_; // parameter from ilimit
         const uint64_t retire_heartbeat_;    // Retire heartbeat interval
 
         InstQueue      reorder_buffer_;
 
+        // Where retired and flushed instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
+
         // Bool that indicates if the ROB stopped simulation.  If
         // false and there are still instructions in the reorder
         // buffer, the machine probably has a lock up
         bool rob_stopped_simulation_{false};
 
+        // With more than one core, reaching the instruction limit
+        // stops this core only; the simulator ends the simulation
+        // when every core has stopped
+        bool stop_core_only_{false};
+
         // Track a program ID to ensure the trace stream matches
         // at retirement.
         uint64_t expected_program_id_ = 1;
@@ -130,10 +181,22 @@ namespace olympia
 
         std::unique_ptr<sparta::NotificationSource<bool>> rob_stopped_notif_source_;
 
+        // Sampled simulation: the detailed instruction stream is cut
+        // into periods of sampling_warmup_ + sampling_measure_
+        // instructions.  A notification is posted on
+        // sampling_notif_channel with true when the measurement part
+        // of a period starts and false when it ends
+        uint64_t sampling_warmup_ = 0;
+        uint64_t sampling_measure_ = 0;
+        uint64_t next_sampling_boundary_ = 0;
+        bool     sampling_measuring_ = false;
+        std::unique_ptr<sparta::NotificationSource<bool>> sampling_notif_source_;
+
         void sendInitialCredits_();
         void robAppended_(const InstGroup &);
         void retireInstructions_();
         void checkForwardProgress_();
+        void checkSamplingBoundary_();
         void handleFlush_(const FlushManager::FlushingCriteria & criteria);
         void dumpDebugContent_(std::ostream& output) const override final;
         void onStartingTeardown_() override final;
@@ -26,7 +26,8 @@ namespace olympia
                               std::vector<int> v(p->num_to_rename + 1);
                               std::iota(v.begin(), v.end(), 0);
                               return v;
-                          }())
+                          }()),
+        event_log_(PipelineEventLog::getBuffer(node))
     {
         uop_queue_.enableCollection(node);
 
@@ -55,7 +56,7 @@ namespace olympia
             if (reg_file == core_types::RegFile::RF_INTEGER)
             {
                 reference_counter_[reg_file].push_back(0);
-                freelist_[reg_file].push(0);
+                freelist_[reg_file].push_back(0);
                 i = 1;
             }
             for (; i < num_regs; i++)
@@ -67,7 +68,7 @@ namespace olympia
             }
             for (uint32_t j = num_regs; j < num_renames; ++j)
             {
-                freelist_[reg_file].push(j);
+                freelist_[reg_file].push_back(j);
                 reference_counter_[reg_file].push_back(0);
             }
         };
@@ -160,7 +161,7 @@ namespace olympia
                 // has no other src references
                 if (reference_counter_[original_dest.rf][original_dest.val] <= 0)
                 {
-                    freelist_[original_dest.rf].push(original_dest.val);
+                    freelist_[original_dest.rf].push_back(original_dest.val);
                 }
             }
         }
@@ -178,7 +179,7 @@ namespace olympia
                 {
                     // freeing data register value, because it's not in the source list, so won't
                     // get caught below
-                    freelist_[data_reg.rf].push(data_reg.val);
+                    freelist_[data_reg.rf].push_back(data_reg.val);
                 }
             }
         }
@@ -192,7 +193,7 @@ namespace olympia
                 // retired we wait until the last reference is retired to then free the prf any
                 // "valid" PRF that is the true mapping of an ARF will have a reference_counter of
                 // at least 1, and thus shouldn't be retired
-                freelist_[src.rf].push(src.val);
+                freelist_[src.rf].push_back(src.val);
             }
         }
         // Instruction queue bookkeeping
@@ -250,7 +251,7 @@ namespace olympia
                         --reference_counter_[renamed_dest.rf][renamed_dest.val];
                         if (reference_counter_[renamed_dest.rf][renamed_dest.val] <= 0)
                         {
-                            freelist_[renamed_dest.rf].push(renamed_dest.val);
+                            freelist_[renamed_dest.rf].push_back(renamed_dest.val);
                         }
                     }
                 }
@@ -268,7 +269,7 @@ namespace olympia
                         {
                             // freeing data register value, because it's not in the source list, so
                             // won't get caught below
-                            freelist_[data_reg.rf].push(data_reg.val);
+                            freelist_[data_reg.rf].push_back(data_reg.val);
                         }
                     }
                 }
@@ -282,7 +283,7 @@ namespace olympia
                         // already been retired we wait until the last reference is retired to then
                         // free the prf any "valid" PRF that is the true mapping of an ARF will have
                         // a reference_counter of at least 1, and thus shouldn't be retired
-                        freelist_[src.rf].push(src.val);
+                        freelist_[src.rf].push_back(src.val);
                     }
                 }
                 inst_queue_.pop_back();
@@ -292,6 +293,13 @@ namespace olympia
         current_stall_ = NO_DECODE_INSTS;
 
         // Clean up buffers
+        if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+        {
+            for (const auto & inst : uop_queue_)
+            {
+                event_log_->record(PipelineEventType::FLUSH, inst);
+            }
+        }
         uop_queue_regcount_data_.clear();
         out_uop_queue_credits_.send(uop_queue_.size());
         uop_queue_.clear();
@@ -415,6 +423,10 @@ namespace olympia
                 // Pick the oldest
                 const auto & renaming_inst = uop_queue_.read(0);
                 renaming_inst->setStatus(Inst::Status::RENAMED);
+                if (SPARTA_EXPECT_FALSE(event_log_ != nullptr))
+                {
+                    event_log_->record(PipelineEventType::RENAME, renaming_inst);
+                }
                 ILOG("sending inst to dispatch: " << renaming_inst);
 
                 const auto & srcs = renaming_inst->getSourceOpInfoList();
@@ -519,7 +531,7 @@ namespace olympia
                         }
                         auto & bitmask = renaming_inst->getDestRegisterBitMask(rf);
                         const uint32_t prf = freelist_[rf].front();
-                        freelist_[rf].pop();
+                        freelist_[rf].pop_front();
                         renaming_inst->getRenameData().setOriginalDestination(
                             {map_table_[rf][num], rf, dest.field_id});
                         renaming_inst->getRenameData().setDestination({prf, rf, dest.field_id});
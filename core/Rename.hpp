@@ -18,6 +18,8 @@
 #include "CoreTypes.hpp"
 #include "FlushManager.hpp"
 #include "InstGroup.hpp"
+#include "PipelineEventLog.hpp"
+#include "RingQueue.hpp"
 
 namespace olympia
 {
@@ -38,7 +40,12 @@ namespace olympia
         class RenameParameterSet : public sparta::ParameterSet
         {
           public:
-            RenameParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+            RenameParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n)
+            {
+                num_to_rename.addDependentValidationCallback(
+                    InstGroup::fitsWidth,
+                    "Num to rename must fit in an InstGroup (InstGroup::MAX_WIDTH)");
+            }
 
             PARAMETER(uint32_t, num_to_rename, 4, "Number of instructions to rename")
             PARAMETER(uint32_t, rename_queue_depth, 10, "Number of instructions queued for rename")
@@ -89,13 +96,15 @@ namespace olympia
         Scoreboards scoreboards_;
         // histogram counter for number of renames each time scheduleRenaming_ is called
         sparta::BasicHistogram<int> rename_histogram_;
+        // where renamed instructions are logged, if anywhere
+        PipelineEventLog::Buffer* const event_log_;
         // map of ARF -> PRF
         uint32_t map_table_[core_types::N_REGFILES][32];
 
         // reference counter for PRF
         std::array<std::vector<int32_t>, core_types::N_REGFILES> reference_counter_;
         // list of free PRF that are available to map
-        std::queue<uint32_t> freelist_[core_types::N_REGFILES];
+        RingQueue<uint32_t> freelist_[core_types::N_REGFILES];
 
         // used to track current number of each type of RF instruction at each
         // given index in the uop_queue_
@@ -104,11 +113,11 @@ namespace olympia
             uint32_t cumulative_reg_counts[core_types::RegFile::N_REGFILES] = {0};
         };
 
-        std::deque<RegCountData> uop_queue_regcount_data_;
+        RingQueue<RegCountData> uop_queue_regcount_data_;
 
         // Used to track inflight instructions for the purpose of recovering
         // the rename data structures
-        std::deque<InstPtr> inst_queue_;
+        RingQueue<InstPtr> inst_queue_;
 
         ///////////////////////////////////////////////////////////////////////
         // Stall counters
@@ -0,0 +1,210 @@
+// <RingQueue.hpp> -*- C++ -*-
+
+//!
+//! \file RingQueue.hpp
+//! \brief A double-ended queue in one growable ring buffer
+//!
+
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class RingQueue
+     * \brief The parts of std::deque the model's queues use, kept in a
+     *        single power-of-2 ring
+     *
+     * std::deque allocates and frees a chunk every few hundred bytes
+     * that pass through it, so a FIFO allocates for as long as it
+     * runs.  A RingQueue only allocates when it grows past its
+     * largest size so far: once a simulation has warmed up, pushing
+     * and popping never touch the heap.  Popped slots are reset to
+     * RecordT() so shared pointers are released on pop.
+     */
+    template <typename RecordT> class RingQueue
+    {
+        template <bool IsConst> class Iterator
+        {
+            using QueueT = std::conditional_t<IsConst, const RingQueue, RingQueue>;
+
+          public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = RecordT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<IsConst, const RecordT*, RecordT*>;
+            using reference = std::conditional_t<IsConst, const RecordT &, RecordT &>;
+
+            Iterator() = default;
+
+            Iterator(QueueT* queue, const size_t idx) : queue_(queue), idx_(idx) {}
+
+            // A non-const iterator converts to a const one
+            template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            Iterator(const Iterator<OtherConst> & other) : queue_(other.queue_), idx_(other.idx_)
+            {
+            }
+
+            reference operator*() const { return (*queue_)[idx_]; }
+
+            pointer operator->() const { return &(*queue_)[idx_]; }
+
+            reference operator[](const difference_type n) const { return (*queue_)[idx_ + n]; }
+
+            Iterator & operator++() { ++idx_; return *this; }
+
+            Iterator & operator--() { --idx_; return *this; }
+
+            Iterator operator++(int) { Iterator it = *this; ++idx_; return it; }
+
+            Iterator operator--(int) { Iterator it = *this; --idx_; return it; }
+
+            Iterator & operator+=(const difference_type n) { idx_ += n; return *this; }
+
+            Iterator & operator-=(const difference_type n) { idx_ -= n; return *this; }
+
+            Iterator operator+(const difference_type n) const { return {queue_, idx_ + n}; }
+
+            Iterator operator-(const difference_type n) const { return {queue_, idx_ - n}; }
+
+            friend Iterator operator+(const difference_type n, const Iterator & it) { return it + n; }
+
+            difference_type operator-(const Iterator & other) const
+            {
+                return static_cast<difference_type>(idx_) - static_cast<difference_type>(other.idx_);
+            }
+
+            bool operator==(const Iterator & other) const { return idx_ == other.idx_; }
+
+            bool operator!=(const Iterator & other) const { return idx_ != other.idx_; }
+
+            bool operator<(const Iterator & other) const { return idx_ < other.idx_; }
+
+            bool operator>(const Iterator & other) const { return idx_ > other.idx_; }
+
+            bool operator<=(const Iterator & other) const { return idx_ <= other.idx_; }
+
+            bool operator>=(const Iterator & other) const { return idx_ >= other.idx_; }
+
+          private:
+            template <bool> friend class Iterator;
+
+            QueueT* queue_ = nullptr;
+            size_t idx_ = 0;
+        };
+
+      public:
+        using value_type = RecordT;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        //! Start with room for capacity entries (rounded up to a power of 2)
+        explicit RingQueue(const size_t capacity = 0) { reserve(capacity); }
+
+        size_t size() const { return size_; }
+
+        bool empty() const { return size_ == 0; }
+
+        size_t capacity() const { return slots_.size(); }
+
+        //! Make room for capacity entries without growing
+        void reserve(const size_t capacity)
+        {
+            if (capacity > slots_.size())
+            {
+                size_t new_capacity = 1;
+                while (new_capacity < capacity)
+                {
+                    new_capacity <<= 1;
+                }
+                grow_(new_capacity);
+            }
+        }
+
+        RecordT & operator[](const size_t idx) { return slots_[(head_ + idx) & mask_]; }
+
+        const RecordT & operator[](const size_t idx) const { return slots_[(head_ + idx) & mask_]; }
+
+        RecordT & front() { return (*this)[0]; }
+
+        const RecordT & front() const { return (*this)[0]; }
+
+        RecordT & back() { return (*this)[size_ - 1]; }
+
+        const RecordT & back() const { return (*this)[size_ - 1]; }
+
+        iterator begin() { return {this, 0}; }
+
+        iterator end() { return {this, size_}; }
+
+        const_iterator begin() const { return {this, 0}; }
+
+        const_iterator end() const { return {this, size_}; }
+
+        void push_back(const RecordT & record) { emplace_back(record); }
+
+        void push_back(RecordT && record) { emplace_back(std::move(record)); }
+
+        template <typename... ArgsT> RecordT & emplace_back(ArgsT &&... args)
+        {
+            if (size_ == slots_.size())
+            {
+                grow_((size_ == 0) ? 16 : (size_ * 2));
+            }
+            RecordT & slot = slots_[(head_ + size_) & mask_];
+            slot = RecordT(std::forward<ArgsT>(args)...);
+            ++size_;
+            return slot;
+        }
+
+        void pop_front()
+        {
+            sparta_assert(size_ != 0, "pop_front() on an empty RingQueue");
+            slots_[head_] = RecordT();
+            head_ = (head_ + 1) & mask_;
+            --size_;
+        }
+
+        void pop_back()
+        {
+            sparta_assert(size_ != 0, "pop_back() on an empty RingQueue");
+            back() = RecordT();
+            --size_;
+        }
+
+        void clear()
+        {
+            while (size_ != 0)
+            {
+                pop_back();
+            }
+            head_ = 0;
+        }
+
+      private:
+        void grow_(const size_t new_capacity)
+        {
+            std::vector<RecordT> slots(new_capacity);
+            for (size_t i = 0; i < size_; ++i)
+            {
+                slots[i] = std::move((*this)[i]);
+            }
+            slots_.swap(slots);
+            mask_ = new_capacity - 1;
+            head_ = 0;
+        }
+
+        std::vector<RecordT> slots_;
+        size_t mask_ = 0;
+        size_t head_ = 0;
+        size_t size_ = 0;
+    };
+} // namespace olympia
@@ -0,0 +1,89 @@
+// <RuntimeTunable.cpp> -*- C++ -*-
+
+//!
+//! \file RuntimeTunable.cpp
+//! \brief Parameters that can be changed in a running, warmed simulation
+//!
+
+#include <algorithm>
+
+#include "RuntimeTunable.hpp"
+
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/simulation/ResourceTreeNode.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    namespace
+    {
+        // Split <unit location>.params.<name> and find the unit
+        RuntimeTunableIF* findTunable(sparta::TreeNode* root,
+                                      const RuntimeOverride & override_param,
+                                      std::string & name,
+                                      sparta::ResourceTreeNode** unit_node = nullptr)
+        {
+            static const std::string PARAMS = ".params.";
+            const auto params_pos = override_param.path.rfind(PARAMS);
+            if (params_pos == std::string::npos)
+            {
+                throw sparta::SpartaException("ERROR: ")
+                    << override_param.path << " is not a parameter path (<unit>.params.<name>)";
+            }
+            std::string location = override_param.path.substr(0, params_pos);
+            name = override_param.path.substr(params_pos + PARAMS.size());
+
+            // Paths are given from the root, as with -p
+            const std::string root_prefix = root->getName() + ".";
+            if (location.compare(0, root_prefix.size(), root_prefix) == 0)
+            {
+                location.erase(0, root_prefix.size());
+            }
+
+            auto rtn = dynamic_cast<sparta::ResourceTreeNode*>(root->getChild(location, false));
+            auto unit = (rtn != nullptr) ? dynamic_cast<RuntimeTunableIF*>(rtn->getResource())
+                                         : nullptr;
+            if (unit == nullptr)
+            {
+                throw sparta::SpartaException("ERROR: ")
+                    << override_param.path << ": " << location
+                    << " is not a unit with runtime-tunable parameters";
+            }
+            const auto tunables = unit->getTunableParameters();
+            if (std::find(tunables.begin(), tunables.end(), name) == tunables.end())
+            {
+                sparta::SpartaException e("ERROR: ");
+                e << override_param.path << " cannot be changed after warm-up.  Tunable:";
+                for (const auto & tunable : tunables)
+                {
+                    e << " " << tunable;
+                }
+                throw e;
+            }
+            if (unit_node != nullptr)
+            {
+                *unit_node = rtn;
+            }
+            return unit;
+        }
+    } // namespace
+
+    void checkRuntimeOverride(sparta::TreeNode* root, const RuntimeOverride & override_param)
+    {
+        std::string name;
+        findTunable(root, override_param, name);
+    }
+
+    void applyRuntimeOverride(sparta::TreeNode* root, const RuntimeOverride & override_param)
+    {
+        std::string name;
+        sparta::ResourceTreeNode* unit_node = nullptr;
+        findTunable(root, override_param, name, &unit_node)->tune(name, override_param.value);
+
+        // Keep the ParameterSet in step with the unit, so that reports
+        // and configuration dumps show the value in effect.  Poked:
+        // the tree is finalized and the parameter already read
+        unit_node->getParameterSet()->getParameter(name)->setValueFromString(override_param.value,
+                                                                             true);
+    }
+} // namespace olympia
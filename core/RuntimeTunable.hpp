@@ -0,0 +1,72 @@
+// <RuntimeTunable.hpp> -*- C++ -*-
+
+//!
+//! \file RuntimeTunable.hpp
+//! \brief Parameters that can be changed in a running, warmed simulation
+//!
+
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class RuntimeTunableIF
+     * \brief A unit with parameters that can change after the model
+     *        has been built and warmed.  Only parameters that are
+     *        re-read every time they are used (latencies, delays, limits)
+     *        qualify; anything that sizes a structure does not
+     */
+    class RuntimeTunableIF
+    {
+      public:
+        virtual ~RuntimeTunableIF() = default;
+
+        //! Names of the parameters (as in the unit's ParameterSet)
+        //! that tune() accepts
+        virtual std::vector<std::string> getTunableParameters() const = 0;
+
+        //! Change a parameter.  Only called with a name from
+        //! getTunableParameters().  The caller updates the
+        //! ParameterSet entry
+        virtual void tune(const std::string & param_name, const std::string & value) = 0;
+
+      protected:
+        template <typename T>
+        static T parseTunable(const std::string & param_name, const std::string & value)
+        {
+            std::istringstream is(value);
+            T parsed{};
+            if (!(is >> parsed) || (false == is.eof()))
+            {
+                throw sparta::SpartaException("ERROR: '")
+                    << value << "' is not a valid value for " << param_name;
+            }
+            return parsed;
+        }
+    };
+
+    /*!
+     * \brief One parameter change, by full parameter path, e.g.
+     *        top.cpu.mss.params.mss_latency
+     */
+    struct RuntimeOverride
+    {
+        std::string path;
+        std::string value;
+    };
+
+    //! Check that the parameter path under root is runtime tunable.
+    //! Throws otherwise
+    void checkRuntimeOverride(sparta::TreeNode* root, const RuntimeOverride & override_param);
+
+    //! Apply the override to the unit under root that owns it, and
+    //! update the unit's parameter to match
+    void applyRuntimeOverride(sparta::TreeNode* root, const RuntimeOverride & override_param);
+} // namespace olympia
@@ -0,0 +1,79 @@
+// <SPSCRing.hpp> -*- C++ -*-
+
+//!
+//! \file SPSCRing.hpp
+//! \brief A bounded, lock-free single-producer/single-consumer ring
+//!
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <vector>
+
+#include "sparta/utils/MathUtils.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class SPSCRing
+     * \brief Fixed-size ring shared between exactly one producer
+     *        thread and one consumer thread
+     *
+     * Entries are addressed by an absolute, ever-increasing sequence
+     * number.  The producer appends with tryPush().  The consumer
+     * reads any entry in [getReleased(), getProduced()) with at(),
+     * which allows it to go back and re-read entries it has already
+     * seen.  Slots are only handed back to the producer when the
+     * consumer calls release().
+     */
+    template <typename RecordT> class SPSCRing
+    {
+      public:
+        explicit SPSCRing(const uint64_t capacity) :
+            capacity_(capacity),
+            mask_(capacity - 1),
+            slots_(capacity)
+        {
+            sparta_assert(sparta::utils::is_power_of_2(capacity),
+                          "SPSCRing capacity must be a power of 2: " << capacity);
+        }
+
+        //! Producer side: append a record.  Returns false if the ring is full
+        bool tryPush(const RecordT & record)
+        {
+            const uint64_t produced = produced_.load(std::memory_order_relaxed);
+            if ((produced - released_.load(std::memory_order_acquire)) == capacity_)
+            {
+                return false;
+            }
+            slots_[produced & mask_] = record;
+            produced_.store(produced + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Consumer side: one past the sequence number of the last record produced
+        uint64_t getProduced() const { return produced_.load(std::memory_order_acquire); }
+
+        //! Consumer side: the oldest sequence number still readable
+        uint64_t getReleased() const { return released_.load(std::memory_order_relaxed); }
+
+        //! Consumer side: access a record.  seq must be in [getReleased(), getProduced())
+        const RecordT & at(const uint64_t seq) const { return slots_[seq & mask_]; }
+
+        //! Consumer side: hand all records older than seq back to the producer
+        void release(const uint64_t seq) { released_.store(seq, std::memory_order_release); }
+
+        uint64_t capacity() const { return capacity_; }
+
+      private:
+        const uint64_t capacity_;
+        const uint64_t mask_;
+        std::vector<RecordT> slots_;
+
+        // Keep the producer and consumer indexes on separate cache lines
+        alignas(64) std::atomic<uint64_t> produced_{0};
+        alignas(64) std::atomic<uint64_t> released_{0};
+    };
+} // namespace olympia
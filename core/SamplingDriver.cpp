@@ -0,0 +1,235 @@
+// <SamplingDriver.cpp> -*- C++ -*-
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "SamplingDriver.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    namespace
+    {
+        // Two-sided 95% confidence
+        constexpr double CONFIDENCE_Z = 1.96;
+
+        // Relative error the "intervals needed" hint is given for
+        constexpr double TARGET_RELATIVE_ERROR = 0.03;
+
+        bool endsWith(const std::string & str, const std::string & suffix)
+        {
+            return (str.size() >= suffix.size())
+                   && (str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
+        }
+    } // namespace
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // SampleSet
+
+    void SampleSet::merge(const SampleSet & other)
+    {
+        interval_cpi.insert(interval_cpi.end(), other.interval_cpi.begin(),
+                            other.interval_cpi.end());
+        measured_cycles += other.measured_cycles;
+        measured_insts += other.measured_insts;
+        for (const auto & [location, total] : other.counter_totals)
+        {
+            counter_totals[location] += total;
+        }
+    }
+
+    void SampleSet::write(std::ostream & os) const
+    {
+        os << std::setprecision(17) << measured_cycles << ' ' << measured_insts << ' '
+           << interval_cpi.size() << ' ' << counter_totals.size() << '\n';
+        for (const double cpi : interval_cpi)
+        {
+            os << cpi << '\n';
+        }
+        writeCounters(os);
+    }
+
+    void SampleSet::read(std::istream & is)
+    {
+        uint64_t num_intervals = 0, num_counters = 0;
+        is >> measured_cycles >> measured_insts >> num_intervals >> num_counters;
+        interval_cpi.resize(num_intervals);
+        for (auto & cpi : interval_cpi)
+        {
+            is >> cpi;
+        }
+        for (uint64_t i = 0; i < num_counters; ++i)
+        {
+            std::string location;
+            uint64_t total = 0;
+            is >> location >> total;
+            counter_totals[location] += total;
+        }
+        if (is.fail())
+        {
+            throw sparta::SpartaException("ERROR: truncated sampling results");
+        }
+    }
+
+    void SampleSet::writeCounters(std::ostream & os) const
+    {
+        for (const auto & [location, total] : counter_totals)
+        {
+            os << location << ' ' << total << '\n';
+        }
+    }
+
+    uint64_t
+    SampleSet::sumCounters_(const std::function<bool(const std::string &)> & match) const
+    {
+        uint64_t sum = 0;
+        for (const auto & [location, total] : counter_totals)
+        {
+            sum += match(location) ? total : 0;
+        }
+        return sum;
+    }
+
+    void SampleSet::report(std::ostream & os, const std::string & prefix) const
+    {
+        const uint64_t num_intervals = interval_cpi.size();
+        if ((num_intervals == 0) || (measured_insts == 0))
+        {
+            os << prefix << "no complete measurement interval; nothing to estimate" << std::endl;
+            return;
+        }
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(4);
+        line << prefix << "measured " << measured_insts << " instructions in " << measured_cycles
+             << " cycles, IPC "
+             << (static_cast<double>(measured_insts) / std::max<uint64_t>(measured_cycles, 1));
+        os << line.str() << std::endl;
+
+        // Mean of the per-interval CPIs and its confidence interval
+        const double mean_cpi =
+            std::accumulate(interval_cpi.begin(), interval_cpi.end(), 0.0) / num_intervals;
+        line.str("");
+        line << prefix << "estimated CPI " << mean_cpi;
+        if (num_intervals > 1)
+        {
+            double sum_sq = 0.0;
+            for (const double cpi : interval_cpi)
+            {
+                sum_sq += (cpi - mean_cpi) * (cpi - mean_cpi);
+            }
+            const double std_dev = std::sqrt(sum_sq / (num_intervals - 1));
+            const double half_width = CONFIDENCE_Z * std_dev / std::sqrt(num_intervals);
+            const double variation = std_dev / mean_cpi;
+            const uint64_t needed = static_cast<uint64_t>(
+                std::ceil(std::pow(CONFIDENCE_Z * variation / TARGET_RELATIVE_ERROR, 2.0)));
+            line << " +/- " << half_width << " (95% confidence, +/- " << std::setprecision(2)
+                 << (100.0 * half_width / mean_cpi) << "%)";
+            os << line.str() << std::endl;
+
+            line.str("");
+            line << std::setprecision(4) << prefix << "CPI coefficient of variation "
+                 << variation << ", about " << needed << " intervals needed for +/- "
+                 << std::setprecision(0) << (100.0 * TARGET_RELATIVE_ERROR)
+                 << "% at 95% confidence";
+        }
+        else
+        {
+            line << " (at least 2 intervals are needed for a confidence interval)";
+        }
+        os << line.str() << std::endl;
+
+        const std::pair<std::string, uint64_t> key_counters[] = {
+            {"dl1_cache_misses",
+             sumCounters_([](const std::string & location)
+                          { return endsWith(location, ".dcache.stats.dl1_cache_misses"); })},
+            {"flushes",
+             sumCounters_([](const std::string & location)
+                          { return endsWith(location, ".rob.stats.total_number_of_flushes"); })},
+            {"dispatch_stall_cycles",
+             sumCounters_([](const std::string & location)
+                          {
+                              return (location.find(".dispatch.stats.stall_") != std::string::npos)
+                                     && !endsWith(location, ".stall_not_stalled");
+                          })}};
+        for (const auto & [name, total] : key_counters)
+        {
+            line.str("");
+            line << std::setprecision(3) << prefix << name << " " << total << " ("
+                 << (1000.0 * total / measured_insts) << " per 1K instructions)";
+            os << line.str() << std::endl;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // SamplingDriver
+
+    SamplingDriver::SamplingDriver(sparta::TreeNode* core_node, const Config & config) :
+        config_(config),
+        clk_(core_node->getClock()),
+        retired_(
+            core_node->getChildAs<const sparta::CounterBase>("rob.stats.total_number_retired"))
+    {
+        findCounters_(core_node);
+        counter_starts_.resize(counters_.size(), 0);
+
+        core_node->getChild("rob")
+            ->registerForNotification<bool, SamplingDriver, &SamplingDriver::onSamplingBoundary_>(
+                this, "sampling_notif_channel");
+    }
+
+    void SamplingDriver::findCounters_(sparta::TreeNode* node)
+    {
+        if (auto counter = dynamic_cast<const sparta::CounterBase*>(node); counter != nullptr)
+        {
+            counters_.emplace_back(counter);
+        }
+        for (auto child : node->getChildren())
+        {
+            findCounters_(child);
+        }
+    }
+
+    void SamplingDriver::onSamplingBoundary_(const bool & measuring)
+    {
+        if (measuring)
+        {
+            start_cycle_ = clk_->currentCycle();
+            start_retired_ = retired_->get();
+            for (size_t i = 0; i < counters_.size(); ++i)
+            {
+                counter_starts_[i] = counters_[i]->get();
+            }
+            return;
+        }
+
+        const uint64_t cycles = clk_->currentCycle() - start_cycle_;
+        const uint64_t insts = retired_->get() - start_retired_;
+        if (insts == 0)
+        {
+            // A fused instruction retired across the whole interval
+            return;
+        }
+        samples_.interval_cpi.emplace_back(static_cast<double>(cycles) / insts);
+        samples_.measured_cycles += cycles;
+        samples_.measured_insts += insts;
+        for (size_t i = 0; i < counters_.size(); ++i)
+        {
+            samples_.counter_totals[counters_[i]->getLocation()] +=
+                counters_[i]->get() - counter_starts_[i];
+        }
+    }
+
+    void SamplingDriver::report(std::ostream & os) const
+    {
+        os << "olympia: sampling: " << samples_.interval_cpi.size()
+           << " measurement intervals of " << config_.measure << " instructions ("
+           << config_.warmup << " detailed warm-up) every " << config_.period << " instructions"
+           << std::endl;
+        samples_.report(os, "olympia: sampling: ");
+    }
+} // namespace olympia
@@ -0,0 +1,106 @@
+// <SamplingDriver.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class SampleSet
+     * \brief Measurement intervals and the counters accumulated over
+     *        them.  Can be written out, read back and merged, so that
+     *        intervals simulated in different processes are reported
+     *        together
+     */
+    struct SampleSet
+    {
+        std::vector<double> interval_cpi;
+        uint64_t measured_cycles = 0;
+        uint64_t measured_insts = 0;
+
+        //! Counter location -> total over the measurement intervals
+        std::map<std::string, uint64_t> counter_totals;
+
+        void merge(const SampleSet & other);
+
+        //! Text serialization, read back with read()
+        void write(std::ostream & os) const;
+        void read(std::istream & is);
+
+        //! Print the CPI estimate, its confidence interval and the key
+        //! counters, each line prefixed with prefix
+        void report(std::ostream & os, const std::string & prefix) const;
+
+        //! Print every counter total, one "location value" per line
+        void writeCounters(std::ostream & os) const;
+
+      private:
+        //! Sum of the totals of all counters whose location matches
+        uint64_t sumCounters_(const std::function<bool(const std::string &)> & match) const;
+    };
+
+    /*!
+     * \class SamplingDriver
+     * \brief Collects the measurement intervals of a sampled (SMARTS
+     *        style) simulation and estimates CPI from them
+     *
+     * Every sampling period of the workload is split in three: the
+     * instructions are first functionally warmed (Fetch), then
+     * simulated in detail as warm-up, then simulated in detail and
+     * measured.  The ROB posts on sampling_notif_channel when a
+     * measurement interval starts and ends; the driver snapshots the
+     * core's cycle count and counters at each end and keeps the
+     * differences.
+     */
+    class SamplingDriver
+    {
+      public:
+        struct Config
+        {
+            uint64_t period = 0;  //!< Workload instructions per period
+            uint64_t warmup = 0;  //!< Detailed, unmeasured instructions per period
+            uint64_t measure = 0; //!< Measured instructions per period
+
+            bool enabled() const { return period != 0; }
+        };
+
+        //! Observe the ROB of the given core
+        SamplingDriver(sparta::TreeNode* core_node, const Config & config);
+
+        //! Print the CPI estimate, its confidence interval and the
+        //! key counters aggregated over the measurement intervals
+        void report(std::ostream & os) const;
+
+        const SampleSet & getSamples() const { return samples_; }
+
+      private:
+        void onSamplingBoundary_(const bool & measuring);
+
+        void findCounters_(sparta::TreeNode* node);
+
+        const Config config_;
+        const sparta::Clock* clk_ = nullptr;
+        const sparta::CounterBase* retired_ = nullptr;
+
+        // Every counter in the core and its value when the current
+        // measurement interval started
+        std::vector<const sparta::CounterBase*> counters_;
+        std::vector<uint64_t> counter_starts_;
+
+        sparta::Clock::Cycle start_cycle_ = 0;
+        uint64_t start_retired_ = 0;
+
+        SampleSet samples_;
+    };
+} // namespace olympia
@@ -11,6 +11,9 @@
 #include "cache/SimpleCache2.hpp"
 #include "cache/ReplacementIF.hpp"
 
+#include "FunctionalWarming.hpp"
+#include "Checkpoint.hpp"
+
 namespace olympia
 {
     class SimpleTLBEntry : public sparta::cache::BasicCacheItem
@@ -90,7 +93,9 @@ namespace olympia
     };  // class SimpleTLBEntry
 
     class SimpleTLB : public sparta::cache::SimpleCache2<SimpleTLBEntry>,
-                      public sparta::Unit
+                      public sparta::Unit,
+                      public FunctionalWarmingIF,
+                      public CheckpointableIF
     {
     public:
         static constexpr const char* name = "tlb";
@@ -122,6 +127,44 @@ namespace olympia
             touchMRU(entry);
             hits++;
         }
+
+        // Functional warming: fill/touch the entry for the page
+        void warm(WarmingRecord & record) override
+        {
+            if (!record.is_mem_access) {
+                return;
+            }
+            auto tlb_entry = peekLine(record.mem_vaddr);
+            if ((tlb_entry != nullptr) && tlb_entry->isValid()) {
+                touchMRU(*tlb_entry);
+            }
+            else {
+                allocateWithMRUUpdate(getLineForReplacementWithInvalidCheck(record.mem_vaddr),
+                                      record.mem_vaddr);
+            }
+        }
+
+        double getWarmingCoverage() const override
+        {
+            uint64_t num_entries = 0;
+            uint64_t num_valid = 0;
+            for (auto set_it = begin(); set_it != end(); ++set_it) {
+                for (auto entry_it = set_it->begin(); entry_it != set_it->end(); ++entry_it) {
+                    ++num_entries;
+                    num_valid += entry_it->isValid() ? 1 : 0;
+                }
+            }
+            return (num_entries == 0) ? 0.0 : static_cast<double>(num_valid) / num_entries;
+        }
+
+        // Checkpoint the TLB entries and replacement state
+        void saveCheckpoint(std::ostream & os) override {
+            checkpoint::saveCache(os, *this);
+        }
+
+        void restoreCheckpoint(std::istream & is) override {
+            checkpoint::restoreCache(is, *this);
+        }
     private:
         sparta::Counter hits;
     }; // class SimpleTLB
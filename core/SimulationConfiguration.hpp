@@ -39,9 +39,79 @@ namespace olympia
                                           "workload", "",
                                           "Workload to run", ps));
             }
+            if(nullptr == ps->getParameter("core_workloads", false)) {
+                core_workloads_param_.reset(new sparta::Parameter<std::vector<std::string>>(
+                                                "core_workloads", {},
+                                                "Workload of each core, by core index.  Cores "
+                                                "without one (or with an empty one) run "
+                                                "workload", ps));
+            }
+            if(nullptr == ps->getParameter("num_cores", false)) {
+                num_cores_param_.reset(new sparta::Parameter<uint32_t>(
+                                           "num_cores", 1,
+                                           "Number of cores simulated.  With more than one, a "
+                                           "core that reaches its instruction limit stops and "
+                                           "the simulation ends when every core has", ps));
+            }
+            if(nullptr == ps->getParameter("fast_forward", false)) {
+                fast_forward_param_.reset(new sparta::Parameter<uint64_t>(
+                                              "fast_forward", 0,
+                                              "Number of workload instructions to skip before "
+                                              "detailed simulation starts", ps));
+            }
+            if(nullptr == ps->getParameter("functional_warming", false)) {
+                functional_warming_param_.reset(new sparta::Parameter<bool>(
+                                                    "functional_warming", false,
+                                                    "Warm caches, TLBs and predictors with the "
+                                                    "instructions skipped by fast_forward", ps));
+            }
+            if(nullptr == ps->getParameter("sampling_period", false)) {
+                sampling_period_param_.reset(new sparta::Parameter<uint64_t>(
+                                                 "sampling_period", 0,
+                                                 "Sampled simulation: workload instructions per "
+                                                 "sampling period.  0 simulates everything in "
+                                                 "detail", ps));
+            }
+            if(nullptr == ps->getParameter("sampling_warmup", false)) {
+                sampling_warmup_param_.reset(new sparta::Parameter<uint64_t>(
+                                                 "sampling_warmup", 0,
+                                                 "Sampled simulation: instructions simulated in "
+                                                 "detail, but not measured, before each "
+                                                 "measurement interval", ps));
+            }
+            if(nullptr == ps->getParameter("sampling_measure", false)) {
+                sampling_measure_param_.reset(new sparta::Parameter<uint64_t>(
+                                                  "sampling_measure", 0,
+                                                  "Sampled simulation: instructions measured per "
+                                                  "sampling period.  The rest of the period is "
+                                                  "functionally warmed", ps));
+            }
+            if(nullptr == ps->getParameter("checkpoint_save", false)) {
+                checkpoint_save_param_.reset(new sparta::Parameter<std::string>(
+                                                 "checkpoint_save", "",
+                                                 "Save the warmed caches and TLBs, and the "
+                                                 "workload position, to this file after the "
+                                                 "fast-forward", ps));
+            }
+            if(nullptr == ps->getParameter("checkpoint_restore", false)) {
+                checkpoint_restore_param_.reset(new sparta::Parameter<std::string>(
+                                                    "checkpoint_restore", "",
+                                                    "Start from this checkpoint instead of the "
+                                                    "beginning of the workload.  fast_forward "
+                                                    "then counts from the checkpoint", ps));
+            }
         }
 
         std::unique_ptr<sparta::Parameter<std::string>> workload_param_;
+        std::unique_ptr<sparta::Parameter<std::vector<std::string>>> core_workloads_param_;
+        std::unique_ptr<sparta::Parameter<uint32_t>>    num_cores_param_;
+        std::unique_ptr<sparta::Parameter<uint64_t>>    fast_forward_param_;
+        std::unique_ptr<sparta::Parameter<bool>>        functional_warming_param_;
+        std::unique_ptr<sparta::Parameter<uint64_t>>    sampling_period_param_;
+        std::unique_ptr<sparta::Parameter<uint64_t>>    sampling_warmup_param_;
+        std::unique_ptr<sparta::Parameter<uint64_t>>    sampling_measure_param_;
+        std::unique_ptr<sparta::Parameter<std::string>> checkpoint_save_param_;
+        std::unique_ptr<sparta::Parameter<std::string>> checkpoint_restore_param_;
 
     };
 }
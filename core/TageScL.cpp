@@ -0,0 +1,463 @@
+#include "TageScL.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    namespace
+    {
+        // Fold a history of up to 64 bits down to bits
+        uint32_t foldHistory(uint64_t history, uint32_t bits) {
+            uint64_t folded = 0;
+            while (history != 0) {
+                folded ^= history;
+                history >>= bits;
+            }
+            return static_cast<uint32_t>(folded & ((1ull << bits) - 1));
+        }
+
+        template<class T>
+        void saturatingUpdate(T & ctr, bool up, int32_t min, int32_t max) {
+            if (up) {
+                ctr = static_cast<T>(std::min<int32_t>(ctr + 1, max));
+            } else {
+                ctr = static_cast<T>(std::max<int32_t>(ctr - 1, min));
+            }
+        }
+
+        constexpr int32_t TAGE_CTR_MIN = -4;
+        constexpr int32_t TAGE_CTR_MAX = 3;
+        constexpr int32_t SC_CTR_MIN = -32;
+        constexpr int32_t SC_CTR_MAX = 31;
+        constexpr uint16_t LOOP_MAX_ITER = 0x3fff;
+
+        // Usefulness is halved every 2^U_RESET_LOG_PERIOD updates
+        constexpr uint32_t U_RESET_LOG_PERIOD = 18;
+    }
+
+    TageScLBranchPredictor::TageScLBranchPredictor(const PredictorConfig & config) :
+        num_tables_(config.tage_num_tables),
+        table_bits_(config.tage_table_bits),
+        tag_bits_(config.tage_tag_bits),
+        bimodal_bits_(config.pht_bits),
+        sc_bits_(config.sc_table_bits),
+        loop_set_bits_(config.loop_set_bits),
+        bimodal_(1ull << config.pht_bits, 1),
+        tagged_(static_cast<size_t>(config.tage_num_tables) << config.tage_table_bits),
+        history_lengths_(config.tage_num_tables),
+        sc_tables_(SC_HISTORY_LENGTHS.size() << config.sc_table_bits, 0),
+        loops_(LOOP_WAYS << config.loop_set_bits),
+        btb_(config.btb_bits)
+    {
+        sparta_assert((num_tables_ >= 2) && (num_tables_ <= MAX_TABLES),
+                      "TAGE needs 2 to " << MAX_TABLES << " tagged tables");
+        sparta_assert((table_bits_ >= 2) && (table_bits_ <= 24), "TAGE table size out of range");
+        sparta_assert((tag_bits_ >= 4) && (tag_bits_ <= 16), "TAGE tags are 4 to 16 bits");
+        sparta_assert((sc_bits_ >= 2) && (sc_bits_ <= 24), "SC table size out of range");
+        sparta_assert((config.tage_min_history >= 1)
+                      && (config.tage_min_history < config.tage_max_history),
+                      "TAGE history lengths must grow");
+
+        // Geometric history lengths
+        const double ratio = static_cast<double>(config.tage_max_history) / config.tage_min_history;
+        for (uint32_t t = 0; t < num_tables_; ++t) {
+            history_lengths_[t] = static_cast<uint32_t>(
+                config.tage_min_history * std::pow(ratio, static_cast<double>(t) / (num_tables_ - 1))
+                + 0.5);
+            if ((t != 0) && (history_lengths_[t] <= history_lengths_[t - 1])) {
+                history_lengths_[t] = history_lengths_[t - 1] + 1;
+            }
+            index_folds_[t].init(history_lengths_[t], table_bits_);
+            tag_folds_[t].init(history_lengths_[t], tag_bits_);
+            tag_folds2_[t].init(history_lengths_[t], tag_bits_ - 1);
+            pc_shifts_[t] = table_bits_ - (t % table_bits_);
+        }
+
+        // Room for the longest history plus the bit leaving it
+        size_t ghist_size = 1;
+        while (ghist_size <= history_lengths_.back()) {
+            ghist_size <<= 1;
+        }
+        ghist_.assign(ghist_size, 0);
+    }
+
+    uint64_t TageScLBranchPredictor::getStorageBits() const
+    {
+        const uint64_t tagged_entry_bits = 3 + 2 + tag_bits_;
+        const uint64_t loop_entry_bits = 10 + 14 + 14 + 2 + 8 + 1 + 1;
+        return (bimodal_.size() * 2) + (tagged_.size() * tagged_entry_bits)
+               + (sc_tables_.size() * 6) + (loops_.size() * loop_entry_bits)
+               + history_lengths_.back();
+    }
+
+    void TageScLBranchPredictor::saveCheckpoint(std::ostream & os)
+    {
+        checkpoint::writeTable(os, history_lengths_);
+        checkpoint::writeTable(os, bimodal_);
+        checkpoint::writeTable(os, tagged_);
+        checkpoint::writeTable(os, sc_tables_);
+        checkpoint::writeTable(os, loops_);
+        checkpoint::writeTable(os, ghist_);
+        for (uint32_t t = 0; t < num_tables_; ++t) {
+            checkpoint::write(os, index_folds_[t].value);
+            checkpoint::write(os, tag_folds_[t].value);
+            checkpoint::write(os, tag_folds2_[t].value);
+        }
+        checkpoint::write(os, ghist_head_);
+        checkpoint::write(os, recent_history_);
+        checkpoint::write(os, path_history_);
+        checkpoint::write(os, use_alt_on_new_);
+        checkpoint::write(os, u_tick_);
+        checkpoint::write(os, sc_threshold_);
+        checkpoint::write(os, sc_threshold_ctr_);
+        checkpoint::write(os, use_loop_);
+        checkpoint::write(os, random_state_);
+        btb_.saveCheckpoint(os);
+    }
+
+    void TageScLBranchPredictor::restoreCheckpoint(std::istream & is)
+    {
+        // The folded histories are only valid for the same lengths
+        std::vector<uint32_t> history_lengths(history_lengths_.size());
+        checkpoint::readTable(is, history_lengths);
+        if (history_lengths != history_lengths_) {
+            throw sparta::SpartaException("ERROR: Checkpoint has TAGE history lengths up to ")
+                << history_lengths.back() << ", the model has lengths up to "
+                << history_lengths_.back();
+        }
+        checkpoint::readTable(is, bimodal_);
+        checkpoint::readTable(is, tagged_);
+        checkpoint::readTable(is, sc_tables_);
+        checkpoint::readTable(is, loops_);
+        checkpoint::readTable(is, ghist_);
+        for (uint32_t t = 0; t < num_tables_; ++t) {
+            index_folds_[t].value = checkpoint::read<uint32_t>(is);
+            tag_folds_[t].value = checkpoint::read<uint32_t>(is);
+            tag_folds2_[t].value = checkpoint::read<uint32_t>(is);
+        }
+        ghist_head_ = checkpoint::read<uint32_t>(is) & static_cast<uint32_t>(ghist_.size() - 1);
+        recent_history_ = checkpoint::read<uint64_t>(is);
+        path_history_ = checkpoint::read<uint64_t>(is);
+        use_alt_on_new_ = checkpoint::read<int32_t>(is);
+        u_tick_ = checkpoint::read<uint32_t>(is);
+        sc_threshold_ = checkpoint::read<int32_t>(is);
+        sc_threshold_ctr_ = checkpoint::read<int32_t>(is);
+        use_loop_ = checkpoint::read<int32_t>(is);
+        random_state_ = checkpoint::read<uint32_t>(is);
+        btb_.restoreCheckpoint(is);
+        last_ = Lookup();
+    }
+
+    uint32_t TageScLBranchPredictor::random_()
+    {
+        // xorshift32: deterministic, so runs repeat exactly
+        random_state_ ^= random_state_ << 13;
+        random_state_ ^= random_state_ >> 17;
+        random_state_ ^= random_state_ << 5;
+        return random_state_;
+    }
+
+    uint32_t TageScLBranchPredictor::tableIndex_(uint32_t table, uint64_t pc) const
+    {
+        const uint64_t p = pc >> 1;
+        const uint32_t path_bits = std::min(history_lengths_[table], 16u);
+        const uint64_t path = path_history_ & ((1ull << path_bits) - 1);
+        const uint64_t index = p ^ (p >> pc_shifts_[table])
+                               ^ index_folds_[table].value ^ path ^ (path >> table_bits_);
+        return static_cast<uint32_t>(index & ((1ull << table_bits_) - 1));
+    }
+
+    uint16_t TageScLBranchPredictor::tableTag_(uint32_t table, uint64_t pc) const
+    {
+        const uint64_t tag = (pc >> 1) ^ tag_folds_[table].value ^ (tag_folds2_[table].value << 1);
+        return static_cast<uint16_t>(tag & ((1ull << tag_bits_) - 1));
+    }
+
+    void TageScLBranchPredictor::lookup_(const BranchInput & input)
+    {
+        Lookup & l = last_;
+        l.pc = input.pc;
+        l.valid = true;
+
+        // TAGE: the longest matching history provides, the next one is
+        // the alternate
+        l.bimodal_index = static_cast<uint32_t>((input.pc >> 1) & ((1ull << bimodal_bits_) - 1));
+        const bool bimodal_pred = bimodal_[l.bimodal_index] > 1;
+        l.provider = -1;
+        l.alt = -1;
+        for (int32_t t = static_cast<int32_t>(num_tables_) - 1; t >= 0; --t) {
+            l.indices[t] = tableIndex_(t, input.pc);
+            l.tags[t] = tableTag_(t, input.pc);
+        }
+        for (int32_t t = static_cast<int32_t>(num_tables_) - 1; t >= 0; --t) {
+            if (entry_(t, l.indices[t]).tag == l.tags[t]) {
+                if (l.provider < 0) {
+                    l.provider = t;
+                } else {
+                    l.alt = t;
+                    break;
+                }
+            }
+        }
+        l.alt_pred = (l.alt >= 0) ? (entry_(l.alt, l.indices[l.alt]).ctr >= 0) : bimodal_pred;
+        if (l.provider >= 0) {
+            const TaggedEntry & provider = entry_(l.provider, l.indices[l.provider]);
+            l.provider_pred = provider.ctr >= 0;
+            l.weak_new = ((provider.ctr == 0) || (provider.ctr == -1)) && (provider.u == 0);
+            l.tage_pred = (l.weak_new && (use_alt_on_new_ >= 0)) ? l.alt_pred : l.provider_pred;
+            l.tage_confident = (provider.ctr == TAGE_CTR_MAX) || (provider.ctr == TAGE_CTR_MIN);
+        } else {
+            l.provider_pred = bimodal_pred;
+            l.weak_new = false;
+            l.tage_pred = bimodal_pred;
+            l.tage_confident = (bimodal_[l.bimodal_index] == 0) || (bimodal_[l.bimodal_index] == 3);
+        }
+
+        // SC: sum of centered counters; reverts TAGE when TAGE is not
+        // confident and the sum clearly disagrees
+        const uint64_t p = input.pc >> 1;
+        l.sc_sum = 0;
+        for (uint32_t i = 0; i < SC_HISTORY_LENGTHS.size(); ++i) {
+            uint64_t key = p;
+            if (i == 0) {
+                key = (p << 1) | (l.tage_pred ? 1 : 0);
+            } else {
+                const uint64_t history = recent_history_ & ((1ull << SC_HISTORY_LENGTHS[i]) - 1);
+                key = p ^ (static_cast<uint64_t>(foldHistory(history, sc_bits_)) << (i & 1))
+                      ^ (static_cast<uint64_t>(i) << (sc_bits_ - 2));
+            }
+            l.sc_indices[i] = static_cast<uint32_t>((i << sc_bits_) | (key & ((1ull << sc_bits_) - 1)));
+            l.sc_sum += (2 * sc_tables_[l.sc_indices[i]]) + 1;
+        }
+        l.sc_pred = l.sc_sum >= 0;
+        l.sc_used = (false == l.tage_confident) && (l.sc_pred != l.tage_pred)
+                    && (std::abs(l.sc_sum) >= sc_threshold_);
+        l.pred = l.sc_used ? l.sc_pred : l.tage_pred;
+
+        // L: a loop with a steady trip count overrides the rest
+        l.loop_index = static_cast<uint32_t>((input.pc >> 1) & ((1u << loop_set_bits_) - 1));
+        l.loop_way = -1;
+        l.loop_valid = false;
+        const uint16_t loop_tag = loopTag_(input.pc);
+        for (uint32_t way = 0; way < LOOP_WAYS; ++way) {
+            const LoopEntry & loop = loops_[(l.loop_index * LOOP_WAYS) + way];
+            if (loop.valid && (loop.tag == loop_tag)) {
+                l.loop_way = static_cast<int32_t>(way);
+                l.loop_valid = (loop.confidence == 3) && (loop.past_iter != 0);
+                l.loop_pred = (loop.current_iter == loop.past_iter) ? !loop.dir : loop.dir;
+                break;
+            }
+        }
+        if (l.loop_valid && (use_loop_ >= 0)) {
+            l.pred = l.loop_pred;
+        }
+    }
+
+    BranchPrediction TageScLBranchPredictor::getPrediction(const BranchInput & input)
+    {
+        BranchPrediction prediction;
+        if (input.is_conditional) {
+            lookup_(input);
+            prediction.taken = last_.pred;
+        } else {
+            last_.valid = false;
+            prediction.taken = true;
+        }
+        prediction.target = btb_.lookup(input.pc);
+        return prediction;
+    }
+
+    void TageScLBranchPredictor::updatePredictor(const BranchUpdate & update)
+    {
+        if (update.branch.is_conditional) {
+            if ((false == last_.valid) || (last_.pc != update.branch.pc)) {
+                lookup_(update.branch);
+            }
+            updateLoop_(update.taken);
+            updateStatisticalCorrector_(update.taken);
+            updateTage_(update.taken);
+            last_.valid = false;
+        }
+        if (update.taken) {
+            btb_.update(update.branch.pc, update.target);
+        }
+        updateHistory_(update.branch.pc, update.taken);
+    }
+
+    void TageScLBranchPredictor::updateTage_(bool taken)
+    {
+        Lookup & l = last_;
+
+        // Allocate longer entries when TAGE was wrong
+        if ((l.tage_pred != taken) && (l.provider < static_cast<int32_t>(num_tables_) - 1)) {
+            // Start one or two tables past the provider, so that
+            // allocations spread over the longer tables
+            uint32_t first = static_cast<uint32_t>(l.provider + 1) + (random_() & 1);
+            first = std::min(first, num_tables_ - 1);
+            bool allocated = false;
+            for (uint32_t t = first; t < num_tables_; ++t) {
+                TaggedEntry & candidate = entry_(t, l.indices[t]);
+                if (candidate.u == 0) {
+                    candidate.tag = l.tags[t];
+                    candidate.ctr = taken ? 0 : -1;
+                    allocated = true;
+                    break;
+                }
+            }
+            if (false == allocated) {
+                for (uint32_t t = first; t < num_tables_; ++t) {
+                    TaggedEntry & candidate = entry_(t, l.indices[t]);
+                    candidate.u = static_cast<uint8_t>(std::max(candidate.u - 1, 0));
+                }
+            }
+        }
+
+        if (l.provider >= 0) {
+            TaggedEntry & provider = entry_(l.provider, l.indices[l.provider]);
+            if (l.weak_new && (l.provider_pred != l.alt_pred)) {
+                saturatingUpdate(use_alt_on_new_, (l.alt_pred == taken), -8, 7);
+            }
+            saturatingUpdate(provider.ctr, taken, TAGE_CTR_MIN, TAGE_CTR_MAX);
+            if (provider.u == 0) {
+                // Not yet useful: train the alternate too
+                if (l.alt >= 0) {
+                    TaggedEntry & alt = entry_(l.alt, l.indices[l.alt]);
+                    saturatingUpdate(alt.ctr, taken, TAGE_CTR_MIN, TAGE_CTR_MAX);
+                } else {
+                    saturatingUpdate(bimodal_[l.bimodal_index], taken, 0, 3);
+                }
+            }
+            if (l.provider_pred != l.alt_pred) {
+                saturatingUpdate(provider.u, (l.provider_pred == taken), 0, 3);
+            }
+        } else {
+            saturatingUpdate(bimodal_[l.bimodal_index], taken, 0, 3);
+        }
+
+        // Age usefulness so stale entries can be replaced
+        if ((++u_tick_ & ((1u << U_RESET_LOG_PERIOD) - 1)) == 0) {
+            for (auto & entry : tagged_) {
+                entry.u >>= 1;
+            }
+        }
+    }
+
+    void TageScLBranchPredictor::updateStatisticalCorrector_(bool taken)
+    {
+        Lookup & l = last_;
+        if ((l.sc_pred != taken) || (std::abs(l.sc_sum) < sc_threshold_)) {
+            for (const uint32_t index : l.sc_indices) {
+                saturatingUpdate(sc_tables_[index], taken, SC_CTR_MIN, SC_CTR_MAX);
+            }
+        }
+
+        // Raise the threshold when corrections go wrong, lower it when
+        // they would have been right
+        if (l.sc_pred != l.tage_pred) {
+            if (l.sc_pred != taken) {
+                if (++sc_threshold_ctr_ >= 32) {
+                    ++sc_threshold_;
+                    sc_threshold_ctr_ = 0;
+                }
+            } else if (--sc_threshold_ctr_ <= -32) {
+                sc_threshold_ = std::max(sc_threshold_ - 1, 4);
+                sc_threshold_ctr_ = 0;
+            }
+        }
+    }
+
+    void TageScLBranchPredictor::updateLoop_(bool taken)
+    {
+        Lookup & l = last_;
+        LoopEntry* const set = &loops_[l.loop_index * LOOP_WAYS];
+
+        if (l.loop_way >= 0) {
+            LoopEntry & loop = set[l.loop_way];
+
+            // Trust the loop predictor when it disagrees with the rest
+            const bool rest = l.sc_used ? l.sc_pred : l.tage_pred;
+            if (l.loop_valid && (l.loop_pred != rest)) {
+                saturatingUpdate(use_loop_, (l.loop_pred == taken), -8, 7);
+            }
+
+            if (l.loop_valid && (l.loop_pred != taken)) {
+                // Trip count changed
+                loop.valid = false;
+                return;
+            }
+            if (l.loop_valid && (rest != taken)) {
+                loop.age = static_cast<uint8_t>(std::min(loop.age + 1, 255));
+            }
+
+            if (taken == loop.dir) {
+                ++loop.current_iter;
+                if ((loop.current_iter > LOOP_MAX_ITER)
+                    || ((loop.past_iter != 0) && (loop.current_iter > loop.past_iter))) {
+                    loop.valid = false;
+                }
+            } else {
+                // Loop exit.  None before it: allocated on a body
+                // branch, with the directions swapped
+                if (loop.current_iter == 0) {
+                    loop.valid = false;
+                } else if (loop.past_iter == 0) {
+                    loop.past_iter = loop.current_iter;
+                } else if (loop.current_iter == loop.past_iter) {
+                    loop.confidence = static_cast<uint8_t>(std::min(loop.confidence + 1, 3));
+                } else {
+                    loop.past_iter = loop.current_iter;
+                    loop.confidence = 0;
+                }
+                loop.current_iter = 0;
+            }
+            return;
+        }
+
+        // Allocate on a misprediction, taking this outcome as an exit
+        if (l.pred != taken) {
+            for (uint32_t way = 0; way < LOOP_WAYS; ++way) {
+                LoopEntry & loop = set[way];
+                if ((false == loop.valid) || (loop.age == 0)) {
+                    loop = LoopEntry();
+                    loop.valid = true;
+                    loop.tag = loopTag_(l.pc);
+                    loop.dir = !taken;
+                    loop.age = 7;
+                    return;
+                }
+            }
+            for (uint32_t way = 0; way < LOOP_WAYS; ++way) {
+                --set[way].age;
+            }
+        }
+    }
+
+    void TageScLBranchPredictor::updateHistory_(uint64_t pc, bool taken)
+    {
+        // Locals: the byte-sized history would otherwise alias the folds
+        const uint32_t new_bit = taken ? 1 : 0;
+        const uint32_t mask = static_cast<uint32_t>(ghist_.size() - 1);
+        const uint32_t head = (ghist_head_ - 1) & mask;
+        uint8_t* const ghist = ghist_.data();
+        ghist[head] = static_cast<uint8_t>(new_bit);
+        ghist_head_ = head;
+        for (uint32_t t = 0; t < num_tables_; ++t) {
+            const uint32_t old_bit = ghist[(head + history_lengths_[t]) & mask];
+            index_folds_[t].update(new_bit, old_bit);
+            tag_folds_[t].update(new_bit, old_bit);
+            tag_folds2_[t].update(new_bit, old_bit);
+        }
+        recent_history_ = (recent_history_ << 1) | new_bit;
+        path_history_ = ((path_history_ << 1) ^ ((pc >> 1) & 1)) & 0xffff;
+    }
+
+} // namespace BranchPredictor
+} // namespace olympia
@@ -0,0 +1,198 @@
+// <TageScL.hpp> -*- C++ -*-
+
+//!
+//! \file TageScL.hpp
+//! \brief A TAGE-SC-L branch predictor with fixed-size flat tables
+//!
+
+/*
+ * TAGE-SC-L (Seznec): a bimodal base predictor, tagged tables indexed
+ * with geometrically longer global histories (TAGE), a statistical
+ * corrector that can revert low-confidence TAGE predictions (SC), and
+ * a loop predictor for loops with a constant trip count (L).
+ *
+ * Every table is a power-of-two sized vector allocated once, in the
+ * constructor.  Histories are kept in a circular bit buffer and folded
+ * incrementally into the table indices and tags, so a prediction and
+ * an update cost a few operations per tagged table.
+ * */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "BranchPred.hpp"
+
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    class TageScLBranchPredictor : public FetchBranchPredictorIF, public PredictorStateIF
+    {
+    public:
+        //! Most tagged tables supported
+        static constexpr uint32_t MAX_TABLES = 16;
+
+        explicit TageScLBranchPredictor(const PredictorConfig & config);
+
+        BranchPrediction getPrediction(const BranchInput & input) override;
+        void updatePredictor(const BranchUpdate & update) override;
+
+        //! Bits of prediction state, BTB excluded
+        uint64_t getStorageBits() const;
+
+        //! History length of each tagged table
+        const std::vector<uint32_t> & getHistoryLengths() const { return history_lengths_; }
+
+        double getBTBCoverage() const override { return btb_.getCoverage(); }
+
+        //! Every table, the global and folded histories and the
+        //! adaptive thresholds.  The last lookup is not kept
+        void saveCheckpoint(std::ostream & os) override;
+        void restoreCheckpoint(std::istream & is) override;
+
+    private:
+        ////////////////////////////////////////////////////////////////////////////////
+        // Tables
+
+        struct TaggedEntry
+        {
+            int8_t ctr = 0;   // 3-bit signed: taken if >= 0
+            uint8_t u = 0;    // 2-bit usefulness
+            uint16_t tag = 0;
+        };
+
+        struct LoopEntry
+        {
+            uint16_t tag = 0;
+            uint16_t past_iter = 0;    // Body iterations of the last trip
+            uint16_t current_iter = 0; // Body iterations of this trip so far
+            uint8_t confidence = 0;    // Valid at 3
+            uint8_t age = 0;
+            bool dir = false;          // Direction of the loop body
+            bool valid = false;
+        };
+
+        //! A global history folded to a shorter length, updated as
+        //! the history moves
+        struct FoldedHistory
+        {
+            uint32_t value = 0;
+            uint32_t folded_length = 0;
+            uint32_t outpoint = 0;
+            uint32_t mask = 0;
+
+            void init(uint32_t original, uint32_t folded) {
+                folded_length = folded;
+                outpoint = original % folded;
+                mask = (1u << folded) - 1;
+                value = 0;
+            }
+
+            void update(uint32_t new_bit, uint32_t old_bit) {
+                value = (value << 1) ^ new_bit ^ (old_bit << outpoint);
+                value = (value ^ (value >> folded_length)) & mask;
+            }
+        };
+
+        //! What getPrediction looked up, for the update that follows
+        struct Lookup
+        {
+            uint64_t pc = 0;
+            bool valid = false;
+            std::array<uint32_t, MAX_TABLES> indices;
+            std::array<uint16_t, MAX_TABLES> tags;
+            int32_t provider = -1; // Tagged table, -1 for the base
+            int32_t alt = -1;
+            bool provider_pred = false;
+            bool alt_pred = false;
+            bool weak_new = false; // Provider newly allocated and weak
+            bool tage_pred = false;
+            bool tage_confident = false;
+            uint32_t bimodal_index = 0;
+
+            std::array<uint32_t, 4> sc_indices;
+            int32_t sc_sum = 0;
+            bool sc_pred = false;
+            bool sc_used = false;
+
+            uint32_t loop_index = 0;
+            int32_t loop_way = -1;
+            bool loop_valid = false;
+            bool loop_pred = false;
+
+            bool pred = false;
+        };
+
+        void lookup_(const BranchInput & input);
+        void updateTage_(bool taken);
+        void updateStatisticalCorrector_(bool taken);
+        void updateLoop_(bool taken);
+        void updateHistory_(uint64_t pc, bool taken);
+
+        uint32_t tableIndex_(uint32_t table, uint64_t pc) const;
+        uint16_t tableTag_(uint32_t table, uint64_t pc) const;
+        TaggedEntry & entry_(uint32_t table, uint32_t index) {
+            return tagged_[(static_cast<size_t>(table) << table_bits_) + index];
+        }
+        uint16_t loopTag_(uint64_t pc) const {
+            return static_cast<uint16_t>((pc >> (1 + loop_set_bits_)) & 0x3ff);
+        }
+        uint32_t random_();
+
+        // Sizes
+        const uint32_t num_tables_;
+        const uint32_t table_bits_;
+        const uint32_t tag_bits_;
+        const uint32_t bimodal_bits_;
+        const uint32_t sc_bits_;
+        const uint32_t loop_set_bits_;
+
+        // Base predictor: 2-bit counters
+        std::vector<uint8_t> bimodal_;
+
+        // Tagged tables, one after the other
+        std::vector<TaggedEntry> tagged_;
+        std::vector<uint32_t> history_lengths_;
+        std::array<FoldedHistory, MAX_TABLES> index_folds_;
+        std::array<FoldedHistory, MAX_TABLES> tag_folds_;
+        std::array<FoldedHistory, MAX_TABLES> tag_folds2_;
+        std::array<uint32_t, MAX_TABLES> pc_shifts_; // Spreads PC bits differently per table
+
+        // Choose the alternate prediction over a newly allocated entry?
+        int32_t use_alt_on_new_ = 0;
+
+        // Periodic usefulness aging
+        uint32_t u_tick_ = 0;
+
+        // Statistical corrector: a bias table indexed by the PC and
+        // the TAGE prediction, and three global history tables
+        static constexpr std::array<uint32_t, 4> SC_HISTORY_LENGTHS{0, 8, 16, 32};
+        std::vector<int8_t> sc_tables_;
+        int32_t sc_threshold_ = 12;
+        int32_t sc_threshold_ctr_ = 0;
+
+        // Loop predictor: 4-way sets
+        static constexpr uint32_t LOOP_WAYS = 4;
+        std::vector<LoopEntry> loops_;
+        int32_t use_loop_ = 0;
+
+        // Global history: newest outcome at ghist_head_
+        std::vector<uint8_t> ghist_;
+        uint32_t ghist_head_ = 0;
+        uint64_t recent_history_ = 0; // Last 64 outcomes, newest in bit 0
+        uint64_t path_history_ = 0;
+
+        BranchTargetBuffer btb_;
+
+        uint32_t random_state_ = 0x2545f491;
+
+        Lookup last_;
+    };
+
+} // namespace BranchPredictor
+} // namespace olympia
@@ -0,0 +1,339 @@
+#include "TargetPred.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    namespace
+    {
+        // Fold a history of up to 64 bits down to bits
+        uint32_t foldHistory(uint64_t history, uint32_t bits) {
+            uint64_t folded = 0;
+            while (history != 0) {
+                folded ^= history;
+                history >>= bits;
+            }
+            return static_cast<uint32_t>(folded & ((1ull << bits) - 1));
+        }
+
+        constexpr uint32_t ITTAGE_TAG_BITS = 10;
+        constexpr uint32_t ITTAGE_MIN_HISTORY = 2;
+        constexpr uint32_t ITTAGE_MAX_HISTORY = 64;
+        constexpr uint8_t ITTAGE_CTR_MAX = 3;
+    }
+
+    ReturnAddressStack::ReturnAddressStack(uint32_t entries) :
+        entries_(entries, 0),
+        mask_(entries - 1)
+    {
+        sparta_assert((entries != 0) && ((entries & (entries - 1)) == 0),
+                      "RAS entries must be a power of 2, got " << entries);
+    }
+
+    IttagePredictor::IttagePredictor(const PredictorConfig & config) :
+        num_tables_(config.ittage_num_tables),
+        table_bits_(config.ittage_table_bits),
+        tables_(static_cast<size_t>(config.ittage_num_tables) << config.ittage_table_bits),
+        history_lengths_(config.ittage_num_tables)
+    {
+        sparta_assert((num_tables_ >= 2) && (num_tables_ <= MAX_TABLES),
+                      "ITTAGE needs 2 to " << MAX_TABLES << " tagged tables");
+        sparta_assert((table_bits_ >= 2) && (table_bits_ <= 20), "ITTAGE table size out of range");
+
+        // Geometric history lengths, all within the 64-bit global history
+        const double ratio = static_cast<double>(ITTAGE_MAX_HISTORY) / ITTAGE_MIN_HISTORY;
+        for (uint32_t t = 0; t < num_tables_; ++t) {
+            history_lengths_[t] = static_cast<uint32_t>(
+                ITTAGE_MIN_HISTORY * std::pow(ratio, static_cast<double>(t) / (num_tables_ - 1))
+                + 0.5);
+            if ((t != 0) && (history_lengths_[t] <= history_lengths_[t - 1])) {
+                history_lengths_[t] = history_lengths_[t - 1] + 1;
+            }
+        }
+    }
+
+    uint32_t IttagePredictor::random_()
+    {
+        // xorshift32: deterministic, so runs repeat exactly
+        random_state_ ^= random_state_ << 13;
+        random_state_ ^= random_state_ >> 17;
+        random_state_ ^= random_state_ << 5;
+        return random_state_;
+    }
+
+    void IttagePredictor::lookup_(uint64_t pc)
+    {
+        Lookup & l = last_;
+        l.pc = pc;
+        l.valid = true;
+        l.provider = -1;
+        l.alt = -1;
+        l.target = 0;
+
+        const uint64_t p = pc >> 1;
+        for (int32_t t = static_cast<int32_t>(num_tables_) - 1; t >= 0; --t) {
+            const uint32_t length = history_lengths_[t];
+            const uint64_t history = (length >= 64) ? global_history_
+                                                    : (global_history_ & ((1ull << length) - 1));
+            const uint64_t path = path_history_ & ((1ull << std::min(length, 16u)) - 1);
+            const uint64_t index = p ^ (p >> (table_bits_ - (t % table_bits_)))
+                                   ^ foldHistory(history, table_bits_) ^ path;
+            l.indices[t] = static_cast<uint32_t>(index & ((1ull << table_bits_) - 1));
+            l.tags[t] = static_cast<uint16_t>(
+                (p ^ foldHistory(history, ITTAGE_TAG_BITS)
+                 ^ (foldHistory(history, ITTAGE_TAG_BITS - 1) << 1))
+                & ((1u << ITTAGE_TAG_BITS) - 1));
+
+            if (entry_(t, l.indices[t]).tag == l.tags[t]) {
+                if (l.provider < 0) {
+                    l.provider = t;
+                } else if (l.alt < 0) {
+                    l.alt = t;
+                }
+            }
+        }
+
+        // A provider that has just been allocated defers to the alternate
+        if (l.provider >= 0) {
+            const Entry & provider = entry_(l.provider, l.indices[l.provider]);
+            if ((provider.ctr == 0) && (l.alt >= 0)) {
+                l.target = entry_(l.alt, l.indices[l.alt]).target;
+            } else {
+                l.target = provider.target;
+            }
+        }
+    }
+
+    uint64_t IttagePredictor::predict(uint64_t pc)
+    {
+        lookup_(pc);
+        return last_.target;
+    }
+
+    void IttagePredictor::update(uint64_t pc, uint64_t target)
+    {
+        if ((false == last_.valid) || (last_.pc != pc)) {
+            lookup_(pc);
+        }
+        Lookup & l = last_;
+        l.valid = false;
+        if (target == 0) {
+            return;
+        }
+
+        if (l.provider >= 0) {
+            Entry & provider = entry_(l.provider, l.indices[l.provider]);
+            const bool alt_correct =
+                (l.alt >= 0) && (entry_(l.alt, l.indices[l.alt]).target == target);
+            if (provider.target == target) {
+                provider.ctr = std::min<uint8_t>(provider.ctr + 1, ITTAGE_CTR_MAX);
+                if (false == alt_correct) {
+                    provider.u = 1;
+                }
+            } else if (provider.ctr > 0) {
+                --provider.ctr;
+            } else {
+                // Replace a target that has not been confirmed
+                provider.target = target;
+            }
+            if ((provider.target != target) && alt_correct) {
+                provider.u = 0;
+            }
+        }
+
+        if (l.target == target) {
+            return;
+        }
+
+        // Allocate in a longer history table, starting at a random one
+        // of the first two candidates
+        const uint32_t first = static_cast<uint32_t>(l.provider + 1);
+        if (first >= num_tables_) {
+            return;
+        }
+        uint32_t start = first;
+        if (((first + 1) < num_tables_) && ((random_() & 1) != 0)) {
+            ++start;
+        }
+        for (uint32_t t = start; t < num_tables_; ++t) {
+            Entry & candidate = entry_(t, l.indices[t]);
+            if (candidate.u == 0) {
+                candidate.tag = l.tags[t];
+                candidate.target = target;
+                candidate.ctr = 0;
+                return;
+            }
+        }
+        // No room: make room for the next allocation
+        for (uint32_t t = first; t < num_tables_; ++t) {
+            entry_(t, l.indices[t]).u = 0;
+        }
+    }
+
+    void IttagePredictor::updateHistory(const BranchInput & branch, bool taken, uint64_t target)
+    {
+        if (branch.is_conditional) {
+            global_history_ = (global_history_ << 1) | (taken ? 1 : 0);
+        } else if (branch.is_indirect) {
+            // Indirect targets tell most about the next indirect target
+            global_history_ = (global_history_ << 3) ^ ((target >> 1) & 0x7);
+        }
+        path_history_ = ((path_history_ << 1) ^ ((branch.pc >> 1) & 1)) & 0xffff;
+    }
+
+    void IttagePredictor::saveCheckpoint(std::ostream & os) const
+    {
+        // Entries are padded: write them field by field
+        checkpoint::write<uint64_t>(os, tables_.size());
+        for (const auto & entry : tables_) {
+            checkpoint::write(os, entry.target);
+            checkpoint::write(os, entry.tag);
+            checkpoint::write(os, entry.ctr);
+            checkpoint::write(os, entry.u);
+        }
+        checkpoint::write(os, global_history_);
+        checkpoint::write(os, path_history_);
+        checkpoint::write(os, random_state_);
+    }
+
+    void IttagePredictor::restoreCheckpoint(std::istream & is)
+    {
+        const auto saved_size = checkpoint::read<uint64_t>(is);
+        if (saved_size != tables_.size()) {
+            throw sparta::SpartaException("ERROR: Checkpoint has ")
+                << saved_size << " ITTAGE entries, the model has " << tables_.size();
+        }
+        for (auto & entry : tables_) {
+            entry.target = checkpoint::read<uint64_t>(is);
+            entry.tag = checkpoint::read<uint16_t>(is);
+            entry.ctr = checkpoint::read<uint8_t>(is);
+            entry.u = checkpoint::read<uint8_t>(is);
+        }
+        global_history_ = checkpoint::read<uint64_t>(is);
+        path_history_ = checkpoint::read<uint64_t>(is);
+        random_state_ = checkpoint::read<uint32_t>(is);
+        last_ = Lookup();
+    }
+
+    TargetPredictor::TargetPredictor(std::unique_ptr<FetchBranchPredictorIF> direction,
+                                     const PredictorConfig & config) :
+        direction_(std::move(direction)),
+        ras_(std::max(config.ras_entries, 1u)),
+        use_ras_(config.ras_entries != 0)
+    {
+        sparta_assert(direction_ != nullptr, "TargetPredictor needs a direction predictor");
+        if (config.ittage_num_tables != 0) {
+            ittage_ = std::make_unique<IttagePredictor>(config);
+        }
+    }
+
+    uint64_t TargetPredictor::updateStack_(const BranchInput & branch)
+    {
+        // A call that returns (jalr ra, ra) pops, then pushes
+        uint64_t return_addr = 0;
+        if (branch.is_return) {
+            return_addr = ras_.pop();
+        }
+        if (branch.is_call) {
+            ras_.push(branch.pc + branch.inst_size);
+        }
+        return return_addr;
+    }
+
+    BranchPrediction TargetPredictor::getPrediction(const BranchInput & input)
+    {
+        Pending pending;
+        pending.checkpoint = ras_.checkpoint();
+        pending.prediction = direction_->getPrediction(input);
+
+        uint64_t target = 0;
+        if (use_ras_) {
+            target = updateStack_(input);
+        }
+        if ((target == 0) && input.is_indirect && (false == input.is_return)
+            && (nullptr != ittage_)) {
+            target = ittage_->predict(input.pc);
+        }
+        if (target != 0) {
+            pending.prediction.target = target;
+        }
+
+        pending_.push_back(pending);
+        return pending.prediction;
+    }
+
+    void TargetPredictor::updatePredictor(const BranchUpdate & update)
+    {
+        direction_->updatePredictor(update);
+        if (nullptr != ittage_) {
+            if (update.branch.is_indirect && (false == update.branch.is_return)) {
+                ittage_->update(update.branch.pc, update.target);
+            }
+            ittage_->updateHistory(update.branch, update.taken, update.target);
+        }
+
+        if (pending_.empty()) {
+            return;
+        }
+        const Pending pending = pending_.front();
+        pending_.pop_front();
+
+        const bool mispredicted =
+            (pending.prediction.taken != update.taken)
+            || (update.taken && (update.target != 0) && (pending.prediction.target != update.target));
+        if (mispredicted && use_ras_) {
+            // Younger predictions were on the wrong path: undo their
+            // pushes and pops, and redo this branch's own
+            ras_.restore(pending.checkpoint);
+            updateStack_(update.branch);
+            pending_.clear();
+        }
+    }
+
+    double TargetPredictor::getBTBCoverage() const
+    {
+        const auto state = dynamic_cast<const PredictorStateIF*>(direction_.get());
+        return (nullptr != state) ? state->getBTBCoverage() : 0.0;
+    }
+
+    void TargetPredictor::saveCheckpoint(std::ostream & os)
+    {
+        sparta_assert(pending_.empty(),
+                      "Checkpoint taken with " << pending_.size() << " predictions pending");
+        if (auto state = dynamic_cast<PredictorStateIF*>(direction_.get()); nullptr != state) {
+            state->saveCheckpoint(os);
+        }
+        ras_.saveCheckpoint(os);
+        checkpoint::write<uint8_t>(os, (nullptr != ittage_) ? 1 : 0);
+        if (nullptr != ittage_) {
+            ittage_->saveCheckpoint(os);
+        }
+    }
+
+    void TargetPredictor::restoreCheckpoint(std::istream & is)
+    {
+        if (auto state = dynamic_cast<PredictorStateIF*>(direction_.get()); nullptr != state) {
+            state->restoreCheckpoint(is);
+        }
+        ras_.restoreCheckpoint(is);
+        const bool saved_ittage = checkpoint::read<uint8_t>(is) != 0;
+        if (saved_ittage != (nullptr != ittage_)) {
+            throw sparta::SpartaException("ERROR: Checkpoint was taken with ITTAGE ")
+                << (saved_ittage ? "on" : "off") << ", the model has it "
+                << (saved_ittage ? "off" : "on");
+        }
+        if (nullptr != ittage_) {
+            ittage_->restoreCheckpoint(is);
+        }
+        pending_.clear();
+    }
+
+} // namespace BranchPredictor
+} // namespace olympia
@@ -0,0 +1,199 @@
+// <TargetPred.hpp> -*- C++ -*-
+
+//!
+//! \file TargetPred.hpp
+//! \brief Return address stack and ITTAGE indirect target predictor
+//!
+
+/*
+ * The direction predictors find every target in a BTB, which holds
+ * one target per branch: returns from a function called from several
+ * places, and indirect jumps with several targets, miss.
+ * TargetPredictor wraps a direction predictor and overrides its
+ * target with a return address stack (RAS) for returns and with an
+ * ITTAGE predictor (Seznec) for other indirect jumps.
+ *
+ * The RAS is updated when a call or return is predicted, and each
+ * prediction keeps a checkpoint of the stack: its top pointer and top
+ * entry.  When a branch resolves mispredicted, the predictions younger
+ * than it were on the wrong path: the RAS is restored from the
+ * branch's checkpoint and the branch's own push or pop is done again.
+ * */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "BranchPred.hpp"
+#include "RingQueue.hpp"
+
+namespace olympia
+{
+namespace BranchPredictor
+{
+
+    //! Circular return address stack.  Overflow overwrites the oldest entry
+    class ReturnAddressStack
+    {
+    public:
+        //! What a checkpoint keeps: enough to undo wrong-path pops, or
+        //! a pop followed by a push
+        struct Checkpoint
+        {
+            uint32_t top = 0;
+            uint64_t top_addr = 0;
+        };
+
+        //! entries must be a power of 2
+        explicit ReturnAddressStack(uint32_t entries);
+
+        void push(uint64_t return_addr) {
+            top_ = (top_ + 1) & mask_;
+            entries_[top_] = return_addr;
+        }
+
+        //! Predicted return address.  0 if nothing was pushed there
+        uint64_t pop() {
+            const uint64_t addr = entries_[top_];
+            top_ = (top_ - 1) & mask_;
+            return addr;
+        }
+
+        Checkpoint checkpoint() const { return {top_, entries_[top_]}; }
+
+        void restore(const Checkpoint & checkpoint) {
+            top_ = checkpoint.top;
+            entries_[top_] = checkpoint.top_addr;
+        }
+
+        void saveCheckpoint(std::ostream & os) const {
+            checkpoint::writeTable(os, entries_);
+            checkpoint::write(os, top_);
+        }
+
+        void restoreCheckpoint(std::istream & is) {
+            checkpoint::readTable(is, entries_);
+            top_ = checkpoint::read<uint32_t>(is) & mask_;
+        }
+
+    private:
+        std::vector<uint64_t> entries_;
+        const uint32_t mask_;
+        uint32_t top_ = 0;
+    };
+
+    /*!
+     * \brief ITTAGE: tagged tables of targets indexed with geometrically
+     *        longer global histories.  The longest matching history
+     *        provides the target
+     */
+    class IttagePredictor
+    {
+    public:
+        //! Most tagged tables supported
+        static constexpr uint32_t MAX_TABLES = 8;
+
+        explicit IttagePredictor(const PredictorConfig & config);
+
+        //! Target of the indirect branch at pc.  0 if no table has one
+        uint64_t predict(uint64_t pc);
+
+        //! Train with the target of the branch last predicted
+        void update(uint64_t pc, uint64_t target);
+
+        //! Add a branch's outcome to the global history
+        void updateHistory(const BranchInput & branch, bool taken, uint64_t target);
+
+        //! History length of each tagged table
+        const std::vector<uint32_t> & getHistoryLengths() const { return history_lengths_; }
+
+        //! Tables and histories.  The last lookup is not kept
+        void saveCheckpoint(std::ostream & os) const;
+        void restoreCheckpoint(std::istream & is);
+
+    private:
+        struct Entry
+        {
+            uint64_t target = 0;
+            uint16_t tag = 0;
+            uint8_t ctr = 0; // 2-bit confidence
+            uint8_t u = 0;   // 1-bit usefulness
+        };
+
+        //! What predict looked up, for the update that follows
+        struct Lookup
+        {
+            uint64_t pc = 0;
+            bool valid = false;
+            std::array<uint32_t, MAX_TABLES> indices;
+            std::array<uint16_t, MAX_TABLES> tags;
+            int32_t provider = -1;
+            int32_t alt = -1;
+            uint64_t target = 0;
+        };
+
+        void lookup_(uint64_t pc);
+        Entry & entry_(uint32_t table, uint32_t index) {
+            return tables_[(static_cast<size_t>(table) << table_bits_) + index];
+        }
+        uint32_t random_();
+
+        const uint32_t num_tables_;
+        const uint32_t table_bits_;
+        std::vector<Entry> tables_;
+        std::vector<uint32_t> history_lengths_;
+
+        // Global history, newest outcome in bit 0, and path history
+        uint64_t global_history_ = 0;
+        uint64_t path_history_ = 0;
+
+        uint32_t random_state_ = 0x6a09e667;
+
+        Lookup last_;
+    };
+
+    //! A direction predictor with RAS and ITTAGE target prediction
+    class TargetPredictor : public FetchBranchPredictorIF, public PredictorStateIF
+    {
+    public:
+        TargetPredictor(std::unique_ptr<FetchBranchPredictorIF> direction,
+                        const PredictorConfig & config);
+
+        BranchPrediction getPrediction(const BranchInput & input) override;
+        void updatePredictor(const BranchUpdate & update) override;
+
+        //! The direction predictor's BTB.  0 if it has no fixed tables
+        double getBTBCoverage() const override;
+
+        //! The direction predictor's state (if it has any), then the
+        //! RAS and ITTAGE
+        void saveCheckpoint(std::ostream & os) override;
+        void restoreCheckpoint(std::istream & is) override;
+
+    private:
+        //! A prediction not updated yet
+        struct Pending
+        {
+            ReturnAddressStack::Checkpoint checkpoint;
+            BranchPrediction prediction;
+        };
+
+        //! The RAS pop and push of a return or call.  Returns the
+        //! popped address, 0 if none
+        uint64_t updateStack_(const BranchInput & branch);
+
+        std::unique_ptr<FetchBranchPredictorIF> direction_;
+        ReturnAddressStack ras_;
+        const bool use_ras_;
+        std::unique_ptr<IttagePredictor> ittage_;
+
+        // Predictions waiting for their update, in program order
+        RingQueue<Pending> pending_;
+    };
+
+} // namespace BranchPredictor
+} // namespace olympia
@@ -0,0 +1,129 @@
+// <UopCache.cpp> -*- C++ -*-
+
+#include "UopCache.hpp"
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    namespace
+    {
+        bool isPowerOf2(uint64_t value) { return (value != 0) && ((value & (value - 1)) == 0); }
+
+        uint32_t log2(uint64_t value)
+        {
+            uint32_t bits = 0;
+            while (value > 1)
+            {
+                value >>= 1;
+                ++bits;
+            }
+            return bits;
+        }
+    } // namespace
+
+    UopCache::UopCache(uint32_t num_entries, uint32_t associativity, uint32_t window_bytes,
+                       uint32_t uops_per_entry) :
+        associativity_(associativity),
+        window_shift_(log2(window_bytes)),
+        uops_per_entry_(uops_per_entry),
+        set_mask_((associativity != 0) ? ((num_entries / associativity) - 1) : 0),
+        entries_(num_entries)
+    {
+        sparta_assert((associativity != 0) && ((num_entries % associativity) == 0)
+                          && isPowerOf2(num_entries / associativity),
+                      "Micro-op cache entries (" << num_entries << ") / associativity ("
+                                                 << associativity << ") must be a power of 2");
+        sparta_assert(isPowerOf2(window_bytes),
+                      "Micro-op cache window must be a power of 2 bytes, got " << window_bytes);
+        sparta_assert(uops_per_entry != 0, "A micro-op cache entry must hold at least 1 uop");
+
+        // An entry never holds more instructions than uops: no
+        // allocation after construction
+        for (auto & entry : entries_)
+        {
+            entry.insts.reserve(uops_per_entry);
+        }
+    }
+
+    UopCache::Entry* UopCache::findEntry_(uint64_t window)
+    {
+        Entry* set = &entries_[(window & set_mask_) * associativity_];
+        for (uint32_t way = 0; way < associativity_; ++way)
+        {
+            if (set[way].valid && (set[way].window == window))
+            {
+                return &set[way];
+            }
+        }
+        return nullptr;
+    }
+
+    const UopCache::DecodedInst* UopCache::lookup(uint64_t pc)
+    {
+        Entry* entry = findEntry_(pc >> window_shift_);
+        if (entry == nullptr)
+        {
+            return nullptr;
+        }
+        for (const auto & decoded : entry->insts)
+        {
+            if (decoded.pc == pc)
+            {
+                entry->last_use = ++use_clock_;
+                return &decoded;
+            }
+        }
+        return nullptr;
+    }
+
+    bool UopCache::fill(const DecodedInst & decoded)
+    {
+        const uint64_t window = decoded.pc >> window_shift_;
+        Entry* entry = findEntry_(window);
+        if (entry == nullptr)
+        {
+            // Replace an invalid entry, or the least recently used one
+            Entry* set = &entries_[(window & set_mask_) * associativity_];
+            entry = &set[0];
+            for (uint32_t way = 0; way < associativity_; ++way)
+            {
+                if (!set[way].valid)
+                {
+                    entry = &set[way];
+                    break;
+                }
+                if (set[way].last_use < entry->last_use)
+                {
+                    entry = &set[way];
+                }
+            }
+            entry->window = window;
+            entry->valid = true;
+            entry->num_uops = 0;
+            entry->insts.clear();
+        }
+        entry->last_use = ++use_clock_;
+
+        for (auto & cached : entry->insts)
+        {
+            if (cached.pc == decoded.pc)
+            {
+                // Decoded again: the fusion around it may have changed.
+                // Keep the uop count the entry was sized with
+                cached.fusion_status = decoded.fusion_status;
+                cached.fusion_size = decoded.fusion_size;
+                return true;
+            }
+        }
+
+        if ((entry->num_uops + decoded.num_uops) > uops_per_entry_)
+        {
+            return false;
+        }
+        entry->num_uops += decoded.num_uops;
+        entry->insts.emplace_back(decoded);
+        return true;
+    }
+
+} // namespace olympia
@@ -0,0 +1,84 @@
+// <UopCache.hpp> -*- C++ -*-
+
+//!
+//! \file UopCache.hpp
+//! \brief Decoded micro-op cache in front of Decode's decoders
+//!
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Inst.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class UopCache
+     * \brief Set-associative cache of what Decode made of each
+     *        instruction, with one entry per aligned window of code
+     *
+     * An entry keeps, for each instruction of its window that decode
+     * has seen, the number of uops it cracked into and how fusion
+     * marked it.  An entry has room for a fixed number of uops: the
+     * instructions of a window that do not fit are not cached and
+     * miss every time.  Replacement is LRU within a set.
+     */
+    class UopCache
+    {
+      public:
+        //! What decode made of one instruction
+        struct DecodedInst
+        {
+            uint64_t pc = 0;
+            uint32_t num_uops = 1;
+            Inst::Status fusion_status = Inst::Status::UNMOD;
+            //! Instructions in the fusion group a FUSED instruction
+            //! heads, itself included
+            uint32_t fusion_size = 1;
+        };
+
+        /*!
+         * \param num_entries    Entries in the cache
+         * \param associativity  Entries per set.  num_entries /
+         *                       associativity must be a power of 2
+         * \param window_bytes   Bytes of code per entry (power of 2)
+         * \param uops_per_entry Uops an entry can hold
+         */
+        UopCache(uint32_t num_entries, uint32_t associativity, uint32_t window_bytes,
+                 uint32_t uops_per_entry);
+
+        //! The cached decode of the instruction at pc, or nullptr
+        const DecodedInst* lookup(uint64_t pc);
+
+        //! Cache decode's output for an instruction, replacing the LRU
+        //! entry of the set if its window is not cached.  Returns false
+        //! if the window's entry has no room left for its uops
+        bool fill(const DecodedInst & decoded);
+
+      private:
+        struct Entry
+        {
+            uint64_t window = 0;
+            bool valid = false;
+            uint64_t last_use = 0;
+            uint32_t num_uops = 0;
+            std::vector<DecodedInst> insts;
+        };
+
+        Entry* findEntry_(uint64_t window);
+
+        const uint32_t associativity_;
+        const uint32_t window_shift_;
+        const uint32_t uops_per_entry_;
+        const uint64_t set_mask_;
+
+        // Sets, one after the other
+        std::vector<Entry> entries_;
+
+        // Advances on every access; an entry's last_use orders its set
+        uint64_t use_clock_ = 0;
+    };
+
+} // namespace olympia
@@ -0,0 +1,90 @@
+// <VectorPriorityQueue.hpp> -*- C++ -*-
+
+//!
+//! \file VectorPriorityQueue.hpp
+//! \brief sparta::PriorityQueue's ordering, kept in a vector
+//!
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace olympia
+{
+    /*!
+     * \class VectorPriorityQueue
+     * \brief A drop-in for the sparta::PriorityQueue calls the issue
+     *        queues make, stored in a vector instead of a std::list
+     *
+     * Items are ordered as sparta::PriorityQueue orders them: a new
+     * item goes in front of the first item for which
+     * SortingAlgorithmT(new, item) is true, at the back otherwise.
+     * The queues are bounded by their unit's size, so reserving that
+     * up front means inserting never allocates.  Unlike a list,
+     * erase() invalidates the iterators after the one erased; use the
+     * one it returns.
+     */
+    template <typename DataT, typename SortingAlgorithmT = std::less<DataT>>
+    class VectorPriorityQueue
+    {
+      public:
+        using iterator = typename std::vector<DataT>::iterator;
+        using const_iterator = typename std::vector<DataT>::const_iterator;
+
+        explicit VectorPriorityQueue(const SortingAlgorithmT & sort_alg = SortingAlgorithmT()) :
+            sort_alg_(sort_alg)
+        {
+        }
+
+        void reserve(const size_t capacity) { items_.reserve(capacity); }
+
+        void insert(const DataT & data)
+        {
+            for (auto it = items_.begin(); it != items_.end(); ++it)
+            {
+                if (sort_alg_(data, *it))
+                {
+                    items_.insert(it, data);
+                    return;
+                }
+            }
+            items_.emplace_back(data);
+        }
+
+        const DataT & top() const
+        {
+            sparta_assert(!items_.empty(), "top() on an empty VectorPriorityQueue");
+            return items_.front();
+        }
+
+        void pop()
+        {
+            sparta_assert(!items_.empty(), "pop() on an empty VectorPriorityQueue");
+            items_.erase(items_.begin());
+        }
+
+        iterator erase(const const_iterator & it) { return items_.erase(it); }
+
+        void clear() { items_.clear(); }
+
+        size_t size() const { return items_.size(); }
+
+        bool empty() const { return items_.empty(); }
+
+        iterator begin() { return items_.begin(); }
+
+        iterator end() { return items_.end(); }
+
+        const_iterator begin() const { return items_.begin(); }
+
+        const_iterator end() const { return items_.end(); }
+
+      private:
+        SortingAlgorithmT sort_alg_;
+        std::vector<DataT> items_;
+    };
+} // namespace olympia
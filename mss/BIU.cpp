@@ -26,6 +26,7 @@ namespace olympia_mss
         in_mss_ack_sync_.setPortDelay(static_cast<sparta::Clock::Cycle>(1));
 
         sparta::StartupEvent(node, CREATE_SPARTA_HANDLER(BIU, sendInitialCredits_));
+        biu_req_queue_.reserve(biu_req_queue_size_);
         ILOG("BIU construct: #" << node->getGroupIdx());
     }
 
@@ -82,7 +83,7 @@ namespace olympia_mss
     {
         out_biu_resp_.send(biu_req_queue_.front(), biu_latency_);
 
-        biu_req_queue_.pop_front();
+        biu_req_queue_.erase(biu_req_queue_.begin());
 
         // Send out the ack to L2Cache through , we just created space in biu_req_queue_
         ev_handle_biu_l2cache_ack_.schedule(sparta::Clock::Cycle(0));
@@ -15,6 +15,7 @@
 #include "MemoryAccessInfo.hpp"
 #include "CoreTypes.hpp"
 #include "FlushManager.hpp"
+#include "RuntimeTunable.hpp"
 
 // UPDATE
 #include "sparta/ports/SyncPort.hpp"
@@ -22,7 +23,7 @@
 
 namespace olympia_mss
 {
-    class BIU : public sparta::Unit
+    class BIU : public sparta::Unit, public olympia::RuntimeTunableIF
     {
     public:
         //! Parameters for BIU model
@@ -45,6 +46,15 @@ namespace olympia_mss
         // name of this resource.
         static const char name[];
 
+        // The bus latency can change after warm-up
+        std::vector<std::string> getTunableParameters() const override {
+            return {"biu_latency"};
+        }
+
+        void tune(const std::string & param_name, const std::string & value) override {
+            biu_latency_ = parseTunable<uint32_t>(param_name, value);
+        }
+
 
         ////////////////////////////////////////////////////////////////////////////////
         // Type Name/Alias Declaration
@@ -81,11 +91,12 @@ namespace olympia_mss
         // Internal States
         ////////////////////////////////////////////////////////////////////////////////
 
-        using BusRequestQueue = std::list<olympia::MemoryAccessInfoPtr>;
+        // Reserved to biu_req_queue_size: never reallocates
+        using BusRequestQueue = std::vector<olympia::MemoryAccessInfoPtr>;
         BusRequestQueue biu_req_queue_;
 
         const uint32_t biu_req_queue_size_;
-        const uint32_t biu_latency_;
+        uint32_t biu_latency_;
 
         bool biu_busy_ = false;
 
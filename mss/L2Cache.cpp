@@ -83,8 +83,8 @@ namespace olympia_mss
         l2cache_latency_(p->l2cache_latency),
         is_icache_connected_(p->is_icache_connected),
         is_dcache_connected_(p->is_dcache_connected),
-        memory_access_allocator_(sparta::notNull(olympia::OlympiaAllocators::getOlympiaAllocators(node))->
-                                 memory_access_allocator) {
+        memory_access_allocator_(sparta::notNull(olympia::OlympiaAllocators::getOlympiaAllocators(node))
+                                 ->getMemoryAccessAllocator()) {
 
     	// In Port Handler registration
         in_dcache_l2cache_req_.registerConsumerHandler
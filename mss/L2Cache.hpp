@@ -26,11 +26,15 @@
 #include "MemoryAccessInfo.hpp"
 
 #include "CacheFuncModel.hpp"
+#include "FunctionalWarming.hpp"
+#include "Checkpoint.hpp"
 #include "LSU.hpp"
 
 namespace olympia_mss
 {
-    class L2Cache : public sparta::Unit
+    class L2Cache : public sparta::Unit,
+                    public olympia::FunctionalWarmingIF,
+                    public olympia::CheckpointableIF
     {
     public:
         //! Parameters for L2Cache model
@@ -68,6 +72,26 @@ namespace olympia_mss
         // name of this resource.
         static const char name[];
 
+        // Functional warming: DL1 misses fill/touch the L2 tags
+        WarmingLevel getWarmingLevel() const override { return WarmingLevel::L2; }
+
+        void warm(olympia::WarmingRecord & record) override {
+            if (record.dl1_miss && !l2_always_hit_) {
+                l2_cache_->warmAccess(record.getPhyAddr());
+            }
+        }
+
+        double getWarmingCoverage() const override { return l2_cache_->getValidFraction(); }
+
+        // Checkpoint the L2 tags and replacement state
+        void saveCheckpoint(std::ostream & os) override {
+            olympia::checkpoint::saveCache(os, *l2_cache_);
+        }
+
+        void restoreCheckpoint(std::istream & is) override {
+            olympia::checkpoint::restoreCache(is, *l2_cache_);
+        }
+
         ////////////////////////////////////////////////////////////////////////////////
         // Type Name/Alias Declaration
         ////////////////////////////////////////////////////////////////////////////////
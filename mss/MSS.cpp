@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <string>
+
 #include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/utils/LogUtils.hpp"
 
@@ -12,15 +15,30 @@ namespace olympia_mss
     // Constructor
     ////////////////////////////////////////////////////////////////////////////////
 
+    MSS::BIUPort::BIUPort(MSS* mss, const uint32_t index) :
+        mss(mss),
+        index(index),
+        in_mss_req_sync(&mss->unit_port_set_, "in_mss_req_sync_core" + std::to_string(index),
+                        mss->getClock()),
+        out_mss_ack_sync(&mss->unit_port_set_, "out_mss_ack_sync_core" + std::to_string(index),
+                         mss->getClock())
+    {
+        in_mss_req_sync.registerConsumerHandler
+            (CREATE_SPARTA_HANDLER_WITH_DATA_WITH_OBJ(BIUPort, this, receiveReq,
+                                                      olympia::MemoryAccessInfoPtr));
+        in_mss_req_sync.setPortDelay(static_cast<sparta::Clock::Cycle>(1));
+    }
+
     MSS::MSS(sparta::TreeNode *node, const MSSParameterSet *p) :
         sparta::Unit(node),
         mss_latency_(p->mss_latency)
     {
-        in_mss_req_sync_.registerConsumerHandler
-            (CREATE_SPARTA_HANDLER_WITH_DATA(MSS, getReqFromBIU_, olympia::MemoryAccessInfoPtr));
-        in_mss_req_sync_.setPortDelay(static_cast<sparta::Clock::Cycle>(1));
+        sparta_assert(p->num_ports > 0, "The MSS needs at least one port");
+        for (uint32_t i = 0; i < p->num_ports; ++i) {
+            biu_ports_.emplace_back(new BIUPort(this, i));
+        }
 
-        ILOG("MSS construct: #" << node->getGroupIdx());
+        ILOG("MSS construct: #" << node->getGroupIdx() << " with " << p->num_ports << " ports");
     }
 
 
@@ -29,30 +47,62 @@ namespace olympia_mss
     ////////////////////////////////////////////////////////////////////////////////
 
     // Receive new MSS request from BIU
-    void MSS::getReqFromBIU_(const olympia::MemoryAccessInfoPtr & memory_access_info_ptr)
+    void MSS::getReqFromBIU_(const uint32_t port,
+                             const olympia::MemoryAccessInfoPtr & memory_access_info_ptr)
     {
         sparta_assert((memory_access_info_ptr != nullptr), "MSS is not handling a valid request!");
 
-        // Handle MSS request event can only be scheduled when MMS is not busy
-        if (!mss_busy_) {
+        // Each BIU has at most one request at the MSS.  Requests from
+        // different cores are serviced one at a time, in arrival order
+        pending_ports_.push_back(port);
+        if (remote_memory_ != nullptr) {
+            remote_memory_->request(port, getClock()->currentCycle(), mss_latency_);
+            ILOG("MSS request from core " << port << " sent to the remote memory");
+        }
+        else if (!mss_busy_) {
             mss_busy_ = true;
             ev_handle_mss_req_.schedule(mss_latency_);
+            ILOG("MSS is busy servicing your request......");
         }
         else {
-            // Assumption: MSS can handle a single request each time
-            sparta_assert(false, "MSS can never receive requests from BIU when it's busy!");
+            ++num_queued_requests_;
+            ILOG("MSS is busy, request from core " << port << " waits behind "
+                 << (pending_ports_.size() - 1) << " others");
         }
-
-        ILOG("MSS is busy servicing your request......");
     }
 
     // Handle MSS request
     void MSS::handle_MSS_req_()
     {
-        mss_busy_ = false;
-        out_mss_ack_sync_.send(true);
+        sparta_assert(false == pending_ports_.empty());
+        const uint32_t port = pending_ports_.front();
+        pending_ports_.pop_front();
+        biu_ports_[port]->out_mss_ack_sync.send(true);
+        ++num_requests_;
+
+        // Start on the next core's request
+        if (pending_ports_.empty()) {
+            mss_busy_ = false;
+        }
+        else {
+            ev_handle_mss_req_.schedule(mss_latency_);
+        }
 
-        ILOG("MSS is done!");
+        ILOG("MSS is done with the request from core " << port << "!");
+    }
+
+
+    // Ack a remotely serviced request
+    void MSS::sendRemoteAck_(const uint32_t & port)
+    {
+        const auto pending = std::find(pending_ports_.begin(), pending_ports_.end(), port);
+        sparta_assert(pending != pending_ports_.end(),
+                      "Remote memory completed a request core " << port << " never made");
+        pending_ports_.erase(pending);
+        biu_ports_[port]->out_mss_ack_sync.send(true);
+        ++num_requests_;
+
+        ILOG("MSS remote request from core " << port << " is done!");
     }
 
 
@@ -60,5 +110,13 @@ namespace olympia_mss
     // Regular Function/Subroutine Call
     ////////////////////////////////////////////////////////////////////////////////
 
+    void MSS::completeRemoteRequest(const uint32_t port, const uint64_t cycle)
+    {
+        const uint64_t now = getClock()->currentCycle();
+        sparta_assert(cycle >= now, "Remote memory completed a request in the past (cycle "
+                      << cycle << ", now " << now << "): the quantum is too long");
+        ev_remote_ack_.preparePayload(port)->schedule(sparta::Clock::Cycle(cycle - now));
+    }
+
 
 }
@@ -1,11 +1,16 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "sparta/ports/PortSet.hpp"
 #include "sparta/ports/SignalPort.hpp"
 #include "sparta/ports/DataPort.hpp"
 #include "sparta/events/EventSet.hpp"
 #include "sparta/events/UniqueEvent.hpp"
+#include "sparta/events/PayloadEvent.hpp"
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/ParameterSet.hpp"
 #include "sparta/simulation/TreeNode.hpp"
@@ -13,14 +18,16 @@
 #include "sparta/events/StartupEvent.hpp"
 #include "sparta/ports/SyncPort.hpp"
 #include "sparta/resources/Pipe.hpp"
+#include "sparta/statistics/Counter.hpp"
 
 #include "MemoryAccessInfo.hpp"
 #include "CoreTypes.hpp"
 #include "FlushManager.hpp"
+#include "RuntimeTunable.hpp"
 
 namespace olympia_mss
 {
-    class MSS : public sparta::Unit
+    class MSS : public sparta::Unit, public olympia::RuntimeTunableIF
     {
     public:
         //! Parameters for MSS model
@@ -33,6 +40,9 @@ namespace olympia_mss
             { }
 
             PARAMETER(uint32_t, mss_latency, 5, "MSS access latency")
+            PARAMETER(uint32_t, num_ports, 1,
+                      "Number of cores (BIUs) sharing the MSS, one port pair each.  "
+                      "Set by the simulator to the number of cores")
         };
 
         // Constructor for MSS
@@ -42,6 +52,41 @@ namespace olympia_mss
         // name of this resource.
         static const char name[];
 
+        // The access latency can change after warm-up
+        std::vector<std::string> getTunableParameters() const override {
+            return {"mss_latency"};
+        }
+
+        void tune(const std::string & param_name, const std::string & value) override {
+            mss_latency_ = parseTunable<uint32_t>(param_name, value);
+        }
+
+        //! A memory side outside this simulation, e.g. shared with
+        //! cores simulated in other processes.  It is handed every
+        //! request and later tells the MSS when each completes
+        class RemoteMemoryIF
+        {
+        public:
+            virtual ~RemoteMemoryIF() = default;
+
+            //! A request arrived on port at cycle.  latency is the
+            //! MSS access latency
+            virtual void request(const uint32_t port, const uint64_t cycle,
+                                 const uint32_t latency) = 0;
+        };
+
+        //! Service requests remotely instead of here
+        void setRemoteMemory(RemoteMemoryIF* remote_memory) { remote_memory_ = remote_memory; }
+
+        //! The remote memory completed the oldest request of port; ack
+        //! it at cycle (not in the past)
+        void completeRemoteRequest(const uint32_t port, const uint64_t cycle);
+
+        //! Are requests waiting for (local or remote) service?
+        bool hasPendingRequests() const { return false == pending_ports_.empty(); }
+
+        uint32_t getLatency() const { return mss_latency_; }
+
 
         ////////////////////////////////////////////////////////////////////////////////
         // Type Name/Alias Declaration
@@ -53,23 +98,47 @@ namespace olympia_mss
         // Input Ports
         ////////////////////////////////////////////////////////////////////////////////
 
-        sparta::SyncInPort<olympia::MemoryAccessInfoPtr> in_mss_req_sync_
-            {&unit_port_set_, "in_mss_req_sync", getClock()};
+        // One request/ack port pair per core: in_mss_req_sync_core<N>
+        // and out_mss_ack_sync_core<N>
+        struct BIUPort
+        {
+            BIUPort(MSS* mss, const uint32_t index);
+
+            void receiveReq(const olympia::MemoryAccessInfoPtr & memory_access_info_ptr) {
+                mss->getReqFromBIU_(index, memory_access_info_ptr);
+            }
+
+            MSS* const mss;
+            const uint32_t index;
+            sparta::SyncInPort<olympia::MemoryAccessInfoPtr> in_mss_req_sync;
+            sparta::SyncOutPort<bool> out_mss_ack_sync;
+        };
+        std::vector<std::unique_ptr<BIUPort>> biu_ports_;
 
 
         ////////////////////////////////////////////////////////////////////////////////
-        // Output Ports
+        // Internal States
         ////////////////////////////////////////////////////////////////////////////////
+        uint32_t mss_latency_;
+        bool mss_busy_ = false;
 
-        sparta::SyncOutPort<bool> out_mss_ack_sync_
-            {&unit_port_set_, "out_mss_ack_sync", getClock()};
+        // Ports with a request waiting, oldest first.  The front one
+        // is being serviced when the MSS is busy
+        std::deque<uint32_t> pending_ports_;
 
+        // Where requests are serviced when not here
+        RemoteMemoryIF* remote_memory_ = nullptr;
 
         ////////////////////////////////////////////////////////////////////////////////
-        // Internal States
+        // Counters
         ////////////////////////////////////////////////////////////////////////////////
-        const uint32_t mss_latency_;
-        bool mss_busy_ = false;
+
+        sparta::Counter num_requests_{getStatisticSet(), "mss_requests",
+                                      "Requests serviced", sparta::Counter::COUNT_NORMAL};
+        sparta::Counter num_queued_requests_{getStatisticSet(), "mss_queued_requests",
+                                             "Requests that arrived while the MSS was busy "
+                                             "with another core's request",
+                                             sparta::Counter::COUNT_NORMAL};
 
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -80,17 +149,24 @@ namespace olympia_mss
         sparta::UniqueEvent<> ev_handle_mss_req_
             {&unit_event_set_, "handle_mss_req", CREATE_SPARTA_HANDLER(MSS, handle_MSS_req_)};
 
+        // Event to ack a remotely serviced request on a port
+        sparta::PayloadEvent<uint32_t> ev_remote_ack_
+            {&unit_event_set_, "remote_ack", CREATE_SPARTA_HANDLER_WITH_DATA(MSS, sendRemoteAck_, uint32_t)};
+
 
         ////////////////////////////////////////////////////////////////////////////////
         // Callbacks
         ////////////////////////////////////////////////////////////////////////////////
 
-        // Receive new MSS request from BIU
-        void getReqFromBIU_(const olympia::MemoryAccessInfoPtr &);
+        // Receive new MSS request from the BIU on a port
+        void getReqFromBIU_(const uint32_t, const olympia::MemoryAccessInfoPtr &);
 
         // Handle MSS request
         void handle_MSS_req_();
 
+        // Ack a remotely serviced request
+        void sendRemoteAck_(const uint32_t &);
+
 
         ////////////////////////////////////////////////////////////////////////////////
         // Regular Function/Subroutine Call
@@ -0,0 +1,116 @@
+// <ConfigFanOut.cpp> -*- C++ -*-
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "ConfigFanOut.hpp"
+#include "ForkedRuns.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    ConfigFanOut::Config ConfigFanOut::parse(const std::string & spec)
+    {
+        const auto colon = spec.find(':');
+        if ((colon == std::string::npos) || (colon == 0))
+        {
+            throw sparta::SpartaException("ERROR: Fan-out configuration '")
+                << spec << "' is not LABEL:PATH=VALUE[,PATH=VALUE...]";
+        }
+
+        Config config;
+        config.label = spec.substr(0, colon);
+        std::istringstream overrides(spec.substr(colon + 1));
+        std::string assignment;
+        while (std::getline(overrides, assignment, ','))
+        {
+            const auto equals = assignment.find('=');
+            if ((equals == std::string::npos) || (equals == 0))
+            {
+                throw sparta::SpartaException("ERROR: Fan-out configuration ")
+                    << config.label << ": '" << assignment << "' is not PATH=VALUE";
+            }
+            config.overrides.push_back(
+                {assignment.substr(0, equals), assignment.substr(equals + 1)});
+        }
+        return config;
+    }
+
+    void ConfigFanOut::check(sparta::TreeNode* root) const
+    {
+        std::set<std::string> labels;
+        for (const auto & config : configs)
+        {
+            if (false == labels.insert(config.label).second)
+            {
+                throw sparta::SpartaException("ERROR: Fan-out configuration ")
+                    << config.label << " is given twice";
+            }
+            for (const auto & override_param : config.overrides)
+            {
+                checkRuntimeOverride(root, override_param);
+            }
+        }
+    }
+
+    uint32_t ConfigFanOut::run(const RunConfig & run_config, std::ostream & os) const
+    {
+        const uint32_t num_configs = static_cast<uint32_t>(configs.size());
+        os << "olympia: fan-out: " << num_configs << " configurations from the warmed model, "
+           << getForkedParallelism(max_jobs) << " at a time" << std::endl;
+
+        std::vector<SampleSet> config_samples;
+        const std::vector<bool> succeeded = runForked(
+            num_configs, max_jobs,
+            [&](const uint32_t index, SampleSet & samples)
+            { return run_config(configs[index], samples); },
+            config_samples);
+
+        // Every configuration is compared with the first one
+        uint32_t num_failed = 0;
+        double baseline_cpi = 0;
+        for (uint32_t index = 0; index < num_configs; ++index)
+        {
+            const Config & config = configs[index];
+            const SampleSet & samples = config_samples[index];
+            const std::string prefix = "olympia: fan-out: " + config.label + ": ";
+            if ((false == succeeded[index]) || (samples.measured_insts == 0))
+            {
+                os << prefix << "failed" << std::endl;
+                ++num_failed;
+                continue;
+            }
+
+            for (const auto & override_param : config.overrides)
+            {
+                os << prefix << override_param.path << " = " << override_param.value << std::endl;
+            }
+            samples.report(os, prefix);
+            const double cpi = static_cast<double>(samples.measured_cycles) / samples.measured_insts;
+            if (index == 0)
+            {
+                baseline_cpi = cpi;
+            }
+            else if (baseline_cpi != 0)
+            {
+                os << prefix << "CPI " << (100.0 * (cpi - baseline_cpi) / baseline_cpi)
+                   << "% relative to " << configs[0].label << std::endl;
+            }
+
+            if (false == report_prefix.empty())
+            {
+                const std::string filename = report_prefix + config.label + ".out";
+                std::ofstream report(filename);
+                samples.writeCounters(report);
+                if (!report)
+                {
+                    throw sparta::SpartaException("ERROR: Issues writing ") << filename;
+                }
+                os << prefix << "counters written to " << filename << std::endl;
+            }
+        }
+        return num_failed;
+    }
+} // namespace olympia
@@ -0,0 +1,61 @@
+// <ConfigFanOut.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SamplingDriver.hpp"
+#include "RuntimeTunable.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief Simulate the warm-up of a region once, then measure the
+     *        region under several configurations, one forked process
+     *        per configuration
+     *
+     * The parent simulates the fast-forward and the detailed warm-up
+     * and stops.  Each child starts from the parent's warmed model
+     * (shared copy-on-write), applies its configuration's parameter
+     * overrides and simulates the measured region.  Only parameters of
+     * RuntimeTunableIF units can be overridden: those that size
+     * structures are fixed once the model is built.
+     */
+    struct ConfigFanOut
+    {
+        //! One configuration: a label and its parameter overrides.  No
+        //! overrides is the configuration the parent was built with
+        struct Config
+        {
+            std::string label;
+            std::vector<RuntimeOverride> overrides;
+        };
+
+        std::vector<Config> configs;
+        uint32_t max_jobs = 0;     //!< Configurations simulated at once.  0 is one per host thread
+        std::string report_prefix; //!< If not empty, write each configuration's counters
+                                   //!< to <report_prefix><label>.out
+
+        bool enabled() const { return false == configs.empty(); }
+
+        //! Parse LABEL:PATH=VALUE[,PATH=VALUE...]
+        static Config parse(const std::string & spec);
+
+        //! Throw if an override does not name a runtime-tunable
+        //! parameter of the tree under root
+        void check(sparta::TreeNode* root) const;
+
+        //! Apply the overrides and simulate the measured region, filling
+        //! in its samples.  Called in the child.  Returns the process
+        //! exit code
+        using RunConfig = std::function<int(const Config & config, SampleSet & samples)>;
+
+        //! Fork the configurations, wait for them and report.  Returns
+        //! the number of configurations that failed
+        uint32_t run(const RunConfig & run_config, std::ostream & os) const;
+    };
+} // namespace olympia
@@ -0,0 +1,115 @@
+// <ForkedRuns.cpp> -*- C++ -*-
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "ForkedRuns.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    uint32_t getForkedParallelism(const uint32_t max_parallel)
+    {
+        return (max_parallel != 0) ? max_parallel
+                                   : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<bool> runForked(const uint32_t num_jobs, const uint32_t max_parallel,
+                                const ForkedJob & job, std::vector<SampleSet> & samples)
+    {
+        const uint32_t parallelism = getForkedParallelism(max_parallel);
+        std::vector<std::string> result_files(num_jobs);
+        std::vector<bool> succeeded(num_jobs, false);
+        samples.assign(num_jobs, SampleSet());
+        std::map<pid_t, uint32_t> running;
+        uint32_t next_job = 0;
+
+        auto wait_for_job = [&]()
+        {
+            int status = 0;
+            const pid_t pid = ::waitpid(-1, &status, 0);
+            if (pid < 0)
+            {
+                throw sparta::SpartaException("ERROR: waitpid: ") << std::strerror(errno);
+            }
+            const auto it = running.find(pid);
+            if (it == running.end())
+            {
+                return;
+            }
+            const uint32_t index = it->second;
+            running.erase(it);
+            if (WIFEXITED(status) && (WEXITSTATUS(status) == 0))
+            {
+                std::ifstream results(result_files[index]);
+                samples[index].read(results);
+                succeeded[index] = true;
+            }
+            std::filesystem::remove(result_files[index]);
+        };
+
+        while ((next_job < num_jobs) || (false == running.empty()))
+        {
+            if ((next_job == num_jobs) || (running.size() == parallelism))
+            {
+                wait_for_job();
+                continue;
+            }
+
+            std::string result_file =
+                (std::filesystem::temp_directory_path() / "olympia_job_XXXXXX").string();
+            const int fd = ::mkstemp(result_file.data());
+            if (fd < 0)
+            {
+                throw sparta::SpartaException("ERROR: Could not create ")
+                    << result_file << ": " << std::strerror(errno);
+            }
+            ::close(fd);
+            result_files[next_job] = result_file;
+
+            // Nothing buffered may be written twice
+            std::cout.flush();
+            std::cerr.flush();
+
+            const pid_t pid = ::fork();
+            if (pid < 0)
+            {
+                throw sparta::SpartaException("ERROR: fork: ") << std::strerror(errno);
+            }
+            if (pid == 0)
+            {
+                int exit_code = 0;
+                try
+                {
+                    SampleSet job_samples;
+                    exit_code = job(next_job, job_samples);
+                    std::ofstream results(result_file);
+                    job_samples.write(results);
+                    exit_code = results.good() ? exit_code : 1;
+                }
+                catch (const std::exception & e)
+                {
+                    std::cerr << "olympia: job " << next_job << ": " << e.what() << std::endl;
+                    exit_code = 1;
+                }
+                std::cout.flush();
+                std::cerr.flush();
+                std::_Exit(exit_code);
+            }
+            running[pid] = next_job++;
+        }
+        return succeeded;
+    }
+} // namespace olympia
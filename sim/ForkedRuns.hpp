@@ -0,0 +1,32 @@
+// <ForkedRuns.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <vector>
+
+#include "SamplingDriver.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief Run jobs in forked copies of this process and collect
+     *        the samples each of them measured
+     *
+     * job(index, samples) is called in a child process for every index
+     * in [0, num_jobs), at most max_parallel at a time (0 is one per
+     * host thread).  The child inherits the parent's state copy-on-write,
+     * so the parent can build and warm a simulator before calling this.
+     * The child's samples come back through a temporary file.
+     *
+     * \return Per job, whether it exited successfully.  samples is
+     *         resized to num_jobs
+     */
+    using ForkedJob = std::function<int(const uint32_t index, SampleSet & samples)>;
+    std::vector<bool> runForked(const uint32_t num_jobs, const uint32_t max_parallel,
+                                const ForkedJob & job, std::vector<SampleSet> & samples);
+
+    //! Number of jobs runForked runs at once for max_parallel
+    uint32_t getForkedParallelism(const uint32_t max_parallel);
+} // namespace olympia
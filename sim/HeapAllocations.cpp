@@ -0,0 +1,113 @@
+// <HeapAllocations.cpp> -*- C++ -*-
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "HeapAllocations.hpp"
+
+#ifdef OLYMPIA_HEAP_ALLOCATION_COUNTING
+namespace
+{
+    // Other threads (the trace reader) allocate too
+    std::atomic<bool> counting{false};
+    std::atomic<uint64_t> num_allocations{0};
+
+    void* countedAlloc(const std::size_t size)
+    {
+        if (counting.load(std::memory_order_relaxed))
+        {
+            num_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (void* ptr = std::malloc((size != 0) ? size : 1); ptr != nullptr)
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+} // namespace
+
+// The replaceable allocation functions: every new/delete in the
+// binary goes through these.  The aligned forms keep their defaults
+void* operator new(std::size_t size) { return countedAlloc(size); }
+
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#else
+namespace
+{
+    // Built without OLYMPIA_HEAP_ALLOCATION_COUNTING: the default
+    // operator new is kept and nothing is counted
+    bool counting = false;
+    uint64_t num_allocations = 0;
+} // namespace
+#endif
+
+namespace olympia
+{
+    bool HeapAllocationCounter::isAvailable()
+    {
+#ifdef OLYMPIA_HEAP_ALLOCATION_COUNTING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    HeapAllocationCounter::HeapAllocationCounter(sparta::TreeNode* core_node,
+                                                 const uint64_t warmup) :
+        retired_(core_node->getChildAs<sparta::CounterBase>("rob.stats.total_number_retired")),
+        warmup_(warmup)
+    {
+        if (warmup_ == 0)
+        {
+            start_();
+        }
+        else
+        {
+            trigger_.reset(new sparta::trigger::CounterTrigger(
+                "heap_allocation_warmup",
+                CREATE_SPARTA_HANDLER(HeapAllocationCounter, start_), retired_, warmup_));
+        }
+    }
+
+    void HeapAllocationCounter::start_()
+    {
+        num_allocations = 0;
+        counting = true;
+        started_ = true;
+    }
+
+    void HeapAllocationCounter::stop()
+    {
+        if (started_ && (false == stopped_))
+        {
+            counting = false;
+            stopped_ = true;
+            allocations_ = num_allocations;
+            retired_insts_ = retired_->get() - warmup_;
+        }
+    }
+
+    void HeapAllocationCounter::report(std::ostream & os) const
+    {
+        if (false == started_)
+        {
+            os << "olympia: heap allocations: the run ended within the " << warmup_
+               << " instruction warm-up; nothing counted" << std::endl;
+            return;
+        }
+        os << "olympia: heap allocations: " << allocations_ << " over " << retired_insts_
+           << " instructions after a " << warmup_ << " instruction warm-up, "
+           << ((retired_insts_ != 0) ? static_cast<double>(allocations_) / retired_insts_ : 0)
+           << " per retired instruction" << std::endl;
+    }
+} // namespace olympia
@@ -0,0 +1,60 @@
+// <HeapAllocations.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <ostream>
+
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+#include "sparta/trigger/SingleTrigger.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief Count the process's heap allocations (operator new) once
+     *        a core has retired its warm-up instructions
+     *
+     * The model's pools and queues are sized up front, so after a
+     * warm-up that fills them a steady-state simulation should not
+     * allocate at all.  Counting replaces the global operator new of
+     * the olympia binary, so it is only built in with the CMake
+     * option OLYMPIA_HEAP_ALLOCATION_COUNTING.  Until a counter
+     * starts, the only cost is a flag test per allocation.
+     */
+    class HeapAllocationCounter
+    {
+      public:
+        //! Start counting once the core has retired warmup
+        //! instructions (right away for 0)
+        HeapAllocationCounter(sparta::TreeNode* core_node, const uint64_t warmup);
+
+        ~HeapAllocationCounter() { stop(); }
+
+        //! Was olympia built with OLYMPIA_HEAP_ALLOCATION_COUNTING?
+        static bool isAvailable();
+
+        //! Stop counting (at the end of the simulation, before the
+        //! reports allocate)
+        void stop();
+
+        //! Allocations between the start and stop
+        uint64_t getSteadyStateAllocations() const { return allocations_; }
+
+        //! Print the allocations and allocations per retired
+        //! instruction between the start and stop
+        void report(std::ostream & os) const;
+
+      private:
+        void start_();
+
+        const sparta::CounterBase* const retired_;
+        const uint64_t warmup_;
+        std::unique_ptr<sparta::trigger::CounterTrigger> trigger_;
+        bool started_ = false;
+        bool stopped_ = false;
+        uint64_t allocations_ = 0;
+        uint64_t retired_insts_ = 0;
+    };
+} // namespace olympia
@@ -8,7 +8,13 @@
  *        in simulation
  */
 
+#include <memory>
+#include <string>
+
 #include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/statistics/StatisticSet.hpp"
+#include "sparta/statistics/ReadOnlyCounter.hpp"
 
 #include "Inst.hpp"
 #include "LoadStoreInstInfo.hpp"
@@ -21,12 +27,38 @@ namespace olympia
      * \class OlympiaAllocators
      * \brief A TreeNode that is actually a functional resource
      *        containing memory allocators
+     *
+     * The pools are sized by the node's parameters, so they are built
+     * on first use: by then the tree has been configured.  Each pool's
+     * high-water mark (the most objects it had out at once) is a
+     * statistic of the node.
      */
     class OlympiaAllocators : public sparta::TreeNode
     {
     public:
         static constexpr char name[] = "olympia_allocators";
 
+        //! Pool sizes.  A pool holds at most max_blocks objects at
+        //! once and warns when it passes water_mark
+        class OlympiaAllocatorsParameterSet : public sparta::ParameterSet
+        {
+        public:
+            OlympiaAllocatorsParameterSet(sparta::TreeNode* n) :
+                sparta::ParameterSet(n)
+            {}
+
+            PARAMETER(uint32_t, inst_max_blocks,                3000, "Inst pool size")
+            PARAMETER(uint32_t, inst_water_mark,                2500, "Inst pool warning level")
+            PARAMETER(uint32_t, inst_arch_info_max_blocks,      3000, "InstArchInfo pool size")
+            PARAMETER(uint32_t, inst_arch_info_water_mark,      2500, "InstArchInfo pool warning level")
+            PARAMETER(uint32_t, load_store_info_max_blocks,     128,  "LoadStoreInstInfo pool size")
+            PARAMETER(uint32_t, load_store_info_water_mark,     80,   "LoadStoreInstInfo pool warning level")
+            PARAMETER(uint32_t, memory_access_max_blocks,       128,  "MemoryAccessInfo pool size")
+            PARAMETER(uint32_t, memory_access_water_mark,       80,   "MemoryAccessInfo pool warning level")
+            PARAMETER(uint32_t, mshr_entry_max_blocks,          300,  "MSHREntryInfo pool size")
+            PARAMETER(uint32_t, mshr_entry_water_mark,          150,  "MSHREntryInfo pool warning level")
+        };
+
         OlympiaAllocators(sparta::TreeNode *node) :
             sparta::TreeNode(node, name, "Allocators used in simulation")
         {}
@@ -37,8 +69,6 @@ namespace olympia
             if(node)
             {
                 if(node->hasChild(OlympiaAllocators::name)) {
-                    // If this class is converted to a resource, use this line
-                    //allocators = node->getChild(OlympiaAllocators::name)->getResourceAs<OlympiaAllocators>();
                     allocators = node->getChildAs<OlympiaAllocators>(OlympiaAllocators::name);
                 }
                 else {
@@ -48,16 +78,77 @@ namespace olympia
             return allocators;
         }
 
-        // Allocators used in simulation.  These values can be
-        // parameterized in the future by converting this class into a
-        // full-blown sparta::Resource and adding a sparta::ParameterSet
-        InstAllocator         inst_allocator          {3000, 2500};
-        InstArchInfoAllocator inst_arch_info_allocator{3000, 2500};
+        // Allocators used in simulation
+        InstAllocator         & getInstAllocator()         { return *createAllocators_().inst_allocator_; }
+        InstArchInfoAllocator & getInstArchInfoAllocator() { return *createAllocators_().inst_arch_info_allocator_; }
 
         // For LSU/MSS
-        LoadStoreInstInfoAllocator  load_store_info_allocator{128, 80};
-        MemoryAccessInfoAllocator   memory_access_allocator  {128, 80};
-        MSHREntryInfoAllocator      mshr_entry_allocator {300, 150};
+        LoadStoreInstInfoAllocator & getLoadStoreInfoAllocator() { return *createAllocators_().load_store_info_allocator_; }
+        MemoryAccessInfoAllocator  & getMemoryAccessAllocator()  { return *createAllocators_().memory_access_allocator_; }
+        MSHREntryInfoAllocator     & getMSHREntryAllocator()     { return *createAllocators_().mshr_entry_allocator_; }
+
+    private:
+
+        //! A pool's high-water mark: the allocator never frees a block,
+        //! so the blocks it has created are the most it had out at once
+        template<class AllocatorT>
+        class HighWaterMarkCounter : public sparta::ReadOnlyCounter
+        {
+        public:
+            HighWaterMarkCounter(sparta::StatisticSet * stat_set, const std::string & pool,
+                                 const std::unique_ptr<AllocatorT> & allocator) :
+                sparta::ReadOnlyCounter(stat_set, pool + "_high_water_mark",
+                                        "Most " + pool + " objects allocated at once",
+                                        sparta::CounterBase::COUNT_LATEST, &unused_),
+                allocator_(allocator)
+            {}
+
+            counter_type get() const override {
+                return (allocator_ != nullptr) ? allocator_->getNumAllocated() : 0;
+            }
+
+        private:
+            const std::unique_ptr<AllocatorT> & allocator_;
+
+            //! Unused: the value is computed by get()
+            const counter_type unused_ = 0;
+        };
+
+        OlympiaAllocators & createAllocators_()
+        {
+            if(inst_allocator_ == nullptr) {
+                inst_allocator_.reset(new InstAllocator(params_.inst_max_blocks,
+                                                        params_.inst_water_mark));
+                inst_arch_info_allocator_.reset(new InstArchInfoAllocator(params_.inst_arch_info_max_blocks,
+                                                                          params_.inst_arch_info_water_mark));
+                load_store_info_allocator_.reset(new LoadStoreInstInfoAllocator(params_.load_store_info_max_blocks,
+                                                                                params_.load_store_info_water_mark));
+                memory_access_allocator_.reset(new MemoryAccessInfoAllocator(params_.memory_access_max_blocks,
+                                                                             params_.memory_access_water_mark));
+                mshr_entry_allocator_.reset(new MSHREntryInfoAllocator(params_.mshr_entry_max_blocks,
+                                                                       params_.mshr_entry_water_mark));
+            }
+            return *this;
+        }
+
+        OlympiaAllocatorsParameterSet params_{this};
+        sparta::StatisticSet stats_{this};
+
+        std::unique_ptr<InstAllocator>              inst_allocator_;
+        std::unique_ptr<InstArchInfoAllocator>      inst_arch_info_allocator_;
+        std::unique_ptr<LoadStoreInstInfoAllocator> load_store_info_allocator_;
+        std::unique_ptr<MemoryAccessInfoAllocator>  memory_access_allocator_;
+        std::unique_ptr<MSHREntryInfoAllocator>     mshr_entry_allocator_;
 
+        HighWaterMarkCounter<InstAllocator>              inst_high_water_mark_
+            {&stats_, "inst", inst_allocator_};
+        HighWaterMarkCounter<InstArchInfoAllocator>      inst_arch_info_high_water_mark_
+            {&stats_, "inst_arch_info", inst_arch_info_allocator_};
+        HighWaterMarkCounter<LoadStoreInstInfoAllocator> load_store_info_high_water_mark_
+            {&stats_, "load_store_info", load_store_info_allocator_};
+        HighWaterMarkCounter<MemoryAccessInfoAllocator>  memory_access_high_water_mark_
+            {&stats_, "memory_access", memory_access_allocator_};
+        HighWaterMarkCounter<MSHREntryInfoAllocator>     mshr_entry_high_water_mark_
+            {&stats_, "mshr_entry", mshr_entry_allocator_};
     };
 }
@@ -10,20 +10,39 @@
 
 #include "CPUFactory.hpp"
 #include "SimulationConfiguration.hpp"
+#include "CoreUtils.hpp"
 
 #include "OlympiaAllocators.hpp"
+#include "PipelineEventLog.hpp"
 
 OlympiaSim::OlympiaSim(const std::string& topology,
                        sparta::Scheduler & scheduler,
                        const uint32_t num_cores,
                        const std::string workload,
                        const uint64_t instruction_limit,
-                       const bool show_factories) :
+                       const bool show_factories,
+                       const uint64_t fast_forward,
+                       const bool functional_warming,
+                       const olympia::SamplingDriver::Config & sampling,
+                       const std::string & checkpoint_save,
+                       const std::string & checkpoint_restore,
+                       const std::vector<std::string> & core_workloads,
+                       const std::vector<uint64_t> & core_instruction_limits,
+                       const std::string & pipeline_event_log) :
     sparta::app::Simulation("sparta_olympia", &scheduler),
     cpu_topology_(topology),
     num_cores_(num_cores),
     workload_(workload),
     instruction_limit_(instruction_limit),
+    fast_forward_(fast_forward),
+    functional_warming_(functional_warming),
+    sampling_(sampling),
+    checkpoint_save_(checkpoint_save),
+    checkpoint_restore_(checkpoint_restore),
+    core_workloads_(core_workloads),
+    core_instruction_limits_(core_instruction_limits),
+    pipeline_event_log_(pipeline_event_log),
+    core_finish_cycles_(num_cores, 0),
     show_factories_(show_factories)
 {
     // Set up the CPU Resource Factory to be available through ResourceTreeNode
@@ -53,6 +72,11 @@ void OlympiaSim::buildTree_()
     // Create the common Allocators
     allocators_tn_.reset(new olympia::OlympiaAllocators(getRoot()));
 
+    // The units find the log when they are built
+    if(false == pipeline_event_log_.empty()) {
+        event_log_tn_.reset(new olympia::PipelineEventLog(getRoot(), pipeline_event_log_));
+    }
+
     // Create a single CPU
     sparta::ResourceTreeNode* cpu_tn = new sparta::ResourceTreeNode(getRoot(),
                                                                     "cpu",
@@ -76,6 +100,30 @@ void OlympiaSim::buildTree_()
     auto extension = sparta::notNull(cpu_tn->getExtension("simulation_configuration"));
     auto workload  = extension->getParameters()->getParameter("workload");
     workload->setValueFromString(workload_);
+    extension->getParameters()->getParameter("core_workloads")
+        ->setValueFromStringVector(core_workloads_);
+    extension->getParameters()->getParameter("num_cores")
+        ->setValueFromString(std::to_string(num_cores_));
+
+    // ... and where detailed simulation starts in it
+    auto fast_forward = extension->getParameters()->getParameter("fast_forward");
+    fast_forward->setValueFromString(sparta::utils::uint64_to_str(fast_forward_));
+    auto functional_warming = extension->getParameters()->getParameter("functional_warming");
+    functional_warming->setValueFromString(functional_warming_ ? "true" : "false");
+
+    // ... and how it is sampled
+    extension->getParameters()->getParameter("sampling_period")
+        ->setValueFromString(sparta::utils::uint64_to_str(sampling_.period));
+    extension->getParameters()->getParameter("sampling_warmup")
+        ->setValueFromString(sparta::utils::uint64_to_str(sampling_.warmup));
+    extension->getParameters()->getParameter("sampling_measure")
+        ->setValueFromString(sparta::utils::uint64_to_str(sampling_.measure));
+
+    // ... and whether it starts from or saves a checkpoint
+    extension->getParameters()->getParameter("checkpoint_save")
+        ->setValueFromString(checkpoint_save_);
+    extension->getParameters()->getParameter("checkpoint_restore")
+        ->setValueFromString(checkpoint_restore_);
 
     // Print the registered factories for debug
     if(show_factories_){
@@ -91,14 +139,33 @@ void OlympiaSim::configureTree_()
     // In TREE_CONFIGURING phase
     // Configuration from command line is already applied
 
-    sparta::ParameterBase* max_instrs =
-        getRoot()->getChildAs<sparta::ParameterBase>("cpu.core0.rob.params.num_insts_to_retire");
+    for(uint32_t core = 0; core < num_cores_; ++core) {
+        sparta::ParameterBase* max_instrs =
+            getRoot()->getChildAs<sparta::ParameterBase>("cpu.core" + std::to_string(core) +
+                                                         ".rob.params.num_insts_to_retire");
+
+        // Safely assign as string for now in case parameter type changes.
+        // Direct integer assignment without knowing parameter type is not yet available through C++ API
+        const uint64_t core_limit = ((core < core_instruction_limits_.size()) &&
+                                     (core_instruction_limits_[core] != 0)) ?
+            core_instruction_limits_[core] : instruction_limit_;
+        if(core_limit != 0){
+            max_instrs->setValueFromString(sparta::utils::uint64_to_str(core_limit));
+        }
 
-    // Safely assign as string for now in case parameter type changes.
-    // Direct integer assignment without knowing parameter type is not yet available through C++ API
-    if(instruction_limit_ != 0){
-        max_instrs->setValueFromString(sparta::utils::uint64_to_str(instruction_limit_));
+        // The L2 only hands out ICache credits when fetch reads
+        // through the ICache
+        const std::string core_path = "cpu.core" + std::to_string(core);
+        if(getRoot()->getChildAs<sparta::ParameterBase>(core_path + ".fetch.params.fetch_from_icache")
+               ->getValueAs<bool>()) {
+            getRoot()->getChildAs<sparta::ParameterBase>(core_path + ".l2cache.params.is_icache_connected")
+                ->setValueFromString("true");
+        }
     }
+
+    // The memory subsystem has a port for every core's BIU
+    getRoot()->getChildAs<sparta::ParameterBase>("cpu.mss.params.num_ports")
+        ->setValueFromString(std::to_string(num_cores_));
 }
 
 void OlympiaSim::bindTree_()
@@ -110,6 +177,74 @@ void OlympiaSim::bindTree_()
     //Tell the factory to bind all units
     auto cpu_factory = getCPUFactory_();
     cpu_factory->bindTree(getRoot());
+
+    // Track when each core reaches its instruction limit
+    for(uint32_t core = 0; core < num_cores_; ++core) {
+        getRoot()->getChild("cpu.core" + std::to_string(core) + ".rob")
+            ->registerForNotification<bool, OlympiaSim, &OlympiaSim::onCoreFinished_>(
+                this, "rob_stopped_notif_channel");
+    }
+
+    // Measure the sampled intervals of the first core
+    if(sampling_.enabled()) {
+        sampling_driver_.reset(new olympia::SamplingDriver(getRoot()->getChild("cpu.core0"),
+                                                           sampling_));
+    }
+}
+
+void OlympiaSim::reportSampling(std::ostream & os) const
+{
+    if(sampling_driver_) {
+        sampling_driver_->report(os);
+    }
+}
+
+void OlympiaSim::onCoreFinished_(const sparta::TreeNode & origin, const sparta::TreeNode &,
+                                 const bool &)
+{
+    const uint32_t core = olympia::coreutils::getCoreIndex(&origin);
+    if(core_finish_cycles_.at(core) == 0) {
+        core_finish_cycles_[core] = origin.getClock()->currentCycle();
+        ++num_cores_finished_;
+    }
+
+    // With one core the ROB stops the simulation itself
+    if((num_cores_ > 1) && (num_cores_finished_ == num_cores_)) {
+        getScheduler()->stopRunning();
+    }
+}
+
+void OlympiaSim::reportCores(std::ostream & os) const
+{
+    if(num_cores_ < 2) {
+        return;
+    }
+
+    // A core's IPC is taken over the cycles up to its instruction
+    // limit; a core that ran to the end of its workload is measured
+    // up to the end of the simulation
+    const auto end_cycle = getRoot()->getChild("cpu")->getClock()->currentCycle();
+    uint64_t total_retired = 0;
+    double sum_ipc = 0;
+    for(uint32_t core = 0; core < num_cores_; ++core) {
+        const std::string core_name = "cpu.core" + std::to_string(core);
+        const uint64_t retired = getRoot()->getChildAs<const sparta::CounterBase>(
+            core_name + ".rob.stats.total_number_retired")->get();
+        const uint64_t cycles = (core_finish_cycles_[core] != 0) ? core_finish_cycles_[core]
+                                                                 : end_cycle;
+        const double ipc = (cycles != 0) ? static_cast<double>(retired) / cycles : 0;
+        const std::string workload = ((core < core_workloads_.size()) &&
+                                      (false == core_workloads_[core].empty())) ?
+            core_workloads_[core] : workload_;
+        os << "olympia: " << core_name << ": " << retired << " instructions in " << cycles
+           << " cycles, IPC " << ipc << " (" << workload << ")" << std::endl;
+        total_retired += retired;
+        sum_ipc += ipc;
+    }
+    os << "olympia: all cores: " << total_retired << " instructions in " << end_cycle
+       << " cycles, aggregate IPC "
+       << ((end_cycle != 0) ? static_cast<double>(total_retired) / end_cycle : 0)
+       << ", sum of per-core IPC " << sum_ipc << std::endl;
 }
 
 
@@ -120,7 +255,8 @@ void OlympiaSim::bindTree_()
 const sparta::CounterBase* OlympiaSim::findSemanticCounter_(CounterSemantic sem) const {
     switch(sem){
         case CSEM_INSTRUCTIONS:
-            return getRoot()->getChildAs<const sparta::CounterBase>("cpu.core0.rob.stats.total_number_retired");
+            // Instructions retired by all cores
+            return getRoot()->getChildAs<const sparta::CounterBase>("cpu.stats.total_number_retired");
             break;
         default:
             return nullptr;
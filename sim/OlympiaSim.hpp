@@ -2,11 +2,16 @@
 
 #pragma once
 
+#include <vector>
+
 #include "sparta/app/Simulation.hpp"
 
+#include "SamplingDriver.hpp"
+
 namespace olympia {
     class CPUFactory;
     class OlympiaAllocators;
+    class PipelineEventLog;
 }
 
 /*!
@@ -27,17 +32,57 @@ public:
      * \param instruction_limit The maximum number of instructions to
      *                          run.  0 means no limit
      * \param show_factories Print the registered factories to stdout
+     * \param fast_forward Number of workload instructions to skip
+     *                     before detailed simulation starts
+     * \param functional_warming Warm caches, TLBs and predictors
+     *                           with the skipped instructions
+     * \param sampling Sampled simulation periods.  Disabled by default
+     * \param checkpoint_save Save the warmed state here after the fast-forward
+     * \param checkpoint_restore Start from this checkpoint
+     * \param core_workloads Workload of each core.  Cores without one
+     *                       run workload
+     * \param core_instruction_limits Instruction limit of each core.
+     *                                Cores without one (or with 0) use
+     *                                instruction_limit
+     * \param pipeline_event_log Log the pipeline events of every
+     *                           instruction to this file.  No log if
+     *                           empty
      */
     OlympiaSim(const std::string& topology,
                sparta::Scheduler & scheduler,
                const uint32_t num_cores,
                const std::string workload,
                const uint64_t instruction_limit=0,
-               const bool show_factories = false);
+               const bool show_factories = false,
+               const uint64_t fast_forward = 0,
+               const bool functional_warming = false,
+               const olympia::SamplingDriver::Config & sampling = {},
+               const std::string & checkpoint_save = "",
+               const std::string & checkpoint_restore = "",
+               const std::vector<std::string> & core_workloads = {},
+               const std::vector<uint64_t> & core_instruction_limits = {},
+               const std::string & pipeline_event_log = "");
 
     // Tear it down
     virtual ~OlympiaSim();
 
+    //! Print the sampled CPI estimate, if sampling
+    void reportSampling(std::ostream & os) const;
+
+    //! The sampled measurements.  nullptr if not sampling
+    const olympia::SamplingDriver* getSamplingDriver() const { return sampling_driver_.get(); }
+
+    //! Print each core's and the aggregate IPC, if there is more than
+    //! one core
+    void reportCores(std::ostream & os) const;
+
+    //! Has every core reached its instruction limit?
+    bool allCoresFinished() const { return num_cores_finished_ == num_cores_; }
+
+    //! Cycle at which the core reached its instruction limit.  0 if it
+    //! has not
+    uint64_t getCoreFinishCycle(const uint32_t core) const { return core_finish_cycles_.at(core); }
+
 private:
 
     //////////////////////////////////////////////////////////////////////
@@ -46,8 +91,12 @@ private:
     // Allocators.  Last thing to delete
     std::unique_ptr<olympia::OlympiaAllocators> allocators_tn_;
 
-    // The CPU TN.  This must be declared _AFTER_ the allocators so it
-    // is destroyed first.
+    // Pipeline event log.  Written out when deleted, after the units
+    // that record into it
+    std::unique_ptr<olympia::PipelineEventLog> event_log_tn_;
+
+    // The CPU TN.  This must be declared _AFTER_ the allocators and
+    // the event log so it is destroyed first.
     std::unique_ptr<sparta::TreeNode> cpu_tn_to_delete_;
 
     //! Build the tree with tree nodes, but does not instantiate the
@@ -80,6 +129,36 @@ private:
     //! Instruction limit (set up -i option on command line)
     const uint64_t instruction_limit_;
 
+    //! Instructions to skip before detailed simulation
+    const uint64_t fast_forward_;
+
+    //! Warm functional state while skipping
+    const bool functional_warming_;
+
+    //! Sampled simulation configuration and its driver
+    const olympia::SamplingDriver::Config sampling_;
+    std::unique_ptr<olympia::SamplingDriver> sampling_driver_;
+
+    //! Checkpoint to save after the fast-forward / to start from
+    const std::string checkpoint_save_;
+    const std::string checkpoint_restore_;
+
+    //! Per-core workloads and instruction limits
+    const std::vector<std::string> core_workloads_;
+    const std::vector<uint64_t> core_instruction_limits_;
+
+    //! Pipeline event log file.  Empty for none
+    const std::string pipeline_event_log_;
+
+    //! Cycle at which each core reached its instruction limit.  0
+    //! while it has not
+    std::vector<uint64_t> core_finish_cycles_;
+    uint32_t num_cores_finished_ = 0;
+
+    //! A core's ROB stopped it at its instruction limit
+    void onCoreFinished_(const sparta::TreeNode & origin, const sparta::TreeNode &,
+                         const bool &);
+
     /*!
      * \brief Get the factory for topology build
      */
@@ -0,0 +1,440 @@
+// <ParallelCores.cpp> -*- C++ -*-
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#include "ParallelCores.hpp"
+#include "OlympiaSim.hpp"
+
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/ResourceTreeNode.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief State shared by the parent and the core processes (in an
+     *        anonymous shared mapping made before forking), followed by
+     *        one Slot per core
+     */
+    struct ParallelCores::Shared
+    {
+        //! A BIU has at most one request outstanding, so a core makes
+        //! only a few per quantum
+        static constexpr uint32_t MAX_REQUESTS = 64;
+
+        struct Slot
+        {
+            uint32_t done = 0;
+            uint32_t failed = 0;
+
+            //! Written by the core during a quantum, read by the parent
+            uint32_t num_requests = 0;
+            uint64_t request_cycles[MAX_REQUESTS];
+            uint32_t request_latencies[MAX_REQUESTS];
+
+            //! Written by the parent between quanta, read by the core
+            uint32_t num_acks = 0;
+            uint64_t ack_cycles[MAX_REQUESTS];
+
+            //! Results
+            uint64_t quantum = 0;
+            uint64_t retired = 0;
+            uint64_t cycles = 0;
+        };
+
+        //! A barrier of every core and the parent.  Not a
+        //! pthread_barrier_t: the parent must be able to give up on a
+        //! core process that died instead of waiting for it forever
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        uint32_t num_parties = 0;
+        uint32_t num_waiting = 0;
+        uint64_t generation = 0;
+        uint32_t aborted = 0;
+        pid_t parent_pid = 0;
+
+        uint32_t all_done = 0;
+
+        Slot & slot(const uint32_t core_idx) { return reinterpret_cast<Slot*>(this + 1)[core_idx]; }
+
+        void init(const uint32_t parties)
+        {
+            num_parties = parties;
+            parent_pid = ::getpid();
+            pthread_mutexattr_t mutex_attr;
+            pthread_mutexattr_init(&mutex_attr);
+            pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&mutex, &mutex_attr);
+            pthread_mutexattr_destroy(&mutex_attr);
+            pthread_condattr_t cond_attr;
+            pthread_condattr_init(&cond_attr);
+            pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+            pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+            pthread_cond_init(&cond, &cond_attr);
+            pthread_condattr_destroy(&cond_attr);
+        }
+
+        void destroy()
+        {
+            pthread_cond_destroy(&cond);
+            pthread_mutex_destroy(&mutex);
+        }
+
+        //! A process that died holding the mutex leaves it to the
+        //! next owner, who finds the count as it was left
+        void lock()
+        {
+            if (pthread_mutex_lock(&mutex) == EOWNERDEAD)
+            {
+                pthread_mutex_consistent(&mutex);
+            }
+        }
+
+        //! Wait for every party.  is_alive is called every poll_ms
+        //! milliseconds while waiting; when it returns false the
+        //! barrier is aborted.  Returns false if the barrier was
+        //! aborted
+        template <typename IsAliveT>
+        bool wait(const IsAliveT & is_alive, const long poll_ms)
+        {
+            lock();
+            if (aborted != 0)
+            {
+                pthread_mutex_unlock(&mutex);
+                return false;
+            }
+            const uint64_t my_generation = generation;
+            if (++num_waiting == num_parties)
+            {
+                num_waiting = 0;
+                ++generation;
+                pthread_cond_broadcast(&cond);
+                pthread_mutex_unlock(&mutex);
+                return true;
+            }
+            while ((my_generation == generation) && (aborted == 0))
+            {
+                timespec deadline;
+                clock_gettime(CLOCK_MONOTONIC, &deadline);
+                deadline.tv_nsec += poll_ms * 1000000;
+                deadline.tv_sec += deadline.tv_nsec / 1000000000;
+                deadline.tv_nsec %= 1000000000;
+                const int err = pthread_cond_timedwait(&cond, &mutex, &deadline);
+                if (err == EOWNERDEAD)
+                {
+                    pthread_mutex_consistent(&mutex);
+                }
+                if ((my_generation == generation) && (err == ETIMEDOUT) && !is_alive())
+                {
+                    aborted = 1;
+                    pthread_cond_broadcast(&cond);
+                }
+            }
+            const bool ok = (my_generation != generation);
+            pthread_mutex_unlock(&mutex);
+            return ok;
+        }
+
+        //! A core's wait: the parent kills the cores if it gives up,
+        //! so a core that finds the barrier aborted (or the parent
+        //! gone) just exits
+        void wait()
+        {
+            if (false == wait([this] { return ::getppid() == parent_pid; }, 1000))
+            {
+                std::_Exit(1);
+            }
+        }
+
+        static size_t size(const uint32_t num_cores)
+        {
+            return sizeof(Shared) + (num_cores * sizeof(Slot));
+        }
+    };
+
+    void ParallelCores::Core::request(const uint32_t, const uint64_t cycle, const uint32_t latency)
+    {
+        auto & slot = shared_->slot(core_idx_);
+        sparta_assert(slot.num_requests < Shared::MAX_REQUESTS,
+                      "Too many memory requests from core " << core_idx_ << " in one quantum");
+        slot.request_cycles[slot.num_requests] = cycle;
+        slot.request_latencies[slot.num_requests] = latency;
+        ++slot.num_requests;
+    }
+
+    void ParallelCores::Core::simulate(OlympiaSim & sim)
+    {
+        auto mss = sim.getRoot()->getChild("cpu.mss")->getResourceAs<olympia_mss::MSS>();
+        mss->setRemoteMemory(this);
+        const uint64_t quantum = (quantum_ != 0) ? quantum_ : mss->getLatency();
+        if ((quantum == 0) || (quantum > mss->getLatency()))
+        {
+            throw sparta::SpartaException("ERROR: The synchronization quantum (")
+                << quantum << " cycles) must be non-zero and no longer than the MSS latency ("
+                << mss->getLatency() << " cycles)";
+        }
+
+        auto & slot = shared_->slot(core_idx_);
+        slot.quantum = quantum;
+        const auto clock = sim.getRoot()->getChild("cpu.core0")->getClock();
+        const auto retired = sim.getRoot()->getChildAs<sparta::CounterBase>(
+            "cpu.core0.rob.stats.total_number_retired");
+        auto scheduler = sim.getScheduler();
+
+        bool done = false;
+        while (false == all_done_)
+        {
+            if (false == done)
+            {
+                // Always the full quantum, even with nothing to do, so
+                // that every core stays at the same cycle
+                scheduler->run(quantum * clock->getPeriod(), true /* exacting */, false);
+                done = sim.allCoresFinished()
+                       || (scheduler->isFinished() && (false == mss->hasPendingRequests()));
+                if (done)
+                {
+                    slot.retired = retired->get();
+                    slot.cycles = sim.allCoresFinished() ? sim.getCoreFinishCycle(0)
+                                                         : clock->currentCycle();
+                }
+            }
+            slot.done = done ? 1 : 0;
+
+            // The parent services the quantum's requests in between
+            shared_->wait();
+            shared_->wait();
+
+            for (uint32_t i = 0; i < slot.num_acks; ++i)
+            {
+                mss->completeRemoteRequest(0, slot.ack_cycles[i]);
+            }
+            slot.num_acks = 0;
+            all_done_ = (shared_->all_done != 0);
+        }
+    }
+
+    void ParallelCores::Core::drain()
+    {
+        auto & slot = shared_->slot(core_idx_);
+        while (false == all_done_)
+        {
+            slot.done = 1;
+            slot.num_requests = 0;
+            shared_->wait();
+            shared_->wait();
+            slot.num_acks = 0;
+            all_done_ = (shared_->all_done != 0);
+        }
+    }
+
+    uint32_t ParallelCores::run(const RunCore & run_core, std::ostream & os)
+    {
+        void* mapping = ::mmap(nullptr, Shared::size(num_cores_), PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            throw sparta::SpartaException("ERROR: mmap: ") << std::strerror(errno);
+        }
+        Shared* shared = new (mapping) Shared;
+        for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+        {
+            new (&shared->slot(core_idx)) Shared::Slot;
+        }
+        shared->init(num_cores_ + 1);
+
+        os << "olympia: parallel cores: " << num_cores_ << " core processes, synchronized every "
+           << quantum_ << " cycles" << ((quantum_ == 0) ? " (the MSS latency)" : "") << std::endl;
+
+        std::vector<pid_t> pids;
+        for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+        {
+            // Nothing buffered may be written twice
+            std::cout.flush();
+            std::cerr.flush();
+
+            const pid_t pid = ::fork();
+            if (pid < 0)
+            {
+                for (const auto started : pids)
+                {
+                    ::kill(started, SIGKILL);
+                }
+                throw sparta::SpartaException("ERROR: fork: ") << std::strerror(errno);
+            }
+            if (pid == 0)
+            {
+                Core core(shared, core_idx, quantum_);
+                int exit_code = 1;
+                try
+                {
+                    exit_code = run_core(core_idx, core);
+                }
+                catch (const std::exception & e)
+                {
+                    std::cerr << "olympia: core " << core_idx << ": " << e.what() << std::endl;
+                    exit_code = 1;
+                }
+                catch (...)
+                {
+                    std::cerr << "olympia: core " << core_idx << ": unknown exception" << std::endl;
+                    exit_code = 1;
+                }
+                if (exit_code != 0)
+                {
+                    shared->slot(core_idx).failed = 1;
+                }
+                core.drain();
+                std::cout.flush();
+                std::cerr.flush();
+                std::_Exit(exit_code);
+            }
+            pids.emplace_back(pid);
+        }
+
+        // A core process only exits once every core is done.  One that
+        // exits before that (killed by a signal, an abort, the OOM
+        // killer) would never reach the barrier again, so while
+        // waiting the parent checks for exited cores and gives up
+        std::vector<int> statuses(num_cores_, 0);
+        std::vector<bool> reaped(num_cores_, false);
+        auto cores_alive = [&]() {
+            bool alive = true;
+            for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+            {
+                if ((false == reaped[core_idx])
+                    && (::waitpid(pids[core_idx], &statuses[core_idx], WNOHANG) == pids[core_idx]))
+                {
+                    reaped[core_idx] = true;
+                    alive = false;
+                }
+            }
+            return alive;
+        };
+        const long POLL_MS = 100;
+
+        // The shared memory side: service every core's requests of a
+        // quantum one at a time, oldest first, ties by core
+        uint64_t busy_until = 0;
+        uint64_t num_requests = 0;
+        uint64_t num_queued = 0;
+        std::vector<std::tuple<uint64_t, uint32_t, uint32_t>> requests; // cycle, core, latency
+        bool aborted = false;
+        while (true)
+        {
+            if (false == shared->wait(cores_alive, POLL_MS))
+            {
+                aborted = true;
+                break;
+            }
+
+            requests.clear();
+            bool all_done = true;
+            for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+            {
+                auto & slot = shared->slot(core_idx);
+                for (uint32_t i = 0; i < slot.num_requests; ++i)
+                {
+                    requests.emplace_back(slot.request_cycles[i], core_idx,
+                                          slot.request_latencies[i]);
+                }
+                slot.num_requests = 0;
+                all_done = all_done && (slot.done != 0);
+            }
+            std::sort(requests.begin(), requests.end());
+            for (const auto & [cycle, core_idx, latency] : requests)
+            {
+                const uint64_t start = std::max(cycle, busy_until);
+                num_queued += (start > cycle) ? 1 : 0;
+                ++num_requests;
+                busy_until = start + latency;
+                auto & slot = shared->slot(core_idx);
+                slot.ack_cycles[slot.num_acks++] = busy_until;
+            }
+            shared->all_done = all_done ? 1 : 0;
+
+            if (false == shared->wait(cores_alive, POLL_MS))
+            {
+                aborted = true;
+                break;
+            }
+            if (all_done)
+            {
+                break;
+            }
+        }
+
+        if (aborted)
+        {
+            os << "olympia: parallel cores: a core process exited before the others were done; "
+               << "stopping them" << std::endl;
+            for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+            {
+                if (false == reaped[core_idx])
+                {
+                    ::kill(pids[core_idx], SIGKILL);
+                }
+            }
+        }
+
+        uint32_t num_failed = 0;
+        uint64_t total_retired = 0;
+        uint64_t end_cycle = 0;
+        double sum_ipc = 0;
+        for (uint32_t core_idx = 0; core_idx < num_cores_; ++core_idx)
+        {
+            int & status = statuses[core_idx];
+            if (false == reaped[core_idx])
+            {
+                ::waitpid(pids[core_idx], &status, 0);
+            }
+            const auto & slot = shared->slot(core_idx);
+            const std::string prefix =
+                "olympia: parallel cores: cpu.core" + std::to_string(core_idx) + ": ";
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0) || (slot.failed != 0) || aborted)
+            {
+                os << prefix << "failed";
+                if (WIFSIGNALED(status))
+                {
+                    os << " (signal " << WTERMSIG(status) << ")";
+                }
+                os << std::endl;
+                ++num_failed;
+                continue;
+            }
+            const double ipc =
+                (slot.cycles != 0) ? static_cast<double>(slot.retired) / slot.cycles : 0;
+            os << prefix << slot.retired << " instructions in " << slot.cycles << " cycles, IPC "
+               << ipc << std::endl;
+            total_retired += slot.retired;
+            end_cycle = std::max(end_cycle, slot.cycles);
+            sum_ipc += ipc;
+        }
+        os << "olympia: parallel cores: all cores: " << total_retired << " instructions in "
+           << end_cycle << " cycles, aggregate IPC "
+           << ((end_cycle != 0) ? static_cast<double>(total_retired) / end_cycle : 0)
+           << ", sum of per-core IPC " << sum_ipc << std::endl;
+        os << "olympia: parallel cores: " << num_requests << " memory requests, " << num_queued
+           << " waited for another core's" << std::endl;
+
+        shared->destroy();
+        ::munmap(mapping, Shared::size(num_cores_));
+        return num_failed;
+    }
+} // namespace olympia
@@ -0,0 +1,92 @@
+// <ParallelCores.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <ostream>
+
+#include "MSS.hpp"
+
+class OlympiaSim;
+
+namespace olympia
+{
+    /*!
+     * \brief Simulate each core of a multi-core system in its own host
+     *        process, with the memory subsystem shared between them
+     *
+     * Every core process builds a single-core OlympiaSim with its own
+     * Scheduler, whose MSS forwards requests instead of servicing them.
+     * The cores run in lockstep quanta of `quantum` cycles.  After each
+     * quantum the parent services the quantum's requests of every core
+     * in (cycle, core) order, exactly as a shared MSS would, and hands
+     * each core the cycles at which its requests complete.
+     *
+     * A request takes at least the MSS latency, so as long as the
+     * quantum is no longer than that, every completion falls in a later
+     * quantum and the result does not depend on host timing.
+     *
+     * Processes rather than threads: Sparta keeps process-wide state
+     * (e.g. SimulationInfo and the logging taps) that is not safe to
+     * share between simulators on different threads.
+     */
+    class ParallelCores
+    {
+      public:
+        class Core;
+
+        //! Build the core's simulator and call core.simulate() with
+        //! it.  Called in the core's process.  Returns the process
+        //! exit code
+        using RunCore = std::function<int(const uint32_t core_idx, Core & core)>;
+
+        //! quantum 0 is the MSS latency
+        ParallelCores(const uint32_t num_cores, const uint64_t quantum) :
+            num_cores_(num_cores),
+            quantum_(quantum)
+        {
+        }
+
+        //! Fork the cores, service their memory requests until they
+        //! are all done and report.  Returns the number of cores that
+        //! failed
+        uint32_t run(const RunCore & run_core, std::ostream & os);
+
+        struct Shared;
+
+        /*!
+         * \brief A core's side of the synchronization
+         */
+        class Core : public olympia_mss::MSS::RemoteMemoryIF
+        {
+          public:
+            Core(Shared* shared, const uint32_t core_idx, const uint64_t quantum) :
+                shared_(shared),
+                core_idx_(core_idx),
+                quantum_(quantum)
+            {
+            }
+
+            //! Simulate quantum by quantum until every core is done
+            void simulate(OlympiaSim & sim);
+
+            //! Keep taking part in the synchronization without
+            //! simulating (after a failure) until every core is done
+            void drain();
+
+            void request(const uint32_t port, const uint64_t cycle,
+                         const uint32_t latency) override;
+
+          private:
+            Shared* const shared_;
+            const uint32_t core_idx_;
+            const uint64_t quantum_;
+            bool all_done_ = false;
+        };
+
+      private:
+        const uint32_t num_cores_;
+        const uint64_t quantum_;
+    };
+} // namespace olympia
@@ -0,0 +1,77 @@
+// <ParallelRegions.cpp> -*- C++ -*-
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "ParallelRegions.hpp"
+#include "ForkedRuns.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+
+namespace olympia
+{
+    ParallelRegions::Region ParallelRegions::getRegion(const uint32_t index) const
+    {
+        // The first region has nothing before it to warm up on
+        const uint64_t start = index * length;
+        const uint64_t detailed_warmup = std::min(warmup, start);
+
+        Region region;
+        region.index = index;
+        region.fast_forward = start - detailed_warmup;
+        region.instruction_limit = detailed_warmup + length;
+        region.sampling.period = detailed_warmup + length;
+        region.sampling.warmup = detailed_warmup;
+        region.sampling.measure = length;
+        return region;
+    }
+
+    uint32_t ParallelRegions::run(const RunRegion & run_region, std::ostream & os) const
+    {
+        os << "olympia: parallel: " << num_regions << " regions of " << length
+           << " instructions (" << warmup << " detailed warm-up), "
+           << getForkedParallelism(max_jobs) << " at a time" << std::endl;
+
+        std::vector<SampleSet> region_samples;
+        const std::vector<bool> succeeded = runForked(
+            num_regions, max_jobs,
+            [&](const uint32_t index, SampleSet & samples)
+            { return run_region(getRegion(index), samples); },
+            region_samples);
+
+        // Per region, then all of them together
+        uint32_t num_failed = 0;
+        SampleSet merged;
+        for (uint32_t index = 0; index < num_regions; ++index)
+        {
+            const SampleSet & samples = region_samples[index];
+            if (false == succeeded[index])
+            {
+                os << "olympia: parallel: region " << index << " failed" << std::endl;
+                ++num_failed;
+            }
+            else if (samples.measured_insts != 0)
+            {
+                os << "olympia: parallel: region " << index << " [" << (index * length) << ", "
+                   << ((index + 1) * length) << ") CPI "
+                   << (static_cast<double>(samples.measured_cycles) / samples.measured_insts)
+                   << std::endl;
+            }
+            merged.merge(samples);
+        }
+        merged.report(os, "olympia: parallel: ");
+
+        if (false == merged_report.empty())
+        {
+            std::ofstream report(merged_report);
+            merged.writeCounters(report);
+            if (!report)
+            {
+                throw sparta::SpartaException("ERROR: Issues writing ") << merged_report;
+            }
+            os << "olympia: parallel: merged counters written to " << merged_report << std::endl;
+        }
+        return num_failed;
+    }
+} // namespace olympia
@@ -0,0 +1,54 @@
+// <ParallelRegions.hpp> -*- C++ -*-
+
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <ostream>
+#include <string>
+
+#include "SamplingDriver.hpp"
+
+namespace olympia
+{
+    /*!
+     * \brief Simulate consecutive regions of one workload at the same
+     *        time, one forked process per region, and merge their
+     *        measurements
+     *
+     * Region k covers workload instructions [k * length, (k+1) * length).
+     * Its process fast-forwards with functional warming to warmup
+     * instructions before the region, simulates those in detail as
+     * warm-up, then measures the region.  Each process has its own
+     * Scheduler and OlympiaSim; nothing is shared but the workload file.
+     */
+    struct ParallelRegions
+    {
+        uint32_t num_regions = 0;
+        uint64_t length = 0;   //!< Instructions per region
+        uint64_t warmup = 0;   //!< Detailed warm-up before each region
+        uint32_t max_jobs = 0; //!< Regions simulated at once.  0 is one per host thread
+        std::string merged_report; //!< If not empty, write the merged counters here
+
+        bool enabled() const { return num_regions != 0; }
+
+        //! How one region is simulated
+        struct Region
+        {
+            uint32_t index = 0;
+            uint64_t fast_forward = 0;
+            uint64_t instruction_limit = 0;
+            SamplingDriver::Config sampling;
+        };
+
+        //! Simulate the region and fill in its samples.  Returns the
+        //! process exit code
+        using RunRegion = std::function<int(const Region & region, SampleSet & samples)>;
+
+        //! Fork the regions, wait for them and report.  Returns the
+        //! number of regions that failed
+        uint32_t run(const RunRegion & run_region, std::ostream & os) const;
+
+        Region getRegion(const uint32_t index) const;
+    };
+} // namespace olympia
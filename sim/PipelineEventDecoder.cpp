@@ -0,0 +1,245 @@
+// <PipelineEventDecoder.cpp> -*- C++ -*-
+
+//!
+//! \file PipelineEventDecoder.cpp
+//! \brief olympia_pel_decode: print a pipeline event log (written with
+//!        olympia --pipeline-event-log) as text, CSV or a Konata
+//!        pipeline view
+//!
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineEventLog.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+#include "sparta/utils/LexicalCast.hpp"
+
+namespace
+{
+    const char USAGE[] =
+        "Usage: olympia_pel_decode [--format text|csv|konata] [--from-cycle N] [--to-cycle N]\n"
+        "                          [--uid N] [--unit SUBSTRING] LOG_FILE\n";
+
+    struct Filter
+    {
+        uint64_t from_cycle = 0;
+        uint64_t to_cycle = std::numeric_limits<uint64_t>::max();
+        bool has_uid = false;
+        uint64_t uid = 0;
+        std::string unit;
+
+        bool pass(const olympia::PipelineEvent & event,
+                  const std::vector<std::string> & units) const
+        {
+            return (event.cycle >= from_cycle) && (event.cycle <= to_cycle)
+                   && ((false == has_uid) || (event.uid == uid))
+                   && (unit.empty() || (units[event.unit].find(unit) != std::string::npos));
+        }
+    };
+
+    void printText(olympia::PipelineEventReader & reader, const Filter & filter, const bool csv)
+    {
+        if (csv)
+        {
+            std::cout << "cycle,unit,event,uid,pc\n";
+        }
+        olympia::PipelineEvent event;
+        while (reader.next(event))
+        {
+            const auto & units = reader.getUnits();
+            if (false == filter.pass(event, units))
+            {
+                continue;
+            }
+            const char* type = olympia::getPipelineEventTypeName(event.type);
+            if (csv)
+            {
+                std::cout << event.cycle << ',' << units[event.unit] << ',' << type << ','
+                          << event.uid << ",0x" << std::hex << event.pc << std::dec << '\n';
+            }
+            else
+            {
+                std::cout << std::setw(10) << event.cycle << ' ' << std::left << std::setw(32)
+                          << units[event.unit] << ' ' << std::setw(8) << type << std::right
+                          << " uid:" << event.uid << " pc:0x" << std::hex << event.pc << std::dec
+                          << '\n';
+            }
+        }
+    }
+
+    //! The core a unit belongs to ("top.cpu.core1.rob" -> 1), for the
+    //! Konata thread id
+    uint32_t getCoreIndex(const std::string & location)
+    {
+        const auto pos = location.find(".core");
+        if (pos == std::string::npos)
+        {
+            return 0;
+        }
+        return static_cast<uint32_t>(std::strtoul(location.c_str() + pos + 5, nullptr, 10));
+    }
+
+    /*!
+     * \brief Write the Konata (Kanata 0004) format: each instruction is
+     *        a row, each event starts a stage, retire and flush end it
+     */
+    void printKonata(olympia::PipelineEventReader & reader, const Filter & filter)
+    {
+        static const char* STAGES[] = {"F", "Dc", "Rn", "Ds", "Is", "Cm"};
+
+        struct Row
+        {
+            uint64_t id;
+            uint64_t pc;
+        };
+
+        // Keyed by core and uid
+        std::unordered_map<uint64_t, Row> rows;
+        uint64_t next_id = 0;
+        uint64_t next_retire_id = 0;
+        bool started = false;
+        uint64_t cycle = 0;
+
+        std::cout << "Kanata\t0004\n";
+        olympia::PipelineEvent event;
+        while (reader.next(event))
+        {
+            const auto & units = reader.getUnits();
+            if (false == filter.pass(event, units))
+            {
+                continue;
+            }
+            if (false == started)
+            {
+                std::cout << "C=\t" << event.cycle << '\n';
+                cycle = event.cycle;
+                started = true;
+            }
+            else if (event.cycle != cycle)
+            {
+                std::cout << "C\t" << (event.cycle - cycle) << '\n';
+                cycle = event.cycle;
+            }
+
+            const uint32_t core = getCoreIndex(units[event.unit]);
+            const uint64_t key = (static_cast<uint64_t>(core) << 48) ^ event.uid;
+            auto row = rows.find(key);
+            if (row == rows.end())
+            {
+                if ((event.type == olympia::PipelineEventType::RETIRE)
+                    || (event.type == olympia::PipelineEventType::FLUSH))
+                {
+                    // Filtered in only at its end
+                    continue;
+                }
+                row = rows.emplace(key, Row{next_id++, event.pc}).first;
+                std::cout << "I\t" << row->second.id << '\t' << event.uid << '\t' << core << '\n';
+                std::cout << "L\t" << row->second.id << "\t0\tuid:" << event.uid << " pc:0x"
+                          << std::hex << event.pc << std::dec << '\n';
+            }
+
+            switch (event.type)
+            {
+            case olympia::PipelineEventType::RETIRE:
+                std::cout << "R\t" << row->second.id << '\t' << next_retire_id++ << "\t0\n";
+                rows.erase(row);
+                break;
+            case olympia::PipelineEventType::FLUSH:
+                std::cout << "R\t" << row->second.id << '\t' << row->second.id << "\t1\n";
+                rows.erase(row);
+                break;
+            default:
+                std::cout << "S\t" << row->second.id << "\t0\t"
+                          << STAGES[static_cast<uint32_t>(event.type)] << '\n';
+                break;
+            }
+        }
+
+        // Never retired nor flushed from the ROB: flushed before
+        // dispatch, or still in flight at the end
+        for (const auto & row : rows)
+        {
+            std::cout << "R\t" << row.second.id << '\t' << row.second.id << "\t1\n";
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Filter filter;
+    std::string format = "text";
+    std::string filename;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = ((i + 1) < argc);
+        if ((arg == "-h") || (arg == "--help"))
+        {
+            std::cout << USAGE;
+            return 0;
+        }
+        else if ((arg == "--format") && has_value)
+        {
+            format = argv[++i];
+        }
+        else if ((arg == "--from-cycle") && has_value)
+        {
+            filter.from_cycle = sparta::utils::smartLexicalCast<uint64_t>(argv[++i]);
+        }
+        else if ((arg == "--to-cycle") && has_value)
+        {
+            filter.to_cycle = sparta::utils::smartLexicalCast<uint64_t>(argv[++i]);
+        }
+        else if ((arg == "--uid") && has_value)
+        {
+            filter.has_uid = true;
+            filter.uid = sparta::utils::smartLexicalCast<uint64_t>(argv[++i]);
+        }
+        else if ((arg == "--unit") && has_value)
+        {
+            filter.unit = argv[++i];
+        }
+        else if (filename.empty() && (arg.rfind("--", 0) != 0))
+        {
+            filename = arg;
+        }
+        else
+        {
+            std::cerr << "ERROR: Unexpected argument '" << arg << "'\n" << USAGE;
+            return 1;
+        }
+    }
+    if (filename.empty() || ((format != "text") && (format != "csv") && (format != "konata")))
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    try
+    {
+        olympia::PipelineEventReader reader(filename);
+        if (format == "konata")
+        {
+            printKonata(reader, filter);
+        }
+        else
+        {
+            printText(reader, filter, (format == "csv"));
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,13 +1,24 @@
 // <main.cpp> -*- C++ -*-
 
 
+#include <cctype>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "OlympiaSim.hpp" // Core model example simulator
+#include "ParallelRegions.hpp"
+#include "ConfigFanOut.hpp"
+#include "ParallelCores.hpp"
+#include "HeapAllocations.hpp"
+#include "DecodedTrace.hpp"
+#include "MavisUnit.hpp"
 
 #include "sparta/app/CommandLineSimulator.hpp"
 #include "sparta/app/MultiDetailOptions.hpp"
 #include "sparta/sparta.hpp"
+#include "sparta/utils/LexicalCast.hpp"
 
 // User-friendly usage that correspond with sparta::app::CommandLineSimulator
 // options
@@ -16,16 +27,75 @@ const char USAGE[] =
     "    [-i insts] [-r RUNTIME] [--show-tree] [--show-dag]\n"
     "    [-p PATTERN VAL] [-c FILENAME]\n"
     "    [-l PATTERN CATEGORY DEST]\n"
-    "    [-h,--help] <workload [stf trace or JSON]>\n"
+    "    [--fast-forward N] [--roi-start N --roi-length N]\n"
+    "    [--sampling-period N --sampling-warmup N --sampling-measure N]\n"
+    "    [--parallel-regions K --region-length N [--region-warmup N]]\n"
+    "    [--roi-start N --roi-length N --fan-out LABEL:PATH=VALUE[,PATH=VALUE...] ...]\n"
+    "    [--save-checkpoint FILE] [--restore-checkpoint FILE]\n"
+    "    [--num-cores N] [--core-workload WORKLOAD[:LIMIT] ...]\n"
+    "    [--parallel-cores [--sync-quantum N]]\n"
+    "    [--convert-trace PDT_FILE]\n"
+    "    [--count-heap-allocations WARMUP [--fail-on-heap-allocations]]\n"
+    "    [--pipeline-event-log FILE]\n"
+    "    [-h,--help] <workload [stf trace, JSON or pre-decoded trace]>\n"
     "\n";
 
 constexpr char VERSION_VARNAME[] = "version,v"; //!< Name of option to show version
 
+namespace
+{
+    // The memory subsystem used to sit under each core
+    // (top.cpu.core0.mss) and is now shared by all of them at
+    // top.cpu.mss.  Parameter paths on the command line (-p and
+    // --fan-out) that still name it under a core are rewritten to the
+    // shared node, with a note, so existing scripts keep working.
+    // Configuration files are not rewritten
+    std::string aliasCoreMSSPath(const std::string & arg)
+    {
+        static const std::string CORE_PREFIX = "cpu.core";
+        static const std::string MSS_SUFFIX = ".mss.";
+        std::string out = arg;
+        size_t pos = 0;
+        while((pos = out.find(CORE_PREFIX, pos)) != std::string::npos) {
+            size_t end = pos + CORE_PREFIX.size();
+            while((end < out.size()) && (std::isdigit(static_cast<unsigned char>(out[end])) ||
+                                         (out[end] == '*'))) {
+                ++end;
+            }
+            if((end > pos + CORE_PREFIX.size()) && (out.compare(end, MSS_SUFFIX.size(), MSS_SUFFIX) == 0)) {
+                out.replace(pos, end - pos, "cpu");
+                pos += 3;
+            } else {
+                pos = end;
+            }
+        }
+        if(out != arg) {
+            std::cerr << "NOTE: the memory subsystem is shared by all cores; '" << arg
+                      << "' is taken as '" << out << "'" << std::endl;
+        }
+        return out;
+    }
+}
+
 int main(int argc, char **argv)
 {
     uint64_t ilimit = 0;
+    uint64_t fast_forward = 0;
+    uint64_t roi_start = 0;
+    uint64_t roi_length = 0;
+    olympia::SamplingDriver::Config sampling;
+    olympia::ParallelRegions parallel;
+    olympia::ConfigFanOut fan_out;
+    std::vector<std::string> fan_out_specs;
+    std::vector<std::string> core_workload_specs;
     uint32_t num_cores = 1;
+    uint64_t sync_quantum = 0;
+    uint64_t heap_count_warmup = 0;
     std::string workload;
+    std::string convert_trace;
+    std::string pipeline_event_log;
+    std::string checkpoint_save;
+    std::string checkpoint_restore;
     const char * WORKLOAD = "workload";
 
     sparta::app::DefaultValues DEFAULTS;
@@ -41,6 +111,20 @@ int main(int argc, char **argv)
     sparta::SimulationInfo::getInstance().write(std::cout, "# ", "\n", show_field_names);
     std::cout << "# Sparta Version: " << sparta::SimulationInfo::sparta_version << std::endl;
 
+    // Parameter paths naming the old per-core MSS are taken as the
+    // shared one; the rewritten arguments outlive every parse below
+    std::vector<std::string> alias_args;
+    std::vector<char *> alias_argv;
+    alias_args.reserve(argc);
+    for(int i = 0; i < argc; ++i) {
+        alias_args.emplace_back(aliasCoreMSSPath(argv[i]));
+    }
+    for(auto & arg : alias_args) {
+        alias_argv.emplace_back(arg.data());
+    }
+    alias_argv.emplace_back(nullptr);
+    argv = alias_argv.data();
+
     // try/catch block to ensure proper destruction of the cls/sim classes in
     // the event of an error
     try{
@@ -48,37 +132,197 @@ int main(int argc, char **argv)
         // simulator, and running the simulator. All of the things done by this
         // classs can be done manually if desired. Use the source for the
         // CommandLineSimulator class as a starting point
-        sparta::app::CommandLineSimulator cls(USAGE, DEFAULTS);
-        auto& app_opts = cls.getApplicationOptions();
-        app_opts.add_options()
-            (VERSION_VARNAME,
-             "produce version message",
-             "produce version message") // Brief
-            ("instruction-limit,i",
-             sparta::app::named_value<uint64_t>("LIMIT", &ilimit)->default_value(ilimit),
-             "Limit the simulation to retiring a specific number of instructions. 0 (default) "
-             "means no limit. If -r is also specified, the first limit reached ends the simulation",
-             "End simulation after a number of instructions. Note that if set to 0, this may be "
-             "overridden by a node parameter within the simulator")
-            ("num-cores",
-             sparta::app::named_value<uint32_t>("CORES", &num_cores)->default_value(1),
-             "The number of cores in simulation", "The number of cores in simulation")
-            ("show-factories",
-             "Show the registered factories")
-            (WORKLOAD,
-             sparta::app::named_value<std::string>(WORKLOAD, &workload),
-             "Specifies the instruction workload (trace, JSON)");
-
-        // Add any positional command-line options
-        po::positional_options_description& pos_opts = cls.getPositionalOptions();
-        pos_opts.add(WORKLOAD, -1);
+        //
+        // The command line may be parsed twice (see the ROI warm-up
+        // below), so the options are added by a function
+        auto make_cls = [&]() {
+            std::unique_ptr<sparta::app::CommandLineSimulator> cls(
+                new sparta::app::CommandLineSimulator(USAGE, DEFAULTS));
+            auto& app_opts = cls->getApplicationOptions();
+            app_opts.add_options()
+                (VERSION_VARNAME,
+                 "produce version message",
+                 "produce version message") // Brief
+                ("instruction-limit,i",
+                 sparta::app::named_value<uint64_t>("LIMIT", &ilimit)->default_value(ilimit),
+                 "Limit the simulation to retiring a specific number of instructions. 0 (default) "
+                 "means no limit. If -r is also specified, the first limit reached ends the simulation",
+                 "End simulation after a number of instructions. Note that if set to 0, this may be "
+                 "overridden by a node parameter within the simulator")
+                ("fast-forward",
+                 sparta::app::named_value<uint64_t>("N", &fast_forward)->default_value(fast_forward),
+                 "Skip the first N workload instructions without simulating them",
+                 "Instructions are consumed from the workload without being built or timed")
+                ("roi-start",
+                 sparta::app::named_value<uint64_t>("N", &roi_start)->default_value(roi_start),
+                 "Start the region of interest at workload instruction N.  Fast-forwards to N "
+                 "unless --fast-forward is smaller, in which case the instructions in between are "
+                 "simulated as warm-up and excluded from the reports",
+                 "Start of the region of interest")
+                ("roi-length",
+                 sparta::app::named_value<uint64_t>("N", &roi_length)->default_value(roi_length),
+                 "Number of instructions in the region of interest",
+                 "Length of the region of interest")
+                ("functional-warming",
+                 "Warm the caches, TLBs and predictors with the fast-forwarded instructions",
+                 "Skipped instructions update the functional state of the memory hierarchy and "
+                 "predictors, without timing or statistics")
+                ("save-checkpoint",
+                 sparta::app::named_value<std::string>("FILE", &checkpoint_save),
+                 "After the fast-forward, save the warmed caches and TLBs and the workload position "
+                 "to FILE",
+                 "Binary checkpoint of the functional state, to be given to --restore-checkpoint")
+                ("restore-checkpoint",
+                 sparta::app::named_value<std::string>("FILE", &checkpoint_restore),
+                 "Start from the state and workload position saved in FILE.  --fast-forward and "
+                 "--roi-start then count from the checkpoint",
+                 "Restore a checkpoint written by --save-checkpoint")
+                ("sampling-period",
+                 sparta::app::named_value<uint64_t>("N", &sampling.period)->default_value(0),
+                 "Sampled simulation: split the workload into periods of N instructions.  Each "
+                 "period is functionally warmed, then simulated in detail for --sampling-warmup "
+                 "plus --sampling-measure instructions.  CPI is estimated from the measured "
+                 "instructions only",
+                 "Length of a sampling period.  0 (default) disables sampling")
+                ("sampling-warmup",
+                 sparta::app::named_value<uint64_t>("N", &sampling.warmup)->default_value(0),
+                 "Sampled simulation: detailed, unmeasured instructions before each measurement",
+                 "Detailed warm-up per sampling period")
+                ("sampling-measure",
+                 sparta::app::named_value<uint64_t>("N", &sampling.measure)->default_value(0),
+                 "Sampled simulation: measured instructions per sampling period",
+                 "Measurement interval per sampling period")
+                ("parallel-regions",
+                 sparta::app::named_value<uint32_t>("K", &parallel.num_regions)->default_value(0),
+                 "Split the first K * --region-length workload instructions into K regions and "
+                 "simulate them at the same time, one process per region.  Each region is reached "
+                 "by fast-forwarding with functional warming.  The measurements are merged",
+                 "Number of regions simulated in parallel")
+                ("region-length",
+                 sparta::app::named_value<uint64_t>("N", &parallel.length)->default_value(0),
+                 "Parallel regions: instructions measured per region",
+                 "Length of a parallel region")
+                ("region-warmup",
+                 sparta::app::named_value<uint64_t>("N", &parallel.warmup)->default_value(0),
+                 "Parallel regions: instructions before each region simulated in detail, but not "
+                 "measured",
+                 "Detailed warm-up per parallel region")
+                ("parallel-jobs",
+                 sparta::app::named_value<uint32_t>("J", &parallel.max_jobs)->default_value(0),
+                 "Parallel regions: number of regions simulated at once.  0 (default) uses every "
+                 "host thread",
+                 "Number of region processes at once")
+                ("merged-report",
+                 sparta::app::named_value<std::string>("FILE", &parallel.merged_report),
+                 "Parallel regions: write every counter, summed over the regions, to FILE",
+                 "Merged counter report")
+                ("fan-out",
+                 sparta::app::named_value<std::vector<std::string>>("LABEL:PATH=VALUE[,...]",
+                                                                    &fan_out_specs),
+                 "Simulate up to --roi-start once, then measure the region of interest once per "
+                 "--fan-out configuration, each in a process forked from the warmed model.  PATH "
+                 "is a parameter path as given to -p; only latencies and delays that can change "
+                 "after warm-up are accepted.  A configuration with no overrides is the baseline",
+                 "Parameter overrides measured from a shared warm-up (repeatable)")
+                ("fan-out-jobs",
+                 sparta::app::named_value<uint32_t>("J", &fan_out.max_jobs)->default_value(0),
+                 "Fan-out: number of configurations simulated at once.  0 (default) uses every "
+                 "host thread",
+                 "Number of fan-out processes at once")
+                ("fan-out-report-prefix",
+                 sparta::app::named_value<std::string>("PREFIX", &fan_out.report_prefix),
+                 "Fan-out: write each configuration's counters to PREFIX<label>.out",
+                 "Per-configuration counter reports")
+                ("num-cores",
+                 sparta::app::named_value<uint32_t>("CORES", &num_cores)->default_value(1),
+                 "The number of cores in simulation", "The number of cores in simulation")
+                ("core-workload",
+                 sparta::app::named_value<std::vector<std::string>>("WORKLOAD[:LIMIT]",
+                                                                    &core_workload_specs),
+                 "Workload of the next core: the first --core-workload is core 0's, and so on.  "
+                 "LIMIT is that core's instruction limit (default -i).  Sets --num-cores if that "
+                 "is not given.  Cores without one run the positional workload.  All cores share "
+                 "the memory subsystem; each stops at its limit and the simulation ends when all "
+                 "have",
+                 "Per-core workload for multi-programmed runs (repeatable)")
+                ("parallel-cores",
+                 "Simulate each core in its own host process, in lockstep with the others, with "
+                 "the memory subsystem serviced in between.  Only the per-core and aggregate "
+                 "results are reported",
+                 "Simulate the cores of a multi-core run in parallel")
+                ("sync-quantum",
+                 sparta::app::named_value<uint64_t>("CYCLES", &sync_quantum)->default_value(0),
+                 "Parallel cores: cycles simulated between synchronizations.  0 (default) is the "
+                 "MSS latency, the longest that gives the same result every run",
+                 "Parallel cores synchronization quantum")
+                ("count-heap-allocations",
+                 sparta::app::named_value<uint64_t>("WARMUP", &heap_count_warmup),
+                 "Count heap allocations (operator new) after core 0 retires WARMUP instructions "
+                 "and report them per retired instruction",
+                 "Count steady-state heap allocations")
+                ("fail-on-heap-allocations",
+                 "With --count-heap-allocations, exit with an error if anything was allocated "
+                 "after the warm-up",
+                 "Fail on steady-state heap allocations")
+                ("pipeline-event-log",
+                 sparta::app::named_value<std::string>("FILE", &pipeline_event_log),
+                 "Log every instruction's fetch, decode, rename, dispatch, issue, complete, retire "
+                 "and flush to FILE in a compact binary form.  Decode it with olympia_pel_decode",
+                 "Write a binary pipeline event log")
+                ("show-factories",
+                 "Show the registered factories")
+                ("convert-trace",
+                 sparta::app::named_value<std::string>("PDT_FILE", &convert_trace),
+                 "Decode the workload (up to -i instructions) into a pre-decoded trace file and exit",
+                 "Convert the workload into a memory-mappable pre-decoded trace (.pdt) that can be "
+                 "given back as a workload")
+                (WORKLOAD,
+                 sparta::app::named_value<std::string>(WORKLOAD, &workload),
+                 "Specifies the instruction workload (trace, JSON, pre-decoded trace)");
+
+            // Add any positional command-line options
+            po::positional_options_description& pos_opts = cls->getPositionalOptions();
+            pos_opts.add(WORKLOAD, -1);
+            return cls;
+        };
 
         // Parse command line options and configure simulator
+        std::unique_ptr<sparta::app::CommandLineSimulator> cls_ptr = make_cls();
         int err_code = 0;
-        if(!cls.parse(argc, argv, err_code)){
+        if(!cls_ptr->parse(argc, argv, err_code)){
             return err_code; // Any errors already printed to cerr
         }
 
+        // Instructions between the end of the fast-forward and the
+        // start of the region of interest are simulated in detail but
+        // excluded from the reports.  Sparta's report warm-up does
+        // exactly this, but it is a command line option of its own:
+        // once the options are parsed and the warm-up is known, the
+        // command line is parsed again with it added.  The fan-out
+        // parent reports on the shared warm-up itself, so it has none
+        std::string roi_warmup_str;
+        if((cls_ptr->getVariablesMap().count("roi-start") != 0) && fan_out_specs.empty()) {
+            const uint64_t detailed_start =
+                (cls_ptr->getVariablesMap().count("fast-forward") != 0) ? fast_forward : roi_start;
+            if(roi_start > detailed_start) {
+                if(cls_ptr->getVariablesMap().count("report-warmup-icount") != 0) {
+                    std::cerr << "ERROR: --roi-start sets the report warm-up; "
+                              << "do not also give --report-warmup-icount" << std::endl;
+                    return -1;
+                }
+                static char REPORT_WARMUP_OPT[] = "--report-warmup-icount";
+                roi_warmup_str = std::to_string(roi_start - detailed_start);
+                std::vector<char *> args(argv, argv + argc);
+                args.emplace_back(REPORT_WARMUP_OPT);
+                args.emplace_back(roi_warmup_str.data());
+                cls_ptr = make_cls();
+                if(!cls_ptr->parse(static_cast<int>(args.size()), args.data(), err_code)){
+                    return err_code;
+                }
+            }
+        }
+        sparta::app::CommandLineSimulator & cls = *cls_ptr;
+
         auto& vm = cls.getVariablesMap();
         if(vm.count("auto-summary") == 0) {
             std::cout << "olympia: Auto-summary reports are disabled in Olympia.  To enable, use '--auto-summary on'"
@@ -90,12 +334,230 @@ int main(int argc, char **argv)
             show_factories = true;
         }
 
+        const bool functional_warming = (vm.count("functional-warming") != 0);
+
+        // Per-core workloads, each with an optional instruction limit
+        std::vector<std::string> core_workloads;
+        std::vector<uint64_t> core_ilimits;
+        for(const auto & spec : core_workload_specs) {
+            const auto colon = spec.rfind(':');
+            if((colon != std::string::npos) && ((colon + 1) < spec.size()) &&
+               std::isdigit(static_cast<unsigned char>(spec[colon + 1]))) {
+                core_workloads.emplace_back(spec.substr(0, colon));
+                core_ilimits.emplace_back(
+                    sparta::utils::smartLexicalCast<uint64_t>(spec.substr(colon + 1)));
+            }
+            else {
+                core_workloads.emplace_back(spec);
+                core_ilimits.emplace_back(0);
+            }
+        }
+        if(core_workloads.size() > num_cores) {
+            if(false == vm["num-cores"].defaulted()) {
+                std::cerr << "ERROR: " << core_workloads.size() << " --core-workload given for "
+                          << num_cores << " cores" << std::endl;
+                return -1;
+            }
+            num_cores = static_cast<uint32_t>(core_workloads.size());
+        }
+        if(workload.empty() && (core_workloads.size() == num_cores)) {
+            // Every core has its own; the first names the simulation
+            workload = core_workloads.front();
+        }
+
+        if(num_cores > 1) {
+            if(sampling.enabled() || parallel.enabled() || (false == fan_out_specs.empty())
+               || (false == convert_trace.empty()) || (false == checkpoint_save.empty())
+               || (false == checkpoint_restore.empty())) {
+                std::cerr << "ERROR: --sampling-*, --parallel-regions, --fan-out, "
+                          << "--convert-trace and checkpoints are single-core only" << std::endl;
+                return -1;
+            }
+        }
+
+        const bool count_heap_allocations = (vm.count("count-heap-allocations") != 0);
+        if(count_heap_allocations) {
+            if(false == olympia::HeapAllocationCounter::isAvailable()) {
+                std::cerr << "ERROR: --count-heap-allocations needs olympia built with "
+                          << "-DOLYMPIA_HEAP_ALLOCATION_COUNTING=ON" << std::endl;
+                return -1;
+            }
+            if(parallel.enabled() || (false == fan_out_specs.empty())
+               || (vm.count("parallel-cores") != 0)) {
+                std::cerr << "ERROR: --count-heap-allocations cannot be combined with "
+                          << "--parallel-regions, --fan-out or --parallel-cores" << std::endl;
+                return -1;
+            }
+        }
+        else if(vm.count("fail-on-heap-allocations") != 0) {
+            std::cerr << "ERROR: --fail-on-heap-allocations needs --count-heap-allocations"
+                      << std::endl;
+            return -1;
+        }
+
+        if((false == pipeline_event_log.empty())
+           && (parallel.enabled() || (false == fan_out_specs.empty())
+               || (vm.count("parallel-cores") != 0))) {
+            std::cerr << "ERROR: --pipeline-event-log cannot be combined with "
+                      << "--parallel-regions, --fan-out or --parallel-cores" << std::endl;
+            return -1;
+        }
+
         if(workload.empty() && (0 == vm.count("no-run"))) {
             std::cerr << "ERROR: Missing a workload to run.  Can be a trace or JSON file" << std::endl;
             std::cerr << USAGE;
             return -1;
         }
 
+        if(vm.count("parallel-cores") != 0) {
+            if(num_cores < 2) {
+                std::cerr << "ERROR: --parallel-cores needs more than one core" << std::endl;
+                return -1;
+            }
+            if((fast_forward != 0) || (vm.count("roi-start") != 0) || functional_warming) {
+                std::cerr << "ERROR: --parallel-cores cannot be combined with --fast-forward, "
+                          << "--roi-* or --functional-warming" << std::endl;
+                return -1;
+            }
+
+            // Every core process builds a single-core simulator of its
+            // own workload.  Report options given on the command line
+            // would have each of them write the same files, so the
+            // simulators are not post-processed
+            olympia::ParallelCores parallel_cores(num_cores, sync_quantum);
+            const uint32_t num_failed = parallel_cores.run(
+                [&](const uint32_t core_idx, olympia::ParallelCores::Core & core) {
+                    const bool own = (core_idx < core_workloads.size());
+                    const uint64_t core_ilimit =
+                        (own && (core_ilimits[core_idx] != 0)) ? core_ilimits[core_idx] : ilimit;
+                    sparta::Scheduler scheduler;
+                    OlympiaSim sim("simple",
+                                   scheduler,
+                                   1, // cores
+                                   own ? core_workloads[core_idx] : workload,
+                                   core_ilimit,
+                                   show_factories);
+                    cls.populateSimulation(&sim);
+                    core.simulate(sim);
+                    return 0;
+                },
+                std::cout);
+            return (num_failed == 0) ? 0 : -1;
+        }
+
+        if(vm.count("roi-start") != 0 || vm.count("roi-length") != 0) {
+            if(vm.count("fast-forward") == 0) {
+                fast_forward = roi_start;
+            }
+            if(fast_forward > roi_start) {
+                std::cerr << "ERROR: --fast-forward (" << fast_forward
+                          << ") is past --roi-start (" << roi_start << ")" << std::endl;
+                return -1;
+            }
+            if(roi_length != 0) {
+                if(ilimit != 0) {
+                    std::cout << "olympia: --roi-length overrides the instruction limit" << std::endl;
+                }
+                // Detailed warm-up plus the region itself
+                ilimit = (roi_start - fast_forward) + roi_length;
+            }
+        }
+
+        if(sampling.enabled()) {
+            if((sampling.measure == 0) || ((sampling.warmup + sampling.measure) > sampling.period)) {
+                std::cerr << "ERROR: --sampling-measure must be non-zero and, with "
+                          << "--sampling-warmup, fit in --sampling-period" << std::endl;
+                return -1;
+            }
+        }
+        else if((sampling.warmup != 0) || (sampling.measure != 0)) {
+            std::cerr << "ERROR: --sampling-warmup/--sampling-measure need --sampling-period"
+                      << std::endl;
+            return -1;
+        }
+
+        if(parallel.enabled()) {
+            if(parallel.length == 0) {
+                std::cerr << "ERROR: --parallel-regions needs --region-length" << std::endl;
+                return -1;
+            }
+            if((fast_forward != 0) || (vm.count("roi-start") != 0) || sampling.enabled()
+               || (false == convert_trace.empty()) || (false == checkpoint_save.empty())
+               || (false == checkpoint_restore.empty())) {
+                std::cerr << "ERROR: --parallel-regions sets the fast-forward and measurement "
+                          << "of each region; it cannot be combined with --fast-forward, "
+                          << "--roi-*, --sampling-*, --convert-trace or checkpoints" << std::endl;
+                return -1;
+            }
+            if(ilimit != 0) {
+                std::cout << "olympia: --parallel-regions overrides the instruction limit" << std::endl;
+            }
+
+            // Every region process builds and runs its own simulator.
+            // Report, log and pipeline collection files named on the
+            // command line would be written by each of them, so they
+            // are rejected; --merged-report covers all the regions
+            for(const auto & opt : vm) {
+                const std::string & name = opt.first;
+                const bool writes_files = (name == "log") || (name == "pipeline-collection")
+                    || ((name.rfind("report", 0) == 0) && (name != "report-search-dir")
+                        && (name != "report-yaml-replacements")
+                        && (name.rfind("report-warmup", 0) != 0));
+                if(writes_files && (false == opt.second.defaulted())) {
+                    std::cerr << "ERROR: --" << name << " cannot be combined with "
+                              << "--parallel-regions: every region would write the same files.  "
+                              << "Use --merged-report" << std::endl;
+                    return -1;
+                }
+            }
+            const uint32_t num_failed = parallel.run(
+                [&](const olympia::ParallelRegions::Region & region, olympia::SampleSet & samples) {
+                    sparta::Scheduler scheduler;
+                    OlympiaSim sim("simple",
+                                   scheduler,
+                                   num_cores,
+                                   workload,
+                                   region.instruction_limit,
+                                   show_factories,
+                                   region.fast_forward,
+                                   true, // functional warming
+                                   region.sampling);
+                    cls.populateSimulation(&sim);
+                    cls.runSimulator(&sim);
+                    cls.postProcess(&sim);
+                    samples = sim.getSamplingDriver()->getSamples();
+                    return 0;
+                },
+                std::cout);
+            return (num_failed == 0) ? 0 : -1;
+        }
+
+        for(const auto & spec : fan_out_specs) {
+            fan_out.configs.emplace_back(olympia::ConfigFanOut::parse(spec));
+        }
+        if(fan_out.enabled()) {
+            if((roi_length == 0) || (roi_start <= fast_forward)) {
+                std::cerr << "ERROR: --fan-out needs --roi-length and a detailed warm-up to "
+                          << "share (--roi-start past --fast-forward)" << std::endl;
+                return -1;
+            }
+            if(sampling.enabled() || (false == convert_trace.empty())
+               || (false == checkpoint_save.empty())) {
+                std::cerr << "ERROR: --fan-out cannot be combined with --sampling-*, "
+                          << "--convert-trace or --save-checkpoint" << std::endl;
+                return -1;
+            }
+
+            // The ROB stops the parent at the end of the warm-up.  The
+            // region is one sampling measurement interval, so each
+            // child's samples cover exactly the region
+            const uint64_t warmup = roi_start - fast_forward;
+            ilimit = warmup;
+            sampling.period = warmup + roi_length;
+            sampling.warmup = warmup;
+            sampling.measure = roi_length;
+        }
+
         // Create the simulator
         sparta::Scheduler scheduler;
         OlympiaSim sim("simple",
@@ -103,14 +565,76 @@ int main(int argc, char **argv)
                        num_cores, // cores
                        workload,
                        ilimit,
-                       show_factories); // run for ilimit instructions
+                       show_factories,
+                       fast_forward, // run for ilimit instructions after skipping fast_forward
+                       functional_warming,
+                       sampling,
+                       checkpoint_save,
+                       checkpoint_restore,
+                       core_workloads,
+                       core_ilimits,
+                       pipeline_event_log);
 
         cls.populateSimulation(&sim);
 
+        if(false == convert_trace.empty()) {
+            auto core0 = sim.getRoot()->getChild("cpu.core0");
+            olympia::convertToDecodedTrace(olympia::getMavis(core0), workload, convert_trace,
+                                           core0->getClock(), ilimit);
+            return 0;
+        }
+
+        if(fan_out.enabled()) {
+            fan_out.check(sim.getRoot());
+            cls.runSimulator(&sim);
+
+            const std::string ilimit_path = "top.cpu.core0.rob.params.num_insts_to_retire";
+            const uint64_t region_end = ilimit + roi_length;
+            const uint32_t num_failed = fan_out.run(
+                [&](const olympia::ConfigFanOut::Config & config, olympia::SampleSet & samples) {
+                    for(const auto & override_param : config.overrides) {
+                        olympia::applyRuntimeOverride(sim.getRoot(), override_param);
+                    }
+                    olympia::applyRuntimeOverride(sim.getRoot(),
+                                                  {ilimit_path, std::to_string(region_end)});
+                    sim.run(sparta::Scheduler::INDEFINITE);
+                    samples = sim.getSamplingDriver()->getSamples();
+                    return 0;
+                },
+                std::cout);
+
+            // The parent's reports cover the shared warm-up only
+            cls.postProcess(&sim);
+            return (num_failed == 0) ? 0 : -1;
+        }
+
+        std::unique_ptr<olympia::HeapAllocationCounter> heap_counter;
+        if(count_heap_allocations) {
+            heap_counter.reset(new olympia::HeapAllocationCounter(sim.getRoot()->getChild("cpu.core0"),
+                                                                  heap_count_warmup));
+        }
+
         cls.runSimulator(&sim);
 
+        if(heap_counter) {
+            heap_counter->stop();
+        }
+
+        sim.reportSampling(std::cout);
+        sim.reportCores(std::cout);
+
         cls.postProcess(&sim);
 
+        if(heap_counter) {
+            heap_counter->report(std::cout);
+            if((vm.count("fail-on-heap-allocations") != 0)
+               && (heap_counter->getSteadyStateAllocations() != 0)) {
+                std::cerr << "ERROR: " << heap_counter->getSteadyStateAllocations()
+                          << " heap allocations after the warm-up" << std::endl;
+                return -1;
+            }
+        }
+
     }catch(...){
         // Could still handle or log the exception here
         throw;
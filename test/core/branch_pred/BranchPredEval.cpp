@@ -0,0 +1,340 @@
+// <BranchPredEval.cpp> -*- C++ -*-
+
+//!
+//! \file BranchPredEval.cpp
+//! \brief BranchPredEval: stream the branches of an STF trace through one
+//!        or more branch predictors and report MPKI and the worst PCs,
+//!        without the timing model
+//!
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "BranchPred.hpp"
+
+#include "sparta/utils/SpartaException.hpp"
+#include "sparta/utils/LexicalCast.hpp"
+#include "stf-inc/stf_inst_reader.hpp"
+
+namespace
+{
+    const char USAGE[] =
+        "Usage: BranchPredEval [-i INSTS] [--top N] [-c PREDICTOR[:KEY=VALUE,...]]... TRACE\n"
+        "  -c may be repeated; every predictor sees the same pass over the trace.\n"
+        "  PREDICTOR is simple, bimodal, gshare or tage_sc_l (default: all but simple)\n"
+        "  KEY is pht_bits, btb_bits, history_bits, tage_num_tables, tage_table_bits,\n"
+        "  tage_tag_bits, tage_min_history, tage_max_history, sc_table_bits, loop_set_bits,\n"
+        "  ras_entries, ittage_num_tables or ittage_table_bits\n"
+        "  e.g. -c gshare:pht_bits=14,history_bits=14 -c tage_sc_l:tage_table_bits=11\n";
+
+    using olympia::BranchPredictor::PredictorConfig;
+
+    //! Set one PredictorConfig field by name
+    void setConfigValue(PredictorConfig & config, const std::string & key, const uint32_t value)
+    {
+        static const std::pair<const char*, uint32_t PredictorConfig::*> FIELDS[] = {
+            {"pht_bits", &PredictorConfig::pht_bits},
+            {"btb_bits", &PredictorConfig::btb_bits},
+            {"history_bits", &PredictorConfig::history_bits},
+            {"tage_num_tables", &PredictorConfig::tage_num_tables},
+            {"tage_table_bits", &PredictorConfig::tage_table_bits},
+            {"tage_tag_bits", &PredictorConfig::tage_tag_bits},
+            {"tage_min_history", &PredictorConfig::tage_min_history},
+            {"tage_max_history", &PredictorConfig::tage_max_history},
+            {"sc_table_bits", &PredictorConfig::sc_table_bits},
+            {"loop_set_bits", &PredictorConfig::loop_set_bits},
+            {"ras_entries", &PredictorConfig::ras_entries},
+            {"ittage_num_tables", &PredictorConfig::ittage_num_tables},
+            {"ittage_table_bits", &PredictorConfig::ittage_table_bits}};
+        for (const auto & field : FIELDS)
+        {
+            if (key == field.first)
+            {
+                config.*(field.second) = value;
+                return;
+            }
+        }
+        throw sparta::SpartaException("Unknown predictor parameter '") << key << "'";
+    }
+
+    //! A predictor under evaluation and its counts
+    struct Candidate
+    {
+        std::string label;
+        std::unique_ptr<olympia::BranchPredictor::FetchBranchPredictorIF> predictor;
+        uint64_t direction_mispredictions = 0;
+        uint64_t target_mispredictions = 0;
+        // Indexed like Evaluator::pcs_
+        std::vector<uint64_t> pc_mispredictions;
+    };
+
+    //! Build a predictor from "name[:key=value,...]"
+    Candidate createCandidate(const std::string & spec)
+    {
+        const auto colon = spec.find(':');
+        const std::string name = spec.substr(0, colon);
+        PredictorConfig config;
+        if (colon != std::string::npos)
+        {
+            std::stringstream options(spec.substr(colon + 1));
+            std::string option;
+            while (std::getline(options, option, ','))
+            {
+                const auto equals = option.find('=');
+                if (equals == std::string::npos)
+                {
+                    throw sparta::SpartaException("Expected KEY=VALUE, got '") << option << "'";
+                }
+                setConfigValue(config, option.substr(0, equals),
+                               sparta::utils::smartLexicalCast<uint32_t>(option.substr(equals + 1)));
+            }
+        }
+
+        Candidate candidate;
+        candidate.label = spec;
+        candidate.predictor = olympia::BranchPredictor::createBranchPredictor(name, config);
+        if (nullptr == candidate.predictor)
+        {
+            throw sparta::SpartaException("Nothing to evaluate for predictor '") << name << "'";
+        }
+        return candidate;
+    }
+
+    class Evaluator
+    {
+    public:
+        explicit Evaluator(std::vector<Candidate> && candidates) :
+            candidates_(std::move(candidates))
+        {}
+
+        void run(const std::string & trace, const uint64_t max_insts)
+        {
+            if (false == std::ifstream(trace).good())
+            {
+                throw sparta::SpartaException("ERROR: Issues opening ") << trace;
+            }
+            constexpr bool SKIP_NONUSER_MODE = false;
+            constexpr bool CHECK_FOR_STF_PTE = false;
+            constexpr bool FILTER_MODE_CHANGE_EVENTS = true;
+            constexpr size_t BUFFER_SIZE = 4096;
+            stf::STFInstReader reader(trace, SKIP_NONUSER_MODE, CHECK_FOR_STF_PTE,
+                                      FILTER_MODE_CHANGE_EVENTS, BUFFER_SIZE);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (auto it = reader.begin(); (it != reader.end()) && (insts_ < max_insts); ++it)
+            {
+                ++insts_;
+                if (false == it->isBranch())
+                {
+                    continue;
+                }
+
+                olympia::BranchPredictor::BranchUpdate update;
+                update.branch = olympia::BranchPredictor::decodeBranch(it->pc(), it->opcode());
+                update.taken = it->isTakenBranch();
+                update.target = it->branchTarget();
+                evaluate_(update);
+            }
+            seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        void report(std::ostream & os, const uint32_t top) const
+        {
+            const double kilo_insts = std::max(insts_, uint64_t(1)) / 1000.0;
+            os << "Instructions: " << insts_ << "  branches: " << branches_
+               << " (conditional: " << conditional_branches_ << ", static: " << pcs_.size() << ")\n"
+               << "Pass: " << std::fixed << std::setprecision(2) << seconds_ << " s, "
+               << (branches_ / std::max(seconds_, 1e-9) / 1e6) << "M branches/s for "
+               << candidates_.size() << " predictor(s)\n\n";
+
+            os << std::left << std::setw(48) << "predictor" << std::right << std::setw(14)
+               << "mispredicts" << std::setw(12) << "direction" << std::setw(12) << "target"
+               << std::setw(10) << "MPKI" << std::setw(10) << "rate %" << '\n';
+            for (const auto & candidate : candidates_)
+            {
+                const uint64_t mispredictions =
+                    candidate.direction_mispredictions + candidate.target_mispredictions;
+                os << std::left << std::setw(48) << candidate.label << std::right << std::setw(14)
+                   << mispredictions << std::setw(12) << candidate.direction_mispredictions
+                   << std::setw(12) << candidate.target_mispredictions << std::setw(10)
+                   << std::setprecision(3) << (mispredictions / kilo_insts) << std::setw(10)
+                   << std::setprecision(2)
+                   << (100.0 * mispredictions / std::max(branches_, uint64_t(1))) << '\n';
+            }
+
+            if (top == 0)
+            {
+                return;
+            }
+            std::vector<uint64_t> pcs_by_slot(pcs_.size());
+            for (const auto & pc : pcs_)
+            {
+                pcs_by_slot[pc.second] = pc.first;
+            }
+            for (const auto & candidate : candidates_)
+            {
+                std::vector<uint32_t> slots(pcs_.size());
+                for (uint32_t slot = 0; slot < slots.size(); ++slot)
+                {
+                    slots[slot] = slot;
+                }
+                const size_t shown = std::min<size_t>(top, slots.size());
+                std::partial_sort(slots.begin(), slots.begin() + shown, slots.end(),
+                                  [&candidate](const uint32_t a, const uint32_t b) {
+                                      return candidate.pc_mispredictions[a]
+                                             > candidate.pc_mispredictions[b];
+                                  });
+
+                os << "\nWorst PCs: " << candidate.label << '\n' << std::setw(18) << "pc"
+                   << std::setw(14) << "executions" << std::setw(10) << "taken %"
+                   << std::setw(14) << "mispredicts" << std::setw(10) << "rate %"
+                   << std::setw(10) << "share %" << '\n';
+                const uint64_t total = std::max<uint64_t>(
+                    candidate.direction_mispredictions + candidate.target_mispredictions, 1);
+                for (size_t i = 0; i < shown; ++i)
+                {
+                    const uint32_t slot = slots[i];
+                    const uint64_t mispredictions = candidate.pc_mispredictions[slot];
+                    if (mispredictions == 0)
+                    {
+                        break;
+                    }
+                    os << std::setw(8) << "0x" << std::hex << std::setw(10) << std::setfill('0')
+                       << pcs_by_slot[slot] << std::setfill(' ') << std::dec << std::setw(14)
+                       << executions_[slot] << std::setw(10)
+                       << (100.0 * taken_[slot] / executions_[slot]) << std::setw(14)
+                       << mispredictions << std::setw(10)
+                       << (100.0 * mispredictions / executions_[slot]) << std::setw(10)
+                       << (100.0 * mispredictions / total) << '\n';
+                }
+            }
+        }
+
+    private:
+        void evaluate_(const olympia::BranchPredictor::BranchUpdate & update)
+        {
+            ++branches_;
+            conditional_branches_ += update.branch.is_conditional ? 1 : 0;
+
+            // One lookup per branch; every per-PC count is a vector slot
+            const auto pc = pcs_.emplace(update.branch.pc, static_cast<uint32_t>(pcs_.size()));
+            const uint32_t slot = pc.first->second;
+            if (pc.second)
+            {
+                executions_.push_back(0);
+                taken_.push_back(0);
+                for (auto & candidate : candidates_)
+                {
+                    candidate.pc_mispredictions.push_back(0);
+                }
+            }
+            ++executions_[slot];
+            taken_[slot] += update.taken ? 1 : 0;
+
+            for (auto & candidate : candidates_)
+            {
+                const auto prediction = candidate.predictor->getPrediction(update.branch);
+                candidate.predictor->updatePredictor(update);
+                if (prediction.taken != update.taken)
+                {
+                    ++candidate.direction_mispredictions;
+                    ++candidate.pc_mispredictions[slot];
+                }
+                else if (update.taken && (prediction.target != update.target))
+                {
+                    ++candidate.target_mispredictions;
+                    ++candidate.pc_mispredictions[slot];
+                }
+            }
+        }
+
+        std::vector<Candidate> candidates_;
+
+        uint64_t insts_ = 0;
+        uint64_t branches_ = 0;
+        uint64_t conditional_branches_ = 0;
+        double seconds_ = 0;
+
+        // Branch PC -> slot in the per-PC vectors
+        std::unordered_map<uint64_t, uint32_t> pcs_;
+        std::vector<uint64_t> executions_;
+        std::vector<uint64_t> taken_;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> specs;
+    uint64_t max_insts = std::numeric_limits<uint64_t>::max();
+    uint32_t top = 10;
+    std::string trace;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = ((i + 1) < argc);
+        if ((arg == "-h") || (arg == "--help"))
+        {
+            std::cout << USAGE;
+            return 0;
+        }
+        else if ((arg == "-c") && has_value)
+        {
+            specs.emplace_back(argv[++i]);
+        }
+        else if ((arg == "-i") && has_value)
+        {
+            max_insts = sparta::utils::smartLexicalCast<uint64_t>(argv[++i]);
+        }
+        else if ((arg == "--top") && has_value)
+        {
+            top = sparta::utils::smartLexicalCast<uint32_t>(argv[++i]);
+        }
+        else if (trace.empty() && (arg.rfind("-", 0) != 0))
+        {
+            trace = arg;
+        }
+        else
+        {
+            std::cerr << "ERROR: Unexpected argument '" << arg << "'\n" << USAGE;
+            return 1;
+        }
+    }
+    if (trace.empty())
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+    if (specs.empty())
+    {
+        specs = {"bimodal", "gshare", "tage_sc_l"};
+    }
+
+    try
+    {
+        std::vector<Candidate> candidates;
+        for (const auto & spec : specs)
+        {
+            candidates.emplace_back(createCandidate(spec));
+        }
+        Evaluator evaluator(std::move(candidates));
+        evaluator.run(trace, max_insts);
+        evaluator.report(std::cout, top);
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "OlympiaSim.hpp"
+
+#include "sparta/app/CommandLineSimulator.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <string>
+
+TEST_INIT
+
+// Runs branch_pattern.json through a full core and checks the flushes
+// the fetch branch predictor causes.  Every instruction of a JSON
+// workload is at PC 0, so all seven branches share one bimodal
+// counter, which starts weakly not taken:
+//
+//   outcome   T  T  T  N  N  N  T
+//   counter   1  2  3  3  2  1  0
+//   predicted N  T  T  T  T  N  N
+//
+// which is 4 direction mispredictions, each flushing the pipeline
+// when the branch retires.
+
+const char USAGE[] = "Usage:\n"
+                     "    BranchPredFlush_test --workload <branch_pattern.json>\n"
+                     "\n";
+
+sparta::app::DefaultValues DEFAULTS;
+
+uint64_t getCounter(sparta::RootTreeNode* root_node, const std::string & name)
+{
+    return root_node->getChildAs<sparta::CounterBase>("cpu.core0.rob.stats." + name)->get();
+}
+
+void runTest(int argc, char** argv)
+{
+    DEFAULTS.auto_summary_default = "off";
+    std::string workload;
+
+    sparta::app::CommandLineSimulator cls(USAGE, DEFAULTS);
+    auto & app_opts = cls.getApplicationOptions();
+    app_opts.add_options()(
+        "workload", sparta::app::named_value<std::string>("WORKLOAD", &workload),
+        "JSON workload of the branch pattern");
+
+    int err_code = 0;
+    if (!cls.parse(argc, argv, err_code))
+    {
+        sparta_assert(false, "Command line parsing failed"); // Any errors already printed to cerr
+    }
+
+    sparta::Scheduler scheduler;
+    OlympiaSim sim("simple", scheduler, 1, workload);
+    cls.populateSimulation(&sim);
+    sparta::RootTreeNode* root_node = sim.getRoot();
+    const std::string predictor =
+        root_node->getChildAs<sparta::ParameterBase>("cpu.core0.fetch.params.branch_predictor")
+            ->getValueAsString();
+
+    cls.runSimulator(&sim);
+
+    const uint64_t expected_mispredictions = (predictor == "bimodal") ? 4 : 0;
+    EXPECT_EQUAL(getCounter(root_node, "total_number_retired"), 14);
+    EXPECT_EQUAL(getCounter(root_node, "total_branches_retired"), 7);
+    EXPECT_EQUAL(getCounter(root_node, "direction_mispredictions"), expected_mispredictions);
+    EXPECT_EQUAL(getCounter(root_node, "target_mispredictions"), 0);
+    EXPECT_EQUAL(getCounter(root_node, "total_number_of_flushes"), expected_mispredictions);
+}
+
+int main(int argc, char** argv)
+{
+    runTest(argc, argv);
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}
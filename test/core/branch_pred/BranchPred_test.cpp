@@ -1,6 +1,11 @@
 #include "SimpleBranchPred.hpp"
+#include "BranchPred.hpp"
+#include "TageScL.hpp"
+#include "TargetPred.hpp"
 #include "sparta/utils/SpartaTester.hpp"
 
+#include <sstream>
+
 TEST_INIT
 
 void runTest(int argc, char **argv)
@@ -34,9 +39,370 @@ void runTest(int argc, char **argv)
             
 }
 
+// Train a predictor on a loop branch taken trip_count - 1 times, then
+// not taken, and count its mispredictions over the last pass
+uint32_t runLoop(olympia::BranchPredictor::FetchBranchPredictorIF & predictor,
+                 uint32_t trip_count = 8)
+{
+   olympia::BranchPredictor::BranchUpdate loop;
+   loop.branch.pc = 0x1000;
+   loop.branch.is_conditional = true;
+   loop.target = 0xf00;
+
+   uint32_t mispredictions = 0;
+   for (uint32_t pass = 0; pass < 50; ++pass) {
+      mispredictions = 0;
+      for (uint32_t iter = 0; iter < trip_count; ++iter) {
+         loop.taken = (iter != (trip_count - 1));
+         const auto prediction = predictor.getPrediction(loop.branch);
+         if ((prediction.taken != loop.taken) ||
+             (loop.taken && (prediction.target != loop.target))) {
+            ++mispredictions;
+         }
+         predictor.updatePredictor(loop);
+      }
+   }
+   return mispredictions;
+}
+
+void runFetchPredictorTest()
+{
+   olympia::BranchPredictor::PredictorConfig config;
+
+   // No predictor: perfect prediction
+   EXPECT_TRUE(olympia::BranchPredictor::createBranchPredictor("perfect", config) == nullptr);
+   EXPECT_THROW(olympia::BranchPredictor::createBranchPredictor("oracle", config));
+
+   // A per-PC counter misses the loop exit
+   auto bimodal = olympia::BranchPredictor::createBranchPredictor("bimodal", config);
+   EXPECT_EQUAL(runLoop(*bimodal), 1u);
+
+   // Global history covers the whole loop
+   auto gshare = olympia::BranchPredictor::createBranchPredictor("gshare", config);
+   EXPECT_EQUAL(runLoop(*gshare), 0u);
+
+   // Unconditional branches are taken; their targets come from the BTB
+   olympia::BranchPredictor::BranchUpdate jump;
+   jump.branch.pc = 0x2000;
+   jump.taken = true;
+   jump.target = 0x3000;
+   auto prediction = gshare->getPrediction(jump.branch);
+   EXPECT_TRUE(prediction.taken);
+   EXPECT_EQUAL(prediction.target, 0);
+   gshare->updatePredictor(jump);
+   prediction = gshare->getPrediction(jump.branch);
+   EXPECT_EQUAL(prediction.target, 0x3000);
+
+   // TAGE-SC-L learns the short loop, and its loop predictor a trip
+   // count longer than the longest history
+   auto tage = olympia::BranchPredictor::createBranchPredictor("tage_sc_l", config);
+   EXPECT_EQUAL(runLoop(*tage), 0u);
+   olympia::BranchPredictor::TageScLBranchPredictor long_loop(config);
+   EXPECT_EQUAL(runLoop(long_loop, 1000), 0u);
+
+   // Geometric history lengths, up to the configured maximum
+   const auto & lengths = long_loop.getHistoryLengths();
+   EXPECT_EQUAL(lengths.size(), config.tage_num_tables);
+   EXPECT_EQUAL(lengths.front(), config.tage_min_history);
+   EXPECT_EQUAL(lengths.back(), config.tage_max_history);
+   for (uint32_t t = 1; t < lengths.size(); ++t) {
+      EXPECT_TRUE(lengths[t] > lengths[t - 1]);
+   }
+
+   // Capacity follows the configured table sizes
+   olympia::BranchPredictor::PredictorConfig small_config = config;
+   small_config.tage_table_bits = config.tage_table_bits - 2;
+   olympia::BranchPredictor::TageScLBranchPredictor small(small_config);
+   EXPECT_TRUE(small.getStorageBits() < long_loop.getStorageBits());
+
+   config.tage_num_tables = olympia::BranchPredictor::TageScLBranchPredictor::MAX_TABLES + 1;
+   EXPECT_THROW(olympia::BranchPredictor::TageScLBranchPredictor{config});
+}
+
+void runTargetPredictorTest()
+{
+   using namespace olympia::BranchPredictor;
+   PredictorConfig config;
+
+   // The RAS wraps around, and a checkpoint undoes wrong-path pops,
+   // or a pop and a push
+   ReturnAddressStack ras(4);
+   for (uint64_t addr = 1; addr <= 5; ++addr) {
+      ras.push(addr * 0x10);
+   }
+   const auto checkpoint = ras.checkpoint();
+   EXPECT_EQUAL(ras.pop(), 0x50);
+   EXPECT_EQUAL(ras.pop(), 0x40);
+   ras.restore(checkpoint);
+   EXPECT_EQUAL(ras.pop(), 0x50);
+   ras.push(0x999);
+   ras.restore(checkpoint);
+   EXPECT_EQUAL(ras.pop(), 0x50);
+   EXPECT_EQUAL(ras.pop(), 0x40);
+   EXPECT_EQUAL(ras.pop(), 0x30);
+   EXPECT_EQUAL(ras.pop(), 0x20); // 0x10 was overwritten
+   EXPECT_THROW(ReturnAddressStack{6});
+
+   // One function called from two places: the BTB keeps one return
+   // target, the RAS predicts both
+   auto run_calls = [](FetchBranchPredictorIF & predictor) {
+      uint32_t mispredictions = 0;
+      for (uint32_t i = 0; i < 100; ++i) {
+         BranchUpdate call;
+         call.branch.pc = (i % 2) ? 0x1000 : 0x2000;
+         call.branch.is_call = true;
+         call.taken = true;
+         call.target = 0x8000;
+         predictor.getPrediction(call.branch);
+         predictor.updatePredictor(call);
+
+         BranchUpdate ret;
+         ret.branch.pc = 0x8040;
+         ret.branch.is_return = true;
+         ret.branch.is_indirect = true;
+         ret.taken = true;
+         ret.target = call.branch.pc + 4;
+         if (predictor.getPrediction(ret.branch).target != ret.target) {
+            ++mispredictions;
+         }
+         predictor.updatePredictor(ret);
+      }
+      return mispredictions;
+   };
+   PredictorConfig no_ras = config;
+   no_ras.ras_entries = 0;
+   no_ras.ittage_num_tables = 0;
+   EXPECT_EQUAL(run_calls(*createBranchPredictor("gshare", no_ras)), 100u);
+   EXPECT_EQUAL(run_calls(*createBranchPredictor("gshare", config)), 0u);
+
+   // Wrong-path predictions are undone when the branch before them
+   // resolves mispredicted, with older predictions still pending
+   // ahead of it.  Every call returns somewhere else, so a wrong
+   // repair pops the wrong address
+   TargetPredictor predictor(std::make_unique<GShareBranchPredictor>(config), config);
+   auto make_call = [](uint64_t pc) {
+      BranchUpdate call;
+      call.branch.pc = pc;
+      call.branch.is_call = true;
+      call.taken = true;
+      call.target = 0x4000;
+      return call;
+   };
+   auto make_ret = [](uint64_t pc, uint64_t target) {
+      BranchUpdate ret;
+      ret.branch.pc = pc;
+      ret.branch.is_return = true;
+      ret.branch.is_indirect = true;
+      ret.taken = true;
+      ret.target = target;
+      return ret;
+   };
+   // Pops a return and checks its predicted target
+   auto expect_ret = [&predictor, &make_ret](uint64_t target) {
+      const BranchUpdate ret = make_ret(0x4280, target);
+      const uint64_t predicted = predictor.getPrediction(ret.branch).target;
+      EXPECT_EQUAL(predicted, target);
+      predictor.updatePredictor(ret);
+   };
+   const BranchUpdate call_a = make_call(0x1000);
+   const BranchUpdate call_b = make_call(0x1300);
+   for (const auto & call : {call_a, call_b}) { // Trains the BTB
+      predictor.getPrediction(call.branch);
+      predictor.updatePredictor(call);
+   }
+   predictor.getPrediction(call_a.branch);
+   predictor.getPrediction(call_b.branch);
+   BranchUpdate cond;
+   cond.branch.pc = 0x4100;
+   cond.branch.is_conditional = true;
+   cond.taken = true;
+   cond.target = 0x4200;
+   predictor.getPrediction(cond.branch); // No BTB target: mispredicted
+   const BranchUpdate wrong_ret = make_ret(0x4180, 0);
+   EXPECT_EQUAL(predictor.getPrediction(wrong_ret.branch).target, 0x1304); // Wrong path
+   predictor.getPrediction(make_call(0x4190).branch); // Overwrites 0x1304
+   predictor.updatePredictor(call_a);
+   predictor.updatePredictor(call_b);
+   predictor.updatePredictor(cond);
+   expect_ret(0x1304);
+   expect_ret(0x1004);
+   expect_ret(0x1304); // Pushed while training
+   expect_ret(0x1004);
+
+   // A mispredicted call behind a pending call: its own push is
+   // done again after the wrong path is undone
+   const BranchUpdate call_c = make_call(0x1600);
+   predictor.getPrediction(call_a.branch);
+   predictor.getPrediction(call_c.branch); // No BTB target: mispredicted
+   EXPECT_EQUAL(predictor.getPrediction(make_ret(0x4180, 0).branch).target, 0x1604);
+   EXPECT_EQUAL(predictor.getPrediction(make_ret(0x4184, 0).branch).target, 0x1004);
+   predictor.getPrediction(make_call(0x4190).branch);
+   predictor.updatePredictor(call_a);
+   predictor.updatePredictor(call_c);
+   expect_ret(0x1604);
+   expect_ret(0x1004);
+
+   // ITTAGE: an indirect jump whose target follows the branch before it
+   auto run_switch = [](FetchBranchPredictorIF & predictor) {
+      uint32_t mispredictions = 0;
+      for (uint32_t i = 0; i < 2000; ++i) {
+         BranchUpdate cond;
+         cond.branch.pc = 0x3000;
+         cond.branch.is_conditional = true;
+         cond.taken = (i % 3) == 0;
+         cond.target = 0x3100;
+         predictor.getPrediction(cond.branch);
+         predictor.updatePredictor(cond);
+
+         BranchUpdate jump;
+         jump.branch.pc = 0x3200;
+         jump.branch.is_indirect = true;
+         jump.taken = true;
+         jump.target = cond.taken ? 0x5000 : 0x6000;
+         if ((i >= 1000) && (predictor.getPrediction(jump.branch).target != jump.target)) {
+            ++mispredictions;
+         } else if (i < 1000) {
+            predictor.getPrediction(jump.branch);
+         }
+         predictor.updatePredictor(jump);
+      }
+      return mispredictions;
+   };
+   EXPECT_TRUE(run_switch(*createBranchPredictor("tage_sc_l", no_ras)) > 100u);
+   EXPECT_EQUAL(run_switch(*createBranchPredictor("tage_sc_l", config)), 0u);
+
+   IttagePredictor ittage(config);
+   EXPECT_EQUAL(ittage.getHistoryLengths().size(), config.ittage_num_tables);
+   EXPECT_EQUAL(ittage.getHistoryLengths().back(), 64u);
+   config.ittage_num_tables = IttagePredictor::MAX_TABLES + 1;
+   EXPECT_THROW(IttagePredictor{config});
+}
+
+void runWarmingTest()
+{
+   using namespace olympia::BranchPredictor;
+   PredictorConfig config;
+
+   // Skipped branches are classified from their encodings
+   const BranchInput call = decodeBranch(0x1000, 0x008000ef); // jal ra, 8
+   EXPECT_FALSE(call.is_conditional);
+   EXPECT_TRUE(call.is_call);
+   EXPECT_FALSE(call.is_indirect);
+   EXPECT_EQUAL(call.inst_size, 4u);
+   const BranchInput ret = decodeBranch(0x1000, 0x00008067); // ret
+   EXPECT_TRUE(ret.is_return);
+   EXPECT_TRUE(ret.is_indirect);
+   EXPECT_FALSE(ret.is_call);
+   const BranchInput c_ret = decodeBranch(0x1000, 0x8082); // c.jr ra
+   EXPECT_TRUE(c_ret.is_return);
+   EXPECT_EQUAL(c_ret.inst_size, 2u);
+   const BranchInput c_call = decodeBranch(0x1000, 0x9782); // c.jalr a5
+   EXPECT_TRUE(c_call.is_call);
+   EXPECT_FALSE(c_call.is_return);
+   EXPECT_FALSE(decodeBranch(0x1000, 0xa001).is_conditional); // c.j
+   EXPECT_TRUE(decodeBranch(0x1000, 0x00b50463).is_conditional); // beq a0, a1, 8
+   EXPECT_TRUE(decodeBranch(0x1000, 0xc119).is_conditional); // c.beqz a0, 6
+
+   // A checkpoint carries the tables over to a fresh predictor
+   TargetPredictor trained(std::make_unique<GShareBranchPredictor>(config), config);
+   EXPECT_EQUAL(runLoop(trained), 0u);
+   BranchUpdate jump;
+   jump.branch.pc = 0x2000;
+   jump.taken = true;
+   jump.target = 0x3000;
+   trained.getPrediction(jump.branch);
+   trained.updatePredictor(jump);
+   EXPECT_TRUE(trained.getBTBCoverage() > 0.0);
+   std::stringstream state;
+   trained.saveCheckpoint(state);
+
+   TargetPredictor restored(std::make_unique<GShareBranchPredictor>(config), config);
+   EXPECT_EQUAL(restored.getPrediction(jump.branch).target, 0);
+   restored.updatePredictor(jump);
+   restored.restoreCheckpoint(state);
+   EXPECT_EQUAL(restored.getBTBCoverage(), trained.getBTBCoverage());
+   EXPECT_EQUAL(restored.getPrediction(jump.branch).target, 0x3000);
+   restored.updatePredictor(jump);
+
+   // Tables of another size do not fit
+   PredictorConfig small_config = config;
+   small_config.btb_bits = config.btb_bits - 1;
+   TargetPredictor small(std::make_unique<GShareBranchPredictor>(small_config), small_config);
+   state.clear();
+   state.seekg(0);
+   EXPECT_THROW(small.restoreCheckpoint(state));
+}
+
+void runTageCheckpointTest()
+{
+   using namespace olympia::BranchPredictor;
+   PredictorConfig config;
+
+   // A restored TAGE-SC-L predicts exactly as the one it was saved
+   // from: its tagged tables, loop predictor, SC and histories all
+   // carry over
+   auto trained = createBranchPredictor("tage_sc_l", config);
+   EXPECT_EQUAL(runLoop(*trained, 1000), 0u);
+   std::stringstream state;
+   dynamic_cast<PredictorStateIF &>(*trained).saveCheckpoint(state);
+
+   auto restored = createBranchPredictor("tage_sc_l", config);
+   dynamic_cast<PredictorStateIF &>(*restored).restoreCheckpoint(state);
+   uint32_t differences = 0;
+   for (uint32_t i = 0; i < 5000; ++i) {
+      BranchUpdate branch;
+      branch.branch.pc = 0x1000 + ((i % 7) * 0x40);
+      branch.branch.is_conditional = true;
+      branch.taken = ((i % 3) == 0) || ((i % 7) == 2);
+      branch.target = branch.branch.pc + 0x100;
+      const auto expected = trained->getPrediction(branch.branch);
+      const auto prediction = restored->getPrediction(branch.branch);
+      if ((prediction.taken != expected.taken) || (prediction.target != expected.target)) {
+         ++differences;
+      }
+      trained->updatePredictor(branch);
+      restored->updatePredictor(branch);
+   }
+   EXPECT_EQUAL(differences, 0u);
+
+   // The loop exit is predicted from the first pass after the restore
+   TageScLBranchPredictor long_loop(config);
+   EXPECT_EQUAL(runLoop(long_loop, 1000), 0u);
+   state.str("");
+   state.clear();
+   long_loop.saveCheckpoint(state);
+   TageScLBranchPredictor cold(config);
+   cold.restoreCheckpoint(state);
+   BranchUpdate loop;
+   loop.branch.pc = 0x1000;
+   loop.branch.is_conditional = true;
+   loop.target = 0xf00;
+   uint32_t mispredictions = 0;
+   for (uint32_t iter = 0; iter < 1000; ++iter) {
+      loop.taken = (iter != 999);
+      if (cold.getPrediction(loop.branch).taken != loop.taken) {
+         ++mispredictions;
+      }
+      cold.updatePredictor(loop);
+   }
+   EXPECT_EQUAL(mispredictions, 0u);
+
+   // Other history lengths do not fit
+   PredictorConfig short_config = config;
+   short_config.tage_max_history = config.tage_max_history / 2;
+   TageScLBranchPredictor short_history(short_config);
+   state.clear();
+   state.seekg(0);
+   EXPECT_THROW(short_history.restoreCheckpoint(state));
+}
+
 int main(int argc, char **argv)
 {
     runTest(argc, argv);
+    runFetchPredictorTest();
+    runTargetPredictorTest();
+    runWarmingTest();
+    runTageCheckpointTest();
 
     REPORT_ERROR;
     return (int)ERROR_CODE;
@@ -38,7 +38,7 @@ namespace core_test
 
             // If num_pipelines == 1, only check pipeline 0 credits
             // Otherwise, check pipeline 0 and pipeline 1
-            while(dut_credits_ > 0)
+            while((dut_credits_ > 0) && (inst_groups->size() < olympia::InstGroup::MAX_WIDTH))
             {
                 mavis::ExtractorDirectInfo ex_info{"add", {inc_reg_num(inst_cnt_), inc_reg_num(inst_cnt_)}, {inst_cnt_}};
                 dinst = mavis_facade_->makeInstDirectly(ex_info, getClock());
@@ -56,6 +56,12 @@ namespace core_test
             info_logger_ << "Sending group: " << inst_groups;
             out_instgrp_write_.send(inst_groups);
         }
+
+        // A group holds at most InstGroup::MAX_WIDTH: send the rest
+        // next cycle
+        if (dut_credits_ > 0 && (test_type_ == "multiple")) {
+            ev_gen_insts_.schedule(1);
+        }
     }
 
 }
@@ -0,0 +1,229 @@
+// <FusionMatcherBench.cpp> -*- C++ -*-
+
+//!
+//! \file FusionMatcherBench.cpp
+//! \brief FusionMatcherBench: time fusion group matching over synthetic
+//!        decode windows with thousands of synthetic fusion groups, with
+//!        the FusionMatcher automaton and with a scan of every group
+//!
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "FusionMatcher.hpp"
+
+#include "sparta/utils/LexicalCast.hpp"
+
+namespace
+{
+    const char USAGE[] =
+        "Usage: FusionMatcherBench [-g GROUPS]... [-w WINDOWS] [-n LENGTH] [--uids UIDS]\n"
+        "  -g may be repeated (default: 256, 2048 and 16384 groups)\n"
+        "  -w decode windows to match (default 100000), -n UIDs per window (default 8)\n"
+        "  --uids distinct Mavis UIDs the groups and windows draw from (default 1024)\n"
+        "  Groups are 2 to 4 UIDs long.  Half the windows hold a group.  The scan of\n"
+        "  every group, checked against the automaton, runs on at most 1000 windows\n";
+
+    using UidList = std::vector<olympia::FusionMatcher::UidType>;
+
+    //! Distinct random groups of 2 to 4 UIDs
+    std::vector<UidList> makeGroups(const uint32_t num_groups, const uint32_t num_uids,
+                                    std::mt19937 & rng)
+    {
+        std::uniform_int_distribution<uint32_t> length(2, 4);
+        std::uniform_int_distribution<uint32_t> uid(1, num_uids);
+        std::set<UidList> groups;
+        while (groups.size() < num_groups)
+        {
+            UidList group(length(rng));
+            for (auto & u : group)
+            {
+                u = uid(rng);
+            }
+            groups.insert(group);
+        }
+        return {groups.begin(), groups.end()};
+    }
+
+    //! Random windows, half of them with a group planted at a random spot
+    std::vector<UidList> makeWindows(const std::vector<UidList> & groups, const uint32_t num_windows,
+                                     const uint32_t window_length, const uint32_t num_uids,
+                                     std::mt19937 & rng)
+    {
+        std::uniform_int_distribution<uint32_t> uid(1, num_uids);
+        std::uniform_int_distribution<size_t> group(0, groups.size() - 1);
+        std::vector<UidList> windows(num_windows, UidList(window_length));
+        for (uint32_t w = 0; w < num_windows; ++w)
+        {
+            for (auto & u : windows[w])
+            {
+                u = uid(rng);
+            }
+            const UidList & planted = groups[group(rng)];
+            if (((w & 1) == 0) && (planted.size() <= window_length))
+            {
+                const size_t start = rng() % (window_length - planted.size() + 1);
+                std::copy(planted.begin(), planted.end(), windows[w].begin() + start);
+            }
+        }
+        return windows;
+    }
+
+    //! Every group compared at every position: the cost grows with the groups
+    void scanGroups(const std::vector<UidList> & groups, const UidList & window,
+                    std::vector<olympia::FusionMatcher::Match> & matches)
+    {
+        for (uint32_t g = 0; g < groups.size(); ++g)
+        {
+            const UidList & grp = groups[g];
+            for (size_t start = 0; (start + grp.size()) <= window.size(); ++start)
+            {
+                if (std::equal(grp.begin(), grp.end(), window.begin() + start))
+                {
+                    matches.push_back({g, static_cast<uint32_t>(start)});
+                }
+            }
+        }
+    }
+
+    double secondsSince(const std::chrono::steady_clock::time_point & start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    //! Sort matches so the two matchers' outputs compare
+    void sortMatches(std::vector<olympia::FusionMatcher::Match> & matches)
+    {
+        std::sort(matches.begin(), matches.end(),
+                  [](const olympia::FusionMatcher::Match & a, const olympia::FusionMatcher::Match & b)
+                  { return (a.pattern != b.pattern) ? (a.pattern < b.pattern) : (a.start < b.start); });
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<uint32_t> group_counts;
+    uint32_t num_windows = 100000;
+    uint32_t window_length = 8;
+    uint32_t num_uids = 1024;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = ((i + 1) < argc);
+        if ((arg == "-h") || (arg == "--help"))
+        {
+            std::cout << USAGE;
+            return 0;
+        }
+        else if ((arg == "-g") && has_value)
+        {
+            group_counts.emplace_back(sparta::utils::smartLexicalCast<uint32_t>(argv[++i]));
+        }
+        else if ((arg == "-w") && has_value)
+        {
+            num_windows = sparta::utils::smartLexicalCast<uint32_t>(argv[++i]);
+        }
+        else if ((arg == "-n") && has_value)
+        {
+            window_length = sparta::utils::smartLexicalCast<uint32_t>(argv[++i]);
+        }
+        else if ((arg == "--uids") && has_value)
+        {
+            num_uids = sparta::utils::smartLexicalCast<uint32_t>(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "ERROR: Unexpected argument '" << arg << "'\n" << USAGE;
+            return 1;
+        }
+    }
+    if (group_counts.empty())
+    {
+        group_counts = {256, 2048, 16384};
+    }
+    if ((num_windows == 0) || (window_length == 0) || (num_uids < 2))
+    {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(8) << "groups" << std::right << std::setw(10) << "states"
+              << std::setw(12) << "build ms" << std::setw(16) << "windows/s" << std::setw(16)
+              << "scan windows/s" << std::setw(10) << "speedup" << std::setw(12) << "matches"
+              << '\n';
+
+    bool mismatch = false;
+    for (const uint32_t num_groups : group_counts)
+    {
+        // Enough UIDs for the groups to be distinct
+        std::mt19937 rng(num_groups);
+        const uint32_t uids = std::max(num_uids, 2 * num_groups);
+        const auto groups = makeGroups(num_groups, uids, rng);
+        const auto windows = makeWindows(groups, num_windows, window_length, uids, rng);
+
+        auto start = std::chrono::steady_clock::now();
+        olympia::FusionMatcher matcher;
+        for (const auto & group : groups)
+        {
+            matcher.addPattern(group);
+        }
+        matcher.compile();
+        const double build_seconds = secondsSince(start);
+
+        std::vector<olympia::FusionMatcher::Match> matches;
+        matches.reserve(16);
+        uint64_t num_matches = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto & window : windows)
+        {
+            matches.clear();
+            matcher.match(window, matches);
+            num_matches += matches.size();
+        }
+        const double match_seconds = secondsSince(start);
+
+        // The scan is slow with many groups: time it on fewer windows,
+        // and check it finds what the automaton does
+        const uint32_t scan_windows = std::min<uint32_t>(num_windows, 1000);
+        std::vector<olympia::FusionMatcher::Match> scanned;
+        double scan_seconds = 0;
+        for (uint32_t w = 0; w < scan_windows; ++w)
+        {
+            scanned.clear();
+            start = std::chrono::steady_clock::now();
+            scanGroups(groups, windows[w], scanned);
+            scan_seconds += secondsSince(start);
+
+            matches.clear();
+            matcher.match(windows[w], matches);
+            sortMatches(matches);
+            sortMatches(scanned);
+            const auto same = [](const olympia::FusionMatcher::Match & a,
+                                 const olympia::FusionMatcher::Match & b)
+            { return (a.pattern == b.pattern) && (a.start == b.start); };
+            if (!std::equal(matches.begin(), matches.end(), scanned.begin(), scanned.end(), same))
+            {
+                std::cerr << "ERROR: the automaton and the scan disagree on window " << w
+                          << " with " << num_groups << " groups\n";
+                mismatch = true;
+                break;
+            }
+        }
+
+        const double rate = num_windows / std::max(match_seconds, 1e-9);
+        const double scan_rate = scan_windows / std::max(scan_seconds, 1e-9);
+        std::cout << std::left << std::setw(8) << num_groups << std::right << std::setw(10)
+                  << matcher.getNumStates() << std::setw(12) << std::fixed << std::setprecision(2)
+                  << (build_seconds * 1e3) << std::setw(16) << std::setprecision(0) << rate
+                  << std::setw(16) << scan_rate << std::setw(10) << std::setprecision(1)
+                  << (rate / scan_rate) << std::setw(12) << num_matches << '\n';
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#include "FusionMatcher.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <algorithm>
+#include <vector>
+
+TEST_INIT
+
+namespace
+{
+   using olympia::FusionMatcher;
+
+   // (pattern, start) pairs, sorted
+   std::vector<std::pair<uint32_t, uint32_t>> findAll(const FusionMatcher & matcher,
+                                                      const std::vector<uint32_t> & input)
+   {
+      std::vector<FusionMatcher::Match> matches;
+      matcher.match(input, matches);
+      std::vector<std::pair<uint32_t, uint32_t>> found;
+      for (const auto & match : matches) {
+         found.emplace_back(match.pattern, match.start);
+      }
+      std::sort(found.begin(), found.end());
+      return found;
+   }
+}
+
+void runFusionMatcherTest()
+{
+   FusionMatcher matcher;
+   const uint32_t add_add = matcher.addPattern({10, 10});
+   const uint32_t lui_addi = matcher.addPattern({20, 30});
+   const uint32_t lui_addi_ld = matcher.addPattern({20, 30, 40});
+   const uint32_t addi_ld = matcher.addPattern({30, 40});
+   const uint32_t add_add_add_sub = matcher.addPattern({10, 10, 10, 50});
+   matcher.compile();
+   EXPECT_EQUAL(matcher.getNumPatterns(), 5u);
+   EXPECT_EQUAL(matcher.getPatternLength(lui_addi_ld), 3u);
+   // Root, 10, 10 10, 10 10 10, 10 10 10 50, 20, 20 30, 20 30 40, 30, 30 40
+   EXPECT_EQUAL(matcher.getNumStates(), 10u);
+
+   // Nested and overlapping groups are all found
+   using Found = std::vector<std::pair<uint32_t, uint32_t>>;
+   EXPECT_TRUE(findAll(matcher, {20, 30, 40}) ==
+               Found({{lui_addi, 0}, {lui_addi_ld, 0}, {addi_ld, 1}}));
+   EXPECT_TRUE(findAll(matcher, {10, 10, 10}) == Found({{add_add, 0}, {add_add, 1}}));
+
+   // Failure links: a partial match of the long group falls back to a
+   // shorter one
+   EXPECT_TRUE(findAll(matcher, {10, 10, 10, 10, 50, 20, 30}) ==
+               Found({{add_add, 0}, {add_add, 1}, {add_add, 2}, {lui_addi, 5},
+                      {add_add_add_sub, 1}}));
+   EXPECT_TRUE(findAll(matcher, {20, 20, 30, 60, 30, 40}) ==
+               Found({{lui_addi, 1}, {addi_ld, 4}}));
+
+   EXPECT_TRUE(findAll(matcher, {}).empty());
+   EXPECT_TRUE(findAll(matcher, {60, 70, 20, 60, 30}).empty());
+
+   // Matches are appended
+   std::vector<FusionMatcher::Match> matches;
+   matcher.match({10, 10}, matches);
+   matcher.match({10, 10}, matches);
+   EXPECT_EQUAL(matches.size(), 2u);
+
+   EXPECT_THROW(matcher.addPattern({1, 2}));
+   FusionMatcher empty;
+   EXPECT_THROW(empty.addPattern({}));
+   EXPECT_THROW(empty.match({1}, matches));
+}
+
+int main()
+{
+    runFusionMatcherTest();
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "sparta/simulation/Unit.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/events/PayloadEvent.hpp"
+#include "sparta/events/StartupEvent.hpp"
+#include "sparta/utils/SpartaSharedPointer.hpp"
+#include "sparta/utils/LogUtils.hpp"
+#include "core/MemoryAccessInfo.hpp"
+#include "OlympiaAllocators.hpp"
+
+#include <cinttypes>
+#include <vector>
+
+namespace icache_test
+{
+    // Stands in for Fetch: sends the ICache the fetch requests,
+    // prefetches and flushes of a script, and records when each
+    // request is answered
+    class FetchSourceUnit : public sparta::Unit
+    {
+      public:
+        static constexpr char name[] = "FetchSourceUnit";
+
+        class FetchSourceUnitParameters : public sparta::ParameterSet
+        {
+          public:
+            explicit FetchSourceUnitParameters(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+        };
+
+        enum class Action
+        {
+            FETCH,
+            PREFETCH,
+            FLUSH // Forget every fetch request not answered yet
+        };
+
+        struct Request
+        {
+            Action action;
+            uint64_t addr = 0;
+            olympia::MemoryAccessInfoPtr mem_info;
+            bool flushed = false;
+            bool answered = false;
+            uint64_t send_cycle = 0;
+            uint64_t resp_cycle = 0;
+        };
+
+        FetchSourceUnit(sparta::TreeNode* n, const FetchSourceUnitParameters*) :
+            sparta::Unit(n),
+            memory_access_allocator_(
+                sparta::notNull(olympia::OlympiaAllocators::getOlympiaAllocators(n))
+                    ->getMemoryAccessAllocator())
+        {
+            in_icache_resp_.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(
+                FetchSourceUnit, receiveResp_, olympia::MemoryAccessInfoPtr));
+
+            sparta::StartupEvent(n, CREATE_SPARTA_HANDLER(FetchSourceUnit, scheduleScript_));
+        }
+
+        //! Add a step to the script, before the simulation starts
+        void addRequest(const uint64_t cycle, const Action action, const uint64_t addr = 0)
+        {
+            script_.emplace_back(cycle, requests_.size());
+            requests_.push_back(Request{action, addr});
+        }
+
+        //! The script's steps, in the order they were added
+        const std::vector<Request> & getRequests() const { return requests_; }
+
+        //! Responses for fetch requests that were flushed
+        uint32_t getStaleResponses() const { return stale_responses_; }
+
+      private:
+        void scheduleScript_()
+        {
+            for (const auto & [cycle, idx] : script_)
+            {
+                ev_send_.preparePayload(idx)->schedule(cycle);
+            }
+        }
+
+        void send_(const size_t & idx)
+        {
+            Request & req = requests_[idx];
+            req.send_cycle = getClock()->currentCycle();
+            switch (req.action)
+            {
+            case Action::FETCH:
+                req.mem_info = sparta::allocate_sparta_shared_pointer<olympia::MemoryAccessInfo>(
+                    memory_access_allocator_, req.addr);
+                ILOG("Fetch request " << req.mem_info);
+                out_icache_req_.send(req.mem_info);
+                break;
+            case Action::PREFETCH:
+                ILOG("Prefetch request 0x" << std::hex << req.addr);
+                out_icache_prefetch_req_.send(
+                    sparta::allocate_sparta_shared_pointer<olympia::MemoryAccessInfo>(
+                        memory_access_allocator_, req.addr));
+                break;
+            case Action::FLUSH:
+                ILOG("Flush");
+                for (auto & pending : requests_)
+                {
+                    if ((pending.action == Action::FETCH) && (nullptr != pending.mem_info)
+                        && !pending.answered)
+                    {
+                        pending.flushed = true;
+                    }
+                }
+                break;
+            }
+        }
+
+        void receiveResp_(const olympia::MemoryAccessInfoPtr & mem_info)
+        {
+            for (auto & req : requests_)
+            {
+                if (req.mem_info == mem_info)
+                {
+                    sparta_assert(!req.answered, "Request answered twice: " << mem_info);
+                    ILOG("Response " << mem_info);
+                    req.answered = true;
+                    req.resp_cycle = getClock()->currentCycle();
+                    if (req.flushed)
+                    {
+                        ++stale_responses_;
+                    }
+                    return;
+                }
+            }
+            sparta_assert(false, "Response for a request never sent: " << mem_info);
+        }
+
+        sparta::DataInPort<olympia::MemoryAccessInfoPtr> in_icache_resp_{&unit_port_set_,
+                                                                         "in_icache_resp", 1};
+
+        sparta::DataOutPort<olympia::MemoryAccessInfoPtr> out_icache_req_{&unit_port_set_,
+                                                                          "out_icache_req"};
+        sparta::DataOutPort<olympia::MemoryAccessInfoPtr> out_icache_prefetch_req_{
+            &unit_port_set_, "out_icache_prefetch_req"};
+
+        sparta::PayloadEvent<size_t> ev_send_{&unit_event_set_, "send",
+                                              CREATE_SPARTA_HANDLER_WITH_DATA(FetchSourceUnit,
+                                                                              send_, size_t)};
+
+        olympia::MemoryAccessInfoAllocator & memory_access_allocator_;
+
+        // (cycle, index into requests_)
+        std::vector<std::pair<uint64_t, size_t>> script_;
+        std::vector<Request> requests_;
+        uint32_t stale_responses_ = 0;
+    };
+} // namespace icache_test
@@ -0,0 +1,402 @@
+#include "ICache.hpp"
+#include "Fetch.hpp"
+#include "sim/OlympiaSim.hpp"
+#include "OlympiaAllocators.hpp"
+
+#include "test/core/icache/FetchSourceUnit.hpp"
+#include "test/core/icache/L2SinkUnit.hpp"
+
+#include "sparta/app/CommandLineSimulator.hpp"
+#include "sparta/app/Simulation.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/ResourceFactory.hpp"
+#include "sparta/simulation/ResourceTreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/SpartaSharedPointer.hpp"
+
+#include <cinttypes>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_INIT
+
+//
+// Simple ICache Simulator.
+//
+// FetchSourceUnit <-> ICache <-> L2SinkUnit
+//
+class ICacheSim : public sparta::app::Simulation
+{
+  public:
+    ICacheSim(sparta::Scheduler* sched) : sparta::app::Simulation("ICacheSim", sched) {}
+
+    ~ICacheSim() { getRoot()->enterTeardown(); }
+
+  private:
+    void buildTree_() override
+    {
+        auto rtn = getRoot();
+
+        allocators_tn_.reset(new olympia::OlympiaAllocators(rtn));
+
+        tns_to_delete_.emplace_back(new sparta::ResourceTreeNode(
+            rtn, "fetch", sparta::TreeNode::GROUP_NAME_NONE, sparta::TreeNode::GROUP_IDX_NONE,
+            "fetch", &fetch_fact));
+        tns_to_delete_.emplace_back(new sparta::ResourceTreeNode(
+            rtn, "icache", sparta::TreeNode::GROUP_NAME_NONE, sparta::TreeNode::GROUP_IDX_NONE,
+            "icache", &icache_fact));
+        tns_to_delete_.emplace_back(new sparta::ResourceTreeNode(
+            rtn, "l2cache", sparta::TreeNode::GROUP_NAME_NONE, sparta::TreeNode::GROUP_IDX_NONE,
+            "l2cache", &l2cache_fact));
+    }
+
+    void configureTree_() override {}
+
+    void bindTree_() override
+    {
+        auto* root_node = getRoot();
+
+        sparta::bind(root_node->getChildAs<sparta::Port>("fetch.ports.out_icache_req"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.in_fetch_req"));
+        sparta::bind(root_node->getChildAs<sparta::Port>("fetch.ports.out_icache_prefetch_req"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.in_fetch_prefetch_req"));
+        sparta::bind(root_node->getChildAs<sparta::Port>("fetch.ports.in_icache_resp"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.out_fetch_resp"));
+
+        sparta::bind(root_node->getChildAs<sparta::Port>("l2cache.ports.in_icache_req"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.out_l2cache_req"));
+        sparta::bind(root_node->getChildAs<sparta::Port>("l2cache.ports.out_icache_resp"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.in_l2cache_resp"));
+        sparta::bind(root_node->getChildAs<sparta::Port>("l2cache.ports.out_icache_ack"),
+                     root_node->getChildAs<sparta::Port>("icache.ports.in_l2cache_ack"));
+    }
+
+    // Allocators.  Last thing to delete
+    std::unique_ptr<olympia::OlympiaAllocators> allocators_tn_;
+
+    sparta::ResourceFactory<icache_test::FetchSourceUnit,
+                            icache_test::FetchSourceUnit::FetchSourceUnitParameters>
+        fetch_fact;
+    sparta::ResourceFactory<olympia::ICache, olympia::ICache::ICacheParameterSet> icache_fact;
+    sparta::ResourceFactory<icache_test::L2SinkUnit, icache_test::L2SinkUnit::L2SinkUnitParameters>
+        l2cache_fact;
+
+    std::vector<std::unique_ptr<sparta::TreeNode>> tns_to_delete_;
+};
+
+using Action = icache_test::FetchSourceUnit::Action;
+
+class olympia::ICacheTester
+{
+  public:
+    ICacheTester(ICache & icache, icache_test::FetchSourceUnit & fetch,
+                 icache_test::L2SinkUnit & l2cache) :
+        icache_(icache),
+        fetch_(fetch),
+        l2cache_(l2cache)
+    {
+    }
+
+    // Misses, hits, and misses that merge into a line already being
+    // fetched
+    void test_hit_miss(const std::function<void()> & run)
+    {
+        fetch_.addRequest(1, Action::FETCH, 0x1000); // Miss
+        fetch_.addRequest(2, Action::FETCH, 0x1010); // Same line: merges
+        fetch_.addRequest(3, Action::FETCH, 0x2000); // Miss
+        fetch_.addRequest(50, Action::FETCH, 0x1000); // Hit
+        fetch_.addRequest(51, Action::FETCH, 0x2020); // Hit
+        run();
+
+        EXPECT_EQUAL(icache_.il1_cache_misses_.get(), 3);
+        EXPECT_EQUAL(icache_.il1_mshr_merges_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_cache_hits_.get(), 2);
+        EXPECT_EQUAL(icache_.il1_mshr_full_.get(), 0);
+        EXPECT_TRUE(l2cache_.getRequests() == std::vector<uint64_t>({0x1000, 0x2000}));
+
+        const auto & reqs = fetch_.getRequests();
+        expectAllAnswered_();
+        // The merged request is answered with the line it waited on
+        EXPECT_EQUAL(reqs[1].resp_cycle, reqs[0].resp_cycle);
+        // Hits are answered the cycle they arrive: one cycle on each port
+        EXPECT_EQUAL(reqs[3].resp_cycle - reqs[3].send_cycle, 2);
+        EXPECT_EQUAL(reqs[4].resp_cycle - reqs[4].send_cycle, 2);
+        EXPECT_TRUE(reqs[0].resp_cycle - reqs[0].send_cycle > 10);
+        expectIdle_();
+    }
+
+    // Misses that find every MSHR busy wait, in order, for one to
+    // free up (mshr_entries = 2)
+    void test_mshr_full(const std::function<void()> & run)
+    {
+        EXPECT_EQUAL(icache_.mshrs_.size(), 2);
+
+        fetch_.addRequest(1, Action::FETCH, 0x1000); // Miss
+        fetch_.addRequest(2, Action::FETCH, 0x2000); // Miss: MSHRs full
+        fetch_.addRequest(3, Action::FETCH, 0x3000); // Blocked
+        fetch_.addRequest(4, Action::FETCH, 0x1020); // Blocked behind 0x3000
+        run();
+
+        EXPECT_EQUAL(icache_.il1_mshr_full_.get(), 2);
+        // 0x3000 takes the MSHR 0x1000 frees, then 0x1020 hits on the
+        // line that came back
+        EXPECT_EQUAL(icache_.il1_cache_misses_.get(), 3);
+        EXPECT_EQUAL(icache_.il1_cache_hits_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_mshr_merges_.get(), 0);
+        EXPECT_TRUE(l2cache_.getRequests() == std::vector<uint64_t>({0x1000, 0x2000, 0x3000}));
+
+        const auto & reqs = fetch_.getRequests();
+        expectAllAnswered_();
+        EXPECT_EQUAL(reqs[3].resp_cycle, reqs[0].resp_cycle);
+        EXPECT_TRUE(reqs[2].resp_cycle > reqs[1].resp_cycle);
+        expectIdle_();
+    }
+
+    // Lines fetch stopped waiting for still come back: the responses
+    // are stale, but the lines are filled and the MSHRs freed
+    void test_flush(const std::function<void()> & run)
+    {
+        EXPECT_EQUAL(icache_.mshrs_.size(), 4);
+
+        fetch_.addRequest(1, Action::FETCH, 0x1000);
+        fetch_.addRequest(2, Action::FETCH, 0x2000);
+        fetch_.addRequest(3, Action::FLUSH);
+        fetch_.addRequest(40, Action::FETCH, 0x1000); // Hit on the stale line
+        fetch_.addRequest(41, Action::FETCH, 0x3000); // Every MSHR is free again
+        fetch_.addRequest(42, Action::FETCH, 0x4000);
+        fetch_.addRequest(43, Action::FETCH, 0x5000);
+        fetch_.addRequest(44, Action::FETCH, 0x6000);
+        run();
+
+        EXPECT_EQUAL(fetch_.getStaleResponses(), 2);
+        EXPECT_EQUAL(icache_.il1_cache_hits_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_cache_misses_.get(), 6);
+        EXPECT_EQUAL(icache_.il1_mshr_full_.get(), 0);
+        EXPECT_EQUAL(l2cache_.getRequests().size(), 6);
+        expectAllAnswered_();
+        expectIdle_();
+    }
+
+    // Prefetches are filtered when their line is in the IL1 or an
+    // MSHR, and dropped rather than take the last free MSHR
+    // (mshr_entries = 3)
+    void test_prefetch(const std::function<void()> & run)
+    {
+        EXPECT_EQUAL(icache_.mshrs_.size(), 3);
+
+        fetch_.addRequest(1, Action::PREFETCH, 0x1000); // Issued
+        fetch_.addRequest(2, Action::PREFETCH, 0x1000); // In an MSHR: filtered
+        fetch_.addRequest(3, Action::PREFETCH, 0x2000); // Issued
+        fetch_.addRequest(4, Action::PREFETCH, 0x3000); // Last free MSHR: dropped
+        fetch_.addRequest(5, Action::FETCH, 0x3000);    // Demand miss takes it
+        fetch_.addRequest(6, Action::FETCH, 0x2010);    // Prefetch in flight: late
+        fetch_.addRequest(60, Action::FETCH, 0x1000);   // Prefetched line: useful
+        fetch_.addRequest(61, Action::FETCH, 0x1030);   // Counted useful once
+        fetch_.addRequest(62, Action::PREFETCH, 0x2000); // In the IL1: filtered
+        run();
+
+        EXPECT_EQUAL(icache_.il1_prefetches_issued_.get(), 2);
+        EXPECT_EQUAL(icache_.il1_prefetches_filtered_.get(), 2);
+        EXPECT_EQUAL(icache_.il1_prefetches_dropped_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_prefetches_useful_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_prefetches_late_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_prefetches_useless_.get(), 0);
+
+        // The demand miss on the dropped prefetch's line did not wait
+        EXPECT_EQUAL(icache_.il1_mshr_full_.get(), 0);
+        EXPECT_EQUAL(icache_.il1_cache_misses_.get(), 2);
+        EXPECT_EQUAL(icache_.il1_mshr_merges_.get(), 1);
+        EXPECT_EQUAL(icache_.il1_cache_hits_.get(), 2);
+        EXPECT_TRUE(l2cache_.getRequests() == std::vector<uint64_t>({0x1000, 0x2000, 0x3000}));
+        expectAllAnswered_();
+        expectIdle_();
+    }
+
+    // Each prefetch Fetch sends is issued, filtered or dropped once.
+    // The simulation stops at its instruction limit, so the last few
+    // may still be on the port
+    static void test_prefetches_accounted(ICache & icache, uint64_t prefetches_sent)
+    {
+        const uint64_t received = icache.il1_prefetches_issued_.get()
+                                  + icache.il1_prefetches_filtered_.get()
+                                  + icache.il1_prefetches_dropped_.get();
+        EXPECT_TRUE(received <= prefetches_sent);
+        EXPECT_EQUAL(received == 0, prefetches_sent == 0);
+    }
+
+  private:
+    void expectAllAnswered_()
+    {
+        for (const auto & req : fetch_.getRequests())
+        {
+            if (req.action == Action::FETCH)
+            {
+                EXPECT_TRUE(req.answered);
+            }
+        }
+    }
+
+    void expectIdle_()
+    {
+        EXPECT_TRUE(icache_.blocked_requests_.empty());
+        for (const auto & mshr : icache_.mshrs_)
+        {
+            EXPECT_FALSE(mshr.valid);
+        }
+    }
+
+    ICache & icache_;
+    icache_test::FetchSourceUnit & fetch_;
+    icache_test::L2SinkUnit & l2cache_;
+};
+
+class olympia::FetchTester
+{
+  public:
+    // A response for a fetch block that is no longer in the FTQ
+    // changes nothing
+    void test_stale_response(Fetch & fetch)
+    {
+        std::vector<bool> ready;
+        for (const auto & block : fetch.fetch_target_queue_)
+        {
+            ready.emplace_back(block.ready);
+        }
+
+        fetch.receiveICacheResp_(sparta::allocate_sparta_shared_pointer<MemoryAccessInfo>(
+            fetch.memory_access_allocator_, 0x1000));
+
+        EXPECT_EQUAL(fetch.fetch_target_queue_.size(), ready.size());
+        for (size_t i = 0; i < ready.size(); ++i)
+        {
+            EXPECT_EQUAL(fetch.fetch_target_queue_[i].ready, ready[i]);
+        }
+    }
+
+    // Fetch prefetches the lines of blocks past the ones being
+    // looked up, and only with a lookahead
+    void test_prefetches(Fetch & fetch, ICache & icache)
+    {
+        if (fetch.fdip_lookahead_ == 0)
+        {
+            EXPECT_EQUAL(fetch.fdip_prefetches_.get(), 0);
+        }
+        else
+        {
+            EXPECT_TRUE(fetch.fdip_prefetches_.get() > 0);
+        }
+        ICacheTester::test_prefetches_accounted(icache, fetch.fdip_prefetches_.get());
+    }
+
+    // Every cycle decode gets nothing is charged to at most one cause
+    void test_stall_counters(Fetch & fetch)
+    {
+        EXPECT_TRUE(fetch.ftq_blocks_.get() > 0);
+        // Cold misses at least
+        EXPECT_TRUE(fetch.stall_icache_cycles_.get() > 0);
+        EXPECT_TRUE(fetch.stall_icache_cycles_.get() + fetch.stall_ftq_empty_cycles_.get()
+                        + fetch.stall_decode_full_cycles_.get()
+                    <= fetch.getClock()->currentCycle());
+    }
+};
+
+// The decoupled front end of a full core, on a trace
+void runFetchTest(sparta::app::CommandLineSimulator & cls, const std::string & workload)
+{
+    sparta::Scheduler scheduler;
+    OlympiaSim sim("simple", scheduler, 1, workload, 20000);
+    cls.populateSimulation(&sim);
+    sparta::RootTreeNode* root_node = sim.getRoot();
+
+    olympia::Fetch* fetch = root_node->getChild("cpu.core0.fetch")->getResourceAs<olympia::Fetch*>();
+    EXPECT_TRUE(fetch->fetch_from_icache_);
+    // The L2 gives the ICache credits only when fetch reads through it
+    EXPECT_TRUE(root_node
+                    ->getChildAs<sparta::ParameterBase>(
+                        "cpu.core0.l2cache.params.is_icache_connected")
+                    ->getValueAs<bool>());
+
+    olympia::FetchTester fetch_tester;
+    cls.runSimulator(&sim, 1000);
+    fetch_tester.test_stale_response(*fetch);
+    cls.runSimulator(&sim);
+    fetch_tester.test_stall_counters(*fetch);
+    fetch_tester.test_prefetches(
+        *fetch, *root_node->getChild("cpu.core0.icache")->getResourceAs<olympia::ICache*>());
+}
+
+const char USAGE[] = "Usage:\n"
+                     "    ICache_test --testcase <hit_miss|mshr_full|flush|prefetch|fetch>\n"
+                     "\n";
+
+sparta::app::DefaultValues DEFAULTS;
+
+void runTest(int argc, char** argv)
+{
+    DEFAULTS.auto_summary_default = "off";
+    std::string testcase;
+    std::string workload;
+
+    sparta::app::CommandLineSimulator cls(USAGE, DEFAULTS);
+    auto & app_opts = cls.getApplicationOptions();
+    app_opts.add_options()(
+        "testcase", sparta::app::named_value<std::string>("TESTCASE", &testcase),
+        "ICache test to run")(
+        "workload",
+        sparta::app::named_value<std::string>("WORKLOAD", &workload)->default_value(""),
+        "Trace for the fetch test");
+
+    int err_code = 0;
+    if (!cls.parse(argc, argv, err_code))
+    {
+        sparta_assert(false, "Command line parsing failed"); // Any errors already printed to cerr
+    }
+
+    if (testcase == "fetch")
+    {
+        runFetchTest(cls, workload);
+        return;
+    }
+
+    sparta::Scheduler sched;
+    ICacheSim icache_sim(&sched);
+    cls.populateSimulation(&icache_sim);
+    sparta::RootTreeNode* root_node = icache_sim.getRoot();
+
+    olympia::ICacheTester tester(
+        *root_node->getChild("icache")->getResourceAs<olympia::ICache*>(),
+        *root_node->getChild("fetch")->getResourceAs<icache_test::FetchSourceUnit*>(),
+        *root_node->getChild("l2cache")->getResourceAs<icache_test::L2SinkUnit*>());
+    const auto run = [&cls, &icache_sim]() { cls.runSimulator(&icache_sim); };
+
+    if (testcase == "hit_miss")
+    {
+        tester.test_hit_miss(run);
+    }
+    else if (testcase == "mshr_full")
+    {
+        tester.test_mshr_full(run);
+    }
+    else if (testcase == "flush")
+    {
+        tester.test_flush(run);
+    }
+    else if (testcase == "prefetch")
+    {
+        tester.test_prefetch(run);
+    }
+    else
+    {
+        sparta_assert(false, "Unknown testcase: " << testcase);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    runTest(argc, argv);
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}
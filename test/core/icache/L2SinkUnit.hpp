@@ -0,0 +1,69 @@
+#pragma once
+
+#include "sparta/simulation/Unit.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/events/StartupEvent.hpp"
+#include "sparta/utils/LogUtils.hpp"
+#include "core/MemoryAccessInfo.hpp"
+
+#include <cinttypes>
+#include <vector>
+
+namespace icache_test
+{
+    // Stands in for the L2: answers every ICache miss request after
+    // a fixed latency, and keeps the ICache's credits topped up
+    class L2SinkUnit : public sparta::Unit
+    {
+      public:
+        static constexpr char name[] = "L2SinkUnit";
+
+        class L2SinkUnitParameters : public sparta::ParameterSet
+        {
+          public:
+            explicit L2SinkUnitParameters(sparta::TreeNode* n) : sparta::ParameterSet(n) {}
+            PARAMETER(sparta::Clock::Cycle, sink_latency, 10, "Latency of a miss request")
+            PARAMETER(uint32_t, credits, 8, "Requests the ICache can have outstanding")
+        };
+
+        L2SinkUnit(sparta::TreeNode* n, const L2SinkUnitParameters* params) :
+            sparta::Unit(n),
+            sink_latency_(params->sink_latency),
+            credits_(params->credits)
+        {
+            in_icache_req_.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(
+                L2SinkUnit, sinkReq_, olympia::MemoryAccessInfoPtr));
+
+            sparta::StartupEvent(n, CREATE_SPARTA_HANDLER(L2SinkUnit, sendInitialCredits_));
+        }
+
+        //! Line addresses requested, in order
+        const std::vector<uint64_t> & getRequests() const { return requests_; }
+
+      private:
+        void sendInitialCredits_()
+        {
+            ILOG("Sending initial credits to ICache : " << credits_);
+            out_icache_ack_.send(credits_);
+        }
+
+        void sinkReq_(const olympia::MemoryAccessInfoPtr & mem_info)
+        {
+            ILOG("Miss request " << mem_info << " sinked");
+            requests_.emplace_back(mem_info->getPhyAddr());
+            out_icache_ack_.send(credits_);
+            out_icache_resp_.send(mem_info, sink_latency_);
+        }
+
+        sparta::DataInPort<olympia::MemoryAccessInfoPtr> in_icache_req_{&unit_port_set_,
+                                                                        "in_icache_req", 1};
+        sparta::DataOutPort<olympia::MemoryAccessInfoPtr> out_icache_resp_{&unit_port_set_,
+                                                                           "out_icache_resp"};
+        sparta::DataOutPort<uint32_t> out_icache_ack_{&unit_port_set_, "out_icache_ack"};
+
+        const sparta::Clock::Cycle sink_latency_;
+        const uint32_t credits_;
+        std::vector<uint64_t> requests_;
+    };
+} // namespace icache_test
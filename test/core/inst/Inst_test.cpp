@@ -0,0 +1,72 @@
+#include "Inst.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <iostream>
+
+TEST_INIT
+
+// Inst's size is mostly its rename bit masks and registers, whose
+// sizes come from Sparta and Mavis.  Everything else (decode info
+// pointers, status, flags, ids, PCs, the retire event and the handle
+// on the cold record) must stay within two cache lines
+constexpr size_t MAX_OTHER_BYTES = 128;
+
+void runInstSizeTest()
+{
+   using olympia::Inst;
+   using RegList = Inst::RenameData::RegList;
+
+   const size_t masks =
+       3 * olympia::core_types::N_REGFILES * sizeof(olympia::core_types::RegisterBitMask);
+   const size_t sized_members = masks + sizeof(Inst::RenameData);
+
+   std::cout << "sizeof(Inst): " << sizeof(Inst) << " bytes, " << ((sizeof(Inst) + 63) / 64)
+             << " cache lines" << std::endl;
+   std::cout << "  rename bit masks: " << masks << std::endl;
+   std::cout << "  rename registers: " << sizeof(Inst::RenameData) << std::endl;
+   std::cout << "  everything else:  " << (sizeof(Inst) - sized_members) << std::endl;
+   std::cout << "sizeof(Inst::ColdData): " << sizeof(Inst::ColdData) << " bytes (rewind iterator "
+             << sizeof(Inst::RewindIterator) << ", vector CSRs " << sizeof(Inst::VCSRs) << ")"
+             << std::endl;
+
+   EXPECT_TRUE(sizeof(Inst) <= (sized_members + MAX_OTHER_BYTES));
+
+   // The cold fields are behind a single handle
+   EXPECT_TRUE(sizeof(Inst::ColdRecord) <= 2 * sizeof(void*));
+
+   // The source registers are inline: no heap storage hangs off an Inst
+   EXPECT_TRUE(sizeof(RegList) <= (RegList::MAX_REGS + 1) * sizeof(Inst::RenameData::Reg));
+}
+
+void runColdRecordTest()
+{
+   using olympia::Inst;
+
+   // Copying an Inst (Mavis does) gives the copy its own cold record
+   Inst::ColdRecord original;
+   original->program_id_increment = 3;
+   original->vcsrs.setVCSRs(32, 16, 2, true);
+
+   Inst::ColdRecord copy(original);
+   EXPECT_EQUAL(copy->program_id_increment, 3);
+   EXPECT_EQUAL(copy->vcsrs.vl, 32);
+   copy->program_id_increment = 5;
+   copy->vcsrs.setVCSRs(8, 8, 1, false);
+   EXPECT_EQUAL(original->program_id_increment, 3);
+   EXPECT_EQUAL(original->vcsrs.vl, 32);
+
+   Inst::ColdRecord assigned;
+   assigned = copy;
+   EXPECT_EQUAL(assigned->program_id_increment, 5);
+   assigned->program_id_increment = 7;
+   EXPECT_EQUAL(copy->program_id_increment, 5);
+}
+
+int main()
+{
+    runInstSizeTest();
+    runColdRecordTest();
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}
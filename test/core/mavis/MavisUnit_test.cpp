@@ -0,0 +1,70 @@
+#include "OlympiaSim.hpp"
+
+#include "sparta/app/CommandLineSimulator.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <string>
+
+TEST_INIT
+
+// Runs decode_cache_pattern.json through a full core with a 2-entry
+// decode cache.  The workload decodes add (A), sub (B) and xor (C)
+// in the order A B A C A B:
+//
+//   access   A     B     A     C     A     B
+//   result   miss  miss  hit   miss  hit   miss
+//   evicts                     B           C
+//   LRU      A     B A   A B   C A   A C   B A
+
+const char USAGE[] = "Usage:\n"
+                     "    MavisUnit_test --workload <decode_cache_pattern.json>\n"
+                     "\n";
+
+sparta::app::DefaultValues DEFAULTS;
+
+uint64_t getCounter(sparta::RootTreeNode* root_node, const std::string & name)
+{
+    return root_node->getChildAs<sparta::CounterBase>("cpu.core0.mavis.stats." + name)->get();
+}
+
+void runTest(int argc, char** argv)
+{
+    DEFAULTS.auto_summary_default = "off";
+    std::string workload;
+
+    sparta::app::CommandLineSimulator cls(USAGE, DEFAULTS);
+    auto & app_opts = cls.getApplicationOptions();
+    app_opts.add_options()(
+        "workload", sparta::app::named_value<std::string>("WORKLOAD", &workload),
+        "JSON workload of opcodes");
+
+    int err_code = 0;
+    if (!cls.parse(argc, argv, err_code))
+    {
+        sparta_assert(false, "Command line parsing failed"); // Any errors already printed to cerr
+    }
+
+    sparta::Scheduler scheduler;
+    OlympiaSim sim("simple", scheduler, 1, workload);
+    cls.populateSimulation(&sim);
+    sparta::RootTreeNode* root_node = sim.getRoot();
+
+    cls.runSimulator(&sim);
+
+    EXPECT_EQUAL(root_node->getChildAs<sparta::CounterBase>("cpu.core0.rob.stats.total_number_retired")
+                     ->get(),
+                 6);
+    EXPECT_EQUAL(getCounter(root_node, "decode_cache_hits"), 2);
+    EXPECT_EQUAL(getCounter(root_node, "decode_cache_misses"), 4);
+    EXPECT_EQUAL(getCounter(root_node, "decode_cache_evictions"), 2);
+}
+
+int main(int argc, char** argv)
+{
+    runTest(argc, argv);
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}
@@ -0,0 +1,70 @@
+#include "UopCache.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+void runUopCacheTest()
+{
+   using olympia::UopCache;
+
+   // 2 sets of 2 entries, 32-byte windows of at most 4 uops
+   UopCache cache(4, 2, 32, 4);
+
+   UopCache::DecodedInst decoded;
+   decoded.pc = 0x1000;
+   decoded.num_uops = 3;
+   decoded.fusion_status = olympia::Inst::Status::FUSED;
+   decoded.fusion_size = 2;
+   EXPECT_TRUE(cache.lookup(0x1000) == nullptr);
+   EXPECT_TRUE(cache.fill(decoded));
+   EXPECT_TRUE(cache.lookup(0x1000) != nullptr);
+   EXPECT_EQUAL(cache.lookup(0x1000)->num_uops, 3u);
+   EXPECT_TRUE(cache.lookup(0x1000)->fusion_status == olympia::Inst::Status::FUSED);
+   EXPECT_EQUAL(cache.lookup(0x1000)->fusion_size, 2u);
+
+   // The window's entry fills up
+   decoded.pc = 0x1004;
+   decoded.num_uops = 1;
+   decoded.fusion_status = olympia::Inst::Status::FUSION_GHOST;
+   decoded.fusion_size = 1;
+   EXPECT_TRUE(cache.fill(decoded));
+   decoded.pc = 0x1008;
+   EXPECT_FALSE(cache.fill(decoded));
+   EXPECT_TRUE(cache.lookup(0x1008) == nullptr);
+
+   // Decoded again, fused differently
+   decoded.pc = 0x1000;
+   decoded.fusion_status = olympia::Inst::Status::UNMOD;
+   EXPECT_TRUE(cache.fill(decoded));
+   EXPECT_TRUE(cache.lookup(0x1000)->fusion_status == olympia::Inst::Status::UNMOD);
+   EXPECT_EQUAL(cache.lookup(0x1000)->fusion_size, 1u);
+   EXPECT_EQUAL(cache.lookup(0x1000)->num_uops, 3u);
+
+   // 0x1000, 0x1040 and 0x1080 share a set: the LRU window goes
+   decoded.pc = 0x1040;
+   EXPECT_TRUE(cache.fill(decoded));
+   cache.lookup(0x1000);
+   decoded.pc = 0x1080;
+   EXPECT_TRUE(cache.fill(decoded));
+   EXPECT_TRUE(cache.lookup(0x1040) == nullptr);
+   EXPECT_TRUE(cache.lookup(0x1000) != nullptr);
+   EXPECT_TRUE(cache.lookup(0x1080) != nullptr);
+
+   // The other set is untouched
+   decoded.pc = 0x1020;
+   EXPECT_TRUE(cache.fill(decoded));
+   EXPECT_TRUE(cache.lookup(0x1000) != nullptr);
+   EXPECT_TRUE(cache.lookup(0x1020) != nullptr);
+
+   EXPECT_THROW(UopCache(6, 2, 32, 4));
+   EXPECT_THROW(UopCache(4, 2, 24, 4));
+   EXPECT_THROW(UopCache(4, 2, 32, 0));
+}
+
+int main()
+{
+    runUopCacheTest();
+
+    REPORT_ERROR;
+    return (int)ERROR_CODE;
+}